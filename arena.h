@@ -1,12 +1,29 @@
 #ifndef ARENA_ALLOCATOR_H
 #define ARENA_ALLOCATOR_H
 
+// NUMA placement binds mapped memory, so it needs mapped arenas
+#if defined(ARENA_NUMA) && !defined(ARENA_MMAP)
+#   define ARENA_MMAP
+#endif
+
+// Purging gives free pages back with madvise, so it needs the mapping support
+#if defined(ARENA_PURGE) && !defined(ARENA_MMAP)
+#   define ARENA_MMAP
+#endif
+
+// MAP_ANONYMOUS and madvise are hidden by strict standard modes, so the implementation asks for them before any system header.
+// Translation units that include a system header first must define _DEFAULT_SOURCE themselves.
+#if defined(ARENA_MMAP) && defined(ARENA_IMPLEMENTATION) && !defined(_DEFAULT_SOURCE)
+#   define _DEFAULT_SOURCE
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
@@ -16,7 +33,6 @@ extern "C" {
 #include <intrin.h>
 #endif
 
-
 #if (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L) || defined(__cplusplus)
 #   include <assert.h>
 #   define ARENA_STATIC_ASSERT(cond, msg) static_assert(cond, #msg)
@@ -26,15 +42,53 @@ extern "C" {
 #endif
 
 
+// Sanitizer hooks: free arena memory is poisoned for AddressSanitizer, MemorySanitizer or Valgrind memcheck (ARENA_VALGRIND)
+#if !defined(ARENA_NO_SANITIZER_HOOKS)
+#   if defined(__SANITIZE_ADDRESS__)
+#       define ARENA_HAS_ASAN
+#   elif defined(__has_feature)
+#       if __has_feature(address_sanitizer)
+#           define ARENA_HAS_ASAN
+#       elif __has_feature(memory_sanitizer)
+#           define ARENA_HAS_MSAN
+#       endif
+#   endif
+#   if defined(ARENA_HAS_ASAN) || defined(ARENA_HAS_MSAN) || defined(ARENA_VALGRIND)
+#       define ARENA_HAS_SANITIZER_HOOKS
+#   endif
+#endif
+
+#if defined(ARENA_HAS_SANITIZER_HOOKS) && defined(ARENA_HAS_ASAN)
+#   include <sanitizer/asan_interface.h>
+#   define ARENA_POISON_MEMORY(ptr, size)   ASAN_POISON_MEMORY_REGION((ptr), (size))
+#   define ARENA_UNPOISON_MEMORY(ptr, size) ASAN_UNPOISON_MEMORY_REGION((ptr), (size))
+#   define ARENA_DEFINE_MEMORY(ptr, size)   ASAN_UNPOISON_MEMORY_REGION((ptr), (size))
+#elif defined(ARENA_HAS_SANITIZER_HOOKS) && defined(ARENA_HAS_MSAN)
+#   include <sanitizer/msan_interface.h>
+#   define ARENA_POISON_MEMORY(ptr, size)   __msan_poison((ptr), (size))
+#   define ARENA_UNPOISON_MEMORY(ptr, size) __msan_poison((ptr), (size)) // Handed out memory starts uninitialized
+#   define ARENA_DEFINE_MEMORY(ptr, size)   __msan_unpoison((ptr), (size))
+#elif defined(ARENA_HAS_SANITIZER_HOOKS)
+#   include <valgrind/memcheck.h>
+#   define ARENA_POISON_MEMORY(ptr, size)   ((void)VALGRIND_MAKE_MEM_NOACCESS((ptr), (size)))
+#   define ARENA_UNPOISON_MEMORY(ptr, size) ((void)VALGRIND_MAKE_MEM_UNDEFINED((ptr), (size)))
+#   define ARENA_DEFINE_MEMORY(ptr, size)   ((void)VALGRIND_MAKE_MEM_DEFINED((ptr), (size)))
+#else
+#   define ARENA_POISON_MEMORY(ptr, size)   ((void)(ptr), (void)(size))
+#   define ARENA_UNPOISON_MEMORY(ptr, size) ((void)(ptr), (void)(size))
+#   define ARENA_DEFINE_MEMORY(ptr, size)   ((void)(ptr), (void)(size))
+#endif
+
 #ifndef ARENA_POISON_BYTE
 #   define ARENA_POISON_BYTE 0xDD
 #endif
 
+// Debug builds poison freed memory with ARENA_POISON_BYTE, unless a sanitizer already tracks it without writing it
 #if defined(ARENA_NO_POISONING)
 #   if defined(ARENA_POISONING)
 #       undef ARENA_POISONING
 #   endif
-#elif defined(DEBUG) && !defined(ARENA_POISONING)
+#elif defined(DEBUG) && !defined(ARENA_POISONING) && !defined(ARENA_HAS_SANITIZER_HOOKS)
 #   define ARENA_POISONING
 #endif
 
@@ -61,6 +115,208 @@ ARENA_STATIC_ASSERT(ARENA_MIN_BUFFER_SIZE > 0, "MIN_BUFFER_SIZE must be a positi
 
 
 #define ARENA_DEFAULT_ALIGNMENT 16 // Default memory alignment
+#define ARENA_MAGIC ((uintptr_t)0xDEADBEEF) // Key of the block magic without ARENA_HARDENING, odd like every key
+#define ARENA_KEY_TAG_MASK ((uintptr_t)(sizeof(uintptr_t) >= 8 ? 0xFFFF : 0xFF)) // Low bits every per-arena key shares with ARENA_MAGIC
+
+
+#ifdef ARENA_SIZE_CLASSES
+#   ifndef ARENA_SMALL_MAX_SIZE
+        // Largest block size (in bytes) served by the segregated size class bins.
+#       define ARENA_SMALL_MAX_SIZE 256
+#   endif
+#   define ARENA_SIZE_CLASS_STEP  ARENA_DEFAULT_ALIGNMENT // Granularity of size classes
+#   define ARENA_SIZE_CLASS_COUNT (ARENA_SMALL_MAX_SIZE / ARENA_SIZE_CLASS_STEP)
+ARENA_STATIC_ASSERT((ARENA_SMALL_MAX_SIZE % ARENA_SIZE_CLASS_STEP) == 0, "SMALL_MAX_SIZE must be a multiple of the size class step.");
+ARENA_STATIC_ASSERT((ARENA_SMALL_MAX_SIZE >= ARENA_SIZE_CLASS_STEP), "SMALL_MAX_SIZE must cover at least one size class.");
+#endif
+
+
+#ifdef ARENA_THREAD_SAFE
+#   ifndef ARENA_THREAD_CACHE_SIZE
+        // Number of recently freed blocks each thread keeps for reuse without synchronization.
+#       define ARENA_THREAD_CACHE_SIZE 16
+#   endif
+#   ifndef ARENA_THREAD_CACHE_MAX_SIZE
+        // Largest block size (in bytes) kept in the per-thread caches.
+#       define ARENA_THREAD_CACHE_MAX_SIZE 256
+#   endif
+#   ifndef ARENA_THREAD_CACHE_ARENAS
+        // Number of live arenas at once whose freed blocks the thread caches can hold, arenas beyond it bypass the caches.
+#       define ARENA_THREAD_CACHE_ARENAS 1024
+#   endif
+#   ifndef ARENA_THREAD_CACHE_REWINDS
+        // Rewinds to rising marks each arena tells apart for the thread caches, older ones are merged and drop the blocks cached in between.
+#       define ARENA_THREAD_CACHE_REWINDS 8
+#   endif
+#   ifndef ARENA_SHARED_BUMP_RESERVE
+        // Bytes a thread reserves at once from a shared bump region, allocations inside them take no atomic operation.
+#       define ARENA_SHARED_BUMP_RESERVE 4096
+#   endif
+#   ifndef ARENA_SHARED_BUMP_SLOTS
+        // Number of shared bump regions each thread keeps a reserved range in.
+#       define ARENA_SHARED_BUMP_SLOTS 4
+#   endif
+ARENA_STATIC_ASSERT((ARENA_THREAD_CACHE_SIZE > 0), "THREAD_CACHE_SIZE must allow at least one cached block.");
+ARENA_STATIC_ASSERT((ARENA_THREAD_CACHE_ARENAS > 0), "THREAD_CACHE_ARENAS must allow at least one caching arena.");
+ARENA_STATIC_ASSERT((ARENA_THREAD_CACHE_REWINDS > 1), "THREAD_CACHE_REWINDS must allow at least two rewinds.");
+ARENA_STATIC_ASSERT((ARENA_SHARED_BUMP_SLOTS > 0), "SHARED_BUMP_SLOTS must allow at least one reserved range.");
+#   if !defined(__GNUC__) && !defined(__clang__) && !defined(_MSC_VER)
+#       error "ARENA_THREAD_SAFE requires GCC/Clang atomic builtins or MSVC interlocked intrinsics"
+#   endif
+#endif
+
+
+#ifdef ARENA_MMAP
+#   if !defined(__unix__) && !defined(__APPLE__)
+#       error "ARENA_MMAP requires a POSIX system with mmap"
+#   endif
+#   ifndef ARENA_HUGE_PAGE_SIZE
+        // Size of the huge pages requested with ARENA_MMAP_HUGEPAGES, mappings are rounded to it
+#       define ARENA_HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+#   endif
+ARENA_STATIC_ASSERT(((ARENA_HUGE_PAGE_SIZE & (ARENA_HUGE_PAGE_SIZE - 1)) == 0), "HUGE_PAGE_SIZE must be a power of two.");
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   include <fcntl.h>
+#   include <errno.h>
+#   include <limits.h>
+#   include <stdio.h>
+#endif
+
+#ifdef ARENA_PURGE
+#   ifndef ARENA_PURGE_DECAY_MS
+        // Milliseconds freed memory may stay resident before frees purge the arena, 0 leaves purging to 'arena_purge'
+#       define ARENA_PURGE_DECAY_MS 0
+#   endif
+#   ifndef ARENA_PURGE_MIN_SIZE
+        // Smallest free block decayed purges give back, smaller holes are cheaper to keep than to fault in again
+#       define ARENA_PURGE_MIN_SIZE (64 * 1024)
+#   endif
+#   ifndef ARENA_PURGE_TICKS
+        // Frees between two reads of the decay clock
+#       define ARENA_PURGE_TICKS 64
+#   endif
+ARENA_STATIC_ASSERT((ARENA_PURGE_TICKS > 0), "PURGE_TICKS must allow at least one free between two clock reads.");
+#   include <time.h>
+#endif
+
+
+#ifdef ARENA_NUMA
+#   ifndef __linux__
+#       error "ARENA_NUMA requires Linux memory policy syscalls"
+#   endif
+#   ifndef ARENA_NUMA_MAX_NODES
+        // Highest number of NUMA nodes arenas can be placed on and pools keep arenas for
+#       define ARENA_NUMA_MAX_NODES 64
+#   endif
+ARENA_STATIC_ASSERT((ARENA_NUMA_MAX_NODES > 0), "NUMA_MAX_NODES must allow at least one node.");
+#   include <errno.h>
+#   include <sys/syscall.h>
+#endif
+
+#if defined(ARENA_THREAD_SAFE) && (defined(__GNUC__) || defined(__clang__))
+    // Tagged words read by lock-free paths use relaxed atomics, which compile to plain moves
+#   define ARENA_LOAD_TAGGED(field)         __atomic_load_n(&(field), __ATOMIC_RELAXED)
+#   define ARENA_STORE_TAGGED(field, value) __atomic_store_n(&(field), (value), __ATOMIC_RELAXED)
+#else
+#   define ARENA_LOAD_TAGGED(field)         (field)
+#   define ARENA_STORE_TAGGED(field, value) ((field) = (value))
+#endif
+
+
+#ifdef ARENA_DEFERRED_COALESCING
+#   ifndef ARENA_DEFERRED_LIMIT
+        // Number of freed blocks kept for quick reuse before they are coalesced with their neighbours.
+#       define ARENA_DEFERRED_LIMIT 64
+#   endif
+#   ifndef ARENA_DEFERRED_SCAN
+        // Blocks at the head of the quick-reuse list an allocation checks for a fit.
+#       define ARENA_DEFERRED_SCAN 4
+#   endif
+ARENA_STATIC_ASSERT((ARENA_DEFERRED_LIMIT > 0), "DEFERRED_LIMIT must allow at least one deferred block.");
+ARENA_STATIC_ASSERT((ARENA_DEFERRED_SCAN > 0), "DEFERRED_SCAN must check at least one block.");
+#endif
+
+#ifndef ARENA_STREAM_ZERO_MIN
+    // Ranges 'arena_reset_zero' clears from this size up bypass the cache, or are given back to the OS on mapped arenas
+#   define ARENA_STREAM_ZERO_MIN (1024 * 1024)
+#endif
+
+#ifndef ARENA_STREAM_COPY_MIN
+    // Buffers 'arena_memdup' and 'arena_copy_iov' copy from this size up are written past the cache
+#   define ARENA_STREAM_COPY_MIN (1024 * 1024)
+#endif
+
+#ifdef ARENA_PROFILING
+#   ifndef ARENA_PROFILE_RATE
+        // Average number of bytes allocated between two samples of the allocation profiler, 0 starts it switched off
+#       define ARENA_PROFILE_RATE (512 * 1024)
+#   endif
+#   ifndef ARENA_PROFILE_DEPTH
+        // Stack frames recorded per sample
+#       define ARENA_PROFILE_DEPTH 8
+#   endif
+#   ifndef ARENA_PROFILE_SITES
+        // Distinct allocation sites the profiler keeps, samples of further sites are only counted
+#       define ARENA_PROFILE_SITES 256
+#   endif
+ARENA_STATIC_ASSERT((ARENA_PROFILE_DEPTH > 0), "PROFILE_DEPTH must record at least one frame.");
+ARENA_STATIC_ASSERT((ARENA_PROFILE_SITES > 0), "PROFILE_SITES must keep at least one site.");
+#   include <stdio.h>
+#   if defined(__GLIBC__) || defined(__APPLE__)
+#       define ARENA_HAS_BACKTRACE
+#       include <execinfo.h>
+#   endif
+#endif
+
+
+#ifndef ARENA_VALIDATION
+    // Validation level pointers passed to free and resize are checked with at startup, one of ArenaValidation
+#   define ARENA_VALIDATION 1
+#endif
+ARENA_STATIC_ASSERT((ARENA_VALIDATION >= 0 && ARENA_VALIDATION <= 2), "VALIDATION must be a level of ArenaValidation.");
+
+#ifdef ARENA_HARDENING
+#   include <time.h>
+#endif
+
+
+// Bounded latency mode is built on the bitmap free index
+#if defined(ARENA_TLSF) && !defined(ARENA_FREE_INDEX_BITMAP)
+#   define ARENA_FREE_INDEX_BITMAP
+#endif
+
+#ifdef ARENA_FREE_INDEX_BITMAP
+#   ifndef ARENA_FREE_INDEX_SL_LOG2
+        // Log2 of the number of free lists every power of two of block sizes is split into
+#       define ARENA_FREE_INDEX_SL_LOG2 2
+#   endif
+#   ifndef ARENA_FREE_INDEX_MAX_SHIFT
+        // Log2 of the smallest size that has no first level class of its own, bigger blocks share the last list
+#       define ARENA_FREE_INDEX_MAX_SHIFT ((sizeof(size_t) * 8 > 36) ? 36 : 31)
+#   endif
+#   ifndef ARENA_FREE_INDEX_SCAN
+        // Blocks of one free list checked for the best fit before moving on to a bigger class
+#       define ARENA_FREE_INDEX_SCAN 8
+#   endif
+ARENA_STATIC_ASSERT((ARENA_FREE_INDEX_SL_LOG2 >= 1 && ARENA_FREE_INDEX_SL_LOG2 <= 5), "FREE_INDEX_SL_LOG2 must be between 1 and 5.");
+ARENA_STATIC_ASSERT((ARENA_FREE_INDEX_MAX_SHIFT > ARENA_FREE_INDEX_SL_LOG2 + 3), "FREE_INDEX_MAX_SHIFT must be above the linear classes.");
+ARENA_STATIC_ASSERT((ARENA_FREE_INDEX_MAX_SHIFT < sizeof(size_t) * 8), "FREE_INDEX_MAX_SHIFT must fit in size_t.");
+ARENA_STATIC_ASSERT((ARENA_FREE_INDEX_SCAN > 0), "FREE_INDEX_SCAN must check at least one block.");
+#   ifdef ARENA_TLSF
+        // Good fit needs no search inside a list, its head always fits
+#       define FREE_INDEX_SCAN_LIMIT 1
+#   else
+#       define FREE_INDEX_SCAN_LIMIT ARENA_FREE_INDEX_SCAN
+#   endif
+#endif
+
+
+// Features that keep additional per-arena state right after the Arena header
+#if defined(ARENA_SIZE_CLASSES) || defined(ARENA_THREAD_SAFE) || defined(ARENA_STATS) || defined(ARENA_FREE_INDEX_BITMAP) || defined(ARENA_DEFERRED_COALESCING) || defined(ARENA_ZERO_TRACKING) || defined(ARENA_FIT_POLICIES) || defined(ARENA_HARDENING) || defined(ARENA_PURGE)
+#   define ARENA_HAS_EXTENSION
+#endif
 
 
 #if defined(__GNUC__) || defined(__clang__)
@@ -76,6 +332,21 @@ ARENA_STATIC_ASSERT(ARENA_MIN_BUFFER_SIZE > 0, "MIN_BUFFER_SIZE must be a positi
 #define MAX_ALIGNMENT ((size_t)(256 << MIN_EXPONENT))
 #define MIN_ALIGNMENT ((size_t)sizeof(uintptr_t))
 
+#ifndef ARENA_MAX_ALLOC_ALIGNMENT
+    // Largest alignment a single allocation may ask for, arenas themselves are aligned up to MAX_ALIGNMENT
+#   define ARENA_MAX_ALLOC_ALIGNMENT (2 * 1024 * 1024)
+#endif
+#define MAX_ALLOC_ALIGNMENT ((size_t)ARENA_MAX_ALLOC_ALIGNMENT)
+ARENA_STATIC_ASSERT(((MAX_ALLOC_ALIGNMENT & (MAX_ALLOC_ALIGNMENT - 1)) == 0), "MAX_ALLOC_ALIGNMENT must be a power of two.");
+ARENA_STATIC_ASSERT((MAX_ALLOC_ALIGNMENT >= MAX_ALIGNMENT), "MAX_ALLOC_ALIGNMENT must not be below the maximum arena alignment.");
+
+#ifndef ARENA_POOL_SLAB_SIZE
+    // Size and alignment of the slabs object pools carve from their parent, a slot finds its slab by masking its address
+#   define ARENA_POOL_SLAB_SIZE MAX_ALIGNMENT
+#endif
+ARENA_STATIC_ASSERT(((ARENA_POOL_SLAB_SIZE & (ARENA_POOL_SLAB_SIZE - 1)) == 0), "POOL_SLAB_SIZE must be a power of two.");
+ARENA_STATIC_ASSERT((ARENA_POOL_SLAB_SIZE <= MAX_ALIGNMENT), "POOL_SLAB_SIZE must not exceed the maximum alignment.");
+
 #define ALIGNMENT_MASK  ((uintptr_t)7)
 #define SIZE_MASK       (~(uintptr_t)7)
 #define IS_FREE_FLAG    ((uintptr_t)1)
@@ -84,12 +355,15 @@ ARENA_STATIC_ASSERT(ARENA_MIN_BUFFER_SIZE > 0, "MIN_BUFFER_SIZE must be a positi
 #define IS_DYNAMIC_FLAG ((uintptr_t)1)
 #define IS_NESTED_FLAG  ((uintptr_t)2)
 #define TAIL_MASK       ((uintptr_t)~3)
+#define HAS_CHUNK_FLAG  ((uintptr_t)1)
+#define IS_MAPPED_FLAG  ((uintptr_t)2)
+#define FREE_BLOCKS_MASK ((uintptr_t)~3)
 
 #define RED false
 #define BLACK true
 
 #define BLOCK_MIN_SIZE (sizeof(Block) + ARENA_MIN_BUFFER_SIZE)
-#define ARENA_MIN_SIZE (sizeof(Arena) + BLOCK_MIN_SIZE)
+#define ARENA_MIN_SIZE (sizeof(Arena) + ARENA_EXT_RESERVE + BLOCK_MIN_SIZE)
 
 #define block_data(block) ((void *)((char *)(block) + sizeof(Block)))
 
@@ -135,6 +409,350 @@ struct Arena {
 
 ARENA_STATIC_ASSERT((sizeof(Arena) == sizeof(Block)), Size_mismatch_between_Arena_and_Block);
 
+#define ARENA_WORD_ROUND(size) (((size) + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1))
+
+#ifdef ARENA_STATS
+/*
+ * Arena counters structure
+ * Cumulative counters of the allocation paths, updated under the arena lock and reported by 'arena_get_stats'
+ */
+typedef struct ArenaCounters {
+    size_t in_use;          // Bytes of occupied blocks (headers included) since the last reset
+    size_t peak_in_use;     // Highest value 'in_use' ever reached
+    size_t tail_allocs;     // Allocations carved from the tail
+    size_t tree_allocs;     // Allocations served by a block of the free tree
+    size_t tail_frees;      // Frees that gave the block back to the tail
+    size_t tree_frees;      // Frees that put the block (merged with its neighbours) into the free tree
+    size_t merges;          // Merges of a freed block with a free neighbour or the tail
+} ArenaCounters;
+#endif // ARENA_STATS
+
+#ifdef ARENA_FREE_INDEX_BITMAP
+#define FREE_INDEX_SL_COUNT     ((size_t)1 << ARENA_FREE_INDEX_SL_LOG2)
+#define FREE_INDEX_LINEAR_SHIFT (ARENA_FREE_INDEX_SL_LOG2 + 3) // Sizes below 2^LINEAR_SHIFT map linearly in steps of 8 bytes
+#define FREE_INDEX_FL_COUNT     (ARENA_FREE_INDEX_MAX_SHIFT - FREE_INDEX_LINEAR_SHIFT + 2)
+ARENA_STATIC_ASSERT((FREE_INDEX_FL_COUNT <= 64), "FREE_INDEX_MAX_SHIFT leaves too many first level classes.");
+
+/*
+ * Free index structure
+ * Two-level segregated index of the free blocks, kept outside of them so a search touches only a few cache lines
+ * The first level splits sizes by power of two, the second splits every power of two into equal ranges
+ * Blocks of one range form a doubly linked list through 'left_free' (previous) and 'right_free' (next)
+ */
+typedef struct ArenaFreeIndex {
+    unsigned long long fl_bitmap;                               // Bit per first level class with a non-empty list
+    uint32_t sl_bitmap[FREE_INDEX_FL_COUNT];                    // Bit per non-empty list of every first level class
+    Block *heads[FREE_INDEX_FL_COUNT][FREE_INDEX_SL_COUNT];     // Heads of the free lists
+} ArenaFreeIndex;
+#endif // ARENA_FREE_INDEX_BITMAP
+
+#ifdef ARENA_THREAD_SAFE
+/*
+ * Rewind floor structure
+ * Lowest position the arena was rewound to from a given rewind on.
+ * Blocks cached before that rewind are still valid if they start in front of the floor.
+ */
+typedef struct ArenaRewindFloor {
+    uintptr_t rewind;       // Number of the first rewind the floor covers
+    uintptr_t position;     // Lowest position of that rewind and all later ones
+} ArenaRewindFloor;
+#endif // ARENA_THREAD_SAFE
+
+#ifdef ARENA_HAS_EXTENSION
+/*
+ * Arena extension structure
+ * Holds per-arena state of optional features, placed right after the Arena header
+ */
+typedef struct ArenaExt {
+    #ifdef ARENA_SIZE_CLASSES
+    Block *bins[ARENA_SIZE_CLASS_COUNT];    // Heads of the segregated lists of small blocks, one per size class
+    #endif
+    #ifdef ARENA_THREAD_SAFE
+    volatile long lock;                     // Spinlock guarding the blocks of the arena
+    Block *remote_free;                     // Lock-free stack of blocks freed by threads other than the owner
+    uintptr_t owner;                        // Token of the thread that created the arena
+    uintptr_t generation;                   // Unique id of the arena contents, renewed on every reset
+    uintptr_t cache_cell;                   // Liveness cell of the arena plus one, 0 before the first cached block
+    uintptr_t rewinds;                      // Number of rewinds since the generation was renewed
+    size_t floor_count;                     // Number of rewind floors in use
+    ArenaRewindFloor floors[ARENA_THREAD_CACHE_REWINDS]; // Rewind floors from the oldest, with rising positions
+    #endif
+    #ifdef ARENA_STATS
+    ArenaCounters counters;                 // Counters of the allocation paths
+    #endif
+    #ifdef ARENA_ZERO_TRACKING
+    uintptr_t zero_mark;                    // Memory from here to the end of the arena was never written since it was last known to be zero
+    void *fresh;                            // Data of the last allocation if it was carved from above the mark
+    #endif
+    #ifdef ARENA_DEFERRED_COALESCING
+    Block *deferred;                        // Quick-reuse list of freed blocks that are not coalesced yet
+    size_t deferred_count;                  // Number of blocks on the quick-reuse list
+    #endif
+    #ifdef ARENA_FIT_POLICIES
+    unsigned fit_policy;                    // Placement policy chosen at creation, one of ArenaFitPolicy
+    #endif
+    #ifdef ARENA_HARDENING
+    uintptr_t key;                          // Random key the magic of every block is XORed with, odd so it never decodes to a block
+    #endif
+    #ifdef ARENA_PURGE
+    size_t dirty;                           // Bytes freed since the last purge, their pages may still be resident
+    uint64_t dirty_since;                   // Decay clock (ms) when the dirty bytes were first seen, 0 before
+    size_t decay_ms;                        // Time dirty bytes may stay resident before a free purges them, 0 for never
+    unsigned purge_ticks;                   // Frees since the decay clock was last read
+    #endif
+    #ifdef ARENA_FREE_INDEX_BITMAP
+    ArenaFreeIndex free_index;              // Segregated index of the free blocks, replaces the free tree (keep it last)
+    #endif
+} ArenaExt;
+
+#   define ARENA_EXT_SIZE ARENA_WORD_ROUND(sizeof(ArenaExt))
+#   ifdef ARENA_FREE_INDEX_BITMAP
+        // Heads of the free lists are guarded by the bitmaps and need no clearing
+#       define ARENA_EXT_CLEAR_SIZE offsetof(ArenaExt, free_index.heads)
+#   else
+#       define ARENA_EXT_CLEAR_SIZE sizeof(ArenaExt)
+#   endif
+#else
+#   define ARENA_EXT_SIZE ((size_t)0)
+#endif // ARENA_HAS_EXTENSION
+
+
+/*
+ * Validation level
+ * Chooses how much 'arena_free_block', 'arena_try_resize' and friends check a pointer before they trust its header
+ */
+typedef enum ArenaValidation {
+    ARENA_VALIDATE_TRUSTED = 0,     // No checks, the header in front of the pointer is used as is (hot internal code)
+    ARENA_VALIDATE_CHECKED,         // Magic and arena bounds checks, foreign and freed pointers are ignored (default)
+    ARENA_VALIDATE_HARDENED         // Also checks the links to both neighbours, so a corrupted or forged header is ignored
+} ArenaValidation;
+
+#ifdef ARENA_FIT_POLICIES
+/*
+ * Fit policy
+ * Chooses where an allocation is placed when more than one free block, or the tail, could serve it
+ */
+typedef enum ArenaFitPolicy {
+    ARENA_FIT_BEST = 0,     // Smallest free block that fits, then the tail (default)
+    ARENA_FIT_FIRST,        // First free block found that fits, fewer steps of the free index search
+    ARENA_FIT_ADDRESS,      // Free block with the lowest address that fits, visits every block big enough
+    ARENA_FIT_TAIL          // The tail first, free blocks only once the tail is too small
+} ArenaFitPolicy;
+#endif // ARENA_FIT_POLICIES
+
+#define ARENA_GROWTH_FACTOR 2          // Default growth factor of growable arenas
+#define ARENA_RETAIN_ALL    SIZE_MAX   // Retain limit that keeps every chunk a growable arena reached
+
+/*
+ * Growth policy of growable arenas
+ * Describes how new chunks are sized and which of them survive 'arena_reset'
+ */
+typedef struct ArenaGrowthPolicy {
+    size_t growth_factor;   // Each new chunk is this many times bigger than the previous one, must be at least 1
+    size_t max_chunk_size;  // Upper bound for the size of a new chunk (0 for unbounded), bigger requests still get their own chunk
+    size_t retain_size;     // Total size of extra chunks kept across 'arena_reset', ARENA_RETAIN_ALL to keep all of them
+} ArenaGrowthPolicy;
+
+/*
+ * Chunk descriptor of growable arenas
+ * Every chunk of a growable arena is an arena on its own, chained to the next one.
+ * The descriptor of the first chunk (the head) also holds the state of the whole chain.
+ */
+typedef struct ArenaChunk {
+    Arena *next;                // Next chunk in the chain
+    Arena *current;             // Head only: chunk that served the last allocation
+    size_t next_size;           // Head only: size of the next chunk to create
+    ArenaGrowthPolicy policy;   // Head only: growth policy of the chain
+    Arena *parent;              // Head only: arena extra chunks are carved from, NULL when they come from malloc
+    bool touched;               // Whether the chunk served an allocation since the last reset
+    #ifdef ARENA_THREAD_SAFE
+    volatile long chain_lock;   // Head only: spinlock guarding the chain state
+    #endif
+} ArenaChunk;
+
+#define ARENA_CHUNK_SIZE ARENA_WORD_ROUND(sizeof(ArenaChunk))
+
+#ifdef ARENA_FIT_POLICIES
+/*
+ * Arena options
+ * Creation parameters of 'arena_new_dynamic_ex' and 'arena_new_static_ex', zero initialized options give the defaults
+ */
+typedef struct ArenaOptions {
+    size_t alignment;                   // Alignment of the arena, 0 for ARENA_DEFAULT_ALIGNMENT
+    ArenaFitPolicy fit_policy;          // Placement policy of the arena, shared by all chunks of a growable one
+    bool growable;                      // Chain new chunks when the arena runs out of space (dynamic arenas only)
+    const ArenaGrowthPolicy *growth;    // Growth policy of a growable arena, NULL for the default one
+} ArenaOptions;
+#endif // ARENA_FIT_POLICIES
+
+#ifdef ARENA_MMAP
+#define ARENA_MMAP_HUGEPAGES    ((unsigned)1)  // Back the arena with huge pages: MAP_HUGETLB if the system has them reserved, else madvise(MADV_HUGEPAGE)
+#define ARENA_MMAP_POPULATE     ((unsigned)2)  // Prefault committed memory, so first touches never fault in the allocation path
+#define ARENA_MMAP_RELEASE      ((unsigned)4)  // Give the pages released by 'arena_reset' back to the OS with MADV_DONTNEED
+#define ARENA_MMAP_LAZY_RELEASE ((unsigned)8)  // Same with MADV_FREE where available, the OS takes the pages only under memory pressure
+#define ARENA_MMAP_GUARD        ((unsigned)16) // Surround the reserved range with inaccessible guard pages, so overruns into or out of the arena fault
+
+/*
+ * Mapping descriptor of mmap-backed arenas
+ * The arena header sits at the start of the mapping, which commits the first 'capacity' bytes of the reserved range
+ */
+typedef struct ArenaMapping {
+    size_t reserved;    // Length of the reserved address range, the arena grows in place until it is committed entirely
+    size_t granule;     // Page size the mapping is committed and released in
+    unsigned flags;     // ARENA_MMAP_* flags the arena was created with
+    size_t guard;       // Length of the guard in front of and after the reserved range, 0 without ARENA_MMAP_GUARD
+} ArenaMapping;
+
+#define ARENA_MAPPING_SIZE ARENA_WORD_ROUND(sizeof(ArenaMapping))
+#define ARENA_MAPPING_FROM_FILE ((unsigned)1 << 30) // Internal flag of arenas mapped from an image, their pages must not be dropped
+#endif // ARENA_MMAP
+
+#ifdef ARENA_NUMA
+/*
+ * NUMA arena pool structure
+ * Holds one arena per NUMA node the process may use, so every thread can allocate from memory local to its node
+ * The pool itself is read-only after 'arena_numa_pool_init', sharing its arenas between threads needs ARENA_THREAD_SAFE
+ */
+typedef struct ArenaNumaPool {
+    Arena *nodes[ARENA_NUMA_MAX_NODES];   // Arena bound to every allowed node, NULL for the others
+    Arena *fallback;                      // Arena for threads running on a node without its own arena
+} ArenaNumaPool;
+#endif // ARENA_NUMA
+
+/*
+ * Bump region structure
+ * A header-free linear allocator carved from an arena (or placed in static memory)
+ * Allocations only move the cursor forward, memory comes back all at once with a reset or free
+ */
+typedef struct ArenaBump {
+    uintptr_t cursor;   // Next free byte of the region
+    uintptr_t end;      // One past the last byte of the region
+    size_t alignment;   // Alignment used by 'arena_bump_alloc'
+    Arena *parent;      // Arena the region was carved from, NULL for static regions
+} ArenaBump;
+
+#ifdef ARENA_THREAD_SAFE
+/*
+ * Shared bump region structure
+ * A bump region any number of threads allocate from at once. Threads reserve ranges of it with an atomic fetch-add
+ *  and carve their allocations from their own range without synchronization
+ * The cursor sits on a cache line of its own, so threads advancing it do not evict the other fields from each other
+ */
+typedef struct ArenaSharedBump {
+    uintptr_t start;        // First byte of the region handed out
+    uintptr_t end;          // One past the last byte of the region
+    size_t alignment;       // Alignment used by 'arena_shared_bump_alloc'
+    size_t reserve;         // Bytes a thread reserves when its range runs out
+    uintptr_t generation;   // Changes with every reset, ranges reserved before it are dropped
+    Arena *parent;          // Arena the region was carved from, NULL for static regions
+    char cursor_line[64];   // Padding in front of the cursor line
+    uintptr_t cursor;       // Next byte no thread has reserved yet, advanced atomically
+    char data_line[64];     // Padding between the cursor and the first allocations
+} ArenaSharedBump;
+#endif // ARENA_THREAD_SAFE
+
+/*
+ * Object pool structure
+ * Hands out fixed-size slots without headers from slabs carved from a parent arena
+ * Every slab starts at an ARENA_POOL_SLAB_SIZE boundary with its own header, so a slot finds it in O(1)
+ */
+typedef struct ArenaPoolSlab ArenaPoolSlab;
+
+typedef struct ArenaPool {
+    Arena *parent;              // Arena the pool and its slabs are carved from
+    size_t slot_size;           // Size of one slot, a multiple of the slot alignment
+    size_t slot_offset;         // Offset of the first slot from the start of a slab
+    size_t slots_per_slab;      // Number of slots one slab holds
+    ArenaPoolSlab *available;   // Slabs with at least one free slot
+    ArenaPoolSlab *full;        // Slabs with every slot handed out
+    ArenaPoolSlab *spare;       // Empty slab kept for the next allocation instead of being released
+} ArenaPool;
+
+/*
+ * Scatter-gather buffer structure
+ * One input buffer of 'arena_copy_iov', the system 'struct iovec' where there is one, so its arrays can be passed as they are
+ */
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/uio.h>
+typedef struct iovec ArenaIoVec;
+#else
+typedef struct ArenaIoVec {
+    void *iov_base;     // Start of the buffer
+    size_t iov_len;     // Length of the buffer in bytes
+} ArenaIoVec;
+#endif
+
+/*
+ * Arena statistics structure
+ * Snapshot filled by 'arena_get_stats', growable arenas report the sum over all of their chunks
+ * Counters are only collected with ARENA_STATS and stay zero without it
+ */
+typedef struct ArenaStats {
+    size_t capacity;            // Total size of the arena, headers included
+    size_t bytes_in_use;        // Bytes of occupied blocks, headers included (parked and nested blocks count as occupied)
+    size_t occupied_blocks;     // Number of occupied blocks
+    size_t free_bytes;          // Bytes in the blocks of the free tree, the tail is not included
+    size_t free_blocks;         // Number of blocks in the free tree
+    size_t largest_free_block;  // Size of the biggest block of the free tree
+    size_t tail_free;           // Free space left in the tail
+    size_t padding_bytes;       // Alignment padding in front of the data of occupied blocks
+    size_t peak_in_use;         // Counter: highest 'bytes_in_use' seen, summed over chunks for growable arenas
+    size_t tail_allocs;         // Counter: allocations carved from the tail
+    size_t tree_allocs;         // Counter: allocations served by a block of the free tree
+    size_t tail_frees;          // Counter: frees that gave the block back to the tail
+    size_t tree_frees;          // Counter: frees that put the block into the free tree
+    size_t merges;              // Counter: merges of freed blocks with free neighbours
+} ArenaStats;
+
+#ifdef ARENA_PROFILING
+/*
+ * Allocation site profile
+ * Samples of one call stack (and tag) recorded by the allocation profiler
+ */
+typedef struct ArenaProfileSite {
+    const char *tag;                        // Tag the thread set with 'arena_profile_set_tag', NULL for none
+    void *frames[ARENA_PROFILE_DEPTH];      // Return addresses of the call stack, innermost first
+    size_t depth;                           // Number of valid frames, 0 where backtraces are not available
+    size_t samples;                         // Number of sampled allocations
+    size_t sampled_bytes;                   // Bytes of the sampled allocations
+    size_t estimated_bytes;                 // Estimate of all bytes the site allocated, each sample stands for the sampling rate
+} ArenaProfileSite;
+#endif // ARENA_PROFILING
+
+/*
+ * Arena mark structure
+ * Position in an arena captured by 'arena_mark', 'arena_rewind' releases every block carved after it
+ * Marks are plain values and stay valid until the arena is reset or rewound to an earlier mark
+ */
+typedef struct ArenaMark {
+    Arena *chunk;           // Arena (chunk of a growable arena) whose tail the mark points into, NULL for an invalid mark
+    uintptr_t position;     // Address of the tail at the time of the mark, or end of the arena if the tail was occupied
+    Arena *last;            // Last chunk of a growable arena, chunks chained after it are released entirely
+} ArenaMark;
+
+/*
+ * Scoped mark
+ * Runs the following statement or block once, then rewinds the arena to where it was before it
+ * Leaving the block with 'break', 'return' or 'goto' skips the rewind
+ */
+#define ARENA_SCOPE(arena) \
+    for (ArenaMark arena_scope_mark_ = arena_mark(arena); arena_scope_mark_.chunk != NULL; arena_rewind((arena), arena_scope_mark_), arena_scope_mark_.chunk = NULL)
+
+/*
+ * Space reserved between the Arena header and its first block.
+ * The optional state (extension, then chunk descriptor or parent link) is followed by one more word,
+ *  so the padding detector in front of the first block never overlaps it.
+ * The reserve is rounded to the default alignment, so default aligned arenas need no extra padding.
+ */
+#define ARENA_RESERVE_ROUND(size) (((size) + ARENA_DEFAULT_ALIGNMENT - 1) & ~((size_t)ARENA_DEFAULT_ALIGNMENT - 1))
+#define ARENA_EXT_RESERVE    ((ARENA_EXT_SIZE != 0) ? ARENA_RESERVE_ROUND(ARENA_EXT_SIZE + sizeof(uintptr_t)) : (size_t)0)
+#define ARENA_CHUNK_RESERVE  ARENA_RESERVE_ROUND(ARENA_EXT_SIZE + ARENA_CHUNK_SIZE + sizeof(uintptr_t))
+#define ARENA_NESTED_RESERVE ARENA_RESERVE_ROUND(ARENA_EXT_SIZE + sizeof(Arena *) + sizeof(uintptr_t))
+#define ARENA_NESTED_CHUNK_RESERVE ARENA_RESERVE_ROUND(ARENA_EXT_SIZE + ARENA_CHUNK_SIZE + sizeof(Arena *) + sizeof(uintptr_t))
+#ifdef ARENA_MMAP
+#define ARENA_MAPPED_RESERVE ARENA_RESERVE_ROUND(ARENA_EXT_SIZE + ARENA_MAPPING_SIZE + sizeof(uintptr_t))
+#endif
+
 
 #ifdef DEBUG
 #include <stdio.h>
@@ -148,18 +766,128 @@ void print_llrb_tree(Block *node, int depth);
 #ifndef ARENA_NO_MALLOC
 Arena *arena_new_dynamic(size_t size);
 Arena *arena_new_dynamic_custom(size_t size, size_t alignment);
+Arena *arena_new_dynamic_growable(size_t size);
+Arena *arena_new_dynamic_growable_custom(size_t size, size_t alignment, const ArenaGrowthPolicy *policy);
+Arena *arena_new_nested_growable(Arena *parent_arena, size_t size);
+Arena *arena_new_nested_growable_custom(Arena *parent_arena, size_t size, size_t alignment, const ArenaGrowthPolicy *policy);
+#endif // ARENA_NO_MALLOC
+
+#ifdef ARENA_FIT_POLICIES
+#ifndef ARENA_NO_MALLOC
+Arena *arena_new_dynamic_ex(size_t size, const ArenaOptions *options);
 #endif // ARENA_NO_MALLOC
+Arena *arena_new_static_ex(void *memory, size_t size, const ArenaOptions *options);
+ArenaFitPolicy arena_get_fit_policy(const Arena *arena);
+#endif // ARENA_FIT_POLICIES
+
+#ifdef ARENA_MMAP
+Arena *arena_new_mapped(size_t size, unsigned flags);
+Arena *arena_new_mapped_custom(size_t size, size_t alignment, unsigned flags);
+Arena *arena_new_mapped_growable(size_t size, size_t max_size, unsigned flags);
+Arena *arena_new_mapped_growable_custom(size_t size, size_t max_size, size_t alignment, unsigned flags);
+bool arena_save(Arena *arena, const char *path);
+Arena *arena_map_file(const char *path, unsigned flags);
+#endif // ARENA_MMAP
+
+#ifdef ARENA_NUMA
+Arena *arena_new_dynamic_numa(size_t size, int node);
+Arena *arena_new_dynamic_numa_custom(size_t size, size_t alignment, int node, unsigned flags);
+int arena_numa_current_node(void);
+bool arena_numa_pool_init(ArenaNumaPool *pool, size_t size, unsigned flags);
+Arena *arena_numa_pool_local(ArenaNumaPool *pool);
+Arena *arena_numa_pool_new_nested(ArenaNumaPool *pool, size_t size);
+void arena_numa_pool_free(ArenaNumaPool *pool);
+#endif // ARENA_NUMA
 
 Arena *arena_new_static(void *memory, size_t size);
 Arena *arena_new_static_custom(void *memory, size_t size, size_t alignment);
+Arena *arena_new_nested(Arena *parent_arena, size_t size);
+Arena *arena_new_nested_custom(Arena *parent_arena, size_t size, size_t alignment);
 void arena_reset(Arena *arena);
 void arena_free(Arena *arena);
 
+ArenaMark arena_mark(Arena *arena);
+void arena_rewind(Arena *arena, ArenaMark mark);
+
 void *arena_alloc(Arena *arena, size_t size);
 void *arena_alloc_custom(Arena *arena, size_t size, size_t alignment);
+void *arena_alloc_fast(Arena *arena, size_t size, size_t alignment);
 void *arena_calloc(Arena *arena, size_t nmemb, size_t size);
+void *arena_memdup(Arena *arena, const void *src, size_t size);
+char *arena_strdup(Arena *arena, const char *str);
+char *arena_strndup(Arena *arena, const char *str, size_t max_len);
+void *arena_copy_iov(Arena *arena, const ArenaIoVec *iov, size_t count);
 void arena_reset_zero(Arena *arena);
 void arena_free_block(void *data);
+size_t arena_alloc_batch(Arena *arena, size_t size, size_t count, void **out_ptrs);
+void arena_free_batch(void **ptrs, size_t count);
+bool arena_try_resize(void *data, size_t new_size);
+void arena_set_validation(ArenaValidation level);
+ArenaValidation arena_get_validation(void);
+
+/*
+ * Typed allocation
+ * ARENA_NEW allocates one object of the type through 'arena_alloc_fast': the size and alignment are constants
+ *  checked at compile time, so no parameter is checked at runtime. The arena must not be NULL
+ */
+#if defined(__cplusplus)
+#   define ARENA_ALIGNOF(type) alignof(type)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#   define ARENA_ALIGNOF(type) _Alignof(type)
+#else
+#   define ARENA_ALIGNOF(type) offsetof(struct { char c; type t; }, t)
+#endif
+#define ARENA_TYPE_ALIGNMENT(type) ((size_t)ARENA_ALIGNOF(type) > MIN_ALIGNMENT ? (size_t)ARENA_ALIGNOF(type) : MIN_ALIGNMENT)
+#define ARENA_TYPE_CHECK(type) (sizeof(char[((size_t)ARENA_ALIGNOF(type) <= MAX_ALIGNMENT) ? 1 : -1]) * 0) // Fails to compile for over-aligned types
+#define ARENA_NEW(arena, type) ((type *)arena_alloc_fast((arena), sizeof(type) + ARENA_TYPE_CHECK(type), ARENA_TYPE_ALIGNMENT(type)))
+
+ArenaBump *arena_bump_new(Arena *parent_arena, size_t size);
+ArenaBump *arena_bump_new_custom(Arena *parent_arena, size_t size, size_t alignment);
+ArenaBump *arena_bump_new_static(void *memory, size_t size);
+ArenaBump *arena_bump_new_static_custom(void *memory, size_t size, size_t alignment);
+void *arena_bump_alloc(ArenaBump *bump, size_t size);
+void *arena_bump_alloc_custom(ArenaBump *bump, size_t size, size_t alignment);
+void arena_bump_reset(ArenaBump *bump);
+void arena_bump_free(ArenaBump *bump);
+
+#ifdef ARENA_THREAD_SAFE
+ArenaSharedBump *arena_shared_bump_new(Arena *parent_arena, size_t size);
+ArenaSharedBump *arena_shared_bump_new_custom(Arena *parent_arena, size_t size, size_t alignment, size_t reserve);
+ArenaSharedBump *arena_shared_bump_new_static(void *memory, size_t size);
+ArenaSharedBump *arena_shared_bump_new_static_custom(void *memory, size_t size, size_t alignment, size_t reserve);
+void *arena_shared_bump_alloc(ArenaSharedBump *bump, size_t size);
+void *arena_shared_bump_alloc_custom(ArenaSharedBump *bump, size_t size, size_t alignment);
+void arena_shared_bump_reset(ArenaSharedBump *bump);
+void arena_shared_bump_free(ArenaSharedBump *bump);
+#endif // ARENA_THREAD_SAFE
+
+ArenaPool *arena_pool_new(Arena *parent_arena, size_t slot_size);
+ArenaPool *arena_pool_new_custom(Arena *parent_arena, size_t slot_size, size_t alignment);
+void *arena_pool_alloc(ArenaPool *pool);
+void arena_pool_release(ArenaPool *pool, void *slot);
+void arena_pool_reset(ArenaPool *pool);
+void arena_pool_free(ArenaPool *pool);
+
+void arena_get_stats(Arena *arena, ArenaStats *stats);
+void arena_coalesce(Arena *arena);
+
+#ifdef ARENA_PURGE
+size_t arena_purge(Arena *arena, size_t min_bytes);
+size_t arena_purge_decayed(Arena *arena);
+void arena_set_purge_decay(Arena *arena, size_t decay_ms);
+#endif // ARENA_PURGE
+
+#ifdef ARENA_PROFILING
+void arena_profile_set_rate(size_t rate);
+void arena_profile_set_tag(const char *tag);
+size_t arena_profile_get_sites(ArenaProfileSite *sites, size_t max_sites);
+void arena_profile_reset(void);
+void arena_dump_snapshot(Arena *arena, FILE *out);
+#endif // ARENA_PROFILING
+
+#ifdef ARENA_THREAD_SAFE
+void arena_thread_cache_flush(Arena *arena);
+#endif // ARENA_THREAD_SAFE
 
 
 
@@ -199,6 +927,38 @@ static inline size_t min_exponent_of(size_t num) {
     #endif
 }
 
+#ifdef ARENA_FREE_INDEX_BITMAP
+/*
+ * Helper function to find maximum exponent of a number
+ * Returns the position of the most significant set bit
+ */
+static inline size_t max_exponent_of(size_t num) {
+    if (num == 0) return 0; // Undefined for zero, return 0 as a safe default
+
+    #if defined(__GNUC__) || defined(__clang__)
+        return sizeof(unsigned long long) * 8 - 1 - (size_t)__builtin_clzll((unsigned long long)num);
+    #else
+        size_t exponent = 0;
+        while ((num >>= 1) != 0) ++exponent;
+        return exponent;
+    #endif
+}
+
+/*
+ * Helper function to find the lowest set bit of a bitmap
+ * Returns the position of the least significant set bit of a non-zero bitmap
+ */
+static inline size_t lowest_bit_of(unsigned long long bitmap) {
+    #if defined(__GNUC__) || defined(__clang__)
+        return (size_t)__builtin_ctzll(bitmap);
+    #else
+        size_t index = 0;
+        while ((bitmap & 1) == 0) { bitmap >>= 1; ++index; }
+        return index;
+    #endif
+}
+#endif // ARENA_FREE_INDEX_BITMAP
+
 /*
  * Get alignment from block
  * Extracts the alignment information stored in the block's size_and_alignment field
@@ -311,7 +1071,7 @@ static inline void set_size(Block *block, size_t size) {
 static inline Block *get_prev(const Block *block) {
     ARENA_ASSERT((block != NULL) && "Internal Error: 'get_prev' called on NULL block");
 
-    return (Block *)((uintptr_t)block->prev & PREV_MASK); // Clear flag bits to get actual pointer
+    return (Block *)((uintptr_t)ARENA_LOAD_TAGGED(block->prev) & PREV_MASK); // Clear flag bits to get actual pointer
 }
 
 /*
@@ -336,8 +1096,8 @@ static inline void set_prev(Block *block, void *ptr) {
      * This way, we can store our flags without increasing the size of the Block struct at all.
     */
     
-    uintptr_t flags_tips = (uintptr_t)block->prev & ~PREV_MASK; // Preserve flag bits
-    block->prev = (Block *)((uintptr_t)ptr | flags_tips); // Set new pointer while preserving flag bits
+    uintptr_t flags_tips = (uintptr_t)ARENA_LOAD_TAGGED(block->prev) & ~PREV_MASK; // Preserve flag bits
+    ARENA_STORE_TAGGED(block->prev, (Block *)((uintptr_t)ptr | flags_tips)); // Set new pointer while preserving flag bits
 }
 
 
@@ -349,7 +1109,7 @@ static inline void set_prev(Block *block, void *ptr) {
 static inline bool get_is_free(const Block *block) {
     ARENA_ASSERT((block != NULL) && "Internal Error: 'get_is_free' called on NULL block");
 
-    return (uintptr_t)block->prev & IS_FREE_FLAG; // Check the is_free flag bit
+    return (uintptr_t)ARENA_LOAD_TAGGED(block->prev) & IS_FREE_FLAG; // Check the is_free flag bit
 }
 
 /*
@@ -364,14 +1124,14 @@ static inline void set_is_free(Block *block, bool is_free) {
      * Here we use 1st least significant bit to store is_free flag. 
     */
 
-    uintptr_t int_ptr = (uintptr_t)(block->prev); // Get current pointer with flags
+    uintptr_t int_ptr = (uintptr_t)ARENA_LOAD_TAGGED(block->prev); // Get current pointer with flags
     if (is_free) {
         int_ptr |= IS_FREE_FLAG;  // Set the is_free flag bit
     }
     else {
         int_ptr &= ~IS_FREE_FLAG; // Clear the is_free flag bit
     }
-    block->prev = (Block *)int_ptr; // Update the prev field with new flags
+    ARENA_STORE_TAGGED(block->prev, (Block *)int_ptr); // Update the prev field with new flags
 }
 
 
@@ -383,7 +1143,7 @@ static inline void set_is_free(Block *block, bool is_free) {
 static inline bool get_color(Block *block) {
     ARENA_ASSERT((block != NULL) && "Internal Error: 'get_color' called on NULL block");
 
-    return ((uintptr_t)block->prev & COLOR_FLAG); // Check the color flag bit
+    return ((uintptr_t)ARENA_LOAD_TAGGED(block->prev) & COLOR_FLAG); // Check the color flag bit
 }
 
 /*
@@ -398,14 +1158,14 @@ static inline void set_color(Block *block, bool color) {
      * Here we use 2nd least significant bit to store color flag. 
     */
 
-    uintptr_t int_ptr = (uintptr_t)(block->prev); // Get current pointer with flags
+    uintptr_t int_ptr = (uintptr_t)ARENA_LOAD_TAGGED(block->prev); // Get current pointer with flags
     if (color) {
         int_ptr |= COLOR_FLAG; // Set the color flag bit
     }
     else {
         int_ptr &= ~COLOR_FLAG; // Clear the color flag bit
     }
-    block->prev = (Block *)int_ptr; // Update the prev field with new flags
+    ARENA_STORE_TAGGED(block->prev, (Block *)int_ptr); // Update the prev field with new flags
 }
 
 
@@ -468,7 +1228,7 @@ static inline uintptr_t get_magic(const Block *block) {
  * Set magic number for block
  * Updates the magic number in the block's as.occupied.magic field
  */
-static inline void set_magic(Block *block, void *user_ptr) {
+static inline void set_magic(Block *block, void *user_ptr, uintptr_t key) {
     ARENA_ASSERT((block != NULL)    && "Internal Error: 'set_magic' called on NULL block");
     ARENA_ASSERT((user_ptr != NULL) && "Internal Error: 'set_magic' called on NULL user_ptr");
 
@@ -483,20 +1243,21 @@ static inline void set_magic(Block *block, void *user_ptr) {
      * By XORing the magic number with the user pointer, we create a unique magic value for each allocation.
      * This makes it significantly harder for an attacker to guess or forge valid magic numbers,
      *  enhancing the security and integrity of the memory management system.
+     * With ARENA_HARDENING the constant is replaced by a random key of the arena, see 'arena_get_key'.
     */
 
-    block->as.occupied.magic = (uintptr_t)0xDEADBEEF ^ (uintptr_t)user_ptr; // Set magic number using XOR with user pointer
+    block->as.occupied.magic = key ^ (uintptr_t)user_ptr; // Set magic number using XOR with user pointer
 }
 
 /*
  * Validate magic number for block
  * Checks if the magic number in the block matches the expected value based on the user pointer
  */
-static inline bool is_valid_magic(const Block *block, const void *user_ptr) {
+static inline bool is_valid_magic(const Block *block, const void *user_ptr, uintptr_t key) {
     ARENA_ASSERT((block != NULL)    && "Internal Error: 'is_valid_magic' called on NULL block");
     ARENA_ASSERT((user_ptr != NULL) && "Internal Error: 'is_valid_magic' called on NULL user_ptr");
 
-    return ((get_magic(block) ^ (uintptr_t)user_ptr) == (uintptr_t)0xDEADBEEF); // Validate magic number by XORing with user pointer
+    return ((get_magic(block) ^ (uintptr_t)user_ptr) == key); // Validate magic number by XORing with user pointer
 }
 
 
@@ -533,7 +1294,7 @@ static inline void set_arena(Block *block, Arena *arena) {
 static inline Block *arena_get_tail(const Arena *arena) {
     ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_get_tail' called on NULL arena");
 
-    return (Block *)((uintptr_t)arena->as.self.tail & TAIL_MASK); // Clear the is_dynamic flag bit to get actual pointer
+    return (Block *)((uintptr_t)ARENA_LOAD_TAGGED(arena->as.self.tail) & TAIL_MASK); // Clear the is_dynamic flag bit to get actual pointer
 }
 
 /*
@@ -549,8 +1310,8 @@ static inline void arena_set_tail(Arena *arena, Block *block) {
      * In this case we store is_dynamic flag in the tail pointer.
     */
 
-    uintptr_t flags_tips = (uintptr_t)arena->as.self.tail & ~TAIL_MASK; // Preserve flag bits
-    arena->as.self.tail = (Block *)((uintptr_t)block | flags_tips); // set new pointer while preserving flag bits
+    uintptr_t flags_tips = (uintptr_t)ARENA_LOAD_TAGGED(arena->as.self.tail) & ~TAIL_MASK; // Preserve flag bits
+    ARENA_STORE_TAGGED(arena->as.self.tail, (Block *)((uintptr_t)block | flags_tips)); // set new pointer while preserving flag bits
 }
 
 
@@ -562,7 +1323,7 @@ static inline void arena_set_tail(Arena *arena, Block *block) {
 static inline bool arena_get_is_dynamic(const Arena *arena) {
     ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_get_is_dynamic' called on NULL arena");
 
-    return ((uintptr_t)arena->as.self.tail & IS_DYNAMIC_FLAG); // Check the is_dynamic flag bit
+    return ((uintptr_t)ARENA_LOAD_TAGGED(arena->as.self.tail) & IS_DYNAMIC_FLAG); // Check the is_dynamic flag bit
 }
 
 /*
@@ -577,14 +1338,14 @@ static inline void arena_set_is_dynamic(Arena *arena, bool is_dynamic) {
      * Here we use 1st least significant bit to store is_dynamic flag. 
     */
 
-    uintptr_t int_ptr = (uintptr_t)(arena->as.self.tail); // Get current pointer with flags
+    uintptr_t int_ptr = (uintptr_t)ARENA_LOAD_TAGGED(arena->as.self.tail); // Get current pointer with flags
     if (is_dynamic) {
         int_ptr |= IS_DYNAMIC_FLAG; // Set the is_dynamic flag bit
     }
     else {
         int_ptr &= ~IS_DYNAMIC_FLAG; // Clear the is_dynamic flag bit
     }
-    arena->as.self.tail = (Block *)int_ptr; // Update the tail field with new flags
+    ARENA_STORE_TAGGED(arena->as.self.tail, (Block *)int_ptr); // Update the tail field with new flags
 }
 
 
@@ -596,7 +1357,7 @@ static inline void arena_set_is_dynamic(Arena *arena, bool is_dynamic) {
 static inline bool arena_get_is_nested(const Arena *arena) {
     ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_get_is_nested' called on NULL arena");
 
-    return ((uintptr_t)arena->as.self.tail & IS_NESTED_FLAG);
+    return ((uintptr_t)ARENA_LOAD_TAGGED(arena->as.self.tail) & IS_NESTED_FLAG);
 }
 
 /*
@@ -611,14 +1372,14 @@ static inline void arena_set_is_nested(Arena *arena, bool is_nested) {
      * Here we use 2st least significant bit to store is_nested flag. 
     */
 
-    uintptr_t int_ptr = (uintptr_t)(arena->as.self.tail);  // Get current pointer with flags
+    uintptr_t int_ptr = (uintptr_t)ARENA_LOAD_TAGGED(arena->as.self.tail);  // Get current pointer with flags
     if (is_nested) {
         int_ptr |= IS_NESTED_FLAG; // Set the is_nested flag bit
     }
     else {
         int_ptr &= ~IS_NESTED_FLAG; // Clear the is_nested flag bit
     }
-    arena->as.self.tail = (Block *)int_ptr; // Update the tail field with new flags
+    ARENA_STORE_TAGGED(arena->as.self.tail, (Block *)int_ptr); // Update the tail field with new flags
 }
 
 
@@ -629,7 +1390,7 @@ static inline void arena_set_is_nested(Arena *arena, bool is_nested) {
 static inline Block *arena_get_free_blocks(const Arena *arena) {
     ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_get_free_blocks' called on NULL arena");
 
-    return arena->as.self.free_blocks; // Return pointer to the root of the free blocks tree
+    return (Block *)((uintptr_t)ARENA_LOAD_TAGGED(arena->as.self.free_blocks) & FREE_BLOCKS_MASK); // Clear the has_chunk flag bit to get actual pointer
 }
 
 /*
@@ -639,7 +1400,70 @@ static inline Block *arena_get_free_blocks(const Arena *arena) {
 static inline void arena_set_free_blocks(Arena *arena, Block *block) {
     ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_set_free_blocks' called on NULL arena");
 
-    arena->as.self.free_blocks = block; // Set pointer to the root of the free blocks tree
+    uintptr_t flags_tips = (uintptr_t)ARENA_LOAD_TAGGED(arena->as.self.free_blocks) & ~FREE_BLOCKS_MASK; // Preserve flag bits
+    ARENA_STORE_TAGGED(arena->as.self.free_blocks, (Block *)((uintptr_t)block | flags_tips)); // Set pointer to the root of the free blocks tree
+}
+
+/*
+ * Get has_chunk flag from arena
+ * Extracts the has_chunk flag stored in the arena's as.self.free_blocks field
+ */
+static inline bool arena_get_has_chunk(const Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_get_has_chunk' called on NULL arena");
+
+    return ((uintptr_t)ARENA_LOAD_TAGGED(arena->as.self.free_blocks) & HAS_CHUNK_FLAG); // Check the has_chunk flag bit
+}
+
+/*
+ * Set has_chunk flag for arena
+ * Updates the has_chunk flag in the arena's as.self.free_blocks field
+ */
+static inline void arena_set_has_chunk(Arena *arena, bool has_chunk) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_set_has_chunk' called on NULL arena");
+
+    /*
+     * Why is it safe to tag 'free_blocks'?
+     * The padding detector relies on the word right before the first block being an even pointer
+     *  when the block follows the header immediately. Arenas with a chunk descriptor always have
+     *  reserved space in between, so the detector is always written and never reads this field.
+    */
+
+    uintptr_t int_ptr = (uintptr_t)(arena->as.self.free_blocks); // Get current pointer with flags
+    if (has_chunk) {
+        int_ptr |= HAS_CHUNK_FLAG; // Set the has_chunk flag bit
+    } 
+    else {
+        int_ptr &= ~HAS_CHUNK_FLAG; // Clear the has_chunk flag bit
+    }
+    arena->as.self.free_blocks = (Block *)int_ptr; // Update the free_blocks field with new flags
+}
+
+/*
+ * Get is_mapped flag from arena
+ * Extracts the is_mapped flag stored in the arena's as.self.free_blocks field
+ */
+static inline bool arena_get_is_mapped(const Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_get_is_mapped' called on NULL arena");
+
+    return ((uintptr_t)ARENA_LOAD_TAGGED(arena->as.self.free_blocks) & IS_MAPPED_FLAG); // Check the is_mapped flag bit
+}
+
+/*
+ * Set is_mapped flag for arena
+ * Updates the is_mapped flag in the arena's as.self.free_blocks field
+ * Mapped arenas always have a reserve, so the padding detector never reads this field either
+ */
+static inline void arena_set_is_mapped(Arena *arena, bool is_mapped) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_set_is_mapped' called on NULL arena");
+
+    uintptr_t int_ptr = (uintptr_t)(arena->as.self.free_blocks); // Get current pointer with flags
+    if (is_mapped) {
+        int_ptr |= IS_MAPPED_FLAG; // Set the is_mapped flag bit
+    } 
+    else {
+        int_ptr &= ~IS_MAPPED_FLAG; // Clear the is_mapped flag bit
+    }
+    arena->as.self.free_blocks = (Block *)int_ptr; // Update the free_blocks field with new flags
 }
 
 
@@ -717,59 +1541,334 @@ static inline void arena_set_alignment(Arena *arena, size_t alignment) {
 
 
 
+#ifdef ARENA_HAS_EXTENSION
 /*
- * Get first block in arena
- * Calculates the pointer to the first block in the arena based on its alignment
+ * Get extension of arena
+ * Returns the optional per-arena state stored right after the Arena header
  */
-static inline Block *arena_get_first_block(const Arena *arena) {
-    ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_get_first_block' called on NULL arena");
-    
-    /*
-     * What is happening here?
-     * Since the Arena_c uses alignment for blocks, the first block may not be located immediately after the Arena struct.
-     * For example(on 64-bit systems), if the arena alignment is 32 bytes, and the size of Arena struct is 32 bytes (4 machine words),
-     *  malloc or stack allocation may return an address with 8 byte alignment, so to have the userdata of first block aligned to desired 32 bytes,
-     *  we need to calculate padding after the Arena struct that, after adding Block size metadata, reaches the next 32-byte aligned address.
-     * 
-     * Arena does that calculation automatically while created, to ensure alignment requirements are met.
-     * 
-     * To find the first block, we need to calculate its address based on the arena's alignment.
-    */
-
-    size_t align = arena_get_alignment(arena); // Get arena alignment
-    uintptr_t raw_start = (uintptr_t)arena + sizeof(Arena); // Calculate raw start address of the first block
-
-    uintptr_t aligned_start = align_up(raw_start + sizeof(Block), align) - sizeof(Block); // Align the start address to the arena's alignment
-    
-    return (Block *)aligned_start;
-} 
-
-
-
+static inline ArenaExt *arena_get_ext(const Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_get_ext' called on NULL arena");
 
+    return (ArenaExt *)(void *)((char *)arena + sizeof(Arena));
+}
+#endif // ARENA_HAS_EXTENSION
 
 /*
- * Get free size in tail block of arena
- * Calculates the amount of free space available in the tail block of the arena
+ * Get key of arena
+ * Returns the key the magic of the blocks of the arena is XORed with, a random one per arena with ARENA_HARDENING
  */
-static inline size_t free_size_in_tail(const Arena *arena) {
-    ARENA_ASSERT((arena != NULL) && "Internal Error: 'free_size_in_tail' called on NULL arena");
-   
-    Block *tail = arena_get_tail(arena); // Get the tail block of the arena 
-    if (!tail || !get_is_free(tail)) return 0;  // If tail is NULL or not free, that means no free space in tail
+static inline uintptr_t arena_get_key(const Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_get_key' called on NULL arena");
 
-    size_t occupied_relative_to_arena = (uintptr_t)tail + sizeof(Block) + get_size(tail) - (uintptr_t)arena;
-    
-    return arena_get_capacity(arena) - occupied_relative_to_arena;
+    #ifdef ARENA_HARDENING
+    return arena_get_ext(arena)->key;
+    #else
+    (void)arena;
+    return ARENA_MAGIC;
+    #endif
 }
 
 /*
- * Get next block from given block (unsafe)
- * Calculates the pointer to the next block based on the current block's size
- * Note: This function does not perform any boundary checks, it just does pointer arithmetic.
+ * Validation level of the process, read by every checked entry point
  */
-static inline Block *next_block_unsafe(const Block *block) {
-    ARENA_ASSERT((block != NULL) && "Internal Error: 'next_block_unsafe' called on NULL block");
+static ArenaValidation arena_validation_level = (ArenaValidation)ARENA_VALIDATION;
+
+
+
+
+#ifdef ARENA_THREAD_SAFE
+#if defined(_MSC_VER) && !defined(__clang__)
+#   include <intrin.h>
+#endif
+
+// POSIX threads run a destructor at exit, which gives the blocks left in the thread cache back
+#if !defined(_WIN32)
+#   include <pthread.h>
+#   define ARENA_HAS_THREAD_EXIT
+#endif
+
+#if defined(__cplusplus)
+#   define ARENA_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+#   define ARENA_THREAD_LOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#   define ARENA_THREAD_LOCAL _Thread_local
+#else
+#   define ARENA_THREAD_LOCAL __thread
+#endif
+
+/*
+ * Thread cache entry
+ * Recently freed block parked in the cache of the current thread.
+ * The generation ties the entry to the arena contents it was freed from,
+ *  so entries outliving an 'arena_reset' or 'arena_free' are never handed out.
+ * The liveness cell of the arena holds its current generation until the arena is freed,
+ *  so any thread can tell dead entries apart without touching the arena.
+ * Rewinds keep the generation, the entry is checked against the rewind floors of the arena instead.
+ */
+typedef struct ArenaCacheEntry {
+    Arena *arena;           // Arena owning the block, only compared and never dereferenced through the entry
+    uintptr_t generation;   // Generation of the arena at the time the block was cached
+    uintptr_t rewinds;      // Rewinds of the arena at the time the block was cached, or it was last checked
+    uintptr_t cell;         // Liveness cell of the arena
+    Block *block;           // Cached block, NULL for an empty slot
+} ArenaCacheEntry;
+
+#define ARENA_NO_CACHE_CELL UINTPTR_MAX // Cell of an arena that never uses the thread caches
+
+static ARENA_THREAD_LOCAL ArenaCacheEntry arena_thread_cache[ARENA_THREAD_CACHE_SIZE];
+static uintptr_t arena_cache_cells[ARENA_THREAD_CACHE_ARENAS]; // Current generation of the arena owning each cell, 0 for a free cell
+static uintptr_t arena_cache_cell_hint = 0;                     // Where the next search for a free cell starts
+static uintptr_t arena_generation_counter = 0;
+
+/*
+ * Atomic primitives
+ * Thin wrappers over GCC/Clang atomic builtins and MSVC interlocked intrinsics
+ */
+static inline void *arena_atomic_load_ptr(void *const volatile *target) {
+    #if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(target, __ATOMIC_ACQUIRE);
+    #else
+    return _InterlockedCompareExchangePointer((void *volatile *)target, NULL, NULL);
+    #endif
+}
+
+static inline bool arena_atomic_cas_ptr(void *volatile *target, void *expected, void *desired) {
+    #if defined(__GNUC__) || defined(__clang__)
+    return __atomic_compare_exchange_n(target, &expected, desired, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    #else
+    return _InterlockedCompareExchangePointer(target, desired, expected) == expected;
+    #endif
+}
+
+static inline void *arena_atomic_exchange_ptr(void *volatile *target, void *value) {
+    #if defined(__GNUC__) || defined(__clang__)
+    return __atomic_exchange_n(target, value, __ATOMIC_ACQ_REL);
+    #else
+    return _InterlockedExchangePointer(target, value);
+    #endif
+}
+
+static inline uintptr_t arena_atomic_fetch_add(volatile uintptr_t *target, uintptr_t value) {
+    #if defined(__GNUC__) || defined(__clang__)
+    return __atomic_fetch_add(target, value, __ATOMIC_RELAXED);
+    #else
+    uintptr_t current;
+    do {
+        current = (uintptr_t)arena_atomic_load_ptr((void *const volatile *)target);
+    } while (!arena_atomic_cas_ptr((void *volatile *)target, (void *)current, (void *)(current + value)));
+    return current;
+    #endif
+}
+
+static inline uintptr_t arena_atomic_next_generation(void) {
+    #if defined(__GNUC__) || defined(__clang__)
+    return __atomic_add_fetch(&arena_generation_counter, 1, __ATOMIC_RELAXED);
+    #else
+    uintptr_t generation;
+    do {
+        generation = (uintptr_t)arena_atomic_load_ptr((void *const volatile *)&arena_generation_counter);
+    } while (!arena_atomic_cas_ptr((void *volatile *)&arena_generation_counter, (void *)generation, (void *)(generation + 1)));
+    return generation + 1;
+    #endif
+}
+
+/*
+ * Spinlock primitives
+ * Locks are held only for the duration of a single tree or tail operation
+ */
+static inline void arena_spin_lock(volatile long *lock) {
+    #if defined(__GNUC__) || defined(__clang__)
+    while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(lock, __ATOMIC_RELAXED)) {} // Spin on plain loads to keep the cache line shared
+    }
+    #else
+    while (_InterlockedExchange(lock, 1)) {
+        while (*lock) {}
+    }
+    #endif
+}
+
+static inline void arena_spin_unlock(volatile long *lock) {
+    #if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+    #else
+    _InterlockedExchange(lock, 0);
+    #endif
+}
+
+/*
+ * Get token of current thread
+ * The address of a thread-local object is unique among all running threads
+ */
+static inline uintptr_t current_thread_token(void) {
+    return (uintptr_t)(void *)&arena_thread_cache[0];
+}
+#endif // ARENA_THREAD_SAFE
+
+#ifdef ARENA_HARDENING
+static uint64_t arena_key_counter = 0;
+
+/*
+ * Make arena key
+ * Mixes the clock, the address of the arena and a counter with the splitmix64 finalizer
+ * The key is not a cryptographic secret, it only keeps headers from being forged without reading the arena first
+ */
+static inline uintptr_t make_arena_key(const Arena *arena) {
+    uint64_t x = (uint64_t)(uintptr_t)arena ^ ((uint64_t)time(NULL) << 20) ^ (uint64_t)clock();
+    #ifdef ARENA_THREAD_SAFE
+    // Threads may create arenas at once, the generation counter hands out unique numbers to all of them
+    uint64_t count = (uint64_t)arena_atomic_next_generation();
+    #else
+    uint64_t count = ++arena_key_counter;
+    #endif
+    x ^= (uint64_t)(uintptr_t)&arena_key_counter + count * 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+
+    // The tag bits let foreign pointers be rejected before their arena is read, and keep keys odd so they never
+    //  decode to a block pointer, see 'decode_block'
+    return ((uintptr_t)x & ~ARENA_KEY_TAG_MASK) | (ARENA_MAGIC & ARENA_KEY_TAG_MASK);
+}
+#endif // ARENA_HARDENING
+
+/*
+ * Lock arena
+ * Acquires the arena spinlock in thread-safe mode, no-op otherwise
+ */
+static inline void lock_arena(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'lock_arena' called on NULL arena");
+
+    #ifdef ARENA_THREAD_SAFE
+    arena_spin_lock(&arena_get_ext(arena)->lock);
+    #else
+    (void)arena;
+    #endif
+}
+
+/*
+ * Unlock arena
+ * Releases the arena spinlock in thread-safe mode, no-op otherwise
+ */
+static inline void unlock_arena(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'unlock_arena' called on NULL arena");
+
+    #ifdef ARENA_THREAD_SAFE
+    arena_spin_unlock(&arena_get_ext(arena)->lock);
+    #else
+    (void)arena;
+    #endif
+}
+
+/*
+ * Get chunk descriptor of arena
+ * Returns the chain state of a growable arena, stored after the extension
+ */
+static inline ArenaChunk *arena_get_chunk(const Arena *arena) {
+    ARENA_ASSERT((arena != NULL)              && "Internal Error: 'arena_get_chunk' called on NULL arena");
+    ARENA_ASSERT((arena_get_has_chunk(arena)) && "Internal Error: 'arena_get_chunk' called on arena without chunk");
+
+    return (ArenaChunk *)(void *)((char *)arena + sizeof(Arena) + ARENA_EXT_SIZE);
+}
+
+/*
+ * Get parent link of nested arena
+ * Returns the slot holding the arena the nested arena was carved from, stored after the extension
+ *  and, for chunks of a nested growable arena, after the chunk descriptor
+ */
+static inline Arena **arena_get_parent_link(const Arena *arena) {
+    ARENA_ASSERT((arena != NULL)              && "Internal Error: 'arena_get_parent_link' called on NULL arena");
+    ARENA_ASSERT((arena_get_is_nested(arena)) && "Internal Error: 'arena_get_parent_link' called on not nested arena");
+
+    size_t offset = sizeof(Arena) + ARENA_EXT_SIZE + (arena_get_has_chunk(arena) ? ARENA_CHUNK_SIZE : 0);
+    return (Arena **)(void *)((char *)arena + offset);
+}
+
+#ifdef ARENA_MMAP
+/*
+ * Get mapping descriptor of arena
+ * Returns the descriptor of an mmap-backed arena, stored after the extension
+ */
+static inline ArenaMapping *arena_get_mapping(const Arena *arena) {
+    ARENA_ASSERT((arena != NULL)              && "Internal Error: 'arena_get_mapping' called on NULL arena");
+    ARENA_ASSERT((arena_get_is_mapped(arena)) && "Internal Error: 'arena_get_mapping' called on not mapped arena");
+
+    return (ArenaMapping *)(void *)((char *)arena + sizeof(Arena) + ARENA_EXT_SIZE);
+}
+#endif // ARENA_MMAP
+
+/*
+ * Get reserved space of arena
+ * Returns the amount of space reserved between the Arena header and its first block
+ */
+static inline size_t arena_get_reserve(const Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_get_reserve' called on NULL arena");
+
+    if (arena_get_has_chunk(arena)) return arena_get_is_nested(arena) ? ARENA_NESTED_CHUNK_RESERVE : ARENA_CHUNK_RESERVE;
+    if (arena_get_is_nested(arena)) return ARENA_NESTED_RESERVE;
+    #ifdef ARENA_MMAP
+    if (arena_get_is_mapped(arena)) return ARENA_MAPPED_RESERVE;
+    #endif
+    return ARENA_EXT_RESERVE;
+}
+
+
+
+/*
+ * Get first block in arena
+ * Calculates the pointer to the first block in the arena based on its alignment
+ */
+static inline Block *arena_get_first_block(const Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_get_first_block' called on NULL arena");
+    
+    /*
+     * What is happening here?
+     * Since the Arena_c uses alignment for blocks, the first block may not be located immediately after the Arena struct.
+     * For example(on 64-bit systems), if the arena alignment is 32 bytes, and the size of Arena struct is 32 bytes (4 machine words),
+     *  malloc or stack allocation may return an address with 8 byte alignment, so to have the userdata of first block aligned to desired 32 bytes,
+     *  we need to calculate padding after the Arena struct that, after adding Block size metadata, reaches the next 32-byte aligned address.
+     * 
+     * Arena does that calculation automatically while created, to ensure alignment requirements are met.
+     * 
+     * To find the first block, we need to calculate its address based on the arena's alignment.
+     * If optional features keep extension state after the header, the first block starts after it.
+    */
+
+    size_t align = arena_get_alignment(arena); // Get arena alignment
+    uintptr_t raw_start = (uintptr_t)arena + sizeof(Arena) + arena_get_reserve(arena); // Calculate raw start address of the first block
+
+    uintptr_t aligned_start = align_up(raw_start + sizeof(Block), align) - sizeof(Block); // Align the start address to the arena's alignment
+    
+    return (Block *)aligned_start;
+} 
+
+
+
+
+
+/*
+ * Get free size in tail block of arena
+ * Calculates the amount of free space available in the tail block of the arena
+ */
+static inline size_t free_size_in_tail(const Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'free_size_in_tail' called on NULL arena");
+   
+    Block *tail = arena_get_tail(arena); // Get the tail block of the arena 
+    if (!tail || !get_is_free(tail)) return 0;  // If tail is NULL or not free, that means no free space in tail
+
+    size_t occupied_relative_to_arena = (uintptr_t)tail + sizeof(Block) + get_size(tail) - (uintptr_t)arena;
+    
+    return arena_get_capacity(arena) - occupied_relative_to_arena;
+}
+
+/*
+ * Get next block from given block (unsafe)
+ * Calculates the pointer to the next block based on the current block's size
+ * Note: This function does not perform any boundary checks, it just does pointer arithmetic.
+ */
+static inline Block *next_block_unsafe(const Block *block) {
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'next_block_unsafe' called on NULL block");
 
     return (Block *)((uintptr_t)block_data(block) + get_size(block)); // Calculate next block address based on current block's size
 }
@@ -814,7 +1913,66 @@ static inline Block *next_block(const Arena *arena, const Block *block) {
     return next_block;
 }
 
-/* 
+/*
+ * Sanitizer hooks
+ * Free memory of an arena is poisoned, so the sanitizer in use reports a use after free where it happens.
+ * Headers always stay accessible, every walk over the arena reads them. Without hooks these compile to nothing
+ */
+static inline void expose_header(Block *block) {
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'expose_header' called on NULL block");
+
+    ARENA_DEFINE_MEMORY(block, sizeof(Block));
+}
+
+static inline void poison_header(Block *block) {
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'poison_header' called on NULL block");
+
+    ARENA_POISON_MEMORY(block, sizeof(Block));
+}
+
+static inline void expose_block_data(Block *block) {
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'expose_block_data' called on NULL block");
+
+    ARENA_UNPOISON_MEMORY(block_data(block), get_size(block));
+}
+
+static inline void poison_block_data(Block *block) {
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'poison_block_data' called on NULL block");
+
+    ARENA_POISON_MEMORY(block_data(block), get_size(block));
+}
+
+static inline void poison_tail(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'poison_tail' called on NULL arena");
+
+    ARENA_POISON_MEMORY(block_data(arena_get_tail(arena)), free_size_in_tail(arena));
+}
+
+/*
+ * Check for poisoned memory
+ * Tells whether the sanitizer in use considers any byte of the range freed, without reporting it
+ * Always false without sanitizer hooks
+ */
+static inline bool is_memory_poisoned(const void *ptr, size_t size) {
+    ARENA_ASSERT((ptr != NULL) && "Internal Error: 'is_memory_poisoned' called on NULL ptr");
+
+    #if defined(ARENA_HAS_SANITIZER_HOOKS) && defined(ARENA_HAS_ASAN)
+    return __asan_region_is_poisoned((void *)(uintptr_t)ptr, size) != NULL;
+    #elif defined(ARENA_HAS_SANITIZER_HOOKS) && defined(ARENA_HAS_MSAN)
+    return __msan_test_shadow(ptr, size) != -1;
+    #elif defined(ARENA_HAS_SANITIZER_HOOKS)
+    VALGRIND_DISABLE_ERROR_REPORTING;
+    bool poisoned = VALGRIND_CHECK_MEM_IS_ADDRESSABLE(ptr, size) != 0;
+    VALGRIND_ENABLE_ERROR_REPORTING;
+    return poisoned;
+    #else
+    (void)ptr;
+    (void)size;
+    return false;
+    #endif
+}
+
+/*
  * Block creation functions
  * Functions to initialize new blocks within the arena
  */
@@ -823,6 +1981,7 @@ static inline Block *create_block(void *point) {
 
     // Initialize block metadata
     Block *block = (Block *)point;
+    expose_header(block);
     set_size(block, 0);
     set_prev(block, NULL);
     set_is_free(block, true);
@@ -844,6 +2003,7 @@ static inline Block *create_next_block(Arena *arena, Block *prev_block) {
     Block *next_block = NULL;
     if (is_block_within_arena(arena, prev_block)) {
         next_block = next_block_unsafe(prev_block);
+        expose_header(next_block); // The spot lies in free memory while the block does not exist
         
         // Safety check - next block already exists
         if (is_block_in_active_part(arena, next_block) && get_prev(next_block) == prev_block) return NULL;
@@ -878,6 +2038,8 @@ static inline void merge_blocks_logic(Arena *arena, Block *target, Block *source
     if (following) {
         set_prev(following, target);
     }
+
+    poison_header(source); // The header of the source is free memory inside the target now
 }
 
 
@@ -939,6 +2101,7 @@ static inline bool is_red(Block *block) {
     return get_color(block) == RED;
 }
 
+#ifndef ARENA_FREE_INDEX_BITMAP
 /*
  * Balance LLRB tree
  * Balances the LLRB tree after insertions or deletions
@@ -1025,14 +2188,15 @@ static Block *insert_block(Block *h, Block *new_block) {
  * Strategy: 
  *   The tree is ordered primarily by size, and secondarily by "address quality" (CTZ).
  *   We aim to find the smallest block that satisfies: block_size >= requested_size + alignment_padding.
+ *   With 'first_fit' the search stops at the first block that satisfies it instead.
  *   Performance: O(log n)
  */
-static Block *find_best_fit(Block *root, size_t size, size_t alignment, Block **out_parent) {
+static Block *find_best_fit(Block *root, size_t size, size_t alignment, bool first_fit, Block **out_parent) {
     ARENA_ASSERT((size > 0)          && "Internal Error: 'find_best_fit' called on too small size");
     ARENA_ASSERT((size <= SIZE_MASK) && "Internal Error: 'find_best_fit' called on too big size");
     ARENA_ASSERT(((alignment & (alignment - 1)) == 0) && "Internal Error: 'find_best_fit' called on invalid alignment");
     ARENA_ASSERT((alignment >= MIN_ALIGNMENT)         && "Internal Error: 'find_best_fit' called on too small alignment");
-    ARENA_ASSERT((alignment <= MAX_ALIGNMENT)         && "Internal Error: 'find_best_fit' called on too big alignment");
+    ARENA_ASSERT((alignment <= MAX_ALLOC_ALIGNMENT)   && "Internal Error: 'find_best_fit' called on too big alignment");
     
     if (root == NULL) return NULL;
 
@@ -1072,6 +2236,7 @@ static Block *find_best_fit(Block *root, size_t size, size_t alignment, Block **
                 best_parent = current_parent;
                 best = current;
             }
+            if (first_fit) break;
 
             // Look for a smaller block in the left sub-tree.
             current_parent = current;
@@ -1094,6 +2259,33 @@ static Block *find_best_fit(Block *root, size_t size, size_t alignment, Block **
     return best;
 }
 
+#ifdef ARENA_FIT_POLICIES
+/*
+ * Find lowest fit block in LLRB tree
+ * Searches the LLRB tree for the free block with the lowest address that can accommodate the requested size and alignment
+ * Only sub-trees that may hold blocks big enough are visited, the right spine iteratively and left sub-trees recursively
+ *   Performance: O(k) for the k blocks of at least the requested size, recursion depth bounded by the tree height
+ */
+static Block *find_lowest_fit(Block *node, size_t size, size_t alignment) {
+    Block *lowest = NULL;
+
+    while (node != NULL) {
+        if (get_size(node) >= size) {
+            uintptr_t data_ptr = (uintptr_t)block_data(node);
+            size_t padding = align_up(data_ptr, alignment) - data_ptr;
+            if (get_size(node) - size >= padding && (lowest == NULL || node < lowest)) lowest = node;
+
+            // Smaller blocks are on the left, some of them may still be big enough
+            Block *left = find_lowest_fit(get_left_tree(node), size, alignment);
+            if (left != NULL && (lowest == NULL || left < lowest)) lowest = left;
+        }
+        node = get_right_tree(node);
+    }
+
+    return lowest;
+}
+#endif // ARENA_FIT_POLICIES
+
 /*
  * Detach block from LLRB tree (fast version)
  * Removes a block from the LLRB tree without rebalancing
@@ -1147,17 +2339,17 @@ static void detach_block_fast(Block **tree_root, Block *target, Block *parent) {
  * High-level internal function that searches for the best fit and removes it from the tree.
  * Returns the detached block or NULL if no suitable block was found.
  */
-static Block *find_and_detach_block(Block **tree_root, size_t size, size_t alignment) {
+static Block *find_and_detach_block(Block **tree_root, size_t size, size_t alignment, bool first_fit) {
     ARENA_ASSERT((size > 0)          && "Internal Error: 'find_and_detach_block' called on too small size");
     ARENA_ASSERT((size <= SIZE_MASK) && "Internal Error: 'find_and_detach_block' called on too big size");
     ARENA_ASSERT(((alignment & (alignment - 1)) == 0) && "Internal Error: 'find_and_detach_block' called on invalid alignment");
     ARENA_ASSERT((alignment >= MIN_ALIGNMENT)         && "Internal Error: 'find_and_detach_block' called on too small alignment");
-    ARENA_ASSERT((alignment <= MAX_ALIGNMENT)         && "Internal Error: 'find_and_detach_block' called on too big alignment");
+    ARENA_ASSERT((alignment <= MAX_ALLOC_ALIGNMENT)   && "Internal Error: 'find_and_detach_block' called on too big alignment");
     
     if (*tree_root == NULL) return NULL;
 
     Block *parent = NULL;
-    Block *best = find_best_fit(*tree_root, size, alignment, &parent);
+    Block *best = find_best_fit(*tree_root, size, alignment, first_fit, &parent);
 
     if (best) {
         detach_block_fast(tree_root, best, parent);
@@ -1207,96 +2399,448 @@ static void detach_block_by_ptr(Block **tree_root, Block *target) {
         detach_block_fast(tree_root, target, parent);
     }
 }
+#endif // ARENA_FREE_INDEX_BITMAP
 
-static void arena_free_block_full(Arena *arena, Block *block);
+#ifdef ARENA_FREE_INDEX_BITMAP
 /*
- * Split block
- * Splits a larger free block into two blocks if it is significantly larger than needed
- * The remainder block is added back to the free blocks tree
+ * Map size to free list
+ * Finds the first and second level class of the free list that holds blocks of the given size
  */
-static inline void split_block(Arena *arena, Block *block, size_t needed_size) {
-    size_t full_size = get_size(block);
-    
-    if (full_size > needed_size && full_size - needed_size >= BLOCK_MIN_SIZE) {
-        set_size(block, needed_size);
-
-        Block *remainder = create_block(next_block_unsafe(block)); 
-        set_prev(remainder, block);
-        set_size(remainder, full_size - needed_size - sizeof(Block));
-        
-        Block *following = next_block(arena, remainder);
-        if (following) {
-            set_prev(following, remainder);
-        }
+static inline void free_index_mapping(size_t size, size_t *fl, size_t *sl) {
+    if (size < ((size_t)1 << FREE_INDEX_LINEAR_SHIFT)) {
+        *fl = 0;
+        *sl = size >> 3;
+        return;
+    }
 
-        arena_free_block_full(arena, remainder);
+    size_t shift = max_exponent_of(size);
+    if (shift > ARENA_FREE_INDEX_MAX_SHIFT) {
+        // Huge blocks share the very last list
+        *fl = FREE_INDEX_FL_COUNT - 1;
+        *sl = FREE_INDEX_SL_COUNT - 1;
+        return;
     }
+
+    *fl = shift - FREE_INDEX_LINEAR_SHIFT + 1;
+    *sl = (size >> (shift - ARENA_FREE_INDEX_SL_LOG2)) & (FREE_INDEX_SL_COUNT - 1);
 }
+#endif // ARENA_FREE_INDEX_BITMAP
 
 /*
- * Internal: Get the arena that owns this block
- * Uses neighbor-borrowing or the LSB Padding Detector to find the header.
+ * Insert block into free index
+ * Makes a free block available to allocations, either in the free tree or in the segregated free lists
  */
-static inline Arena *get_parent_arena(Block *block) {
-    Block *prev = block;
-    
-    /*
-     * Logic: Physical Neighbor Walkback
-     * We traverse the 'prev' pointers, which point to physical neighbors in memory.
-     * We are looking for a block that can tell us who its owner is.
-    */
-    while (get_prev(prev) != NULL) {
-        prev = get_prev(prev);
-
-        /* 
-         * We found an occupied block. But wait!
-         * Because Arena and Block are ABI-compatible, a nested arena 
-         * LOOKS like an occupied block to its parent. 
-         * We must check the 'IS_NESTED' flag to ensure we don't accidentally 
-         * treat a nested arena as a simple block.
-        */
-        if (!get_is_free(prev) && !arena_get_is_nested((Arena*)(void *)(prev))) {
-            return get_arena(prev);
-        }
+static inline void free_index_insert(Arena *arena, Block *block) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'free_index_insert' called on NULL arena");
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'free_index_insert' called on NULL block");
 
-        // If it's a nested arena or a free block, we keep walking back.
-    }
+    #ifdef ARENA_FREE_INDEX_BITMAP
+    ArenaFreeIndex *index = &arena_get_ext(arena)->free_index;
+    size_t fl, sl;
+    free_index_mapping(get_size(block), &fl, &sl);
 
-    /*
-     * Logic: Terminal Case - The First Block
-     * If we reach the start (prev == NULL), we are at the very beginning of 
-     * the arena segment. We check the word immediately preceding the block.
-     * To get more understanding whats going on go to 'arena_new_static_custom'
-     * function. 
-    */
-    uintptr_t *detector_spot = (uintptr_t *)((char *)prev - sizeof(uintptr_t));
-    uintptr_t val = *detector_spot;
-    
-    if (val & 1) return (Arena *)((char *)prev - (val >> 1));
+    Block *head = (index->sl_bitmap[fl] & ((uint32_t)1 << sl)) ? index->heads[fl][sl] : NULL;
+    set_left_tree(block, NULL);
+    set_right_tree(block, head);
+    if (head) set_left_tree(head, block);
 
-    return (Arena *)((char *)prev - sizeof(Arena));
+    index->heads[fl][sl] = block;
+    index->fl_bitmap |= 1ULL << fl;
+    index->sl_bitmap[fl] |= (uint32_t)1 << sl;
+    #else
+    arena_set_free_blocks(arena, insert_block(arena_get_free_blocks(arena), block));
+    #endif
 }
 
+/*
+ * Remove block from free index
+ * Takes a specific free block out of the free index, e.g. before it merges with a neighbour
+ */
+static inline void free_index_remove(Arena *arena, Block *block) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'free_index_remove' called on NULL arena");
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'free_index_remove' called on NULL block");
+
+    #ifdef ARENA_FREE_INDEX_BITMAP
+    ArenaFreeIndex *index = &arena_get_ext(arena)->free_index;
+    Block *prev = get_left_tree(block);
+    Block *next = get_right_tree(block);
+
+    if (next) set_left_tree(next, prev);
+    if (prev) {
+        set_right_tree(prev, next);
+    }
+    else {
+        size_t fl, sl;
+        free_index_mapping(get_size(block), &fl, &sl);
+        ARENA_ASSERT((index->heads[fl][sl] == block) && "Internal Error: 'free_index_remove' called on block outside of the index");
+
+        index->heads[fl][sl] = next;
+        if (!next) {
+            index->sl_bitmap[fl] &= ~((uint32_t)1 << sl);
+            if (index->sl_bitmap[fl] == 0) index->fl_bitmap &= ~(1ULL << fl);
+        }
+    }
+
+    set_left_tree(block, NULL);
+    set_right_tree(block, NULL);
+    #else
+    Block *root = arena_get_free_blocks(arena);
+    detach_block_by_ptr(&root, block);
+    arena_set_free_blocks(arena, root);
+    #endif
+}
 
+#ifdef ARENA_TLSF
+/*
+ * Round request up to good fit
+ * Returns the smallest size whose free list holds only blocks that fit the request, alignment padding included
+ * Every block of a list is at least its lower bound, so looking at the head of the first non-empty list is enough
+ */
+static inline size_t good_fit_size(const Arena *arena, size_t size, size_t alignment) {
+    // Free blocks are aligned to the arena, so no padding can exceed the difference of the alignments
+    size_t arena_alignment = arena_get_alignment(arena);
+    if (alignment > arena_alignment) size += alignment - arena_alignment;
 
+    size_t granularity = (size < ((size_t)1 << FREE_INDEX_LINEAR_SHIFT))
+        ? (size_t)8
+        : (size_t)1 << (max_exponent_of(size) - ARENA_FREE_INDEX_SL_LOG2);
+    size_t rounded = size + granularity - 1;
 
+    return (rounded < size) ? size : rounded; // LCOV_EXCL_LINE: only sizes close to SIZE_MAX overflow
+}
+#endif // ARENA_TLSF
 
 /*
- * Free block (full version)
- * Frees a block of memory and merges with adjacent free blocks if possible
+ * Take block from free index
+ * Finds a free block that fits the requested size and alignment and removes it from the free index
+ * The free tree returns the best fit, the free lists check up to ARENA_FREE_INDEX_SCAN blocks of the
+ *  smallest list that may fit and otherwise move on to the next non-empty list found by the bitmaps
+ * With ARENA_TLSF the request is rounded up to the next list first, so only the head of one list is checked
+ * With ARENA_FIT_POLICIES first fit takes the first block that fits, address-ordered fit checks every
+ *  block big enough and takes the lowest one
+ * Returns the detached block or NULL if no suitable block was found
  */
-static void arena_free_block_full(Arena *arena, Block *block) {
-    ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_free_block_full' called on NULL arena");
-    ARENA_ASSERT((block != NULL) && "Internal Error: 'arena_free_block_full' called on NULL block");
+static Block *free_index_take(Arena *arena, size_t size, size_t alignment) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'free_index_take' called on NULL arena");
 
-    set_is_free(block, true);
-    set_left_tree(block, NULL);
-    set_right_tree(block, NULL);
-    set_color(block, RED);
+    #ifdef ARENA_FIT_POLICIES
+    unsigned policy = arena_get_ext(arena)->fit_policy;
+    #endif
 
-    Block *tail = arena_get_tail(arena);
-    Block *prev = get_prev(block);
-    
+    #ifdef ARENA_FREE_INDEX_BITMAP
+    ArenaFreeIndex *index = &arena_get_ext(arena)->free_index;
+    if (index->fl_bitmap == 0) return NULL;
+
+    size_t scan_limit = FREE_INDEX_SCAN_LIMIT;
+    bool lowest_address = false;
+    #ifdef ARENA_FIT_POLICIES
+    if (policy == ARENA_FIT_FIRST) scan_limit = 1;
+    if (policy == ARENA_FIT_ADDRESS) {
+        scan_limit = SIZE_MAX;
+        lowest_address = true;
+    }
+    #endif
+
+    size_t fl, sl;
+    #ifdef ARENA_TLSF
+    free_index_mapping(good_fit_size(arena, size, alignment), &fl, &sl);
+    #else
+    free_index_mapping(size, &fl, &sl);
+    #endif
+
+    Block *best = NULL;
+    while (true) {
+        // Next non-empty list of the current first level class, or the first one of a bigger class
+        uint32_t sl_map = index->sl_bitmap[fl] & (~(uint32_t)0 << sl);
+        if (sl_map == 0) {
+            unsigned long long fl_map = (fl + 1 < FREE_INDEX_FL_COUNT) ? index->fl_bitmap & (~0ULL << (fl + 1)) : 0;
+            if (fl_map == 0) break;
+
+            fl = lowest_bit_of(fl_map);
+            sl_map = index->sl_bitmap[fl];
+        }
+        sl = lowest_bit_of(sl_map);
+
+        // The first list may hold smaller blocks, bigger ones may still lack room for the alignment padding
+        Block *current = index->heads[fl][sl];
+        for (size_t checked = 0; current && checked < scan_limit; checked++) {
+            size_t current_size = get_size(current);
+            uintptr_t data_ptr = (uintptr_t)block_data(current);
+            size_t padding = align_up(data_ptr, alignment) - data_ptr;
+
+            if (current_size >= size && current_size - size >= padding) {
+                if (!best || (lowest_address ? current < best : current_size < get_size(best))) best = current;
+            }
+            current = get_right_tree(current);
+        }
+
+        if (best && !lowest_address) break;
+
+        if (++sl == FREE_INDEX_SL_COUNT) {
+            sl = 0;
+            if (++fl == FREE_INDEX_FL_COUNT) break;
+        }
+    }
+
+    if (best) free_index_remove(arena, best);
+    return best;
+    #else
+    Block *root = arena_get_free_blocks(arena);
+    Block *block = NULL;
+    #ifdef ARENA_FIT_POLICIES
+    if (policy == ARENA_FIT_ADDRESS) {
+        block = find_lowest_fit(root, size, alignment);
+        if (block) detach_block_by_ptr(&root, block);
+    }
+    else {
+        block = find_and_detach_block(&root, size, alignment, policy == ARENA_FIT_FIRST);
+    }
+    #else
+    block = find_and_detach_block(&root, size, alignment, false);
+    #endif
+    arena_set_free_blocks(arena, root);
+
+    return block;
+    #endif
+}
+
+/*
+ * Clear free index
+ * Forgets every free block at once, used when the whole arena is reset
+ * List heads are only read where the bitmaps mark a list as non-empty, so clearing the bitmaps is enough
+ */
+static inline void free_index_clear(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'free_index_clear' called on NULL arena");
+
+    arena_set_free_blocks(arena, NULL);
+
+    #ifdef ARENA_FREE_INDEX_BITMAP
+    ArenaFreeIndex *index = &arena_get_ext(arena)->free_index;
+    index->fl_bitmap = 0;
+    memset(index->sl_bitmap, 0, sizeof(index->sl_bitmap));
+    #endif
+}
+
+/*
+ * Check free index
+ * Returns true if the arena has no free blocks outside its tail, so allocations can skip the search
+ */
+static inline bool free_index_is_empty(const Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'free_index_is_empty' called on NULL arena");
+
+    #ifdef ARENA_FREE_INDEX_BITMAP
+    return arena_get_ext(arena)->free_index.fl_bitmap == 0;
+    #else
+    return arena_get_free_blocks(arena) == NULL;
+    #endif
+}
+
+/*
+ * Count allocation
+ * Records a block that just became occupied in the counters of its arena, no-op without ARENA_STATS
+ */
+static inline void count_alloc(Arena *arena, const Block *block, bool from_tail) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'count_alloc' called on NULL arena");
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'count_alloc' called on NULL block");
+
+    #ifdef ARENA_STATS
+    ArenaCounters *counters = &arena_get_ext(arena)->counters;
+    if (from_tail) counters->tail_allocs++;
+    else counters->tree_allocs++;
+
+    counters->in_use += sizeof(Block) + get_size(block);
+    if (counters->in_use > counters->peak_in_use) counters->peak_in_use = counters->in_use;
+    #else
+    (void)block;
+    (void)from_tail;
+    #endif
+}
+
+/*
+ * Count free
+ * Records a block of 'block_size' bytes (header included) given back to the tail or the free tree,
+ *  no-op without ARENA_STATS and ARENA_PURGE
+ */
+static inline void count_free(Arena *arena, size_t block_size, bool to_tail) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'count_free' called on NULL arena");
+
+    #ifdef ARENA_PURGE
+    arena_get_ext(arena)->dirty += block_size;
+    #endif
+
+    #ifdef ARENA_STATS
+    ArenaCounters *counters = &arena_get_ext(arena)->counters;
+    if (to_tail) counters->tail_frees++;
+    else counters->tree_frees++;
+
+    counters->in_use = (counters->in_use > block_size) ? counters->in_use - block_size : 0;
+    #else
+    (void)block_size;
+    (void)to_tail;
+    #endif
+}
+
+/*
+ * Count merge
+ * Records a merge of a freed block with a free neighbour, no-op without ARENA_STATS
+ */
+static inline void count_merge(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'count_merge' called on NULL arena");
+
+    #ifdef ARENA_STATS
+    arena_get_ext(arena)->counters.merges++;
+    #endif
+}
+
+/*
+ * Count resize
+ * Records an occupied block changing its size in place, no-op without ARENA_STATS
+ */
+static inline void count_resize(Arena *arena, size_t old_size, size_t new_size) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'count_resize' called on NULL arena");
+
+    #ifdef ARENA_STATS
+    ArenaCounters *counters = &arena_get_ext(arena)->counters;
+    counters->in_use += new_size;
+    counters->in_use = (counters->in_use > old_size) ? counters->in_use - old_size : 0;
+    if (counters->in_use > counters->peak_in_use) counters->peak_in_use = counters->in_use;
+    #else
+    (void)old_size;
+    (void)new_size;
+    #endif
+}
+
+/*
+ * Mark tail dirty
+ * Raises the known-zero mark of the arena to the end of its tail, after blocks or a new tail header were written there
+ * No-op without ARENA_ZERO_TRACKING
+ */
+static inline void mark_tail_dirty(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'mark_tail_dirty' called on NULL arena");
+
+    #ifdef ARENA_ZERO_TRACKING
+    Block *tail = arena_get_tail(arena);
+    uintptr_t end = (uintptr_t)block_data(tail) + get_size(tail); // A free tail has zero size, an occupied one reaches the end of the arena
+    if (end > arena_get_ext(arena)->zero_mark) arena_get_ext(arena)->zero_mark = end;
+    #endif
+}
+
+/*
+ * Mark arena zeroed
+ * Lowers the known-zero mark to the data of the tail, once everything behind it is known to read as zero
+ * No-op without ARENA_ZERO_TRACKING
+ */
+static inline void mark_arena_zeroed(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'mark_arena_zeroed' called on NULL arena");
+
+    #ifdef ARENA_ZERO_TRACKING
+    arena_get_ext(arena)->zero_mark = (uintptr_t)block_data(arena_get_tail(arena));
+    #endif
+}
+
+#ifndef ARENA_NO_MALLOC
+/*
+ * Allocate backing memory
+ * Gets the memory of a dynamic arena or chunk from the C allocator
+ * With ARENA_ZERO_TRACKING it comes from 'calloc', which serves big requests with fresh pages that read as zero without being written
+ */
+static inline void *alloc_backing(size_t size) {
+    #ifdef ARENA_ZERO_TRACKING
+    return calloc(1, size);
+    #else
+    return malloc(size);
+    #endif
+}
+#endif // ARENA_NO_MALLOC
+
+/*
+ * Mark tail carved
+ * Remembers whether the data just carved from the tail lies above the known-zero mark, then raises the mark past it
+ * No-op without ARENA_ZERO_TRACKING
+ */
+static inline void mark_tail_carved(Arena *arena, void *data) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'mark_tail_carved' called on NULL arena");
+    ARENA_ASSERT((data != NULL)  && "Internal Error: 'mark_tail_carved' called on NULL data");
+
+    #ifdef ARENA_ZERO_TRACKING
+    ArenaExt *ext = arena_get_ext(arena);
+    ext->fresh = ((uintptr_t)data >= ext->zero_mark) ? data : NULL;
+    #else
+    (void)data;
+    #endif
+
+    mark_tail_dirty(arena);
+}
+
+static void arena_free_block_full(Arena *arena, Block *block);
+/*
+ * Split block
+ * Splits a larger free block into two blocks if it is significantly larger than needed
+ * The remainder block is added back to the free blocks tree
+ */
+static inline void split_block(Arena *arena, Block *block, size_t needed_size) {
+    size_t full_size = get_size(block);
+    
+    if (full_size > needed_size && full_size - needed_size >= BLOCK_MIN_SIZE) {
+        set_size(block, needed_size);
+
+        Block *remainder = create_block(next_block_unsafe(block)); 
+        set_prev(remainder, block);
+        set_size(remainder, full_size - needed_size - sizeof(Block));
+        
+        Block *following = next_block(arena, remainder);
+        if (following) {
+            set_prev(following, remainder);
+        }
+
+        arena_free_block_full(arena, remainder);
+    }
+}
+
+/*
+ * Internal: Get the arena that owns a nested arena
+ * Reads the parent link stored in the reserve of the nested arena, O(1) regardless of its neighbours
+ */
+static inline Arena *get_parent_arena(const Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'get_parent_arena' called on NULL arena");
+
+    /*
+     * Why not ask the block?
+     * A nested arena lives inside an occupied block of its parent, and since Arena and Block are ABI-compatible,
+     *  its header overwrites the 'as.occupied.arena' field of that block with its own 'tail'.
+     * Recovering the owner from physical neighbours means walking back over every free block and nested arena
+     *  in front of it, which gets slow with thousands of nested arenas in one parent.
+     * Instead 'arena_new_nested_custom' saves the owner of the block in the reserve before the header takes it over.
+    */
+
+    return *arena_get_parent_link(arena);
+}
+
+
+
+
+
+/*
+ * Free block (full version)
+ * Frees a block of memory and merges with adjacent free blocks if possible
+ */
+static void arena_free_block_full(Arena *arena, Block *block) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_free_block_full' called on NULL arena");
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'arena_free_block_full' called on NULL block");
+
+    // Remainders of splits come in already free, only occupied blocks count as frees
+    bool was_occupied = !get_is_free(block);
+    size_t released_size = sizeof(Block) + get_size(block);
+    poison_block_data(block);
+
+    set_is_free(block, true);
+    set_left_tree(block, NULL);
+    set_right_tree(block, NULL);
+    set_color(block, RED);
+
+    Block *tail = arena_get_tail(arena);
+    Block *prev = get_prev(block);
+    
     Block *result_to_tree = block;
     
     // If block is tail, just set its size to 0
@@ -1307,32 +2851,34 @@ static void arena_free_block_full(Arena *arena, Block *block) {
     else {
         Block *next = next_block(arena, block);
 
-        // If next block is tail, just set its size to 0 and update tail pointer
-        if (next == tail) {
+        // If next block is free tail, just set its size to 0 and update tail pointer
+        // (an occupied tail means the last allocation absorbed the whole remaining space)
+        if (next == tail && get_is_free(tail)) {
             set_size(block, 0);
             arena_set_tail(arena, block);
+            poison_header(tail);
             result_to_tree = NULL; 
+            count_merge(arena);
         } 
         // Merge with next block if it is free
         else if (next && get_is_free(next)) {
-            Block *free_blocks_root = arena_get_free_blocks(arena);
-            detach_block_by_ptr(&free_blocks_root, next);
-            arena_set_free_blocks(arena, free_blocks_root);
+            free_index_remove(arena, next);
             merge_blocks_logic(arena, block, next);
             result_to_tree = block;
+            count_merge(arena);
         }
     }
 
     // Merge with previous block if it is free
     if (prev && get_is_free(prev)) {
-        Block *free_blocks_root = arena_get_free_blocks(arena);
-        detach_block_by_ptr(&free_blocks_root, prev);
-        arena_set_free_blocks(arena, free_blocks_root);
+        count_merge(arena);
+        free_index_remove(arena, prev);
 
         // If we merged with tail before, just update tail pointer
         if (result_to_tree == NULL) {
             set_size(prev, 0);
             arena_set_tail(arena, prev);
+            poison_header(block);
         } 
         // Else, merge previous with current result
         else {
@@ -1343,10 +2889,10 @@ static void arena_free_block_full(Arena *arena, Block *block) {
 
     // Insert the resulting free block back into the free blocks tree
     if (result_to_tree != NULL) {
-        Block *free_blocks_root = arena_get_free_blocks(arena);
-        free_blocks_root = insert_block(free_blocks_root, result_to_tree);
-        arena_set_free_blocks(arena, free_blocks_root);
+        free_index_insert(arena, result_to_tree);
     }
+
+    if (was_occupied) count_free(arena, released_size, result_to_tree == NULL);
 }
 
 /*
@@ -1360,24 +2906,47 @@ static void *alloc_in_free_blocks(Arena *arena, size_t size, size_t alignment) {
     ARENA_ASSERT((size <= SIZE_MASK)                  && "Internal Error: 'alloc_in_free_blocks' called on too big size");
     ARENA_ASSERT(((alignment & (alignment - 1)) == 0) && "Internal Error: 'alloc_in_free_blocks' called on invalid alignment");
     ARENA_ASSERT((alignment >= MIN_ALIGNMENT)         && "Internal Error: 'alloc_in_free_blocks' called on too small alignment");
-    ARENA_ASSERT((alignment <= MAX_ALIGNMENT)         && "Internal Error: 'alloc_in_free_blocks' called on too big alignment");
+    ARENA_ASSERT((alignment <= MAX_ALLOC_ALIGNMENT)   && "Internal Error: 'alloc_in_free_blocks' called on too big alignment");
 
-    Block *root = arena_get_free_blocks(arena);
-    Block *block = find_and_detach_block(&root, size, alignment);
-    arena_set_free_blocks(arena, root);
-    
+    Block *block = free_index_take(arena, size, alignment);
+
+    #ifndef ARENA_TLSF
+    // Free blocks are aligned to the arena, one that is bigger by the difference of the alignments fits at any address
+    size_t arena_alignment = arena_get_alignment(arena);
+    if (!block && alignment > arena_alignment && size <= SIZE_MASK - alignment) {
+        block = free_index_take(arena, size + alignment - arena_alignment, arena_alignment);
+    }
+    #endif
     if (!block) return NULL;
-    
-    set_is_free(block, false);
-    
+
     uintptr_t data_ptr = (uintptr_t)block_data(block);
     uintptr_t aligned_ptr = align_up(data_ptr, alignment);
     size_t padding = aligned_ptr - data_ptr;
 
+    // Padding that can hold a block of its own goes back to the free index instead of being wasted in front of the data
+    if (padding >= BLOCK_MIN_SIZE) {
+        size_t full_size = get_size(block);
+        set_size(block, padding - sizeof(Block));
+
+        Block *aligned_block = create_block(next_block_unsafe(block));
+        set_prev(aligned_block, block);
+        set_size(aligned_block, full_size - padding);
+
+        Block *following = next_block(arena, aligned_block);
+        if (following) set_prev(following, aligned_block);
+
+        free_index_insert(arena, block);
+        block = aligned_block;
+        padding = 0;
+    }
+
+    set_is_free(block, false);
+
     size_t total_needed = padding + size;
     size_t aligned_needed = align_up(total_needed, sizeof(uintptr_t)); 
     
     split_block(arena, block, aligned_needed);
+    expose_block_data(block);
 
     if (padding > 0) {
         uintptr_t *spot_before = (uintptr_t *)(aligned_ptr - sizeof(uintptr_t));
@@ -1385,7 +2954,8 @@ static void *alloc_in_free_blocks(Arena *arena, size_t size, size_t alignment) {
     }
 
     set_arena(block, arena);
-    set_magic(block, (void *)aligned_ptr);
+    set_magic(block, (void *)aligned_ptr, arena_get_key(arena));
+    count_alloc(arena, block, false);
 
     return (void *)aligned_ptr;
 }
@@ -1401,7 +2971,7 @@ static void *alloc_in_tail_full(Arena *arena, size_t size, size_t alignment) {
     ARENA_ASSERT((size <= SIZE_MASK)                  && "Internal Error: 'alloc_in_tail_full' called on too big size");
     ARENA_ASSERT(((alignment & (alignment - 1)) == 0) && "Internal Error: 'alloc_in_tail_full' called on invalid alignment");
     ARENA_ASSERT((alignment >= MIN_ALIGNMENT)         && "Internal Error: 'alloc_in_tail_full' called on too small alignment");
-    ARENA_ASSERT((alignment <= MAX_ALIGNMENT)         && "Internal Error: 'alloc_in_tail_full' called on too big alignment");
+    ARENA_ASSERT((alignment <= MAX_ALLOC_ALIGNMENT)   && "Internal Error: 'alloc_in_tail_full' called on too big alignment");
     if (free_size_in_tail(arena) < size) return NULL;  // Quick check to avoid unnecessary calculations
     
     /*
@@ -1440,9 +3010,7 @@ static void *alloc_in_tail_full(Arena *arena, size_t size, size_t alignment) {
     if (alignment > arena_get_alignment(arena) && padding > 0) {
         if (padding >= BLOCK_MIN_SIZE) {
             set_size(tail, padding - sizeof(Block));
-            Block *free_blocks_root = arena_get_free_blocks(arena);
-            free_blocks_root = insert_block(free_blocks_root, tail);
-            arena_set_free_blocks(arena, free_blocks_root);
+            free_index_insert(arena, tail);
 
             Block *new_tail = create_next_block(arena, tail);
             arena_set_tail(arena, new_tail);
@@ -1482,6 +3050,9 @@ static void *alloc_in_tail_full(Arena *arena, size_t size, size_t alignment) {
     * Therefore, any padding in 'padding' variable will be always 0 or powers of 2 with sizeof(uintptr_t) as minimum.
     */
    
+    set_size(tail, final_needed_block_size);
+    expose_block_data(tail);
+
     // Store pointer to block metadata before user data for deallocation if there is padding
     if (padding > 0) {
         uintptr_t *spot_before_user_data = (uintptr_t *)(aligned_data_ptr - sizeof(uintptr_t));
@@ -1489,10 +3060,10 @@ static void *alloc_in_tail_full(Arena *arena, size_t size, size_t alignment) {
     }
 
     // Finalize tail block as occupied
-    set_size(tail, final_needed_block_size);
     set_is_free(tail, false);
-    set_magic(tail, (void *)aligned_data_ptr);
+    set_magic(tail, (void *)aligned_data_ptr, arena_get_key(arena));
     set_arena(tail, arena);
+    count_alloc(arena, tail, true);
 
     // If there is remaining free space, create a new free block
     if (free_space != final_needed_block_size) {
@@ -1500,328 +3071,4603 @@ static void *alloc_in_tail_full(Arena *arena, size_t size, size_t alignment) {
         arena_set_tail(arena, new_tail);
     }
 
+    mark_tail_carved(arena, (void *)aligned_data_ptr);
+
     return (void *)aligned_data_ptr;
 }
 
+/*
+ * Allocate memory in tail block of arena (fast version)
+ * Handles the common case of 'alloc_in_tail_full': no padding in front of the data, since the tail data is
+ *  already at the arena alignment, and enough room behind it for a new tail, so no edge case applies
+ * Returns pointer to allocated memory or NULL if the request needs the full version
+ */
+static inline void *alloc_in_tail_fast(Arena *arena, size_t size) {
+    ARENA_ASSERT((arena != NULL)     && "Internal Error: 'alloc_in_tail_fast' called on NULL arena");
+    ARENA_ASSERT((size > 0)          && "Internal Error: 'alloc_in_tail_fast' called on too small size");
+    ARENA_ASSERT((size <= SIZE_MASK) && "Internal Error: 'alloc_in_tail_fast' called on too big size");
+
+    Block *tail = arena_get_tail(arena);
+    uintptr_t data = (uintptr_t)block_data(tail);
+    size_t alignment = arena_get_alignment(arena);
+
+    // The data of the next tail lands at the arena alignment as well
+    size_t block_size = align_up(size + sizeof(Block), alignment) - sizeof(Block);
+    size_t free_space = free_size_in_tail(arena);
+    if ((data & (alignment - 1)) != 0 || free_space < block_size + BLOCK_MIN_SIZE) return NULL;
+
+    set_size(tail, block_size);
+    expose_block_data(tail);
+    set_is_free(tail, false);
+    set_magic(tail, (void *)data, arena_get_key(arena));
+    set_arena(tail, arena);
+    count_alloc(arena, tail, true);
+
+    arena_set_tail(arena, create_next_block(arena, tail));
+    mark_tail_carved(arena, (void *)data);
+
+    return (void *)data;
+}
+
 
 
 
 
 /*
- * Free a block of memory in the arena
- * Marks the block as free, merges it with adjacent free blocks if possible,
- * and updates the free block list
+ * Get next parked block
+ * Extracts the next block pointer of a parked block (binned, cached or freed remotely),
+ *  stored in the block's as.occupied.magic field
  */
-void arena_free_block(void *data) {
-    if (!data) return;
-    if ((uintptr_t)data % sizeof(uintptr_t) != 0) return;
+static inline Block *get_parked_next(const Block *block) {
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'get_parked_next' called on NULL block");
 
-    Block *block = NULL;
+    return (Block *)(block->as.occupied.magic & ~(uintptr_t)1); // Clear the park tag bit to get actual pointer
+}
+
+/*
+ * Set next parked block
+ * Updates the next block pointer of a parked block in the block's as.occupied.magic field
+ */
+static inline void set_parked_next(Block *block, Block *next) {
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'set_parked_next' called on NULL block");
 
     /*
-     * Retrieve block metadata from user data pointer
-     * We have two possible scenarios:
-     * 1. There is no alignment padding before user data:
-     *      In this case, we can directly calculate the block pointer by subtracting the size of Block
-     *      from the user data pointer.
-     * 2. There is alignment padding before user data:
-     *      In this case, we stored the block pointer XORed with user data pointer just before the user data.
-     *      We can retrieve it and XOR it back with user data pointer to get the original block pointer.
-     * 
-     * Thanks to Block struct having magic value as last field, we can validate which scenario is correct by just checking
-     *  whether the XORed value before the user data matches the expected value.
+     * Why store the link in the magic field?
+     * Parked blocks stay marked as occupied, so neighbours never try to merge with them
+     *  and 'as.occupied.arena' must keep pointing to the owner for 'arena_free_block'.
+     * The magic is the only field left, and it has to become invalid anyway to reject double frees.
+     *
+     * The link is tagged with LSB set: the word before user data then decodes in 'arena_free_block'
+     *  to a misaligned value, so a double free is rejected before any pointer is dereferenced.
     */
 
-    uintptr_t *spot_before_user_data = (uintptr_t *)((char *)data - sizeof(uintptr_t));
-    uintptr_t check = *spot_before_user_data ^ (uintptr_t)data;
-    if (check == (uintptr_t)0xDEADBEEF) {
-        block = (Block *)(void *)((char *)data - sizeof(Block));
-    }
-    else {
-        if ((uintptr_t)check % sizeof(uintptr_t) != 0) return;
-        block = (Block *)check;
-    }
-    
-    ARENA_ASSERT((block != NULL) && "Internal Error: 'arena_free_block' detected NULL block");
-    
-    // If block size is bigger than SIZE_MASK, it's invalid
-    if (get_size(block) > SIZE_MASK) return;
-    // If block is already free, it's invalid
-    if (get_is_free(block)) return;
-    // If magic is invalid, it's invalid
-    if (!is_valid_magic(block, data)) return;
-    
-    Arena *arena = get_arena(block);
-    
-    ARENA_ASSERT((arena != NULL) && "Internal Error: 'arena_free_block' detected block with NULL arena");
-    
-    // If block is out of arena bounds, it's invalid
-    if (!is_block_within_arena(arena, block)) return;
+    block->as.occupied.magic = (uintptr_t)next | (uintptr_t)1;
+}
 
-    #ifdef ARENA_POISONING
-    memset(block_data(block), ARENA_POISON_BYTE, get_size(block));
-    #endif
 
-    arena_free_block_full(arena, block);
+#ifdef ARENA_SIZE_CLASSES
+/*
+ * Get size class of block
+ * Returns the bin index able to hold the block, or ARENA_SIZE_CLASS_COUNT if the block is not small
+ * A bin with index i holds blocks of [(i + 1) * STEP ... (i + 2) * STEP) bytes,
+ *  so any of them satisfies every request of up to (i + 1) * STEP bytes.
+ */
+static inline size_t size_class_of_block(size_t block_size) {
+    size_t class_number = block_size / ARENA_SIZE_CLASS_STEP;
+    if (class_number == 0 || class_number > ARENA_SIZE_CLASS_COUNT) return ARENA_SIZE_CLASS_COUNT;
+
+    return class_number - 1;
 }
 
 /*
- * Allocate memory in the arena with custom alignment
- * Returns NULL if there is not enough space
+ * Get size class of request
+ * Returns the bin index whose blocks are guaranteed to fit the requested size
  */
-void *arena_alloc_custom(Arena *arena, size_t size, size_t alignment) {
-    if (!arena || size == 0 || size > arena_get_capacity(arena)) return NULL;
-    if ((alignment & (alignment - 1)) != 0) return NULL;
-    if (alignment < MIN_ALIGNMENT || alignment > MAX_ALIGNMENT) return NULL;
-
-    // Trying to allocate in free blocks first
-    void *result = alloc_in_free_blocks(arena, size, alignment);
-    if (result) return result;
+static inline size_t size_class_of_request(size_t size) {
+    ARENA_ASSERT((size > 0)                     && "Internal Error: 'size_class_of_request' called on zero size");
+    ARENA_ASSERT((size <= ARENA_SMALL_MAX_SIZE) && "Internal Error: 'size_class_of_request' called on too big size");
 
-    if (free_size_in_tail(arena) == 0) return NULL;
-    return alloc_in_tail_full(arena, size, alignment);
+    return (size + ARENA_SIZE_CLASS_STEP - 1) / ARENA_SIZE_CLASS_STEP - 1;
 }
 
 /*
- * Allocate memory in the arena with default alignment
- * Returns NULL if there is not enough space
+ * Free block into size class bin
+ * Pushes a small block to the bin of its size class without touching the LLRB tree
+ * Returns false if the block must go through the regular free path
  */
-void *arena_alloc(Arena *arena, size_t size) {
-    if (!arena) return NULL;
-    return arena_alloc_custom(arena, size, arena_get_alignment(arena));
+static inline bool free_to_size_class(Arena *arena, Block *block) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'free_to_size_class' called on NULL arena");
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'free_to_size_class' called on NULL block");
+
+    size_t index = size_class_of_block(get_size(block));
+    if (index == ARENA_SIZE_CLASS_COUNT) return false;
+
+    // Bins hand out data pointers as is, so they must already satisfy the arena alignment
+    if (((uintptr_t)block_data(block) & (arena_get_alignment(arena) - 1)) != 0) return false;
+
+    // Blocks touching the tail are cheaper to give back to it
+    Block *tail = arena_get_tail(arena);
+    if (block == tail) return false;
+    if (next_block(arena, block) == tail && get_is_free(tail)) return false;
+
+    ArenaExt *ext = arena_get_ext(arena);
+    set_parked_next(block, ext->bins[index]);
+    ext->bins[index] = block;
+    poison_block_data(block);
+
+    return true;
 }
 
 /*
- * Allocate zero-initialized memory in the arena
- * Returns NULL if there is not enough space or overflow is detected
+ * Allocate memory in size class bins of arena
+ * Pops a block from the bin matching the requested size in O(1)
+ * Returns pointer to allocated memory or NULL if the bin is empty or the request is not small
  */
-void *arena_calloc(Arena *arena, size_t nmemb, size_t size) {
-    if (!arena) return NULL;
+static inline void *alloc_in_size_class(Arena *arena, size_t size, size_t alignment) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'alloc_in_size_class' called on NULL arena");
+    ARENA_ASSERT((size > 0)      && "Internal Error: 'alloc_in_size_class' called on too small size");
+
+    if (size > ARENA_SMALL_MAX_SIZE || alignment > arena_get_alignment(arena)) return NULL;
+
+    ArenaExt *ext = arena_get_ext(arena);
+    size_t index = size_class_of_request(size);
+
+    Block *block = ext->bins[index];
+    if (!block) return NULL;
+
+    ext->bins[index] = get_parked_next(block);
+
+    void *data = block_data(block);
+    expose_block_data(block);
+    set_magic(block, data, arena_get_key(arena));
+
+    return data;
+}
+
+#ifndef ARENA_DEFERRED_COALESCING
+/*
+ * Flush size class bins of arena
+ * Returns every binned block to the regular free path, so it can be coalesced with its neighbours
+ * Deferred coalescing replaces it with a single sweep over the arena
+ * Returns true if at least one block was released
+ */
+static bool flush_size_classes(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'flush_size_classes' called on NULL arena");
+
+    ArenaExt *ext = arena_get_ext(arena);
+    bool released = false;
+
+    for (size_t i = 0; i < ARENA_SIZE_CLASS_COUNT; i++) {
+        Block *block = ext->bins[i];
+        ext->bins[i] = NULL;
+
+        while (block) {
+            Block *next = get_parked_next(block);
+            arena_free_block_full(arena, block);
+            block = next;
+            released = true;
+        }
+    }
+
+    return released;
+}
+#endif // ARENA_DEFERRED_COALESCING
+#endif // ARENA_SIZE_CLASSES
+
+#ifdef ARENA_DEFERRED_COALESCING
+static bool flush_deferred(Arena *arena);
+
+/*
+ * Free block into quick-reuse list
+ * Parks a freed block without merging it, so an allocation of the same size right after takes it back for free
+ * A full list is coalesced in one pass first, which bounds the memory the arena hides from bigger requests
+ * Returns false if the block must go through the regular free path
+ */
+static inline bool free_to_deferred(Arena *arena, Block *block) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'free_to_deferred' called on NULL arena");
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'free_to_deferred' called on NULL block");
+
+    // The list hands out data pointers as is, so they must already satisfy the arena alignment
+    if (((uintptr_t)block_data(block) & (arena_get_alignment(arena) - 1)) != 0) return false;
+
+    // The flush may merge a run into the tail, so it comes before the tail checks
+    ArenaExt *ext = arena_get_ext(arena);
+    if (ext->deferred_count >= ARENA_DEFERRED_LIMIT) flush_deferred(arena);
+
+    // Blocks touching the tail are cheaper to give back to it
+    Block *tail = arena_get_tail(arena);
+    if (block == tail) return false;
+    if (next_block(arena, block) == tail && get_is_free(tail)) return false;
+
+    set_parked_next(block, ext->deferred);
+    ext->deferred = block;
+    ext->deferred_count++;
+    poison_block_data(block);
+
+    return true;
+}
+
+/*
+ * Allocate memory in quick-reuse list of arena
+ * Checks the most recently freed blocks for one the regular path would not split
+ * Returns pointer to allocated memory or NULL if no deferred block fits
+ */
+static inline void *alloc_in_deferred(Arena *arena, size_t size, size_t alignment) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'alloc_in_deferred' called on NULL arena");
+    ARENA_ASSERT((size > 0)      && "Internal Error: 'alloc_in_deferred' called on too small size");
+
+    if (alignment > arena_get_alignment(arena)) return NULL;
+
+    ArenaExt *ext = arena_get_ext(arena);
+    Block *prev = NULL;
+    Block *block = ext->deferred;
+
+    for (size_t checked = 0; block && checked < ARENA_DEFERRED_SCAN; checked++) {
+        size_t block_size = get_size(block);
+        if (block_size >= size && block_size - size < BLOCK_MIN_SIZE + sizeof(uintptr_t)) {
+            if (prev) set_parked_next(prev, get_parked_next(block));
+            else ext->deferred = get_parked_next(block);
+            ext->deferred_count--;
+
+            void *data = block_data(block);
+            expose_block_data(block);
+            set_magic(block, data, arena_get_key(arena));
+            return data;
+        }
+
+        prev = block;
+        block = get_parked_next(block);
+    }
+
+    return NULL;
+}
+#endif // ARENA_DEFERRED_COALESCING
+
+#if defined(ARENA_DEFERRED_COALESCING) || defined(ARENA_SIZE_CLASSES)
+/*
+ * Mark parked blocks as free
+ * Turns every block of a parked list into a free block, without merging it or indexing it
+ * Returns true if the list held at least one block
+ */
+static bool unpark_blocks(Arena *arena, Block *block) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'unpark_blocks' called on NULL arena");
+
+    bool released = block != NULL;
+    while (block) {
+        Block *next = get_parked_next(block);
+        count_free(arena, sizeof(Block) + get_size(block), false);
+        set_is_free(block, true);
+        block = next;
+    }
+
+    return released;
+}
+#endif
+
+/*
+ * Merge free runs
+ * Merges each run of adjacent free blocks once and rebuilds the free index from the runs
+ * In thread-safe mode the caller must hold the arena lock
+ */
+static void merge_free_runs(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'merge_free_runs' called on NULL arena");
+
+    free_index_clear(arena);
+
+    Block *tail = arena_get_tail(arena);
+    Block *run = NULL;
+    Block *block = arena_get_first_block(arena);
+
+    while (block != tail) {
+        Block *next = next_block(arena, block);
+
+        if (!get_is_free(block)) {
+            if (run) free_index_insert(arena, run);
+            run = NULL;
+        }
+        else if (run) {
+            merge_blocks_logic(arena, run, block);
+            count_merge(arena);
+        }
+        else {
+            run = block;
+            set_left_tree(run, NULL);
+            set_right_tree(run, NULL);
+            set_color(run, RED);
+        }
+
+        block = next;
+    }
+
+    // A run in front of a free tail becomes the new tail
+    if (run) {
+        if (get_is_free(tail)) {
+            set_size(run, 0);
+            arena_set_tail(arena, run);
+            count_merge(arena);
+        }
+        else {
+            free_index_insert(arena, run);
+        }
+    }
+}
+
+/*
+ * Coalesce arena
+ * Gives every parked block back in a single pass over the physical blocks of the arena:
+ *  each run of adjacent free blocks is merged once and the free index is rebuilt from the runs,
+ *  instead of detaching and reinserting neighbours for every block on its own
+ * In thread-safe mode the caller must hold the arena lock
+ * Returns true if at least one block was released
+ */
+static bool coalesce_arena(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'coalesce_arena' called on NULL arena");
+
+    bool released = false;
+
+    #ifdef ARENA_DEFERRED_COALESCING
+    ArenaExt *ext = arena_get_ext(arena);
+    released |= unpark_blocks(arena, ext->deferred);
+    ext->deferred = NULL;
+    ext->deferred_count = 0;
+    #endif
+
+    #ifdef ARENA_SIZE_CLASSES
+    for (size_t i = 0; i < ARENA_SIZE_CLASS_COUNT; i++) {
+        released |= unpark_blocks(arena, arena_get_ext(arena)->bins[i]);
+        arena_get_ext(arena)->bins[i] = NULL;
+    }
+    #endif
+
+    if (!released) return false;
+
+    merge_free_runs(arena);
+    return true;
+}
+
+#ifdef ARENA_DEFERRED_COALESCING
+/*
+ * Flush quick-reuse list of arena
+ * Gives the deferred blocks back with the single pass of 'coalesce_arena', the size class bins stay as they are
+ * In thread-safe mode the caller must hold the arena lock
+ * Returns true if at least one block was released
+ */
+static bool flush_deferred(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'flush_deferred' called on NULL arena");
+
+    ArenaExt *ext = arena_get_ext(arena);
+    bool released = unpark_blocks(arena, ext->deferred);
+    ext->deferred = NULL;
+    ext->deferred_count = 0;
+
+    if (released) merge_free_runs(arena);
+    return released;
+}
+#endif // ARENA_DEFERRED_COALESCING
+
+/*
+ * Check links of block
+ * Verifies that both physical neighbours of an occupied block point back to it, which a header
+ *  overwritten by an overrun of the block in front of it or a forged header fails
+ */
+static inline bool has_valid_links(const Arena *arena, const Block *block) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'has_valid_links' called on NULL arena");
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'has_valid_links' called on NULL block");
+
+    Block *prev = get_prev(block);
+    if (prev && (!is_block_within_arena(arena, prev) || next_block_unsafe(prev) != block)) return false;
+
+    Block *next = next_block(arena, block);
+    return !next || get_prev(next) == block;
+}
+
+/*
+ * Check links of block at the validation level
+ * Runs the neighbour check of ARENA_VALIDATE_HARDENED. Neighbours are split and merged under the arena lock,
+ *  so in thread-safe mode the caller must hold it, else a concurrent merge makes a valid block fail the check
+ */
+static inline bool has_checked_links(const Arena *arena, const Block *block) {
+    return arena_validation_level != ARENA_VALIDATE_HARDENED || has_valid_links(arena, block);
+}
+
+/*
+ * Check links of block under its lock
+ * Takes the arena lock for 'has_checked_links', so frees can reject a block before it reaches the thread cache,
+ *  the remote list or the poisoning. Valid links stay valid under the splits and merges of other threads
+ */
+static inline bool has_checked_links_locking(Arena *arena, const Block *block) {
+    if (arena_validation_level != ARENA_VALIDATE_HARDENED) return true;
+
+    lock_arena(arena);
+    bool intact = has_valid_links(arena, block);
+    unlock_arena(arena);
+
+    return intact;
+}
+
+/*
+ * Release block to arena
+ * Returns an occupied block to its arena, through the size class bins or the quick-reuse list when enabled
+ * In thread-safe mode the caller must hold the arena lock
+ */
+static inline void release_block(Arena *arena, Block *block) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'release_block' called on NULL arena");
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'release_block' called on NULL block");
+
+    #ifdef ARENA_SIZE_CLASSES
+    if (free_to_size_class(arena, block)) return;
+    #endif
+
+    #ifdef ARENA_DEFERRED_COALESCING
+    if (free_to_deferred(arena, block)) return;
+    #endif
+
+    arena_free_block_full(arena, block);
+}
+
+#ifdef ARENA_THREAD_SAFE
+/*
+ * Push block to remote free list
+ * Parks a block freed by a thread other than the owner on the lock-free stack of its arena
+ * Any number of threads may push concurrently, the stack is drained by 'drain_remote_frees'
+ */
+static inline void push_remote_free(Arena *arena, Block *block) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'push_remote_free' called on NULL arena");
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'push_remote_free' called on NULL block");
+
+    void *volatile *head = (void *volatile *)&arena_get_ext(arena)->remote_free;
+    Block *top = NULL;
+    poison_block_data(block);
+
+    do {
+        top = (Block *)arena_atomic_load_ptr(head);
+        set_parked_next(block, top);
+    } while (!arena_atomic_cas_ptr(head, top, block));
+}
+
+/*
+ * Drain remote free list
+ * Takes the whole remote free stack in one exchange and merges its blocks back into the arena
+ * The caller must hold the arena lock, so there is only ever one consumer
+ */
+static inline void drain_remote_frees(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'drain_remote_frees' called on NULL arena");
+
+    void *volatile *head = (void *volatile *)&arena_get_ext(arena)->remote_free;
+    if (arena_atomic_load_ptr(head) == NULL) return; // Fast path without a write to the shared line
+
+    Block *block = (Block *)arena_atomic_exchange_ptr(head, NULL);
+    while (block) {
+        Block *next = get_parked_next(block);
+        release_block(arena, block);
+        block = next;
+    }
+}
+
+/*
+ * Renew arena generation
+ * Gives the arena contents a new unique id, the cached blocks of the previous contents turn into free slots
+ */
+static inline void renew_generation(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'renew_generation' called on NULL arena");
+
+    uintptr_t generation = arena_atomic_next_generation();
+    ARENA_STORE_TAGGED(arena_get_ext(arena)->generation, generation);
+    ARENA_STORE_TAGGED(arena_get_ext(arena)->rewinds, (uintptr_t)0);
+    arena_get_ext(arena)->floor_count = 0;
+
+    uintptr_t cell = ARENA_LOAD_TAGGED(arena_get_ext(arena)->cache_cell);
+    if (cell != 0 && cell != ARENA_NO_CACHE_CELL) {
+        arena_atomic_exchange_ptr((void *volatile *)&arena_cache_cells[cell - 1], (void *)generation);
+    }
+}
+
+/*
+ * Record rewind
+ * Counts a rewind of the arena to the given position instead of renewing its generation,
+ *  so blocks other threads cached in front of every later mark are still handed out or flushed
+ * The caller must hold the arena lock
+ */
+static void record_rewind(Arena *arena, uintptr_t position) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'record_rewind' called on NULL arena");
+
+    ArenaExt *ext = arena_get_ext(arena);
+    uintptr_t rewinds = ext->rewinds + 1;
+
+    // A rewind below a floor also covers every rewind the floor stands for
+    while (ext->floor_count > 0 && ext->floors[ext->floor_count - 1].position >= position) ext->floor_count--;
+
+    // Out of floors, the two oldest merge into one at the lower position, dropping blocks cached between them above it
+    if (ext->floor_count == ARENA_THREAD_CACHE_REWINDS) {
+        ext->floors[1].position = ext->floors[0].position;
+        memmove(&ext->floors[0], &ext->floors[1], (ARENA_THREAD_CACHE_REWINDS - 1) * sizeof(ArenaRewindFloor));
+        ext->floor_count--;
+    }
+
+    ext->floors[ext->floor_count].rewind = rewinds;
+    ext->floors[ext->floor_count].position = position;
+    ext->floor_count++;
+    ARENA_STORE_TAGGED(ext->rewinds, rewinds);
+}
+
+/*
+ * Check cached block against rewinds
+ * A block survives if it starts in front of the lowest position rewound to since it was cached,
+ *  the first floor of a later rewind holds that position
+ * Returns true if the block is still parked, the caller must hold the arena lock
+ */
+static bool survived_rewinds(Arena *arena, const ArenaCacheEntry *entry) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'survived_rewinds' called on NULL arena");
+    ARENA_ASSERT((entry != NULL) && "Internal Error: 'survived_rewinds' called on NULL entry");
+
+    ArenaExt *ext = arena_get_ext(arena);
+    if (entry->rewinds == ext->rewinds) return true;
+
+    for (size_t i = 0; i < ext->floor_count; i++) {
+        if (ext->floors[i].rewind > entry->rewinds) return (uintptr_t)entry->block < ext->floors[i].position;
+    }
+
+    return false; // LCOV_EXCL_LINE: the last rewind always has a floor
+}
+
+/*
+ * Attach liveness cell
+ * Claims a free cell for the arena on its first cached block
+ * Only arenas that are always given back through 'arena_free' get one,
+ *  static and nested arenas may vanish without notice and would never free their cell
+ * Returns the cell plus one, or ARENA_NO_CACHE_CELL if the arena must bypass the caches
+ */
+static uintptr_t attach_cache_cell(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'attach_cache_cell' called on NULL arena");
+
+    lock_arena(arena);
+
+    uintptr_t cell = arena_get_ext(arena)->cache_cell;
+    if (cell == 0) {
+        cell = ARENA_NO_CACHE_CELL;
+
+        if ((arena_get_is_dynamic(arena) || arena_get_is_mapped(arena)) && !arena_get_is_nested(arena)) {
+            uintptr_t generation = ARENA_LOAD_TAGGED(arena_get_ext(arena)->generation);
+            uintptr_t start = arena_atomic_fetch_add(&arena_cache_cell_hint, 1);
+
+            for (uintptr_t i = 0; i < ARENA_THREAD_CACHE_ARENAS; i++) {
+                uintptr_t index = (start + i) % ARENA_THREAD_CACHE_ARENAS;
+                void *volatile *target = (void *volatile *)&arena_cache_cells[index];
+                if (arena_atomic_load_ptr(target) == NULL && arena_atomic_cas_ptr(target, NULL, (void *)generation)) {
+                    cell = index + 1;
+                    break;
+                }
+            }
+        }
+
+        ARENA_STORE_TAGGED(arena_get_ext(arena)->cache_cell, cell);
+    }
+
+    unlock_arena(arena);
+    return cell;
+}
+
+/*
+ * Detach liveness cell
+ * Frees the cell of an arena that is going away, turning the entries of all threads holding its blocks into free slots
+ */
+static inline void detach_cache_cell(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'detach_cache_cell' called on NULL arena");
+
+    uintptr_t cell = ARENA_LOAD_TAGGED(arena_get_ext(arena)->cache_cell);
+    if (cell != 0 && cell != ARENA_NO_CACHE_CELL) {
+        arena_atomic_exchange_ptr((void *volatile *)&arena_cache_cells[cell - 1], NULL);
+    }
+    ARENA_STORE_TAGGED(arena_get_ext(arena)->cache_cell, (uintptr_t)0);
+}
+
+/*
+ * Check thread cache entry
+ * Returns true if the entry holds a block of contents that are still alive
+ */
+static inline bool is_cache_entry_live(const ArenaCacheEntry *entry) {
+    ARENA_ASSERT((entry != NULL) && "Internal Error: 'is_cache_entry_live' called on NULL entry");
+
+    if (entry->block == NULL) return false;
+    return (uintptr_t)arena_atomic_load_ptr((void *const volatile *)&arena_cache_cells[entry->cell - 1]) == entry->generation;
+}
+
+#ifdef ARENA_HAS_THREAD_EXIT
+static pthread_key_t arena_thread_exit_key;
+static pthread_once_t arena_thread_exit_once = PTHREAD_ONCE_INIT;
+static bool arena_thread_exit_ready = false;
+static ARENA_THREAD_LOCAL bool arena_thread_exit_armed = false;
+
+/*
+ * Flush exiting thread
+ * Destructor of the thread exit key, gives every block still cached by the exiting thread back to its arena
+ * Entries of freed or reset arenas are dropped without touching the arena
+ */
+static void flush_exiting_thread(void *unused) {
+    (void)unused;
+
+    for (size_t i = 0; i < ARENA_THREAD_CACHE_SIZE; i++) {
+        ArenaCacheEntry *entry = &arena_thread_cache[i];
+
+        if (is_cache_entry_live(entry)) {
+            Arena *arena = entry->arena;
+            lock_arena(arena);
+            if (survived_rewinds(arena, entry)) release_block(arena, entry->block);
+            unlock_arena(arena);
+        }
+
+        entry->block = NULL;
+    }
+}
+
+static void create_thread_exit_key(void) {
+    arena_thread_exit_ready = pthread_key_create(&arena_thread_exit_key, flush_exiting_thread) == 0;
+}
+
+/*
+ * Arm thread exit flush
+ * Registers the exit destructor for the calling thread before it caches its first block
+ * Without a key (creation failed), cached blocks wait for 'arena_thread_cache_flush' or the next reset
+ */
+static inline void arm_thread_exit(void) {
+    if (arena_thread_exit_armed) return;
+    arena_thread_exit_armed = true;
+
+    pthread_once(&arena_thread_exit_once, create_thread_exit_key);
+    if (arena_thread_exit_ready) pthread_setspecific(arena_thread_exit_key, &arena_thread_cache[0]); // Any non-NULL value runs the destructor
+}
+#endif // ARENA_HAS_THREAD_EXIT
+
+/*
+ * Free block into thread cache
+ * Parks a small block in the cache of the current thread, without any synchronization
+ * Returns false if the block is not cacheable or the cache is full
+ */
+static inline bool free_to_thread_cache(Arena *arena, Block *block) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'free_to_thread_cache' called on NULL arena");
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'free_to_thread_cache' called on NULL block");
+
+    if (get_size(block) > ARENA_THREAD_CACHE_MAX_SIZE) return false;
+
+    // Allocations look the cache up by the arena they are made in, which is not the chunk for growable arenas
+    if (arena_get_has_chunk(arena)) return false;
+
+    // The cache hands out data pointers as is, so they must already satisfy the arena alignment
+    if (((uintptr_t)block_data(block) & (arena_get_alignment(arena) - 1)) != 0) return false;
+
+    // Read without the lock, racing with 'attach_cache_cell' of another thread until the cell is set
+    uintptr_t cell = ARENA_LOAD_TAGGED(arena_get_ext(arena)->cache_cell);
+    if (cell == 0) cell = attach_cache_cell(arena);
+    if (cell == ARENA_NO_CACHE_CELL) return false;
+
+    uintptr_t generation = ARENA_LOAD_TAGGED(arena_get_ext(arena)->generation);
+
+    #ifdef ARENA_HAS_THREAD_EXIT
+    arm_thread_exit();
+    #endif
+
+    for (size_t i = 0; i < ARENA_THREAD_CACHE_SIZE; i++) {
+        ArenaCacheEntry *entry = &arena_thread_cache[i];
+
+        // Entries left from previous contents of any arena, or from arenas freed since, are free slots as well
+        if (!is_cache_entry_live(entry)) {
+            set_parked_next(block, NULL); // Invalidate the magic, so a double free is rejected
+            poison_block_data(block);
+            entry->arena = arena;
+            entry->generation = generation;
+            entry->rewinds = ARENA_LOAD_TAGGED(arena_get_ext(arena)->rewinds);
+            entry->cell = cell;
+            entry->block = block;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Allocate memory in thread cache
+ * Reuses a block of the arena parked in the cache of the current thread, without any synchronization
+ * Only blocks the regular path would not split are taken, so the cache never wastes memory
+ * Returns pointer to allocated memory or NULL if no cached block fits
+ */
+static inline void *alloc_in_thread_cache(Arena *arena, size_t size, size_t alignment) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'alloc_in_thread_cache' called on NULL arena");
+    ARENA_ASSERT((size > 0)      && "Internal Error: 'alloc_in_thread_cache' called on too small size");
+
+    if (size > ARENA_THREAD_CACHE_MAX_SIZE || alignment > arena_get_alignment(arena)) return NULL;
+
+    uintptr_t generation = ARENA_LOAD_TAGGED(arena_get_ext(arena)->generation);
+    uintptr_t rewinds = ARENA_LOAD_TAGGED(arena_get_ext(arena)->rewinds);
+
+    for (size_t i = 0; i < ARENA_THREAD_CACHE_SIZE; i++) {
+        ArenaCacheEntry *entry = &arena_thread_cache[i];
+        if (entry->block == NULL || entry->arena != arena || entry->generation != generation) continue;
+
+        // After a rewind the block may be gone, and its header must not be read before the check
+        if (entry->rewinds != rewinds) {
+            lock_arena(arena);
+            bool survived = survived_rewinds(arena, entry);
+            entry->rewinds = arena_get_ext(arena)->rewinds;
+            unlock_arena(arena);
+
+            if (!survived) {
+                entry->block = NULL;
+                continue;
+            }
+        }
+
+        Block *block = entry->block;
+        size_t block_size = get_size(block);
+        if (block_size < size || block_size - size >= BLOCK_MIN_SIZE + sizeof(uintptr_t)) continue;
+
+        entry->block = NULL;
+
+        void *data = block_data(block);
+        expose_block_data(block);
+        set_magic(block, data, arena_get_key(arena));
+        return data;
+    }
+
+    return NULL;
+}
+
+/*
+ * Flush thread cache for arena
+ * Returns the blocks of the arena parked in the cache of the current thread back to it
+ * Returns true if at least one block was released
+ */
+static bool flush_thread_cache(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'flush_thread_cache' called on NULL arena");
+
+    uintptr_t generation = ARENA_LOAD_TAGGED(arena_get_ext(arena)->generation);
+    bool released = false;
+
+    for (size_t i = 0; i < ARENA_THREAD_CACHE_SIZE; i++) {
+        ArenaCacheEntry *entry = &arena_thread_cache[i];
+        if (entry->block == NULL || entry->arena != arena) continue;
+
+        // Blocks of previous contents are already gone with a reset, blocks behind a later mark with the rewind
+        if (entry->generation == generation) {
+            lock_arena(arena);
+            if (survived_rewinds(arena, entry)) {
+                release_block(arena, entry->block);
+                released = true;
+            }
+            unlock_arena(arena);
+        }
+
+        entry->block = NULL;
+    }
+
+    return released;
+}
+#endif // ARENA_THREAD_SAFE
+
+/*
+ * Decode block of user data
+ * Returns the block header a pointer returned by an allocation belongs to, without checking it
+ */
+static inline Block *decode_block(const void *data) {
+    ARENA_ASSERT((data != NULL) && "Internal Error: 'decode_block' called on NULL data");
+
+    /*
+     * Retrieve block metadata from user data pointer
+     * We have two possible scenarios:
+     * 1. There is no alignment padding before user data:
+     *      In this case, we can directly calculate the block pointer by subtracting the size of Block
+     *      from the user data pointer.
+     * 2. There is alignment padding before user data:
+     *      In this case, we stored the block pointer XORed with user data pointer just before the user data.
+     *      We can retrieve it and XOR it back with user data pointer to get the original block pointer.
+     * 
+     * Thanks to Block struct having magic value as last field, the word before the user data XORed with it
+     *  is either the key of the arena (scenario 1) or the block pointer (scenario 2).
+     * Keys are odd and block pointers word aligned, so the lowest bit tells the scenarios apart
+     *  without knowing the key, which is what lets every arena have its own.
+    */
+
+    uintptr_t check = *(const uintptr_t *)(const void *)((const char *)data - sizeof(uintptr_t)) ^ (uintptr_t)data;
+    if (check & 1) return (Block *)(void *)((char *)data - sizeof(Block));
+
+    return (Block *)check;
+}
+
+/*
+ * Get occupied block from user data
+ * Decodes the block header of a pointer returned by an allocation and validates it as much as the validation level asks
+ * Returns NULL if the pointer does not belong to a live allocation (foreign, already freed or parked)
+ */
+static Block *get_occupied_block(void *data) {
+    if (!data) return NULL;
+
+    ArenaValidation level = arena_validation_level;
+    if (level == ARENA_VALIDATE_TRUSTED) return decode_block(data);
+
+    if ((uintptr_t)data % sizeof(uintptr_t) != 0) return NULL;
+
+    // Freed memory is poisoned, a poisoned word in front of the data means the block is gone already
+    if (is_memory_poisoned((char *)data - sizeof(uintptr_t), sizeof(uintptr_t))) return NULL;
+
+    // Without per-arena keys the magic of an unpadded block is known up front, with them at least its tag bits
+    uintptr_t check = *(uintptr_t *)(void *)((char *)data - sizeof(uintptr_t)) ^ (uintptr_t)data;
+    #ifdef ARENA_HARDENING
+    if ((check & 1) && (check & ARENA_KEY_TAG_MASK) != (ARENA_MAGIC & ARENA_KEY_TAG_MASK)) return NULL;
+    #else
+    if ((check & 1) && check != ARENA_MAGIC) return NULL;
+    #endif
+
+    Block *block = decode_block(data);
+    if ((uintptr_t)block % sizeof(uintptr_t) != 0) return NULL;
+    if (is_memory_poisoned(block, sizeof(Block))) return NULL;
+    
+    // If block size is bigger than SIZE_MASK, it's invalid
+    if (get_size(block) > SIZE_MASK) return NULL;
+    // If block is already free, it's invalid
+    if (get_is_free(block)) return NULL;
+
+    #ifdef ARENA_HARDENING
+    // The key of the magic lives in the arena, reject magics without the tag of every key before reading through it
+    if (((get_magic(block) ^ (uintptr_t)data) & ARENA_KEY_TAG_MASK) != (ARENA_MAGIC & ARENA_KEY_TAG_MASK)) return NULL;
+    #endif
+
+    Arena *arena = get_arena(block);
+    if (!arena || (uintptr_t)arena % sizeof(uintptr_t) != 0) return NULL;
+
+    // If magic is invalid, it's invalid
+    if (!is_valid_magic(block, data, arena_get_key(arena))) return NULL;
+    
+    // If block is out of arena bounds, it's invalid
+    if (!is_block_within_arena(arena, block)) return NULL;
+
+    // Links to the neighbours are checked by the callers, under the lock of the arena ('has_checked_links')
+    return block;
+}
+
+#ifdef ARENA_PURGE
+/*
+ * Get purge clock
+ * Returns the monotonic time in milliseconds the purge decay is measured with
+ */
+static inline uint64_t purge_clock_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+/*
+ * Purge single arena
+ * Gives the whole pages inside every free block of at least 'min_bytes' and inside the tail back to the OS.
+ * Headers and the partial pages around them stay resident, so the blocks stay valid and allocate as before
+ * The caller must hold the arena lock. Returns the number of bytes given back
+ */
+static size_t purge_arena(Arena *arena, size_t min_bytes) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'purge_arena' called on NULL arena");
+
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    int advice = MADV_DONTNEED;
+    bool drops_to_zero = false;
+    if (arena_get_is_mapped(arena)) {
+        const ArenaMapping *mapping = arena_get_mapping(arena);
+        page_size = mapping->granule;
+        #ifdef MADV_FREE
+        if (mapping->flags & ARENA_MMAP_LAZY_RELEASE) advice = MADV_FREE;
+        #endif
+        // Dropped pages of a file image would read back the file, not zeros
+        drops_to_zero = advice == MADV_DONTNEED && !(mapping->flags & ARENA_MAPPING_FROM_FILE);
+    }
+
+    Block *tail = arena_get_tail(arena);
+    size_t purged = 0;
+
+    for (Block *block = arena_get_first_block(arena); block != NULL; block = next_block(arena, block)) {
+        if (!get_is_free(block)) continue; // Parked and cached blocks stay marked occupied and keep their pages
+
+        size_t size = (block == tail) ? free_size_in_tail(arena) : get_size(block);
+        if (size < min_bytes) continue;
+
+        uintptr_t start = align_up((uintptr_t)block_data(block), page_size);
+        uintptr_t end = ((uintptr_t)block_data(block) + size) & ~(uintptr_t)(page_size - 1);
+        if (start >= end || madvise((void *)start, end - start, advice) != 0) continue;
+        purged += end - start;
+
+        #ifdef ARENA_ZERO_TRACKING
+        // A tail dropped up to the end of the arena reads as zero again
+        if (drops_to_zero && block == tail && end == (uintptr_t)arena + arena_get_capacity(arena) &&
+            start < arena_get_ext(arena)->zero_mark) {
+            arena_get_ext(arena)->zero_mark = start;
+        }
+        #endif
+    }
+    (void)drops_to_zero;
+
+    arena_get_ext(arena)->dirty = 0;
+    arena_get_ext(arena)->dirty_since = 0;
+
+    return purged;
+}
+
+/*
+ * Purge arena if decayed
+ * Purges the free blocks of at least ARENA_PURGE_MIN_SIZE once enough memory was freed and stayed resident
+ *  for the decay time of the arena. The first call that sees the dirty bytes starts their decay
+ * The caller must hold the arena lock. Returns the number of bytes given back
+ */
+static size_t purge_if_decayed(Arena *arena, uint64_t now) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'purge_if_decayed' called on NULL arena");
+
+    ArenaExt *ext = arena_get_ext(arena);
+    if (ext->decay_ms == 0 || ext->dirty < ARENA_PURGE_MIN_SIZE) return 0;
+
+    if (ext->dirty_since == 0) {
+        ext->dirty_since = now | 1; // Never 0, which stands for no dirty bytes seen yet
+        return 0;
+    }
+    if (now - ext->dirty_since < ext->decay_ms) return 0;
+
+    return purge_arena(arena, ARENA_PURGE_MIN_SIZE);
+}
+
+/*
+ * Tick purge
+ * Counts a free of the arena and reads the decay clock every ARENA_PURGE_TICKS frees, so frees stay cheap
+ * The caller must hold the arena lock
+ */
+static inline void tick_purge(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'tick_purge' called on NULL arena");
+
+    ArenaExt *ext = arena_get_ext(arena);
+    if (ext->decay_ms == 0 || ++ext->purge_ticks < ARENA_PURGE_TICKS) return;
+
+    ext->purge_ticks = 0;
+    purge_if_decayed(arena, purge_clock_ms());
+}
+#endif // ARENA_PURGE
+
+/*
+ * Free a block of memory in the arena
+ * Marks the block as free, merges it with adjacent free blocks if possible,
+ * and updates the free block list
+ */
+void arena_free_block(void *data) {
+    Block *block = get_occupied_block(data);
+    if (!block) return;
+
+    Arena *arena = get_arena(block);
+    if (!has_checked_links_locking(arena, block)) return; // Corrupted header, the block is not freed
+
+    #ifdef ARENA_POISONING
+    memset(block_data(block), ARENA_POISON_BYTE, get_size(block));
+    #endif
+
+    #ifdef ARENA_THREAD_SAFE
+    if (free_to_thread_cache(arena, block)) return;
+
+    // Blocks of arenas owned by other threads are merged lazily by their next allocation
+    if (arena_get_ext(arena)->owner != current_thread_token()) {
+        push_remote_free(arena, block);
+        return;
+    }
+    #endif
+
+    lock_arena(arena);
+    release_block(arena, block);
+    #ifdef ARENA_PURGE
+    tick_purge(arena);
+    #endif
+    unlock_arena(arena);
+}
+
+/*
+ * Allocate memory in a single arena
+ * Tries every allocation path of the arena itself, without looking at the rest of its chunk chain
+ * Returns pointer to allocated memory or NULL if allocation fails
+ */
+static void *alloc_in_arena(Arena *arena, size_t size, size_t alignment) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'alloc_in_arena' called on NULL arena");
+    ARENA_ASSERT((size > 0)      && "Internal Error: 'alloc_in_arena' called on too small size");
+
+    if (size > arena_get_capacity(arena)) return NULL;
+
+    #ifdef ARENA_ZERO_TRACKING
+    arena_get_ext(arena)->fresh = NULL; // Only a carve from the tail during this call may report fresh memory
+    #endif
+
+    #ifdef ARENA_SIZE_CLASSES
+    // Small requests are served from the size class bins in O(1)
+    void *binned = alloc_in_size_class(arena, size, alignment);
+    if (binned) return binned;
+    #endif
+
+    #ifdef ARENA_DEFERRED_COALESCING
+    // Blocks freed just before are reused without ever being merged
+    void *deferred = alloc_in_deferred(arena, size, alignment);
+    if (deferred) return deferred;
+    #endif
+
+    #ifdef ARENA_FIT_POLICIES
+    bool tail_first = arena_get_ext(arena)->fit_policy == ARENA_FIT_TAIL;
+    #else
+    bool tail_first = false;
+    #endif
+
+    // Trying to allocate in free blocks first, unless there are none or the policy prefers the tail
+    void *result = NULL;
+    if (!tail_first && !free_index_is_empty(arena)) {
+        result = alloc_in_free_blocks(arena, size, alignment);
+        if (result) return result;
+    }
+
+    if (free_size_in_tail(arena) != 0) {
+        if (alignment <= arena_get_alignment(arena)) result = alloc_in_tail_fast(arena, size);
+        if (!result) result = alloc_in_tail_full(arena, size, alignment);
+    }
+
+    if (!result && tail_first && !free_index_is_empty(arena)) {
+        result = alloc_in_free_blocks(arena, size, alignment);
+    }
+
+    #ifdef ARENA_DEFERRED_COALESCING
+    // Deferred and binned blocks may add up to the requested size once merged, sweep the arena and retry
+    if (!result && coalesce_arena(arena)) {
+        result = alloc_in_free_blocks(arena, size, alignment);
+        if (!result && free_size_in_tail(arena) != 0) {
+            result = alloc_in_tail_full(arena, size, alignment);
+        }
+    }
+    #elif defined(ARENA_SIZE_CLASSES)
+    // Binned blocks are never coalesced, so give them back and retry before reporting failure
+    if (!result && flush_size_classes(arena)) {
+        result = alloc_in_free_blocks(arena, size, alignment);
+        if (!result && free_size_in_tail(arena) != 0) {
+            result = alloc_in_tail_full(arena, size, alignment);
+        }
+    }
+    #endif
+
+    return result;
+}
+
+/*
+ * Allocate memory in tail of bare arena
+ * Shortcut of 'alloc_in_arena' while the arena hands out nothing but its tail: with no free block, no deferred block
+ *  and no binned block of the size class, every other path would miss anyway, so they are not even tried
+ * In thread-safe mode the caller must hold the arena lock
+ * Returns pointer to allocated memory or NULL if the request needs the regular path
+ */
+static inline void *alloc_in_bare_tail(Arena *arena, size_t size, size_t alignment) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'alloc_in_bare_tail' called on NULL arena");
+    ARENA_ASSERT((size > 0)      && "Internal Error: 'alloc_in_bare_tail' called on too small size");
+
+    if (alignment > arena_get_alignment(arena) || size > arena_get_capacity(arena)) return NULL;
+    if (!free_index_is_empty(arena)) return NULL;
+
+    #ifdef ARENA_SIZE_CLASSES
+    if (size <= ARENA_SMALL_MAX_SIZE && arena_get_ext(arena)->bins[size_class_of_request(size)] != NULL) return NULL;
+    #endif
+
+    #ifdef ARENA_DEFERRED_COALESCING
+    if (arena_get_ext(arena)->deferred != NULL) return NULL;
+    #endif
+
+    return alloc_in_tail_fast(arena, size);
+}
+
+/*
+ * Allocate memory in a single arena under its lock
+ * In thread-safe mode also merges the blocks freed remotely since the last allocation
+ * Returns pointer to allocated memory or NULL if allocation fails
+ */
+static void *alloc_in_arena_locked(Arena *arena, size_t size, size_t alignment) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'alloc_in_arena_locked' called on NULL arena");
+
+    lock_arena(arena);
+
+    #ifdef ARENA_THREAD_SAFE
+    drain_remote_frees(arena);
+    #endif
+
+    void *result = alloc_in_arena(arena, size, alignment);
+
+    unlock_arena(arena);
+
+    return result;
+}
+
+/*
+ * Reset single arena
+ * Clears the blocks of the arena itself and resets it to the initial state
+ */
+static void reset_arena(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'reset_arena' called on NULL arena");
+
+    Block *first_block = arena_get_first_block(arena);
+
+    #ifdef ARENA_PURGE
+    // Everything in front of the tail becomes free memory that was written before
+    arena_get_ext(arena)->dirty += (uintptr_t)arena_get_tail(arena) - (uintptr_t)first_block;
+    #endif
+
+    // Reset first block
+    set_size(first_block, 0);
+    set_prev(first_block, NULL);
+    set_is_free(first_block, true);
+    set_color(first_block, RED);
+    set_left_tree(first_block, NULL);
+    set_right_tree(first_block, NULL);
+
+    // Reset arena metadata
+    free_index_clear(arena);
+    arena_set_tail(arena, first_block);
+
+    #ifdef ARENA_STATS
+    arena_get_ext(arena)->counters.in_use = 0; // Cumulative counters and the peak survive resets
+    #endif
+
+    #ifdef ARENA_SIZE_CLASSES
+    memset(arena_get_ext(arena)->bins, 0, sizeof(arena_get_ext(arena)->bins)); // Binned blocks are gone with the rest
+    #endif
+
+    #ifdef ARENA_DEFERRED_COALESCING
+    arena_get_ext(arena)->deferred = NULL;
+    arena_get_ext(arena)->deferred_count = 0;
+    #endif
+
+    #ifdef ARENA_THREAD_SAFE
+    // Remotely freed and cached blocks are gone as well, a new generation invalidates the caches of all threads
+    arena_get_ext(arena)->remote_free = NULL;
+    renew_generation(arena);
+    #endif
+
+    poison_tail(arena);
+}
+
+#if defined(ARENA_SIZE_CLASSES) || defined(ARENA_DEFERRED_COALESCING)
+/*
+ * Drop parked blocks after position
+ * Unlinks the blocks of a parked list that start at or after the given address
+ * Returns the number of blocks dropped
+ */
+static size_t drop_parked_after(Block **list, uintptr_t position) {
+    ARENA_ASSERT((list != NULL) && "Internal Error: 'drop_parked_after' called on NULL list");
+
+    size_t dropped = 0;
+    Block *prev = NULL;
+    Block *block = *list;
+
+    while (block) {
+        Block *next = get_parked_next(block);
+        if ((uintptr_t)block >= position) {
+            if (prev) set_parked_next(prev, next);
+            else *list = next;
+            dropped++;
+        }
+        else {
+            prev = block;
+        }
+        block = next;
+    }
+
+    return dropped;
+}
+#endif
+
+/*
+ * Rewind arena
+ * Releases every block from the given position up to the tail without merging them one by one:
+ *  free blocks leave the free index and the tail moves back to the position, or in front of the block still covering it
+ * In thread-safe mode the caller must hold the arena lock
+ */
+static void rewind_arena(Arena *arena, uintptr_t position) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'rewind_arena' called on NULL arena");
+
+    Block *tail = arena_get_tail(arena);
+
+    // Frees after the mark already gave everything behind it back to the tail
+    if ((uintptr_t)tail < position || ((uintptr_t)tail == position && get_is_free(tail))) return;
+
+    if (position <= (uintptr_t)arena_get_first_block(arena)) {
+        reset_arena(arena);
+        return;
+    }
+
+    #ifdef ARENA_SIZE_CLASSES
+    for (size_t i = 0; i < ARENA_SIZE_CLASS_COUNT; i++) {
+        drop_parked_after(&arena_get_ext(arena)->bins[i], position);
+    }
+    #endif
+
+    #ifdef ARENA_DEFERRED_COALESCING
+    arena_get_ext(arena)->deferred_count -= drop_parked_after(&arena_get_ext(arena)->deferred, position);
+    #endif
+
+    #ifdef ARENA_THREAD_SAFE
+    // Blocks other threads cached may lie behind the mark, they are dropped on their next lookup
+    record_rewind(arena, position);
+    #endif
+
+    if (!get_is_free(tail)) count_free(arena, sizeof(Block) + get_size(tail), true);
+
+    Block *block = get_prev(tail);
+    while ((uintptr_t)block >= position) {
+        if (get_is_free(block)) free_index_remove(arena, block);
+        else count_free(arena, sizeof(Block) + get_size(block), true);
+        block = get_prev(block);
+    }
+
+    // A free block in front of the mark may have merged over it, it becomes the tail
+    if (get_is_free(block)) {
+        free_index_remove(arena, block);
+        set_size(block, 0);
+        arena_set_tail(arena, block);
+        poison_tail(arena);
+        return;
+    }
+
+    // The header at the mark may be stale, or covered by a block that grew over it
+    Block *new_tail = create_block(next_block_unsafe(block));
+    set_prev(new_tail, block);
+    arena_set_tail(arena, new_tail);
+    poison_tail(arena);
+}
+
+#ifndef ARENA_NO_MALLOC
+static Arena *arena_init(void *memory, size_t size, size_t alignment, bool has_chunk, bool is_mapped, Arena *parent);
+static Arena *carve_nested_arena(Arena *parent_arena, size_t size, size_t alignment, bool has_chunk);
+/*
+ * Get grown chunk size
+ * Applies the geometric growth of the policy to the given chunk size, bounded by its maximum
+ */
+static inline size_t grown_chunk_size(const ArenaGrowthPolicy *policy, size_t size) {
+    ARENA_ASSERT((policy != NULL)               && "Internal Error: 'grown_chunk_size' called on NULL policy");
+    ARENA_ASSERT((policy->growth_factor != 0)   && "Internal Error: 'grown_chunk_size' called on zero growth factor");
+
+    if (size <= SIZE_MASK / policy->growth_factor) size *= policy->growth_factor;
+    if (policy->max_chunk_size != 0 && size > policy->max_chunk_size) size = policy->max_chunk_size;
+
+    return size;
+}
+
+/*
+ * Create chunk of growable arena
+ * Allocates a standalone arena with a chunk descriptor, able to hold 'size' bytes of blocks
+ * Returns NULL if memory allocation fails
+ */
+static Arena *create_chunk(size_t size, size_t alignment) {
+    if (size < BLOCK_MIN_SIZE || size > SIZE_MASK - sizeof(Arena) - ARENA_CHUNK_RESERVE - alignment) return NULL;
+
+    void *data = alloc_backing(size + sizeof(Arena) + ARENA_CHUNK_RESERVE + alignment);
+    if (!data) return NULL;
+
+    Arena *chunk = arena_init(data, size + sizeof(Arena) + ARENA_CHUNK_RESERVE, alignment, true, false, NULL);
+
+    if (!chunk) {
+        // LCOV_EXCL_START
+        free(data);
+        return NULL;
+        // LCOV_EXCL_STOP
+    }
+
+    arena_set_is_dynamic(chunk, true);
+    mark_arena_zeroed(chunk);
+
+    return chunk;
+}
+
+/*
+ * Borrow chunk of nested growable arena
+ * Carves a nested arena with a chunk descriptor from the parent, able to hold 'size' bytes of blocks
+ * Returns NULL if the parent cannot fit it
+ */
+static Arena *borrow_chunk(Arena *parent, size_t size, size_t alignment) {
+    ARENA_ASSERT((parent != NULL) && "Internal Error: 'borrow_chunk' called on NULL parent");
+
+    if (size < BLOCK_MIN_SIZE || size > SIZE_MASK - sizeof(Arena) - ARENA_NESTED_CHUNK_RESERVE - alignment) return NULL;
+
+    return carve_nested_arena(parent, size + sizeof(Arena) + ARENA_NESTED_CHUNK_RESERVE + alignment, alignment, true);
+}
+
+/*
+ * Release chunk of growable arena
+ * Chunks carved from a parent go back to it as one block, the others go back to malloc
+ */
+static void release_chunk(Arena *chunk) {
+    ARENA_ASSERT((chunk != NULL) && "Internal Error: 'release_chunk' called on NULL chunk");
+
+    if (arena_get_is_nested(chunk)) {
+        Arena *owner = get_parent_arena(chunk);
+        lock_arena(owner);
+        arena_free_block_full(owner, (Block *)chunk);
+        unlock_arena(owner);
+        return;
+    }
+
+    ARENA_DEFINE_MEMORY(chunk, arena_get_capacity(chunk));
+    free(chunk);
+}
+
+/*
+ * Grow growable arena
+ * Appends a new chunk to the chain of the head arena, big enough for the given request
+ * Nested growable arenas carve the chunk from their parent, the others allocate it
+ * Returns the new chunk or NULL if memory allocation fails
+ */
+static Arena *grow_chunks(Arena *head, size_t size, size_t alignment) {
+    ARENA_ASSERT((head != NULL) && "Internal Error: 'grow_chunks' called on NULL head");
+
+    ArenaChunk *head_chunk = arena_get_chunk(head);
+    size_t chunk_alignment = arena_get_alignment(head);
+
+    // Worst case of a tail allocation: block metadata plus the full alignment padding
+    if (size > SIZE_MASK - sizeof(Block) - alignment) return NULL;
+    size_t needed = size + sizeof(Block) + alignment;
+    size_t chunk_size = head_chunk->next_size > needed ? head_chunk->next_size : needed;
+
+    Arena *chunk = head_chunk->parent
+        ? borrow_chunk(head_chunk->parent, chunk_size, chunk_alignment)
+        : create_chunk(chunk_size, chunk_alignment);
+    if (!chunk) return NULL;
+
+    #ifdef ARENA_FIT_POLICIES
+    arena_get_ext(chunk)->fit_policy = arena_get_ext(head)->fit_policy; // Every chunk places blocks the same way
+    #endif
+
+    #ifdef ARENA_PURGE
+    arena_get_ext(chunk)->decay_ms = arena_get_ext(head)->decay_ms; // Every chunk decays the same way
+    #endif
+
+    head_chunk->next_size = grown_chunk_size(&head_chunk->policy, head_chunk->next_size);
+
+    Arena *last = head;
+    while (arena_get_chunk(last)->next) last = arena_get_chunk(last)->next;
+    arena_get_chunk(last)->next = chunk;
+
+    return chunk;
+}
+
+/*
+ * Allocate memory in chunks of growable arena
+ * Tries the chunk that served the last allocation, then the rest of the chain, then grows it
+ * Returns pointer to allocated memory or NULL if allocation fails
+ */
+static void *alloc_in_chunks(Arena *head, size_t size, size_t alignment) {
+    ARENA_ASSERT((head != NULL) && "Internal Error: 'alloc_in_chunks' called on NULL head");
+
+    ArenaChunk *head_chunk = arena_get_chunk(head);
+
+    #ifdef ARENA_THREAD_SAFE
+    arena_spin_lock(&head_chunk->chain_lock);
+    #endif
+
+    Arena *current = head_chunk->current ? head_chunk->current : head;
+    void *result = alloc_in_arena_locked(current, size, alignment);
+
+    for (Arena *chunk = head; chunk != NULL && !result; chunk = arena_get_chunk(chunk)->next) {
+        if (chunk == current) continue;
+
+        result = alloc_in_arena_locked(chunk, size, alignment);
+        if (result) {
+            head_chunk->current = chunk;
+            arena_get_chunk(chunk)->touched = true;
+        }
+    }
+
+    if (!result) {
+        Arena *chunk = grow_chunks(head, size, alignment);
+        if (chunk) {
+            head_chunk->current = chunk;
+            arena_get_chunk(chunk)->touched = true;
+            result = alloc_in_arena_locked(chunk, size, alignment);
+        }
+    }
+
+    #ifdef ARENA_THREAD_SAFE
+    arena_spin_unlock(&head_chunk->chain_lock);
+    #endif
+
+    return result;
+}
+
+/*
+ * Reset chunks of growable arena
+ * Resets the extra chunks reached since the last reset while they fit in the retain limit of the policy,
+ *  and releases the rest of the chain, so its memory follows the high-water mark of the last cycle
+ */
+static void reset_chunks(Arena *head) {
+    ARENA_ASSERT((head != NULL) && "Internal Error: 'reset_chunks' called on NULL head");
+
+    ArenaChunk *head_chunk = arena_get_chunk(head);
+    size_t retained = 0;
+    size_t last_size = arena_get_capacity(head);
+    Arena *last = head;
+
+    Arena *chunk = head_chunk->next;
+    head_chunk->next = NULL;
+
+    while (chunk) {
+        ArenaChunk *descriptor = arena_get_chunk(chunk);
+        Arena *next = descriptor->next;
+        size_t capacity = arena_get_capacity(chunk);
+
+        bool keep = descriptor->touched && capacity <= head_chunk->policy.retain_size - retained;
+        if (keep) {
+            retained += capacity;
+            last_size = capacity;
+            descriptor->next = NULL;
+            descriptor->touched = false;
+            arena_get_chunk(last)->next = chunk;
+            last = chunk;
+            reset_arena(chunk);
+        }
+        else {
+            release_chunk(chunk);
+        }
+
+        chunk = next;
+    }
+
+    // Released chunks no longer count for geometric growth
+    size_t next_size = grown_chunk_size(&head_chunk->policy, last_size);
+    if (next_size < head_chunk->next_size) head_chunk->next_size = next_size;
+
+    head_chunk->current = head;
+}
+#endif // ARENA_NO_MALLOC
+
+#ifdef ARENA_MMAP
+/*
+ * Get mapping granule
+ * Returns the page size mappings with the given flags are committed and released in
+ */
+static inline size_t mapping_granule(unsigned flags) {
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    if ((flags & ARENA_MMAP_HUGEPAGES) && page_size < ARENA_HUGE_PAGE_SIZE) return ARENA_HUGE_PAGE_SIZE;
+
+    return page_size;
+}
+
+/*
+ * Populate range
+ * Prefaults committed memory, with a single call where the kernel supports it, else by touching every page
+ * The memory is freshly mapped and thus zero, so writing a zero does not change its contents
+ */
+static void populate_range(void *start, size_t length, size_t page_size) {
+    #ifdef MADV_POPULATE_WRITE
+    if (madvise(start, length, MADV_POPULATE_WRITE) == 0) return;
+    #endif
+
+    for (size_t offset = 0; offset < length; offset += page_size) {
+        ((volatile char *)start)[offset] = 0;
+    }
+}
+
+/*
+ * Map region
+ * Maps 'length' bytes of anonymous memory, readable and writable or only reserved (PROT_NONE)
+ * Huge pages are taken from the reserved pool with MAP_HUGETLB first, then requested as transparent huge pages
+ * Returns NULL if the system refuses the mapping
+ */
+static void *map_region(size_t length, bool reserve_only, unsigned flags) {
+    int protection = reserve_only ? PROT_NONE : (PROT_READ | PROT_WRITE);
+    int map_flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    #ifdef MAP_NORESERVE
+    if (reserve_only) map_flags |= MAP_NORESERVE;
+    #endif
+
+    bool populate = !reserve_only && (flags & ARENA_MMAP_POPULATE);
+    int populate_flags = 0;
+    #ifdef MAP_POPULATE
+    if (populate) populate_flags = MAP_POPULATE;
+    #endif
+
+    void *memory = MAP_FAILED;
+
+    #ifdef MAP_HUGETLB
+    if (flags & ARENA_MMAP_HUGEPAGES) {
+        memory = mmap(NULL, length, protection, map_flags | populate_flags | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) return memory; // LCOV_EXCL_LINE
+    }
+    #endif
+
+    // Transparent huge pages are only assigned on fault, so prefault after the advice instead of in mmap
+    bool advise_huge = (flags & ARENA_MMAP_HUGEPAGES) != 0;
+    memory = mmap(NULL, length, protection, map_flags | (advise_huge ? 0 : populate_flags), -1, 0);
+    if (memory == MAP_FAILED) return NULL;
+
+    #ifdef MADV_HUGEPAGE
+    if (advise_huge) madvise(memory, length, MADV_HUGEPAGE); // Best effort, the mapping works without huge pages as well
+    #endif
+
+    if (populate && (advise_huge || populate_flags == 0)) {
+        populate_range(memory, length, mapping_granule(0));
+    }
+
+    return memory;
+}
+
+/*
+ * Commit mapping
+ * Grows a mapped arena in place by committing more of its reserved range, at least 'extra' bytes,
+ *  geometrically otherwise, so a long run of allocations commits memory only a few times
+ * The tail takes the new memory, or a new tail follows an occupied one
+ * In thread-safe mode the caller must hold the arena lock
+ * Returns false if the reserved range is committed entirely or the system refuses to commit it
+ */
+static bool commit_mapping(Arena *arena, size_t extra) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'commit_mapping' called on NULL arena");
+
+    ArenaMapping *mapping = arena_get_mapping(arena);
+    size_t committed = arena_get_capacity(arena);
+    if (committed >= mapping->reserved) return false;
+
+    size_t room = mapping->reserved - committed;
+    size_t growth = committed * (ARENA_GROWTH_FACTOR - 1);
+    if (growth < extra) growth = extra;
+    if (growth > room) growth = room;
+    growth = align_up(growth, mapping->granule);
+    if (growth > room) growth = room; // LCOV_EXCL_LINE
+
+    char *start = (char *)arena + committed;
+    if (mprotect(start, growth, PROT_READ | PROT_WRITE) != 0) return false; // LCOV_EXCL_LINE
+    if (mapping->flags & ARENA_MMAP_POPULATE) populate_range(start, growth, mapping_granule(0));
+    ARENA_POISON_MEMORY(start, growth);
+
+    Block *tail = arena_get_tail(arena);
+    arena_set_capacity(arena, committed + growth);
+
+    // An occupied tail ends right at the old end of the arena
+    if (!get_is_free(tail)) {
+        arena_set_tail(arena, create_next_block(arena, tail));
+        mark_tail_dirty(arena);
+    }
+
+    return true;
+}
+
+/*
+ * Allocate memory in mapping
+ * Commits more of the reserved range of a mapped arena until the request fits or the range is exhausted
+ * Returns pointer to allocated memory or NULL if allocation fails
+ */
+static void *alloc_in_mapping(Arena *arena, size_t size, size_t alignment) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'alloc_in_mapping' called on NULL arena");
+
+    if (size > arena_get_mapping(arena)->reserved) return NULL;
+
+    lock_arena(arena);
+
+    // Another thread may have made room since the failed attempt
+    void *result = alloc_in_arena(arena, size, alignment);
+    while (!result && commit_mapping(arena, size + alignment + sizeof(Block) + BLOCK_MIN_SIZE)) {
+        result = alloc_in_arena(arena, size, alignment);
+    }
+
+    unlock_arena(arena);
+
+    return result;
+}
+
+#ifndef ARENA_ZERO_TRACKING
+/*
+ * Get start of zeroed range
+ * Returns the address after which a reset mapped arena is known to read as zero:
+ *  the start of the range 'release_mapping' gave back with MADV_DONTNEED, or the end of the arena
+ */
+static inline uintptr_t mapping_zero_start(const Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'mapping_zero_start' called on NULL arena");
+
+    uintptr_t end = (uintptr_t)arena + arena_get_capacity(arena);
+    const ArenaMapping *mapping = arena_get_mapping(arena);
+    if (!(mapping->flags & ARENA_MMAP_RELEASE) || (mapping->flags & ARENA_MMAP_LAZY_RELEASE)) return end;
+
+    uintptr_t start = align_up((uintptr_t)block_data(arena_get_first_block(arena)), mapping->granule);
+    return start < end ? start : end;
+}
+#endif // ARENA_ZERO_TRACKING
+
+/*
+ * Release mapping
+ * Gives the whole pages behind the first block of a freshly reset mapped arena back to the OS,
+ *  so idle arenas do not hold resident memory. The address range stays committed and reads as zero on next use
+ * (or keeps its old contents until the OS takes the pages, with ARENA_MMAP_LAZY_RELEASE)
+ */
+static void release_mapping(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'release_mapping' called on NULL arena");
+
+    const ArenaMapping *mapping = arena_get_mapping(arena);
+    if (!(mapping->flags & (ARENA_MMAP_RELEASE | ARENA_MMAP_LAZY_RELEASE))) return;
+
+    uintptr_t start = align_up((uintptr_t)block_data(arena_get_first_block(arena)), mapping->granule);
+    uintptr_t end = (uintptr_t)arena + arena_get_capacity(arena);
+    if (start >= end) return;
+
+    int advice = MADV_DONTNEED;
+    #ifdef MADV_FREE
+    if (mapping->flags & ARENA_MMAP_LAZY_RELEASE) advice = MADV_FREE;
+    #endif
+
+    madvise((void *)start, end - start, advice);
+
+    #ifdef ARENA_ZERO_TRACKING
+    // Dropped pages read as zero again, lazily freed ones may still hold their old contents
+    if (advice == MADV_DONTNEED && start < arena_get_ext(arena)->zero_mark) arena_get_ext(arena)->zero_mark = start;
+    #endif
+}
+#endif // ARENA_MMAP
+
+#ifdef ARENA_PROFILING
+#ifdef ARENA_THREAD_SAFE
+#   define ARENA_PROFILE_LOCAL ARENA_THREAD_LOCAL
+#else
+#   define ARENA_PROFILE_LOCAL
+#endif
+
+static size_t arena_profile_rate = ARENA_PROFILE_RATE;
+static ARENA_PROFILE_LOCAL size_t arena_profile_countdown;      // Bytes the thread allocates before its next sample, 0 before the first
+static ARENA_PROFILE_LOCAL uint32_t arena_profile_seed;         // State of the generator spreading the samples
+static ARENA_PROFILE_LOCAL const char *arena_profile_tag;       // Tag attached to the samples of the thread
+static ArenaProfileSite arena_profile_table[ARENA_PROFILE_SITES];
+static size_t arena_profile_site_count = 0;
+static size_t arena_profile_dropped = 0;                        // Samples of sites the table had no room for
+#ifdef ARENA_THREAD_SAFE
+static volatile long arena_profile_lock = 0;
+#endif
+
+/*
+ * Get profile interval
+ * Draws the bytes until the next sample uniformly from [rate / 2, rate * 3 / 2),
+ *  so allocation patterns repeating with the rate itself are still sampled evenly
+ */
+static size_t profile_interval(size_t rate) {
+    if (arena_profile_seed == 0) arena_profile_seed = (uint32_t)((uintptr_t)&arena_profile_seed >> 4) | 1;
+
+    // Xorshift32 is plenty for spreading samples
+    uint32_t x = arena_profile_seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    arena_profile_seed = x;
+
+    return rate / 2 + (size_t)x % rate + 1;
+}
+
+/*
+ * Record profile sample
+ * Captures the call stack and adds the allocation to its site in the profile table
+ */
+static void profile_record(size_t size, size_t rate) {
+    bool armed = arena_profile_countdown != 0;
+    arena_profile_countdown = profile_interval(rate);
+
+    // The first allocation of a thread only starts its countdown
+    if (!armed) {
+        if (arena_profile_countdown > size) {
+            arena_profile_countdown -= size;
+            return;
+        }
+        arena_profile_countdown = profile_interval(rate);
+    }
+
+    void *frames[ARENA_PROFILE_DEPTH + 1];
+    size_t depth = 0;
+    #ifdef ARENA_HAS_BACKTRACE
+    int captured = backtrace(frames, ARENA_PROFILE_DEPTH + 1);
+    depth = captured > 1 ? (size_t)captured - 1 : 0; // Drop the frame of this function
+    #endif
+
+    const char *tag = arena_profile_tag;
+    uintptr_t hash = (uintptr_t)tag;
+    for (size_t i = 0; i < depth; i++) hash = (hash ^ (uintptr_t)frames[i + 1]) * (uintptr_t)0x9E3779B1u;
+
+    #ifdef ARENA_THREAD_SAFE
+    arena_spin_lock(&arena_profile_lock);
+    #endif
+
+    ArenaProfileSite *site = NULL;
+    for (size_t probe = 0; probe < ARENA_PROFILE_SITES; probe++) {
+        ArenaProfileSite *slot = &arena_profile_table[(hash + probe) % ARENA_PROFILE_SITES];
+        if (slot->samples == 0) {
+            slot->tag = tag;
+            slot->depth = depth;
+            memcpy(slot->frames, frames + 1, depth * sizeof(void *));
+            arena_profile_site_count++;
+            site = slot;
+            break;
+        }
+        if (slot->tag == tag && slot->depth == depth && memcmp(slot->frames, frames + 1, depth * sizeof(void *)) == 0) {
+            site = slot;
+            break;
+        }
+    }
+
+    if (site) {
+        site->samples++;
+        site->sampled_bytes += size;
+        site->estimated_bytes += size > rate ? size : rate;
+    }
+    else {
+        arena_profile_dropped++;
+    }
+
+    #ifdef ARENA_THREAD_SAFE
+    arena_spin_unlock(&arena_profile_lock);
+    #endif
+}
+#endif // ARENA_PROFILING
+
+/*
+ * Profile allocation
+ * Counts the bytes down to the next sample of the allocation profiler, a load and a compare with it switched off
+ * No-op without ARENA_PROFILING
+ */
+static inline void profile_alloc(size_t size) {
+    #ifdef ARENA_PROFILING
+    size_t rate = ARENA_LOAD_TAGGED(arena_profile_rate);
+    if (rate == 0) return;
+
+    if (arena_profile_countdown > size) {
+        arena_profile_countdown -= size;
+        return;
+    }
+    profile_record(size, rate);
+    #else
+    (void)size;
+    #endif
+}
+
+/*
+ * Allocate memory with checked parameters
+ * Runs every allocation path for a request the caller already validated
+ * Growable arenas chain a new chunk when none of their chunks can serve the request
+ * Returns NULL if there is not enough space
+ */
+static inline void *alloc_checked(Arena *arena, size_t size, size_t alignment) {
+    ARENA_ASSERT((arena != NULL)                      && "Internal Error: 'alloc_checked' called on NULL arena");
+    ARENA_ASSERT((size > 0)                           && "Internal Error: 'alloc_checked' called on too small size");
+    ARENA_ASSERT(((alignment & (alignment - 1)) == 0) && "Internal Error: 'alloc_checked' called on invalid alignment");
+    ARENA_ASSERT((alignment >= MIN_ALIGNMENT)         && "Internal Error: 'alloc_checked' called on too small alignment");
+    ARENA_ASSERT((alignment <= MAX_ALLOC_ALIGNMENT)   && "Internal Error: 'alloc_checked' called on too big alignment");
+
+    #ifdef ARENA_THREAD_SAFE
+    void *cached = alloc_in_thread_cache(arena, size, alignment);
+    if (cached) {
+        profile_alloc(size);
+        return cached;
+    }
+    #endif
+
+    void *result = NULL;
+
+    #ifndef ARENA_NO_MALLOC
+    if (arena_get_has_chunk(arena)) {
+        result = alloc_in_chunks(arena, size, alignment);
+    }
+    else
+    #endif
+    {
+        result = alloc_in_arena_locked(arena, size, alignment);
+
+        #ifdef ARENA_MMAP
+        if (!result && arena_get_is_mapped(arena)) {
+            result = alloc_in_mapping(arena, size, alignment);
+        }
+        #endif
+    }
+
+    #ifdef ARENA_THREAD_SAFE
+    // Blocks parked in the cache of this thread may be needed to coalesce a bigger block
+    if (!result && flush_thread_cache(arena)) {
+        result = alloc_in_arena_locked(arena, size, alignment);
+    }
+    #endif
+
+    if (result) profile_alloc(size);
+    return result;
+}
+
+/*
+ * Allocate memory in the arena with custom alignment
+ * Growable arenas chain a new chunk when none of their chunks can serve the request
+ * Returns NULL if there is not enough space
+ */
+void *arena_alloc_custom(Arena *arena, size_t size, size_t alignment) {
+    if (!arena || size == 0) return NULL;
+    if ((alignment & (alignment - 1)) != 0) return NULL;
+    if (alignment < MIN_ALIGNMENT || alignment > MAX_ALLOC_ALIGNMENT) return NULL;
+
+    return alloc_checked(arena, size, alignment);
+}
+
+/*
+ * Allocate memory in the arena with default alignment
+ * The alignment of an arena is valid by construction, so only the size is checked
+ * Returns NULL if there is not enough space
+ */
+void *arena_alloc(Arena *arena, size_t size) {
+    if (!arena || size == 0) return NULL;
+    return alloc_checked(arena, size, arena_get_alignment(arena));
+}
+
+/*
+ * Allocate memory without parameter checks
+ * For requests whose size and alignment are valid by construction, as the ARENA_NEW macros guarantee at compile time:
+ *  a non-NULL arena, a size above zero, a power of two alignment between MIN_ALIGNMENT and MAX_ALLOC_ALIGNMENT
+ * While the arena has no free or parked block, the request is carved from the tail right away
+ * The parameters are only asserted in debug builds
+ * Returns NULL if there is not enough space
+ */
+void *arena_alloc_fast(Arena *arena, size_t size, size_t alignment) {
+    ARENA_ASSERT((arena != NULL)                      && "Internal Error: 'arena_alloc_fast' called on NULL arena");
+    ARENA_ASSERT((size > 0)                           && "Internal Error: 'arena_alloc_fast' called on too small size");
+    ARENA_ASSERT(((alignment & (alignment - 1)) == 0) && "Internal Error: 'arena_alloc_fast' called on invalid alignment");
+
+    #ifndef ARENA_NO_MALLOC
+    // Growable arenas pick the chunk to carve from on the regular path
+    if (arena_get_has_chunk(arena)) return alloc_checked(arena, size, alignment);
+    #endif
+
+    #ifdef ARENA_THREAD_SAFE
+    void *result = alloc_in_thread_cache(arena, size, alignment);
+    if (!result) {
+        lock_arena(arena);
+        drain_remote_frees(arena);
+        result = alloc_in_bare_tail(arena, size, alignment);
+        unlock_arena(arena);
+    }
+    #else
+    void *result = alloc_in_bare_tail(arena, size, alignment);
+    #endif
+
+    if (!result) return alloc_checked(arena, size, alignment);
+
+    profile_alloc(size);
+    return result;
+}
+
+/*
+ * Take fresh allocation
+ * Returns true if the data was just carved from memory of its arena known to read as zero, so it needs no clearing
+ * Always false in thread-safe mode, where another thread may allocate between the carve and the check
+ */
+static inline bool take_fresh(void *data) {
+    ARENA_ASSERT((data != NULL) && "Internal Error: 'take_fresh' called on NULL data");
+
+    #if defined(ARENA_ZERO_TRACKING) && !defined(ARENA_THREAD_SAFE)
+    Block *block = get_occupied_block(data);
+    if (!block) return false; // LCOV_EXCL_LINE
+
+    ArenaExt *ext = arena_get_ext(get_arena(block));
+    bool fresh = ext->fresh == data;
+    ext->fresh = NULL;
+    return fresh;
+    #else
+    (void)data;
+    return false;
+    #endif
+}
+
+/*
+ * Allocate zero-initialized memory in the arena
+ * Returns NULL if there is not enough space or overflow is detected
+ */
+void *arena_calloc(Arena *arena, size_t nmemb, size_t size) {
+    if (!arena) return NULL;
 
     if (nmemb > 0 && (SIZE_MAX / nmemb) < size) {
         return NULL; // Overflow detected
     }
 
-    size_t total_size = nmemb * size;
-    void *ptr = arena_alloc(arena, total_size);
-    if (ptr) {
-        memset(ptr, 0, total_size); // Zero-initialize the allocated memory
+    size_t total_size = nmemb * size;
+    void *ptr = arena_alloc(arena, total_size);
+    if (ptr && !take_fresh(ptr)) {
+        memset(ptr, 0, total_size); // Zero-initialize the allocated memory
+    }
+    else if (ptr) {
+        ARENA_DEFINE_MEMORY(ptr, total_size); // Fresh memory reads as zero, though the sanitizer considers it uninitialized
+    }
+    return ptr;
+}
+
+// Streaming stores of big copies and 'arena_reset_zero', only translation units with the implementation include the intrinsics
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define ARENA_HAS_SSE2
+#   include <emmintrin.h>
+#endif
+
+/*
+ * Copy memory
+ * Copies a buffer into freshly allocated arena memory. Big buffers are written with non-temporal stores,
+ *  so copying them does not evict the working set from the cache, smaller ones go through 'memcpy'
+ */
+static void copy_memory(void *dst, const void *src, size_t size) {
+    #ifdef ARENA_HAS_SSE2
+    if (size >= ARENA_STREAM_COPY_MIN) {
+        char *cursor = (char *)dst;
+        const char *from = (const char *)src;
+        size_t head = align_up((uintptr_t)cursor, 64) - (uintptr_t)cursor;
+        memcpy(cursor, from, head);
+        cursor += head;
+        from += head;
+        size -= head;
+
+        for (; size >= 64; size -= 64, cursor += 64, from += 64) {
+            __m128i a = _mm_loadu_si128((const __m128i *)(const void *)from);
+            __m128i b = _mm_loadu_si128((const __m128i *)(const void *)(from + 16));
+            __m128i c = _mm_loadu_si128((const __m128i *)(const void *)(from + 32));
+            __m128i d = _mm_loadu_si128((const __m128i *)(const void *)(from + 48));
+            _mm_stream_si128((__m128i *)(void *)cursor, a);
+            _mm_stream_si128((__m128i *)(void *)(cursor + 16), b);
+            _mm_stream_si128((__m128i *)(void *)(cursor + 32), c);
+            _mm_stream_si128((__m128i *)(void *)(cursor + 48), d);
+        }
+        _mm_sfence(); // Streaming stores are weakly ordered, make them visible before the memory is handed out
+
+        memcpy(cursor, from, size);
+        return;
+    }
+    #endif
+
+    memcpy(dst, src, size);
+}
+
+/*
+ * Duplicate memory in the arena
+ * Allocates a block of 'size' bytes and copies 'src' into it
+ * Returns NULL if there is not enough space or the parameters are invalid
+ */
+void *arena_memdup(Arena *arena, const void *src, size_t size) {
+    if (!arena || !src || size == 0) return NULL;
+
+    void *ptr = arena_alloc(arena, size);
+    if (ptr) copy_memory(ptr, src, size);
+    return ptr;
+}
+
+/*
+ * Duplicate string
+ * Allocates a NUL-terminated copy of the first 'len' characters of the string
+ */
+static char *duplicate_string(Arena *arena, const char *str, size_t len) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'duplicate_string' called on NULL arena");
+    ARENA_ASSERT((str != NULL)   && "Internal Error: 'duplicate_string' called on NULL string");
+
+    if (len == SIZE_MAX) return NULL; // LCOV_EXCL_LINE: no string is that long
+
+    char *copy = (char *)arena_alloc(arena, len + 1);
+    if (!copy) return NULL;
+
+    copy_memory(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+/*
+ * Duplicate string in the arena
+ * Allocates a copy of the NUL-terminated string
+ * Returns NULL if there is not enough space or the parameters are invalid
+ */
+char *arena_strdup(Arena *arena, const char *str) {
+    if (!arena || !str) return NULL;
+
+    return duplicate_string(arena, str, strlen(str));
+}
+
+/*
+ * Duplicate string prefix in the arena
+ * Allocates a NUL-terminated copy of at most 'max_len' characters of the string, which need not be terminated within them
+ * Returns NULL if there is not enough space or the parameters are invalid
+ */
+char *arena_strndup(Arena *arena, const char *str, size_t max_len) {
+    if (!arena || !str) return NULL;
+
+    const char *end = (const char *)memchr(str, '\0', max_len);
+    return duplicate_string(arena, str, end ? (size_t)(end - str) : max_len);
+}
+
+/*
+ * Gather buffers in the arena
+ * Allocates one block for all 'count' buffers and copies them into it back to back, in one pass
+ * Empty buffers are skipped. Returns NULL if there is not enough space, nothing to copy or the lengths overflow
+ */
+void *arena_copy_iov(Arena *arena, const ArenaIoVec *iov, size_t count) {
+    if (!arena || !iov || count == 0) return NULL;
+
+    size_t total_size = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (iov[i].iov_len == 0) continue;
+        if (!iov[i].iov_base || iov[i].iov_len > SIZE_MAX - total_size) return NULL; // Overflow detected
+        total_size += iov[i].iov_len;
+    }
+    if (total_size == 0) return NULL;
+
+    char *ptr = (char *)arena_alloc(arena, total_size);
+    if (!ptr) return NULL;
+
+    char *cursor = ptr;
+    for (size_t i = 0; i < count; i++) {
+        if (iov[i].iov_len == 0) continue;
+        copy_memory(cursor, iov[i].iov_base, iov[i].iov_len);
+        cursor += iov[i].iov_len;
+    }
+    return ptr;
+}
+
+/*
+ * Resize block in place
+ * Grows a block into the free tail or a free physical successor, or shrinks it and gives the rest back
+ * Never moves the allocation: returns false if it cannot be resized where it is (or the pointer is invalid)
+ */
+bool arena_try_resize(void *data, size_t new_size) {
+    if (new_size == 0 || new_size > SIZE_MASK) return false;
+
+    Block *block = get_occupied_block(data);
+    if (!block) return false;
+
+    Arena *arena = get_arena(block);
+
+    // Block size that ends the data at the new size, with the next header placed for aligned data
+    uintptr_t block_start = (uintptr_t)block_data(block);
+    uintptr_t data_end = (uintptr_t)data + new_size;
+    if (data_end < (uintptr_t)data) return false;
+    size_t needed = align_up(data_end + sizeof(Block), arena_get_alignment(arena)) - sizeof(Block) - block_start;
+
+    lock_arena(arena);
+    if (!has_checked_links(arena, block)) {
+        unlock_arena(arena);
+        return false;
+    }
+
+    bool resized = false;
+    size_t size = get_size(block);
+    Block *tail = arena_get_tail(arena);
+
+    if (needed <= size) {
+        // Shrink: a big enough rest becomes a free block (or the new tail), a small one stays as padding
+        if (size - needed >= BLOCK_MIN_SIZE) {
+            if (block == tail) {
+                set_size(block, needed);
+                Block *new_tail = create_block(next_block_unsafe(block));
+                set_prev(new_tail, block);
+                arena_set_tail(arena, new_tail);
+                poison_tail(arena);
+            }
+            else {
+                split_block(arena, block, needed);
+            }
+        }
+        resized = true;
+    }
+    else if (block != tail) {
+        Block *next = next_block(arena, block);
+
+        if (next == tail && get_is_free(tail)) {
+            // Grow into the tail, its header becomes part of the block
+            size_t available = size + sizeof(Block) + free_size_in_tail(arena);
+            if (needed <= available) {
+                if (available - needed >= BLOCK_MIN_SIZE) {
+                    set_size(block, needed);
+                    Block *new_tail = create_block(next_block_unsafe(block));
+                    set_prev(new_tail, block);
+                    arena_set_tail(arena, new_tail);
+                }
+                else {
+                    // Same as 'alloc_in_tail_full': a rest too small for a block is absorbed and the block becomes the tail
+                    set_size(block, available);
+                    arena_set_tail(arena, block);
+                }
+                resized = true;
+            }
+        }
+        else if (next && get_is_free(next)) {
+            // Grow into the free successor and give back what is left of it
+            if (needed <= size + sizeof(Block) + get_size(next)) {
+                free_index_remove(arena, next);
+
+                merge_blocks_logic(arena, block, next);
+                split_block(arena, block, needed);
+                resized = true;
+            }
+        }
+    }
+
+    if (resized) {
+        expose_block_data(block);
+        count_resize(arena, size, get_size(block));
+        mark_tail_dirty(arena);
+    }
+
+    unlock_arena(arena);
+
+    return resized;
+}
+
+/*
+ * Set validation level
+ * Chooses how much the entry points taking a user pointer check it, for every arena of the process
+ * Set it once at startup, before other threads use arenas, so the same binary can run trusted or hardened
+ * Unknown levels are ignored
+ */
+void arena_set_validation(ArenaValidation level) {
+    if (level < ARENA_VALIDATE_TRUSTED || level > ARENA_VALIDATE_HARDENED) return;
+
+    arena_validation_level = level;
+}
+
+/*
+ * Get validation level
+ * Returns the level set by 'arena_set_validation', ARENA_VALIDATION until it is called
+ */
+ArenaValidation arena_get_validation(void) {
+    return arena_validation_level;
+}
+
+/*
+ * Occupy carved block
+ * Writes the header of a block carved by a batch allocation
+ * Returns pointer to its user data
+ */
+static inline void *occupy_block(Arena *arena, Block *block, size_t block_size) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'occupy_block' called on NULL arena");
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'occupy_block' called on NULL block");
+
+    void *data = block_data(block);
+    set_size(block, block_size);
+    expose_block_data(block);
+    set_is_free(block, false);
+    set_arena(block, arena);
+    set_magic(block, data, arena_get_key(arena));
+
+    return data;
+}
+
+/*
+ * Allocate batch in tail block of arena
+ * Carves up to 'count' blocks of 'block_size' bytes from the tail in a single pass
+ * Stops while the tail still has room for a minimal block, so the last piece takes the regular path
+ * Returns the number of carved blocks
+ */
+static size_t alloc_batch_in_tail(Arena *arena, size_t block_size, size_t count, void **out_ptrs) {
+    ARENA_ASSERT((arena != NULL)    && "Internal Error: 'alloc_batch_in_tail' called on NULL arena");
+    ARENA_ASSERT((out_ptrs != NULL) && "Internal Error: 'alloc_batch_in_tail' called on NULL out_ptrs");
+
+    Block *tail = arena_get_tail(arena);
+    if (!tail || !get_is_free(tail)) return 0;
+
+    // The tail is only carved without padding when its data already has the arena alignment
+    if (((uintptr_t)block_data(tail) & (arena_get_alignment(arena) - 1)) != 0) return 0; // LCOV_EXCL_LINE
+
+    ARENA_ASSERT((get_size(tail) == 0) && "Internal Error: 'alloc_batch_in_tail' called on tail with non zero size");
+
+    size_t stride = sizeof(Block) + block_size;
+    size_t free_space = free_size_in_tail(arena);
+    size_t done = 0;
+
+    // Same condition as 'alloc_in_tail_full' uses to leave a new tail behind the block
+    while (done < count && free_space >= block_size + BLOCK_MIN_SIZE) {
+        out_ptrs[done++] = occupy_block(arena, tail, block_size);
+        count_alloc(arena, tail, true);
+
+        Block *next = create_block(next_block_unsafe(tail));
+        set_prev(next, tail);
+        tail = next;
+        free_space -= stride;
+    }
+
+    arena_set_tail(arena, tail);
+    mark_tail_dirty(arena);
+    return done;
+}
+
+/*
+ * Allocate batch in one free block of arena
+ * Detaches a single free block big enough for all 'count' blocks and carves it in a single pass
+ * The rest of the free block is split off and goes back to the free tree
+ * Returns the number of carved blocks, either 'count' or 0
+ */
+static size_t alloc_batch_in_free_block(Arena *arena, size_t block_size, size_t count, void **out_ptrs) {
+    ARENA_ASSERT((arena != NULL)    && "Internal Error: 'alloc_batch_in_free_block' called on NULL arena");
+    ARENA_ASSERT((count > 0)        && "Internal Error: 'alloc_batch_in_free_block' called on zero count");
+    ARENA_ASSERT((out_ptrs != NULL) && "Internal Error: 'alloc_batch_in_free_block' called on NULL out_ptrs");
+
+    size_t stride = sizeof(Block) + block_size;
+    if (count > SIZE_MASK / stride) return 0;
+
+    size_t alignment = arena_get_alignment(arena);
+    Block *block = free_index_take(arena, count * stride - sizeof(Block), alignment);
+    if (!block) return 0;
+
+    // LCOV_EXCL_START
+    if (((uintptr_t)block_data(block) & (alignment - 1)) != 0) {
+        // Carving assumes no padding, put a block that needs it back
+        free_index_insert(arena, block);
+        return 0;
+    }
+    // LCOV_EXCL_STOP
+
+    size_t full_size = get_size(block);
+    Block *following = next_block(arena, block);
+
+    for (size_t i = 0; i + 1 < count; i++) {
+        out_ptrs[i] = occupy_block(arena, block, block_size);
+        count_alloc(arena, block, false);
+
+        Block *next = create_block(next_block_unsafe(block));
+        set_prev(next, block);
+        block = next;
+        full_size -= stride;
+    }
+
+    // The last piece spans the rest of the free block until 'split_block' trims it
+    out_ptrs[count - 1] = occupy_block(arena, block, full_size);
+    if (following) {
+        set_prev(following, block);
+    }
+    split_block(arena, block, block_size);
+    count_alloc(arena, block, false);
+
+    return count;
+}
+
+/*
+ * Allocate batch in a single arena
+ * Like single allocations, prefers a free block (big enough for the whole batch) over the tail,
+ *  and takes the regular path for whatever neither could carve
+ * In thread-safe mode the caller must hold the arena lock
+ * Returns the number of allocated blocks
+ */
+static size_t alloc_batch_in_arena(Arena *arena, size_t size, size_t alignment, size_t count, void **out_ptrs) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'alloc_batch_in_arena' called on NULL arena");
+    ARENA_ASSERT((size > 0)      && "Internal Error: 'alloc_batch_in_arena' called on too small size");
+
+    // Block size 'alloc_in_tail_full' would give an aligned block, so the next header lands aligned as well
+    size_t block_size = align_up(size + sizeof(Block), alignment) - sizeof(Block);
+
+    size_t done = 0;
+    if (count > 1) {
+        done = alloc_batch_in_free_block(arena, block_size, count, out_ptrs);
+    }
+    if (done < count) {
+        done += alloc_batch_in_tail(arena, block_size, count - done, out_ptrs + done);
+    }
+
+    while (done < count) {
+        void *result = alloc_in_arena(arena, size, alignment);
+        if (!result) break;
+        out_ptrs[done++] = result;
+    }
+
+    return done;
+}
+
+/*
+ * Allocate a batch of blocks in the arena
+ * Allocates up to 'count' blocks of 'size' bytes with the arena alignment and stores them in 'out_ptrs'
+ * Headers are written in one pass over the tail or a single free block instead of 'count' separate allocations
+ * Returns the number of allocated blocks, less than 'count' only if the arena ran out of memory
+ */
+size_t arena_alloc_batch(Arena *arena, size_t size, size_t count, void **out_ptrs) {
+    if (!arena || size == 0 || size > SIZE_MASK || !out_ptrs) return 0;
+
+    size_t alignment = arena_get_alignment(arena);
+    size_t done = 0;
+
+    // Growable arenas spread the batch over their chunks through the regular path
+    if (!arena_get_has_chunk(arena)) {
+        lock_arena(arena);
+
+        #ifdef ARENA_THREAD_SAFE
+        drain_remote_frees(arena);
+        #endif
+
+        done = alloc_batch_in_arena(arena, size, alignment, count, out_ptrs);
+
+        unlock_arena(arena);
+    }
+
+    while (done < count) {
+        void *result = arena_alloc_custom(arena, size, alignment);
+        if (!result) break;
+        out_ptrs[done++] = result;
+    }
+
+    return done;
+}
+
+/*
+ * Helper: Compare pointers by address for 'qsort'
+ */
+static int compare_ptrs(const void *a, const void *b) {
+    uintptr_t left = (uintptr_t)*(void *const *)a;
+    uintptr_t right = (uintptr_t)*(void *const *)b;
+
+    return (left > right) - (left < right);
+}
+
+/*
+ * Release run of blocks
+ * Joins physically adjacent occupied blocks into the first one and releases it with a single merge
+ * In thread-safe mode the caller must hold the arena lock
+ */
+static void release_block_run(Arena *arena, Block *first, Block *last) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'release_block_run' called on NULL arena");
+    ARENA_ASSERT((first != NULL) && "Internal Error: 'release_block_run' called on NULL first");
+    ARENA_ASSERT((last != NULL)  && "Internal Error: 'release_block_run' called on NULL last");
+
+    if (first != last) {
+        size_t run_size = (uintptr_t)block_data(last) + get_size(last) - (uintptr_t)block_data(first);
+        set_size(first, run_size);
+
+        // An occupied tail absorbed the rest of the arena, the joined block takes its place
+        if (last == arena_get_tail(arena)) {
+            arena_set_tail(arena, first);
+        }
+        else {
+            Block *following = next_block(arena, first);
+            if (following) {
+                set_prev(following, first);
+            }
+        }
+    }
+
+    release_block(arena, first);
+}
+
+/*
+ * Free a batch of blocks
+ * Sorts the pointers by address and frees every run of physically adjacent blocks with a single merge
+ * Invalid pointers, NULLs and duplicates are skipped. The order of 'ptrs' is not preserved.
+ */
+void arena_free_batch(void **ptrs, size_t count) {
+    if (!ptrs || count == 0) return;
+
+    // Batches usually come from 'arena_alloc_batch' and are sorted already
+    size_t sorted = 1;
+    while (sorted < count && (uintptr_t)ptrs[sorted - 1] <= (uintptr_t)ptrs[sorted]) sorted++;
+    if (sorted < count) {
+        qsort(ptrs, count, sizeof(void *), compare_ptrs);
+    }
+
+    Arena *run_arena = NULL;
+    Block *run_first = NULL;
+    Block *run_last = NULL;
+
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0 && ptrs[i] == ptrs[i - 1]) continue; // Freeing it twice would merge the block into itself
+
+        // Blocks of the pending run are untouched until it is released, so later pointers still validate
+        Block *block = get_occupied_block(ptrs[i]);
+        if (!block) continue;
+
+        Arena *arena = get_arena(block);
+
+        // The lock of the arena of the pending run is held already, other arenas are locked for the check alone
+        bool held = run_first && arena == run_arena;
+        if (!held && run_first && arena_validation_level == ARENA_VALIDATE_HARDENED) {
+            // Never hold two arena locks at once, another thread may take them in the other order
+            release_block_run(run_arena, run_first, run_last);
+            #ifdef ARENA_PURGE
+            tick_purge(run_arena);
+            #endif
+            unlock_arena(run_arena);
+            run_arena = NULL;
+            run_first = NULL;
+        }
+        if (!(held ? has_checked_links(arena, block) : has_checked_links_locking(arena, block))) continue;
+
+        #ifdef ARENA_POISONING
+        memset(block_data(block), ARENA_POISON_BYTE, get_size(block));
+        #endif
+
+        #ifdef ARENA_THREAD_SAFE
+        // Blocks of arenas owned by other threads are merged lazily by their next allocation
+        if (arena_get_ext(arena)->owner != current_thread_token()) {
+            push_remote_free(arena, block);
+            continue;
+        }
+        #endif
+
+        if (run_first && arena == run_arena && next_block_unsafe(run_last) == block) {
+            // The header becomes data of the joined block, clear it like a merge would, so stale pointers are rejected
+            set_is_free(block, true);
+            set_left_tree(block, NULL);
+            set_right_tree(block, NULL);
+            count_merge(arena);
+
+            run_last = block;
+            continue;
+        }
+
+        if (run_first) {
+            release_block_run(run_arena, run_first, run_last);
+            #ifdef ARENA_PURGE
+            if (arena != run_arena) tick_purge(run_arena);
+            #endif
+            if (arena != run_arena) unlock_arena(run_arena);
+        }
+        if (!run_first || arena != run_arena) lock_arena(arena);
+
+        run_arena = arena;
+        run_first = block;
+        run_last = block;
+    }
+
+    if (run_first) {
+        release_block_run(run_arena, run_first, run_last);
+        #ifdef ARENA_PURGE
+        tick_purge(run_arena);
+        #endif
+        unlock_arena(run_arena);
+    }
+}
+
+/*
+ * Initialize arena
+ * Sets up the arena header, its reserved state and the first block in the given memory
+ * Arenas with a chunk descriptor reserve additional space for the chain state of growable arenas
+ * Arenas with a parent are nested and reserve additional space for the link to it, after the chunk descriptor if they have one
+ * Mapped arenas reserve additional space for the descriptor of their mapping
+ * Returns NULL if the provided size is too small, memory is NULL or size is negative
+ */
+static Arena *arena_init(void *memory, size_t size, size_t alignment, bool has_chunk, bool is_mapped, Arena *parent) {
+    size_t reserve = parent ? ARENA_NESTED_RESERVE : ARENA_EXT_RESERVE;
+    if (has_chunk) reserve = parent ? ARENA_NESTED_CHUNK_RESERVE : ARENA_CHUNK_RESERVE;
+    #ifdef ARENA_MMAP
+    if (is_mapped) reserve = ARENA_MAPPED_RESERVE;
+    #endif
+
+    if (!memory || size < sizeof(Arena) + reserve + BLOCK_MIN_SIZE || size > SIZE_MASK) return NULL;
+    if ((alignment & (alignment - 1)) != 0) return NULL;
+    if (alignment < MIN_ALIGNMENT|| alignment > MAX_ALIGNMENT) return NULL;
+
+    uintptr_t raw_addr = (uintptr_t)memory;
+    uintptr_t aligned_addr = align_up(raw_addr, MIN_ALIGNMENT);
+    size_t arena_padding = aligned_addr - raw_addr; 
+
+    if (size < arena_padding + sizeof(Arena) + reserve + BLOCK_MIN_SIZE) return NULL;
+    
+    Arena *arena = (Arena *)aligned_addr;
+
+    /*
+     * Magic LSB Padding Detector
+     *
+     *What is this for?
+     * One of the core goals of Arena_c is Zero-Cost Parent Tracking. We need to find 
+     * the 'Arena' header starting from a 'Block' pointer (especially the first block) 
+     * without storing an explicit 8-byte 'parent' pointer in every single block.
+     *
+     * In a nested or static arena, there is often a gap (padding) between the 
+     * end of the 'Arena' struct and the start of the first 'Block' due to 
+     * alignment requirements. Instead of wasting this space, we use it to store 
+     * a "back-link" offset to the Arena header.
+     *
+     * Why/How are we sure there is enough space?
+     * 1. Structural Invariants: Both 'Arena' and 'Block' structures are designed 
+     *    to be multiples of the machine word (sizeof(uintptr_t)).
+     * 2. Alignment Logic: Since 'alignment' is a power of two and is at least 
+     *    sizeof(uintptr_t), any gap created by 'align_up' will also be 
+     *    a multiple of the machine word.
+     * 3. The Condition: If 'aligned_block_start' is greater than the end of the 
+     *    Arena structure, the difference is guaranteed to be at least 4 bytes 
+     *    (on 32-bit) or 8 bytes (on 64-bit). This is exactly the space needed 
+     *    to store our tagged uintptr_t offset.
+     *
+     * The Detection Trick
+     * We store the offset shifted left by 1, with the Least Significant Bit (LSB) 
+     * set to 1 (e.g., (offset << 1) | 1). 
+     * Why? Because the last field of an 'Arena' struct is 'free_blocks' (a pointer). 
+     * Valid pointers are always word-aligned (even numbers). By checking the LSB, 
+     * we can instantly distinguish between:
+     *   - 0: We are looking at the 'free_blocks' pointer (Arena is immediately adjacent).
+     *   - 1: We are looking at our custom padding offset (Arena is 'offset' bytes away).
+    */
+
+    uintptr_t aligned_block_start = align_up(aligned_addr + sizeof(Block) + sizeof(Arena) + reserve, alignment) - sizeof(Block);
+    if (aligned_block_start + BLOCK_MIN_SIZE > raw_addr + size) return NULL; // Alignment padding ate the whole buffer
+
+    Block *block = create_block((void *)(aligned_block_start));
+
+    if (aligned_block_start > (aligned_addr + sizeof(Arena))) {
+        uintptr_t offset = aligned_block_start - (uintptr_t)arena;
+        uintptr_t *detector_spot = (uintptr_t *)(aligned_block_start - sizeof(uintptr_t));
+        *detector_spot = (offset << 1) | 1;
+    }
+
+    arena_set_alignment(arena, alignment);
+    arena_set_capacity(arena, size - arena_padding);
+    arena->as.self.free_blocks = NULL; // Drop whatever flag bits the raw memory had before tagging them
+    arena->as.self.tail = NULL;
+    arena_set_has_chunk(arena, has_chunk);
+    arena_set_is_mapped(arena, is_mapped);
+    arena_set_tail(arena, block);
+    arena_set_is_dynamic(arena, false);
+    arena_set_is_nested(arena, parent != NULL);
+
+    #ifdef ARENA_HAS_EXTENSION
+    memset(arena_get_ext(arena), 0, ARENA_EXT_CLEAR_SIZE);
+    #endif
+
+    #ifdef ARENA_ZERO_TRACKING
+    // Fresh mappings read as zero, any other memory may hold old contents until it is cleared once
+    arena_get_ext(arena)->zero_mark = is_mapped ? (uintptr_t)block_data(block) : (uintptr_t)arena + arena_get_capacity(arena);
+    #endif
+
+    #ifdef ARENA_THREAD_SAFE
+    arena_get_ext(arena)->owner = current_thread_token();
+    renew_generation(arena);
+    #endif
+
+    #ifdef ARENA_HARDENING
+    arena_get_ext(arena)->key = make_arena_key(arena);
+    #endif
+
+    #ifdef ARENA_PURGE
+    arena_get_ext(arena)->decay_ms = ARENA_PURGE_DECAY_MS;
+    #endif
+
+    if (has_chunk) {
+        memset(arena_get_chunk(arena), 0, sizeof(ArenaChunk));
+    }
+    if (parent) {
+        *arena_get_parent_link(arena) = parent;
+    }
+
+    poison_tail(arena);
+
+    return arena;
+}
+
+/*
+ * Create a static arena
+ * Initializes an arena using preallocated memory and sets up the first block
+ * Returns NULL if the provided size is too small, memory is NULL or size is negative
+ */
+Arena *arena_new_static_custom(void *memory, size_t size, size_t alignment) {
+    return arena_init(memory, size, alignment, false, false, NULL);
+}
+
+/*
+ * Create a static arena with default alignment
+ * Initializes an arena using preallocated memory with default alignment
+ * Returns NULL if the provided size is too small, memory is NULL or size is negative
+ */
+Arena *arena_new_static(void *memory, size_t size) {
+    return arena_new_static_custom(memory, size, ARENA_DEFAULT_ALIGNMENT);
+}
+
+#ifndef ARENA_NO_MALLOC
+/*
+ * Create a dynamic arena
+ * Allocates memory for the arena and initializes it with the specified size and alignment
+ * Returns NULL if the provided size is too small, memory allocation fails or size is negative
+ */
+Arena *arena_new_dynamic_custom(size_t size, size_t alignment) {
+    if (size < BLOCK_MIN_SIZE || size > SIZE_MASK) return NULL;
+    if ((alignment & (alignment - 1)) != 0) return NULL;
+    if (alignment < MIN_ALIGNMENT|| alignment > MAX_ALIGNMENT) return NULL;
+
+    // Optional per-arena state must not eat the requested capacity
+    void *data = alloc_backing(size + sizeof(Arena) + ARENA_EXT_RESERVE + alignment);
+    if (!data) return NULL;
+    
+    Arena *arena = arena_new_static_custom(data, size + sizeof(Arena) + ARENA_EXT_RESERVE, alignment);
+
+    if (!arena) {
+        // LCOV_EXCL_START
+        free(data);
+        return NULL;
+        // LCOV_EXCL_STOP
+    }
+
+    arena_set_is_dynamic(arena, true);
+    mark_arena_zeroed(arena);
+
+    return arena;
+}
+
+/*
+ * Create a dynamic arena with default alignment
+ * Allocates memory for the arena and initializes it with the specified size and default alignment
+ * Returns NULL if the provided size is too small, memory allocation fails or size is negative
+ */
+Arena *arena_new_dynamic(size_t size) {
+    return arena_new_dynamic_custom(size, ARENA_DEFAULT_ALIGNMENT);
+}
+
+/*
+ * Initialize chain of growable arena
+ * Sets up the chain state in the descriptor of the head, NULL policy selects the default one with the given retain limit
+ */
+static void init_chain(Arena *head, size_t size, const ArenaGrowthPolicy *policy, size_t default_retain_size) {
+    ARENA_ASSERT((head != NULL) && "Internal Error: 'init_chain' called on NULL head");
+
+    ArenaChunk *chunk = arena_get_chunk(head);
+    if (policy) {
+        chunk->policy = *policy;
+    }
+    else {
+        chunk->policy.growth_factor = ARENA_GROWTH_FACTOR;
+        chunk->policy.max_chunk_size = 0;
+        chunk->policy.retain_size = default_retain_size;
+    }
+
+    chunk->current = head;
+    chunk->next_size = grown_chunk_size(&chunk->policy, size);
+}
+
+/*
+ * Create a growable dynamic arena
+ * Allocates the first chunk of the arena with the specified size and alignment.
+ * When the arena runs out of space, new chunks are chained according to the growth policy,
+ *  so already allocated memory never moves. NULL policy selects the default one
+ *  (ARENA_GROWTH_FACTOR, unbounded chunks, all chunks retained across resets).
+ * Returns NULL if the provided size is too small, the policy is invalid or memory allocation fails
+ */
+Arena *arena_new_dynamic_growable_custom(size_t size, size_t alignment, const ArenaGrowthPolicy *policy) {
+    if (size < BLOCK_MIN_SIZE || size > SIZE_MASK) return NULL;
+    if ((alignment & (alignment - 1)) != 0) return NULL;
+    if (alignment < MIN_ALIGNMENT|| alignment > MAX_ALIGNMENT) return NULL;
+    if (policy && policy->growth_factor == 0) return NULL;
+
+    Arena *arena = create_chunk(size, alignment);
+    if (!arena) return NULL;
+
+    init_chain(arena, size, policy, ARENA_RETAIN_ALL);
+
+    return arena;
+}
+
+/*
+ * Create a growable dynamic arena with default alignment and growth policy
+ * Returns NULL if the provided size is too small or memory allocation fails
+ */
+Arena *arena_new_dynamic_growable(size_t size) {
+    return arena_new_dynamic_growable_custom(size, ARENA_DEFAULT_ALIGNMENT, NULL);
+}
+#endif // ARENA_NO_MALLOC
+
+#ifdef ARENA_FIT_POLICIES
+/*
+ * Check arena options
+ * Options are valid if the fit policy is known, NULL options stand for the defaults
+ */
+static inline bool is_valid_options(const ArenaOptions *options) {
+    return options == NULL || (unsigned)options->fit_policy <= (unsigned)ARENA_FIT_TAIL;
+}
+
+/*
+ * Get alignment of arena options
+ * Returns the requested alignment, or the default one if none was given
+ */
+static inline size_t options_alignment(const ArenaOptions *options) {
+    return (options != NULL && options->alignment != 0) ? options->alignment : (size_t)ARENA_DEFAULT_ALIGNMENT;
+}
+
+#ifndef ARENA_NO_MALLOC
+/*
+ * Create a dynamic arena with options
+ * Allocates a fixed-size or growable arena with the alignment and fit policy of the options
+ * Returns NULL if the size is too small, the options are invalid or memory allocation fails
+ */
+Arena *arena_new_dynamic_ex(size_t size, const ArenaOptions *options) {
+    if (!is_valid_options(options)) return NULL;
+
+    Arena *arena = (options && options->growable)
+        ? arena_new_dynamic_growable_custom(size, options_alignment(options), options->growth)
+        : arena_new_dynamic_custom(size, options_alignment(options));
+    if (!arena) return NULL;
+
+    if (options) arena_get_ext(arena)->fit_policy = (unsigned)options->fit_policy;
+
+    return arena;
+}
+#endif // ARENA_NO_MALLOC
+
+/*
+ * Create a static arena with options
+ * Initializes an arena in preallocated memory with the alignment and fit policy of the options
+ * Returns NULL if the memory is too small, the options are invalid or ask for a growable arena
+ */
+Arena *arena_new_static_ex(void *memory, size_t size, const ArenaOptions *options) {
+    if (!is_valid_options(options) || (options && options->growable)) return NULL;
+
+    Arena *arena = arena_new_static_custom(memory, size, options_alignment(options));
+    if (!arena) return NULL;
+
+    if (options) arena_get_ext(arena)->fit_policy = (unsigned)options->fit_policy;
+
+    return arena;
+}
+
+/*
+ * Get fit policy of arena
+ * Returns the placement policy the arena was created with, ARENA_FIT_BEST for NULL
+ */
+ArenaFitPolicy arena_get_fit_policy(const Arena *arena) {
+    if (!arena) return ARENA_FIT_BEST;
+
+    return (ArenaFitPolicy)arena_get_ext(arena)->fit_policy;
+}
+#endif // ARENA_FIT_POLICIES
+
+#ifdef ARENA_MMAP
+#ifdef ARENA_NUMA
+#define ARENA_MPOL_BIND            2        // MPOL_BIND of <numaif.h>, which is part of libnuma and not of the C library
+#define ARENA_MPOL_F_MEMS_ALLOWED  (1 << 2) // MPOL_F_MEMS_ALLOWED of <numaif.h>
+#define ARENA_NUMA_WORD_BITS       (sizeof(unsigned long) * 8)
+#define ARENA_NUMA_MASK_WORDS      ((ARENA_NUMA_MAX_NODES + ARENA_NUMA_WORD_BITS - 1) / ARENA_NUMA_WORD_BITS)
+
+/*
+ * Bind range to node
+ * Sets the memory policy of the range, so every page of it is allocated on the given node when first touched
+ * Without the policy syscalls (kernels without NUMA, sandboxes that deny them) placement falls back to first touch
+ * Returns false if the node does not exist or the process may not use it
+ */
+static bool bind_to_node(void *memory, size_t length, int node) {
+    if (node < 0 || node >= ARENA_NUMA_MAX_NODES) return false;
+
+    unsigned long mask[ARENA_NUMA_MASK_WORDS] = {0};
+    mask[(size_t)node / ARENA_NUMA_WORD_BITS] = 1UL << ((size_t)node % ARENA_NUMA_WORD_BITS);
+
+    // The kernel reads 'maxnode - 1' bits of the mask
+    if (syscall(SYS_mbind, memory, length, ARENA_MPOL_BIND, mask, (unsigned long)ARENA_NUMA_MAX_NODES + 1, 0) == 0) return true;
+
+    return errno == ENOSYS || errno == EPERM; // LCOV_EXCL_LINE
+}
+#endif // ARENA_NUMA
+
+/*
+ * Map arena
+ * Maps a reserved range for 'max_size' bytes and commits the first 'size' of them as a new arena
+ * With a node (ARENA_NUMA only, -1 for none) the range is bound to it before any page is touched,
+ *  and the committed part is prefaulted, so the whole arena is placed on the node right away
+ * Returns NULL if the sizes or the alignment are invalid or the system refuses the mapping
+ */
+static Arena *map_arena(size_t size, size_t max_size, size_t alignment, unsigned flags, int node) {
+    if (size == 0 || max_size < size || max_size > SIZE_MASK / 2) return NULL;
+    if ((alignment & (alignment - 1)) != 0) return NULL;
+    if (alignment < MIN_ALIGNMENT || alignment > MAX_ALIGNMENT) return NULL;
+
+    size_t granule = mapping_granule(flags);
+    size_t header = sizeof(Arena) + ARENA_MAPPED_RESERVE + alignment;
+    size_t reserved = align_up(max_size + header, granule);
+    size_t committed = align_up(size + header, granule);
+    size_t guard = (flags & ARENA_MMAP_GUARD) ? granule : 0;
+
+    // Guard pages stay reserved only, so the arena is committed after mapping the whole range
+    bool lazy = committed < reserved || guard != 0;
+    bool prefault = lazy && (flags & ARENA_MMAP_POPULATE);
+    unsigned map_flags = flags;
+
+    #ifdef ARENA_NUMA
+    if (node >= 0) {
+        map_flags &= ~ARENA_MMAP_POPULATE; // Pages faulted before the binding would land on the wrong node
+        prefault = true;
+    }
+    #else
+    (void)node;
+    #endif
+
+    char *region = (char *)map_region(reserved + 2 * guard, lazy, map_flags);
+    if (!region) return NULL; // LCOV_EXCL_LINE
+    char *memory = region + guard;
+
+    #ifdef ARENA_NUMA
+    if (node >= 0 && !bind_to_node(memory, reserved, node)) {
+        munmap(region, reserved + 2 * guard);
+        return NULL;
+    }
+    #endif
+
+    if (lazy) {
+        // LCOV_EXCL_START
+        if (mprotect(memory, committed, PROT_READ | PROT_WRITE) != 0) {
+            munmap(region, reserved + 2 * guard);
+            return NULL;
+        }
+        // LCOV_EXCL_STOP
+    }
+    if (prefault) populate_range(memory, committed, mapping_granule(0));
+
+    // The mapping is page aligned, so the header lands at its very start
+    Arena *arena = arena_init(memory, committed, alignment, false, true, NULL);
+    ARENA_ASSERT(((void *)arena == (void *)memory) && "Internal Error: mapped arena does not start at its mapping");
+
+    ArenaMapping *mapping = arena_get_mapping(arena);
+    mapping->reserved = reserved;
+    mapping->granule = granule;
+    mapping->flags = flags;
+    mapping->guard = guard;
+
+    return arena;
+}
+
+/*
+ * Create a mapped growable arena with custom alignment
+ * Reserves address space for 'max_size' bytes up front and commits only the first 'size' of them,
+ *  the arena then grows in place (pointers and the arena handle stay valid) until the reservation is used up
+ * Returns NULL if the sizes or the alignment are invalid or the system refuses the mapping
+ */
+Arena *arena_new_mapped_growable_custom(size_t size, size_t max_size, size_t alignment, unsigned flags) {
+    return map_arena(size, max_size, alignment, flags, -1);
+}
+
+/*
+ * Create a mapped growable arena
+ * Reserves address space for 'max_size' bytes, commits 'size' of them and grows in place with default alignment
+ * Returns NULL if the sizes are invalid or the system refuses the mapping
+ */
+Arena *arena_new_mapped_growable(size_t size, size_t max_size, unsigned flags) {
+    return arena_new_mapped_growable_custom(size, max_size, ARENA_DEFAULT_ALIGNMENT, flags);
+}
+
+/*
+ * Create a mapped arena with custom alignment
+ * Maps the memory of the arena directly from the OS instead of malloc, which allows huge pages,
+ *  prefaulting and giving pages back on reset (see the ARENA_MMAP_* flags)
+ * Returns NULL if the size or the alignment are invalid or the system refuses the mapping
+ */
+Arena *arena_new_mapped_custom(size_t size, size_t alignment, unsigned flags) {
+    return arena_new_mapped_growable_custom(size, size, alignment, flags);
+}
+
+/*
+ * Create a mapped arena
+ * Maps the memory of the arena directly from the OS with default alignment
+ * Returns NULL if the size is invalid or the system refuses the mapping
+ */
+Arena *arena_new_mapped(size_t size, unsigned flags) {
+    return arena_new_mapped_custom(size, ARENA_DEFAULT_ALIGNMENT, flags);
+}
+
+#define ARENA_IMAGE_VERSION 3
+
+/*
+ * Arena image header
+ * Starts an image file, the committed memory of the arena follows at 'header_size' (a page) from its start
+ * The image is only valid at its original address, where every pointer in it (headers and user data alike) stays right
+ */
+typedef struct ArenaImageHeader {
+    char magic[8];          // "ARENAIMG"
+    uint32_t version;       // ARENA_IMAGE_VERSION the image was written with
+    uint32_t features;      // Layout-changing features the writer was built with
+    uintptr_t base;         // Address of the arena header, the image is mapped back there
+    size_t committed;       // Bytes of arena memory stored in the image
+    size_t reserved;        // Address range reserved for the arena, so it can keep growing in place
+    size_t header_size;     // Offset of the arena memory in the file
+    uint32_t arena_size;    // Size of the Arena structure of the writer
+    uint32_t block_size;    // Size of the Block structure of the writer
+    uint32_t ext_size;      // Size of the ArenaExt structure of the writer, 0 without an extension
+    uint32_t max_alignment; // Largest alignment the writer supports
+} ArenaImageHeader;
+
+/*
+ * Get image features
+ * Returns the compile-time features that change the layout or meaning of arena memory, images must match them
+ */
+static inline uint32_t image_features(void) {
+    uint32_t features = 0;
+    #ifdef ARENA_SIZE_CLASSES
+    features |= 1u << 0;
+    #endif
+    #ifdef ARENA_THREAD_SAFE
+    features |= 1u << 1;
+    #endif
+    #ifdef ARENA_STATS
+    features |= 1u << 2;
+    #endif
+    #ifdef ARENA_FREE_INDEX_BITMAP
+    features |= 1u << 3;
+    #endif
+    #ifdef ARENA_TLSF
+    features |= 1u << 4;
+    #endif
+    #ifdef ARENA_DEFERRED_COALESCING
+    features |= 1u << 5;
+    #endif
+    #ifdef ARENA_ZERO_TRACKING
+    features |= 1u << 6;
+    #endif
+    #ifdef ARENA_HARDENING
+    features |= 1u << 7;
+    #endif
+    #ifdef ARENA_FIT_POLICIES
+    features |= 1u << 8;
+    #endif
+    #ifdef ARENA_PURGE
+    features |= 1u << 9;
+    #endif
+    return features;
+}
+
+/*
+ * Set image layout
+ * Stores the size of every structure images depend on in a field of its own, so two layouts never compare equal
+ */
+static inline void set_image_layout(ArenaImageHeader *header) {
+    ARENA_ASSERT((header != NULL) && "Internal Error: 'set_image_layout' called on NULL header");
+
+    header->arena_size = (uint32_t)sizeof(Arena);
+    header->block_size = (uint32_t)sizeof(Block);
+    #ifdef ARENA_HAS_EXTENSION
+    header->ext_size = (uint32_t)sizeof(ArenaExt);
+    #else
+    header->ext_size = 0;
+    #endif
+    header->max_alignment = (uint32_t)MAX_ALIGNMENT;
+}
+
+/*
+ * Check image layout
+ * Returns true if the image was written by a build with the same structure sizes
+ */
+static inline bool has_image_layout(const ArenaImageHeader *header) {
+    ARENA_ASSERT((header != NULL) && "Internal Error: 'has_image_layout' called on NULL header");
+
+    ArenaImageHeader expected;
+    set_image_layout(&expected);
+
+    return header->arena_size == expected.arena_size && header->block_size == expected.block_size &&
+           header->ext_size == expected.ext_size && header->max_alignment == expected.max_alignment;
+}
+
+/*
+ * Write whole buffer
+ * Writes all bytes to the file, retrying partial writes and interrupted calls
+ * Returns false on write errors
+ */
+static bool write_all(int fd, const void *buffer, size_t size) {
+    const char *cursor = (const char *)buffer;
+    while (size > 0) {
+        ssize_t written = write(fd, cursor, size);
+        if (written < 0) {
+            if (errno == EINTR) continue; // LCOV_EXCL_LINE
+            return false; // LCOV_EXCL_LINE
+        }
+        cursor += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+/*
+ * Poison free memory
+ * Poisons the data of every free block and the tail again, after the whole arena had to be accessible
+ */
+static void poison_free_memory(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'poison_free_memory' called on NULL arena");
+
+    #ifdef ARENA_HAS_SANITIZER_HOOKS
+    Block *tail = arena_get_tail(arena);
+    for (Block *block = arena_get_first_block(arena); block && block != tail; block = next_block(arena, block)) {
+        if (get_is_free(block)) poison_block_data(block);
+    }
+    poison_tail(arena);
+    #else
+    (void)arena;
+    #endif
+}
+
+/*
+ * Write arena image
+ * Writes the header and the used part of the arena, the free tail stays a hole that reads as zero
+ * Returns false on write errors
+ */
+static bool write_image(int fd, Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'write_image' called on NULL arena");
+
+    ArenaImageHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "ARENAIMG", sizeof(header.magic));
+    header.version = ARENA_IMAGE_VERSION;
+    header.features = image_features();
+    header.base = (uintptr_t)arena;
+    header.committed = arena_get_capacity(arena);
+    header.reserved = arena_get_mapping(arena)->reserved;
+    header.header_size = (size_t)sysconf(_SC_PAGESIZE);
+    set_image_layout(&header);
+
+    Block *tail = arena_get_tail(arena);
+    size_t used = get_is_free(tail) ? (size_t)((char *)block_data(tail) - (char *)arena) : header.committed;
+
+    if (!write_all(fd, &header, sizeof(header))) return false; // LCOV_EXCL_LINE
+    if (lseek(fd, (off_t)header.header_size, SEEK_SET) < 0) return false; // LCOV_EXCL_LINE
+
+    // The image holds free blocks as well, the sanitizer in use must let the write read them
+    ARENA_DEFINE_MEMORY(arena, used);
+    bool written = write_all(fd, arena, used);
+    poison_free_memory(arena);
+    if (!written) return false; // LCOV_EXCL_LINE
+
+    return ftruncate(fd, (off_t)(header.header_size + header.committed)) == 0;
+}
+
+/*
+ * Save arena image
+ * Writes a mapped arena to a file that 'arena_map_file' maps back at the same address, without any fixup
+ * The image is written next to the path and renamed over it, so processes mapping the old file keep a valid image
+ * Other threads must not use the arena while it is saved, blocks they still cache are saved as occupied
+ * Returns false if the arena is not a mapped arena or the file cannot be written
+ */
+bool arena_save(Arena *arena, const char *path) {
+    if (!arena || !path || !arena_get_is_mapped(arena) || arena_get_has_chunk(arena)) return false;
+
+    size_t length = strlen(path);
+    char temporary[PATH_MAX];
+    if (length + sizeof(".tmp") > sizeof(temporary)) return false;
+    memcpy(temporary, path, length);
+    memcpy(temporary + length, ".tmp", sizeof(".tmp"));
+
+    bool saved = false;
+    int fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        #ifdef ARENA_THREAD_SAFE
+        flush_thread_cache(arena);
+        #endif
+        lock_arena(arena);
+        #ifdef ARENA_THREAD_SAFE
+        drain_remote_frees(arena);
+        #endif
+        saved = write_image(fd, arena);
+        unlock_arena(arena);
+
+        saved = (close(fd) == 0) && saved;
+        saved = saved && rename(temporary, path) == 0;
+        if (!saved) unlink(temporary);
+    }
+
+    return saved;
+}
+
+/*
+ * Check image header
+ * Verifies that the image was written by a compatible build and that the file holds all of its memory
+ */
+static bool is_valid_image(const ArenaImageHeader *header, int fd) {
+    ARENA_ASSERT((header != NULL) && "Internal Error: 'is_valid_image' called on NULL header");
+
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    if (memcmp(header->magic, "ARENAIMG", sizeof(header->magic)) != 0) return false;
+    if (header->version != ARENA_IMAGE_VERSION || header->features != image_features()) return false;
+    if (!has_image_layout(header)) return false;
+    if (header->header_size == 0 || header->header_size % page_size != 0 || header->base % page_size != 0) return false;
+    if (header->committed == 0 || header->committed > header->reserved || header->reserved > SIZE_MASK / 2) return false;
+
+    struct stat status;
+    if (fstat(fd, &status) != 0) return false; // LCOV_EXCL_LINE
+
+    return (uint64_t)status.st_size == (uint64_t)header->header_size + header->committed;
+}
+
+/*
+ * Map arena image
+ * Reserves the original address range of the arena and maps the image over its committed part, copy-on-write
+ * Returns NULL if the range is in use in this process or the memory does not hold a mapped arena
+ */
+static Arena *map_image(int fd, const ArenaImageHeader *header, unsigned flags) {
+    ARENA_ASSERT((header != NULL) && "Internal Error: 'map_image' called on NULL header");
+
+    void *base = (void *)header->base;
+    int reserve_flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    #ifdef MAP_NORESERVE
+    reserve_flags |= MAP_NORESERVE;
+    #endif
+    #ifdef MAP_FIXED_NOREPLACE
+    reserve_flags |= MAP_FIXED_NOREPLACE;
+    #endif
+
+    // Without MAP_FIXED_NOREPLACE the address is only a hint, which the kernel honours if the range is free
+    void *range = mmap(base, header->reserved, PROT_NONE, reserve_flags, -1, 0);
+    if (range == MAP_FAILED) return NULL;
+    if (range != base) {
+        munmap(range, header->reserved); // LCOV_EXCL_LINE
+        return NULL; // LCOV_EXCL_LINE
+    }
+
+    int image_flags = MAP_PRIVATE | MAP_FIXED;
+    #ifdef MAP_POPULATE
+    if (flags & ARENA_MMAP_POPULATE) image_flags |= MAP_POPULATE;
+    #endif
+
+    // Mapping over the own reservation, so the fixed placement cannot replace anything else
+    if (mmap(base, header->committed, PROT_READ | PROT_WRITE, image_flags, fd, (off_t)header->header_size) == MAP_FAILED) {
+        munmap(base, header->reserved); // LCOV_EXCL_LINE
+        return NULL; // LCOV_EXCL_LINE
+    }
+
+    Arena *arena = (Arena *)base;
+    if (!arena_get_is_mapped(arena) || arena_get_has_chunk(arena) || arena_get_is_nested(arena) ||
+        arena_get_capacity(arena) != header->committed || arena_get_mapping(arena)->reserved != header->reserved) {
+        munmap(base, header->reserved);
+        return NULL;
+    }
+    arena_get_mapping(arena)->guard = 0; // Only the reserved range is mapped back, without the guards of the saved arena
+    poison_free_memory(arena);
+
+    return arena;
+}
+
+/*
+ * Map arena from file
+ * Maps an image written by 'arena_save' back at its original address, so the arena and every pointer stored in it
+ *  are valid right away. Pages are loaded on first touch and changes stay private to the process
+ * Only ARENA_MMAP_POPULATE is honoured, pages of the image are never given back to the OS on reset
+ * Returns NULL if the file is not a compatible image or its address range is in use in this process
+ */
+Arena *arena_map_file(const char *path, unsigned flags) {
+    if (!path) return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    ArenaImageHeader header;
+    Arena *arena = NULL;
+    if (read(fd, &header, sizeof(header)) == (ssize_t)sizeof(header) && is_valid_image(&header, fd)) {
+        arena = map_image(fd, &header, flags);
+    }
+    close(fd);
+    if (!arena) return NULL;
+
+    arena_get_mapping(arena)->flags = (flags & ARENA_MMAP_POPULATE) | ARENA_MAPPING_FROM_FILE;
+
+    // State that belongs to the process that saved the image
+    #ifdef ARENA_THREAD_SAFE
+    arena_get_ext(arena)->lock = 0;
+    arena_get_ext(arena)->remote_free = NULL;
+    arena_get_ext(arena)->owner = current_thread_token();
+    arena_get_ext(arena)->cache_cell = 0;
+    renew_generation(arena);
+    #endif
+    #ifdef ARENA_ZERO_TRACKING
+    arena_get_ext(arena)->fresh = NULL;
+    #endif
+
+    return arena;
+}
+#endif // ARENA_MMAP
+
+#ifdef ARENA_NUMA
+/*
+ * Create a NUMA arena with custom alignment
+ * Maps a mapped arena (see the ARENA_MMAP_* flags) bound to the given node and first-touches all of it there
+ * Returns NULL if the node does not exist, the size or the alignment are invalid or the mapping fails
+ */
+Arena *arena_new_dynamic_numa_custom(size_t size, size_t alignment, int node, unsigned flags) {
+    if (node < 0 || node >= ARENA_NUMA_MAX_NODES) return NULL;
+
+    return map_arena(size, size, alignment, flags, node);
+}
+
+/*
+ * Create a NUMA arena
+ * Maps an arena bound to the given node with default alignment
+ * Returns NULL if the node does not exist, the size is invalid or the mapping fails
+ */
+Arena *arena_new_dynamic_numa(size_t size, int node) {
+    return arena_new_dynamic_numa_custom(size, ARENA_DEFAULT_ALIGNMENT, node, 0);
+}
+
+/*
+ * Get current NUMA node
+ * Returns the node of the CPU the calling thread runs on, 0 if the system cannot tell
+ */
+int arena_numa_current_node(void) {
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) return 0; // LCOV_EXCL_LINE
+
+    return (int)node;
+}
+
+/*
+ * Initialize NUMA arena pool
+ * Creates an arena of 'size' bytes bound to every node the process may allocate on
+ * Returns false (with the pool left empty) if any of the arenas cannot be created
+ */
+bool arena_numa_pool_init(ArenaNumaPool *pool, size_t size, unsigned flags) {
+    if (!pool) return false;
+    memset(pool, 0, sizeof(ArenaNumaPool));
+
+    unsigned long allowed[ARENA_NUMA_MASK_WORDS] = {0};
+    if (syscall(SYS_get_mempolicy, NULL, allowed, (unsigned long)ARENA_NUMA_MAX_NODES + 1, NULL, ARENA_MPOL_F_MEMS_ALLOWED) != 0) {
+        allowed[0] = 1; // LCOV_EXCL_LINE: without memory policies there is a single node
+    }
+
+    for (int node = 0; node < ARENA_NUMA_MAX_NODES; node++) {
+        if (!(allowed[(size_t)node / ARENA_NUMA_WORD_BITS] & (1UL << ((size_t)node % ARENA_NUMA_WORD_BITS)))) continue;
+
+        Arena *arena = arena_new_dynamic_numa_custom(size, ARENA_DEFAULT_ALIGNMENT, node, flags);
+        if (!arena) {
+            arena_numa_pool_free(pool);
+            return false;
+        }
+
+        pool->nodes[node] = arena;
+        if (!pool->fallback) pool->fallback = arena;
+    }
+
+    return pool->fallback != NULL;
+}
+
+/*
+ * Get local arena of NUMA pool
+ * Returns the arena bound to the node the calling thread runs on, or the fallback arena if that node has none
+ * Threads may migrate between nodes, the result is a placement hint and not a guarantee
+ */
+Arena *arena_numa_pool_local(ArenaNumaPool *pool) {
+    if (!pool) return NULL;
+
+    int node = arena_numa_current_node();
+    if (node >= 0 && node < ARENA_NUMA_MAX_NODES && pool->nodes[node]) return pool->nodes[node];
+
+    return pool->fallback; // LCOV_EXCL_LINE
+}
+
+/*
+ * Create nested arena local to the calling thread
+ * Carves a nested arena from the arena of the current node, so a worker owns memory local to it
+ * Returns NULL if the pool is empty or the local arena cannot fit the nested arena
+ */
+Arena *arena_numa_pool_new_nested(ArenaNumaPool *pool, size_t size) {
+    Arena *local = arena_numa_pool_local(pool);
+    if (!local) return NULL;
+
+    return arena_new_nested(local, size);
+}
+
+/*
+ * Free NUMA arena pool
+ * Unmaps the arenas of every node, nested arenas carved from them are gone as well
+ */
+void arena_numa_pool_free(ArenaNumaPool *pool) {
+    if (!pool) return;
+
+    for (int node = 0; node < ARENA_NUMA_MAX_NODES; node++) {
+        arena_free(pool->nodes[node]);
+    }
+    memset(pool, 0, sizeof(ArenaNumaPool));
+}
+#endif // ARENA_NUMA
+
+/*
+ * Free arena
+ * Deallocates the memory used by the arena if it was dynamically allocated
+ * Nested arenas give their chunks back to the parent, the nested arenas inside them are gone at once
+ * Can be safely called with static arenas (no operation in that case)
+ */
+void arena_free(Arena *arena) {
+    if (!arena) return;
+
+    #ifdef ARENA_THREAD_SAFE
+    flush_thread_cache(arena); // Free the cache slots of this thread still holding blocks of the arena
+    detach_cache_cell(arena);  // And those of all other threads
+    #endif
+
+    #ifndef ARENA_NO_MALLOC
+    if (arena_get_has_chunk(arena)) {
+        Arena *chunk = arena_get_chunk(arena)->next;
+        while (chunk) {
+            Arena *next = arena_get_chunk(chunk)->next;
+            release_chunk(chunk);
+            chunk = next;
+        }
+    }
+    #endif // ARENA_NO_MALLOC
+
+    if (arena_get_is_nested(arena)) {
+        Arena *parent = get_parent_arena(arena);
+        lock_arena(parent);
+        arena_free_block_full(parent, (Block *)arena); 
+        unlock_arena(parent);
+        return;
+    }
+
+    // The memory goes back to its owner, which expects all of it accessible again
+    ARENA_DEFINE_MEMORY(arena, arena_get_capacity(arena));
+
+    #ifdef ARENA_MMAP
+    if (arena_get_is_mapped(arena)) {
+        ArenaMapping *mapping = arena_get_mapping(arena);
+        munmap((char *)arena - mapping->guard, mapping->reserved + 2 * mapping->guard);
+        return;
+    }
+    #endif
+
+    #ifndef ARENA_NO_MALLOC
+    if (arena_get_is_dynamic(arena)) {
+        free(arena);
+    }
+    #endif // ARENA_NO_MALLOC
+}
+
+/*
+ * Mark the arena
+ * Captures the current tail, so 'arena_rewind' can later release everything allocated after it at once
+ * Growable arenas are marked in the chunk that served the last allocation
+ * Returns an invalid mark (NULL chunk) for a NULL arena
+ */
+ArenaMark arena_mark(Arena *arena) {
+    ArenaMark mark = { NULL, 0, NULL };
+    if (!arena) return mark;
+
+    mark.chunk = arena;
+
+    #ifndef ARENA_NO_MALLOC
+    ArenaChunk *head_chunk = arena_get_has_chunk(arena) ? arena_get_chunk(arena) : NULL;
+    if (head_chunk) {
+        #ifdef ARENA_THREAD_SAFE
+        arena_spin_lock(&head_chunk->chain_lock);
+        #endif
+
+        if (head_chunk->current) mark.chunk = head_chunk->current;
+        mark.last = arena;
+        while (arena_get_chunk(mark.last)->next) mark.last = arena_get_chunk(mark.last)->next;
+    }
+    #endif
+
+    lock_arena(mark.chunk);
+    Block *tail = arena_get_tail(mark.chunk);
+    mark.position = get_is_free(tail) ? (uintptr_t)tail : (uintptr_t)mark.chunk + arena_get_capacity(mark.chunk);
+    unlock_arena(mark.chunk);
+
+    #if !defined(ARENA_NO_MALLOC) && defined(ARENA_THREAD_SAFE)
+    if (head_chunk) arena_spin_unlock(&head_chunk->chain_lock);
+    #endif
+
+    return mark;
+}
+
+/*
+ * Rewind the arena to a mark
+ * Releases every block carved from the tail after the mark in O(blocks carved), without merging them one by one.
+ * Blocks reused from free space in front of the mark stay allocated, as do blocks placed in other chunks of a growable arena
+ *  that existed at the time of the mark. Chunks chained after the mark are emptied.
+ * Marks of another arena are ignored
+ */
+void arena_rewind(Arena *arena, ArenaMark mark) {
+    if (!arena || !mark.chunk) return;
+
+    #ifdef ARENA_THREAD_SAFE
+    flush_thread_cache(arena);
+    #endif
+
+    #ifndef ARENA_NO_MALLOC
+    if (arena_get_has_chunk(arena)) {
+        ArenaChunk *head_chunk = arena_get_chunk(arena);
+
+        #ifdef ARENA_THREAD_SAFE
+        arena_spin_lock(&head_chunk->chain_lock);
+        #endif
+
+        bool found_chunk = false;
+        bool found_last = false;
+        for (Arena *chunk = arena; chunk != NULL; chunk = arena_get_chunk(chunk)->next) {
+            if (chunk == mark.chunk) found_chunk = true;
+            if (chunk == mark.last) found_last = true;
+        }
+
+        if (found_chunk && found_last) {
+            lock_arena(mark.chunk);
+            #ifdef ARENA_THREAD_SAFE
+            drain_remote_frees(mark.chunk);
+            #endif
+            rewind_arena(mark.chunk, mark.position);
+            unlock_arena(mark.chunk);
+
+            for (Arena *chunk = arena_get_chunk(mark.last)->next; chunk != NULL; chunk = arena_get_chunk(chunk)->next) {
+                lock_arena(chunk);
+                reset_arena(chunk);
+                unlock_arena(chunk);
+            }
+
+            head_chunk->current = mark.chunk;
+        }
+
+        #ifdef ARENA_THREAD_SAFE
+        arena_spin_unlock(&head_chunk->chain_lock);
+        #endif
+        return;
+    }
+    #endif
+
+    if (mark.chunk != arena) return;
+
+    lock_arena(arena);
+    #ifdef ARENA_THREAD_SAFE
+    drain_remote_frees(arena);
+    #endif
+    rewind_arena(arena, mark.position);
+    unlock_arena(arena);
+}
+
+/*
+ * Reset the arena
+ * Clears the arena's blocks and resets it to the initial state without freeing memory
+ * Growable arenas keep or release their extra chunks according to the growth policy
+ */
+void arena_reset(Arena *arena) {
+    if (!arena) return;
+
+    reset_arena(arena);
+
+    #ifndef ARENA_NO_MALLOC
+    if (arena_get_has_chunk(arena)) reset_chunks(arena);
+    #endif
+
+    #ifdef ARENA_MMAP
+    if (arena_get_is_mapped(arena)) release_mapping(arena);
+    #endif
+}
+
+/*
+ * Zero memory
+ * Clears a range of arena memory. Big ranges of mapped arenas are given back to the OS and read as zero on next use,
+ *  other big ranges are written with non-temporal stores, so clearing them does not evict the working set from the cache
+ */
+static void zero_memory(Arena *arena, void *start, size_t size) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'zero_memory' called on NULL arena");
+
+    if (size < ARENA_STREAM_ZERO_MIN) {
+        memset(start, 0, size);
+        return;
+    }
+
+    #ifdef ARENA_MMAP
+    // Dropped pages of a file image would read back the file, not zeros
+    const ArenaMapping *mapping = arena_get_is_mapped(arena) ? arena_get_mapping(arena) : NULL;
+    if (mapping && !(mapping->flags & (ARENA_MMAP_POPULATE | ARENA_MAPPING_FROM_FILE))) {
+        uintptr_t first = align_up((uintptr_t)start, mapping->granule);
+        uintptr_t last = ((uintptr_t)start + size) & ~(uintptr_t)(mapping->granule - 1);
+        if (first < last && madvise((void *)first, last - first, MADV_DONTNEED) == 0) {
+            memset(start, 0, first - (uintptr_t)start);
+            memset((void *)last, 0, (uintptr_t)start + size - last);
+            return;
+        }
+    }
+    #endif
+
+    #ifdef ARENA_HAS_SSE2
+    char *cursor = (char *)start;
+    size_t head = align_up((uintptr_t)cursor, 64) - (uintptr_t)cursor;
+    memset(cursor, 0, head);
+    cursor += head;
+    size -= head;
+
+    const __m128i zero = _mm_setzero_si128();
+    for (; size >= 64; size -= 64, cursor += 64) {
+        _mm_stream_si128((__m128i *)(void *)cursor, zero);
+        _mm_stream_si128((__m128i *)(void *)(cursor + 16), zero);
+        _mm_stream_si128((__m128i *)(void *)(cursor + 32), zero);
+        _mm_stream_si128((__m128i *)(void *)(cursor + 48), zero);
+    }
+    _mm_sfence(); // Streaming stores are weakly ordered, make them visible before the memory is handed out
+
+    memset(cursor, 0, size);
+    #else
+    memset(start, 0, size);
+    #endif
+}
+
+/*
+ * Clear tail
+ * Zeroes the tail of a freshly reset arena, up to where its memory is known to read as zero already
+ */
+static void clear_tail(Arena *arena) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'clear_tail' called on NULL arena");
+
+    uintptr_t start = (uintptr_t)block_data(arena_get_tail(arena));
+    uintptr_t end = start + free_size_in_tail(arena);
+
+    #ifdef ARENA_ZERO_TRACKING
+    // Only the range written since the memory was last zero needs clearing
+    if (arena_get_ext(arena)->zero_mark < end) end = arena_get_ext(arena)->zero_mark;
+    #elif defined(ARENA_MMAP)
+    // Pages given back with MADV_DONTNEED read as zero already, touching them again would only bring them back
+    if (arena_get_is_mapped(arena)) end = mapping_zero_start(arena);
+    #endif
+
+    if (end > start) {
+        ARENA_DEFINE_MEMORY((void *)start, end - start);
+        zero_memory(arena, (void *)start, end - start);
+        ARENA_POISON_MEMORY((void *)start, end - start);
+    }
+    mark_arena_zeroed(arena);
+}
+
+/*
+ * Reset the arena and set its tail to zero
+ * clears the arens`s blocks and reserts it ti the initial state with zeroing all the memory
+ */
+void arena_reset_zero(Arena *arena) {
+    if (!arena) return;
+    arena_reset(arena); // Reset arena
+
+    clear_tail(arena); // Set tail to zero
+
+    #ifndef ARENA_NO_MALLOC
+    if (arena_get_has_chunk(arena)) {
+        for (Arena *chunk = arena_get_chunk(arena)->next; chunk != NULL; chunk = arena_get_chunk(chunk)->next) {
+            clear_tail(chunk); // Set tails of retained chunks to zero
+        }
+    }
+    #endif
+}
+
+#ifdef ARENA_THREAD_SAFE
+/*
+ * Flush the thread cache for arena
+ * Returns the blocks of the arena parked in the cache of the calling thread back to the arena.
+ * POSIX threads flush their whole cache when they exit. Elsewhere, call it from worker threads before they exit,
+ *  so their cached blocks are not kept until the next reset.
+ */
+void arena_thread_cache_flush(Arena *arena) {
+    if (!arena) return;
+
+    flush_thread_cache(arena);
+}
+#endif // ARENA_THREAD_SAFE
+
+/*
+ * Carve nested arena
+ * Allocates a block of 'size' bytes from the parent arena and initializes a nested arena over it,
+ *  with a chunk descriptor for nested growable arenas and their chunks
+ * Returns NULL if the parent cannot fit the block or the block is too small for the arena
+ */
+static Arena *carve_nested_arena(Arena *parent_arena, size_t size, size_t alignment, bool has_chunk) {
+    ARENA_ASSERT((parent_arena != NULL) && "Internal Error: 'carve_nested_arena' called on NULL parent");
+
+    void *data = arena_alloc(parent_arena, size);  // Allocate memory from the parent arena
+    if (!data) return NULL;
+
+    Block *block = decode_block(data);
+
+    // The block owner may be a chunk of a growable parent, remember it before the header overwrites it
+    Arena *owner = get_arena(block);
+
+    // A block of the free tree may be bigger than asked for, the arena takes all of it so the size
+    //  the parent walks by stays the size of the block
+    Arena *arena = arena_init((void *)block, get_size(block), alignment, has_chunk, false, owner);
+    if (!arena) {
+        arena_free_block(data); // Block is too small for the header and the reserve of a nested arena
+        return NULL;
+    }
+
+    return arena;
+}
+
+/*
+ * Create a nested arena with custom alignment
+ * Allocates memory for a nested arena from a parent arena and initializes it
+ * Returns NULL if the parent arena is NULL, requested size is too small, or allocation fails
+ */
+Arena *arena_new_nested_custom(Arena *parent_arena, size_t size, size_t alignment) {
+    if (!parent_arena || size < BLOCK_MIN_SIZE || size > SIZE_MASK) return NULL;
+    if ((alignment & (alignment - 1)) != 0) return NULL;
+    if (alignment < MIN_ALIGNMENT|| alignment > MAX_ALIGNMENT) return NULL;
+
+    return carve_nested_arena(parent_arena, size, alignment, false);
+}
+
+/*
+ * Create a nested arena with alignment of parent arena
+ * Allocates memory for a nested arena from a parent arena and initializes it
+ * Returns NULL if the parent arena is NULL, requested size is too small, or allocation fails
+ */
+Arena *arena_new_nested(Arena *parent_arena, size_t size) {
+    if (!parent_arena || size < BLOCK_MIN_SIZE || size > SIZE_MASK) return NULL;
+
+    return arena_new_nested_custom(parent_arena, size, arena_get_alignment(parent_arena));
+}
+
+#ifndef ARENA_NO_MALLOC
+/*
+ * Create a nested growable arena
+ * Carves the first chunk of 'size' bytes from the parent arena. When it runs out of space, new chunks are carved
+ *  from the parent according to the growth policy, and 'arena_free' gives every chunk back in O(chunks).
+ * NULL policy selects the default one (ARENA_GROWTH_FACTOR, unbounded chunks, no chunk retained across resets),
+ *  so an idle arena holds only its first chunk after 'arena_reset'.
+ * Returns NULL if the parent arena is NULL, the size is too small, the policy is invalid or allocation fails
+ */
+Arena *arena_new_nested_growable_custom(Arena *parent_arena, size_t size, size_t alignment, const ArenaGrowthPolicy *policy) {
+    if (!parent_arena || size < BLOCK_MIN_SIZE || size > SIZE_MASK) return NULL;
+    if ((alignment & (alignment - 1)) != 0) return NULL;
+    if (alignment < MIN_ALIGNMENT|| alignment > MAX_ALIGNMENT) return NULL;
+    if (policy && policy->growth_factor == 0) return NULL;
+
+    Arena *arena = carve_nested_arena(parent_arena, size, alignment, true);
+    if (!arena) return NULL;
+
+    init_chain(arena, size, policy, 0);
+    arena_get_chunk(arena)->parent = parent_arena;
+
+    return arena;
+}
+
+/*
+ * Create a nested growable arena with alignment of parent arena and default growth policy
+ * Returns NULL if the parent arena is NULL, the size is too small or allocation fails
+ */
+Arena *arena_new_nested_growable(Arena *parent_arena, size_t size) {
+    if (!parent_arena || size < BLOCK_MIN_SIZE || size > SIZE_MASK) return NULL;
+
+    return arena_new_nested_growable_custom(parent_arena, size, arena_get_alignment(parent_arena), NULL);
+}
+#endif // ARENA_NO_MALLOC
+
+/*
+ * Check bump alignment
+ * Bump regions have no headers, so any power of two up to MAX_ALIGNMENT is fine, even below MIN_ALIGNMENT
+ */
+static inline bool is_valid_bump_alignment(size_t alignment) {
+    return alignment != 0 && (alignment & (alignment - 1)) == 0 && alignment <= MAX_ALIGNMENT;
+}
+
+/*
+ * Initialize bump region
+ * Places the region header at the start of the given memory, the rest is handed out by the cursor
+ * Returns NULL if the memory is NULL, too small for the header or the alignment is invalid
+ */
+static ArenaBump *bump_init(void *memory, size_t size, size_t alignment, Arena *parent) {
+    if (!memory || !is_valid_bump_alignment(alignment)) return NULL;
+
+    uintptr_t raw_addr = (uintptr_t)memory;
+    uintptr_t aligned_addr = align_up(raw_addr, MIN_ALIGNMENT);
+    if (size < aligned_addr - raw_addr + sizeof(ArenaBump)) return NULL;
+
+    ArenaBump *bump = (ArenaBump *)aligned_addr;
+    bump->end = raw_addr + size;
+    bump->alignment = alignment;
+    bump->parent = parent;
+    arena_bump_reset(bump);
+
+    return bump;
+}
+
+/*
+ * Create a bump region with custom alignment
+ * Carves one block of 'size' usable bytes from the parent arena, the only header the region ever pays for
+ * Returns NULL if the parent arena is NULL, size is zero, alignment is invalid, or allocation fails
+ */
+ArenaBump *arena_bump_new_custom(Arena *parent_arena, size_t size, size_t alignment) {
+    if (!parent_arena || size == 0 || size > SIZE_MASK - sizeof(ArenaBump)) return NULL;
+    if (!is_valid_bump_alignment(alignment)) return NULL;
+
+    void *data = arena_alloc(parent_arena, sizeof(ArenaBump) + size);
+    if (!data) return NULL;
+
+    return bump_init(data, sizeof(ArenaBump) + size, alignment, parent_arena);
+}
+
+/*
+ * Create a bump region with alignment of parent arena
+ * Returns NULL if the parent arena is NULL, size is zero, or allocation fails
+ */
+ArenaBump *arena_bump_new(Arena *parent_arena, size_t size) {
+    if (!parent_arena) return NULL;
+
+    return arena_bump_new_custom(parent_arena, size, arena_get_alignment(parent_arena));
+}
+
+/*
+ * Create a static bump region with custom alignment
+ * Uses preallocated memory, the region header is taken from its start
+ * Returns NULL if the memory is NULL, too small for the header or the alignment is invalid
+ */
+ArenaBump *arena_bump_new_static_custom(void *memory, size_t size, size_t alignment) {
+    return bump_init(memory, size, alignment, NULL);
+}
+
+/*
+ * Create a static bump region with default alignment
+ * Returns NULL if the memory is NULL or too small for the header
+ */
+ArenaBump *arena_bump_new_static(void *memory, size_t size) {
+    return arena_bump_new_static_custom(memory, size, ARENA_DEFAULT_ALIGNMENT);
+}
+
+/*
+ * Allocate memory in the bump region with custom alignment
+ * Aligns the cursor and moves it past the allocation, no header is written
+ * Returns NULL if there is not enough space or the alignment is invalid
+ */
+void *arena_bump_alloc_custom(ArenaBump *bump, size_t size, size_t alignment) {
+    if (!bump || size == 0 || !is_valid_bump_alignment(alignment)) return NULL;
+
+    uintptr_t ptr = align_up(bump->cursor, alignment);
+    if (ptr < bump->cursor || ptr > bump->end || bump->end - ptr < size) return NULL;
+
+    bump->cursor = ptr + size;
+    return (void *)ptr;
+}
+
+/*
+ * Allocate memory in the bump region with its alignment
+ * Returns NULL if there is not enough space
+ */
+void *arena_bump_alloc(ArenaBump *bump, size_t size) {
+    if (!bump) return NULL;
+    return arena_bump_alloc_custom(bump, size, bump->alignment);
+}
+
+/*
+ * Reset the bump region
+ * Releases every allocation of the region at once in O(1)
+ */
+void arena_bump_reset(ArenaBump *bump) {
+    if (!bump) return;
+
+    bump->cursor = (uintptr_t)bump + sizeof(ArenaBump);
+}
+
+/*
+ * Free the bump region
+ * Returns the region to the arena it was carved from
+ * Can be safely called with static regions (no operation in that case)
+ */
+void arena_bump_free(ArenaBump *bump) {
+    if (!bump || !bump->parent) return;
+
+    arena_free_block(bump); // The header sits at the data pointer of the parent block
+}
+
+#ifdef ARENA_THREAD_SAFE
+/*
+ * Reserved range of shared bump region
+ * Part of a shared bump region the current thread carves its allocations from without synchronization
+ * The generation ties the range to the region contents it was reserved from, so ranges outliving a reset are dropped
+ */
+typedef struct ArenaBumpRange {
+    const ArenaSharedBump *bump;    // Region of the range, only compared and never dereferenced through the range
+    uintptr_t generation;           // Generation of the region at the time the range was reserved
+    uintptr_t cursor;               // Next free byte of the range
+    uintptr_t end;                  // One past the last byte of the range
+} ArenaBumpRange;
+
+static ARENA_THREAD_LOCAL ArenaBumpRange arena_bump_ranges[ARENA_SHARED_BUMP_SLOTS];
+static ARENA_THREAD_LOCAL size_t arena_bump_range_victim = 0;
+
+/*
+ * Initialize shared bump region
+ * Places the region header at the start of the given memory, the rest is reserved by the threads
+ * Returns NULL if the memory is NULL, too small for the header or the alignment is invalid
+ */
+static ArenaSharedBump *shared_bump_init(void *memory, size_t size, size_t alignment, size_t reserve, Arena *parent) {
+    if (!memory || !is_valid_bump_alignment(alignment)) return NULL;
+    if (reserve == 0) reserve = ARENA_SHARED_BUMP_RESERVE;
+    if (reserve > SIZE_MASK) return NULL;
+
+    uintptr_t raw_addr = (uintptr_t)memory;
+    uintptr_t aligned_addr = align_up(raw_addr, MIN_ALIGNMENT);
+    if (size < aligned_addr - raw_addr + sizeof(ArenaSharedBump)) return NULL;
+
+    ArenaSharedBump *bump = (ArenaSharedBump *)aligned_addr;
+    bump->start = aligned_addr + sizeof(ArenaSharedBump);
+    bump->end = raw_addr + size;
+    bump->alignment = alignment;
+    bump->reserve = align_up(reserve, MIN_ALIGNMENT); // Ranges keep the cursor word aligned
+    bump->parent = parent;
+    arena_shared_bump_reset(bump);
+
+    return bump;
+}
+
+/*
+ * Create a shared bump region with custom alignment and reservation size
+ * Carves one block of 'size' usable bytes from the parent arena. 'reserve' is the number of bytes a thread
+ *  takes from the region at once, zero selects ARENA_SHARED_BUMP_RESERVE
+ * Returns NULL if the parent arena is NULL, size is zero, alignment is invalid, or allocation fails
+ */
+ArenaSharedBump *arena_shared_bump_new_custom(Arena *parent_arena, size_t size, size_t alignment, size_t reserve) {
+    if (!parent_arena || size == 0 || size > SIZE_MASK - sizeof(ArenaSharedBump)) return NULL;
+    if (!is_valid_bump_alignment(alignment) || reserve > SIZE_MASK) return NULL;
+
+    void *data = arena_alloc(parent_arena, sizeof(ArenaSharedBump) + size);
+    if (!data) return NULL;
+
+    return shared_bump_init(data, sizeof(ArenaSharedBump) + size, alignment, reserve, parent_arena);
+}
+
+/*
+ * Create a shared bump region with alignment of parent arena and default reservation size
+ * Returns NULL if the parent arena is NULL, size is zero, or allocation fails
+ */
+ArenaSharedBump *arena_shared_bump_new(Arena *parent_arena, size_t size) {
+    if (!parent_arena) return NULL;
+
+    return arena_shared_bump_new_custom(parent_arena, size, arena_get_alignment(parent_arena), 0);
+}
+
+/*
+ * Create a static shared bump region with custom alignment and reservation size
+ * Uses preallocated memory, the region header is taken from its start
+ * Returns NULL if the memory is NULL, too small for the header or the alignment is invalid
+ */
+ArenaSharedBump *arena_shared_bump_new_static_custom(void *memory, size_t size, size_t alignment, size_t reserve) {
+    return shared_bump_init(memory, size, alignment, reserve, NULL);
+}
+
+/*
+ * Create a static shared bump region with default alignment and reservation size
+ * Returns NULL if the memory is NULL or too small for the header
+ */
+ArenaSharedBump *arena_shared_bump_new_static(void *memory, size_t size) {
+    return arena_shared_bump_new_static_custom(memory, size, ARENA_DEFAULT_ALIGNMENT, 0);
+}
+
+/*
+ * Get reserved range of shared bump region
+ * Returns the range the current thread holds in the region, an empty one if it holds none yet
+ * Ranges of other regions are replaced in turn, the rest of a replaced range stays unused until the next reset
+ */
+static inline ArenaBumpRange *get_bump_range(const ArenaSharedBump *bump) {
+    ARENA_ASSERT((bump != NULL) && "Internal Error: 'get_bump_range' called on NULL bump");
+
+    uintptr_t generation = bump->generation;
+    for (size_t i = 0; i < ARENA_SHARED_BUMP_SLOTS; i++) {
+        if (arena_bump_ranges[i].bump == bump && arena_bump_ranges[i].generation == generation) return &arena_bump_ranges[i];
+    }
+
+    ArenaBumpRange *range = &arena_bump_ranges[arena_bump_range_victim];
+    arena_bump_range_victim = (arena_bump_range_victim + 1) % ARENA_SHARED_BUMP_SLOTS;
+
+    range->bump = bump;
+    range->generation = generation;
+    range->cursor = 0;
+    range->end = 0;
+    return range;
+}
+
+/*
+ * Reserve range of shared bump region
+ * Advances the shared cursor by 'length' bytes with a single fetch-add
+ * Returns the start of the reserved range, 0 if the region is exhausted. The range may end past the region
+ */
+static inline uintptr_t reserve_bump_range(ArenaSharedBump *bump, size_t length) {
+    ARENA_ASSERT((bump != NULL) && "Internal Error: 'reserve_bump_range' called on NULL bump");
+
+    volatile uintptr_t *cursor = (volatile uintptr_t *)&bump->cursor;
+
+    // Exhausted regions are not advanced any further, so failing allocations never wrap the cursor around
+    if ((uintptr_t)arena_atomic_load_ptr((void *const volatile *)cursor) >= bump->end) return 0;
+
+    uintptr_t start = arena_atomic_fetch_add(cursor, length);
+    return start < bump->end ? start : 0;
+}
+
+/*
+ * Allocate memory in the shared bump region with custom alignment
+ * Carves the allocation from the range of the current thread, reserving a new range when it runs out.
+ *  Requests bigger than half a range reserve a range of their own, so the current range stays in use
+ * Safe to call from any number of threads at once, no header is written
+ * Returns NULL if there is not enough space or the alignment is invalid
+ */
+void *arena_shared_bump_alloc_custom(ArenaSharedBump *bump, size_t size, size_t alignment) {
+    if (!bump || size == 0 || size > SIZE_MASK || !is_valid_bump_alignment(alignment)) return NULL;
+
+    ArenaBumpRange *range = get_bump_range(bump);
+    uintptr_t ptr = align_up(range->cursor, alignment);
+    if (ptr >= range->cursor && ptr <= range->end && range->end - ptr >= size) {
+        range->cursor = ptr + size;
+        return (void *)ptr;
     }
-    return ptr;
+
+    // Ranges start word aligned, bigger alignments need room to align the allocation inside the range
+    size_t needed = align_up(size, MIN_ALIGNMENT) + (alignment > MIN_ALIGNMENT ? alignment - MIN_ALIGNMENT : 0);
+    if (needed > bump->reserve / 2) {
+        uintptr_t start = reserve_bump_range(bump, needed);
+        if (!start || bump->end - start < needed) return NULL;
+        return (void *)align_up(start, alignment);
+    }
+
+    uintptr_t start = reserve_bump_range(bump, bump->reserve);
+    if (!start) return NULL;
+
+    // The last range of the region may be shorter than the others
+    range->end = bump->end - start < bump->reserve ? bump->end : start + bump->reserve;
+    range->cursor = start;
+
+    ptr = align_up(start, alignment);
+    if (ptr > range->end || range->end - ptr < size) return NULL;
+
+    range->cursor = ptr + size;
+    return (void *)ptr;
+}
+
+/*
+ * Allocate memory in the shared bump region with its alignment
+ * Returns NULL if there is not enough space
+ */
+void *arena_shared_bump_alloc(ArenaSharedBump *bump, size_t size) {
+    if (!bump) return NULL;
+    return arena_shared_bump_alloc_custom(bump, size, bump->alignment);
+}
+
+/*
+ * Reset the shared bump region
+ * Releases every allocation of the region at once in O(1) and drops the ranges threads reserved in it
+ * Call it between batches, while no thread allocates from the region
+ */
+void arena_shared_bump_reset(ArenaSharedBump *bump) {
+    if (!bump) return;
+
+    bump->cursor = bump->start;
+    bump->generation = arena_atomic_next_generation();
+}
+
+/*
+ * Free the shared bump region
+ * Returns the region to the arena it was carved from, the ranges threads still hold in it are dropped
+ * Can be safely called with static regions (no operation in that case)
+ */
+void arena_shared_bump_free(ArenaSharedBump *bump) {
+    if (!bump || !bump->parent) return;
+
+    arena_free_block(bump); // The header sits at the data pointer of the parent block
+}
+#endif // ARENA_THREAD_SAFE
+
+/*
+ * Object pool slab structure
+ * Header at the start of every slab, the slots follow it up to the end of the slab
+ */
+struct ArenaPoolSlab {
+    ArenaPoolSlab *prev;        // Previous slab in the list of the pool
+    ArenaPoolSlab *next;        // Next slab in the list of the pool
+    ArenaPool *pool;            // Pool the slab belongs to
+    void *free_slots;           // Released slots, linked through their first word
+    uintptr_t cursor;           // Slots from here on were never handed out
+    size_t used;                // Number of slots handed out
+};
+
+/*
+ * Slab data size
+ * Slabs take the alignment of the slab size and leave room for the parent block header at their end,
+ *  so slabs carved one after another from the parent tail follow each other without padding
+ */
+#define ARENA_POOL_SLAB_DATA (ARENA_POOL_SLAB_SIZE - sizeof(Block))
+
+/*
+ * Link slab into list
+ * Pushes the slab at the head of a doubly linked slab list of the pool
+ */
+static inline void pool_link_slab(ArenaPoolSlab **list, ArenaPoolSlab *slab) {
+    ARENA_ASSERT((list != NULL) && "Internal Error: 'pool_link_slab' called on NULL list");
+    ARENA_ASSERT((slab != NULL) && "Internal Error: 'pool_link_slab' called on NULL slab");
+
+    slab->prev = NULL;
+    slab->next = *list;
+    if (*list) (*list)->prev = slab;
+    *list = slab;
+}
+
+/*
+ * Unlink slab from list
+ * Removes the slab from the doubly linked slab list it is in
+ */
+static inline void pool_unlink_slab(ArenaPoolSlab **list, ArenaPoolSlab *slab) {
+    ARENA_ASSERT((list != NULL) && "Internal Error: 'pool_unlink_slab' called on NULL list");
+    ARENA_ASSERT((slab != NULL) && "Internal Error: 'pool_unlink_slab' called on NULL slab");
+
+    if (slab->prev) slab->prev->next = slab->next;
+    else *list = slab->next;
+    if (slab->next) slab->next->prev = slab->prev;
+}
+
+/*
+ * Create slab of pool
+ * Carves a new slab from the parent arena and puts it at the head of the available slabs
+ * Returns NULL if the parent has no room for it
+ */
+static ArenaPoolSlab *pool_new_slab(ArenaPool *pool) {
+    ARENA_ASSERT((pool != NULL) && "Internal Error: 'pool_new_slab' called on NULL pool");
+
+    ArenaPoolSlab *slab = (ArenaPoolSlab *)arena_alloc_custom(pool->parent, ARENA_POOL_SLAB_DATA, ARENA_POOL_SLAB_SIZE);
+    if (!slab) return NULL;
+
+    slab->pool = pool;
+    slab->free_slots = NULL;
+    slab->cursor = (uintptr_t)slab + pool->slot_offset;
+    slab->used = 0;
+    pool_link_slab(&pool->available, slab);
+
+    return slab;
+}
+
+/*
+ * Release slab list
+ * Gives every slab of a list back to the parent arena
+ */
+static void pool_release_slabs(ArenaPoolSlab *slab) {
+    while (slab) {
+        ArenaPoolSlab *next = slab->next;
+        arena_free_block(slab);
+        slab = next;
+    }
+}
+
+/*
+ * Create an object pool with custom alignment
+ * The pool header is carved from the parent arena, slabs follow on demand
+ * Returns NULL if the parent arena is NULL, the alignment is invalid, a slab cannot hold one slot, or allocation fails
+ */
+ArenaPool *arena_pool_new_custom(Arena *parent_arena, size_t slot_size, size_t alignment) {
+    if (!parent_arena || slot_size == 0 || slot_size > ARENA_POOL_SLAB_DATA) return NULL;
+    if ((alignment & (alignment - 1)) != 0 || alignment == 0 || alignment > ARENA_POOL_SLAB_SIZE) return NULL;
+
+    // Free slots hold the link of the free list in their first word
+    if (alignment < MIN_ALIGNMENT) alignment = MIN_ALIGNMENT;
+    slot_size = align_up(slot_size, alignment);
+
+    size_t slot_offset = align_up(sizeof(ArenaPoolSlab), alignment);
+    if (slot_offset + slot_size > ARENA_POOL_SLAB_DATA) return NULL;
+
+    ArenaPool *pool = (ArenaPool *)arena_alloc(parent_arena, sizeof(ArenaPool));
+    if (!pool) return NULL;
+
+    pool->parent = parent_arena;
+    pool->slot_size = slot_size;
+    pool->slot_offset = slot_offset;
+    pool->slots_per_slab = (ARENA_POOL_SLAB_DATA - slot_offset) / slot_size;
+    pool->available = NULL;
+    pool->full = NULL;
+    pool->spare = NULL;
+
+    return pool;
+}
+
+/*
+ * Create an object pool with alignment of parent arena
+ * Returns NULL if the parent arena is NULL, a slab cannot hold one slot, or allocation fails
+ */
+ArenaPool *arena_pool_new(Arena *parent_arena, size_t slot_size) {
+    if (!parent_arena) return NULL;
+
+    // Objects never need more alignment than the largest power of two dividing their size, so slots pack tighter
+    size_t alignment = arena_get_alignment(parent_arena);
+    size_t natural = slot_size & (~slot_size + 1);
+    if (natural < alignment) alignment = natural;
+
+    return arena_pool_new_custom(parent_arena, slot_size, alignment);
+}
+
+/*
+ * Allocate slot from pool
+ * Takes a released slot of the first available slab, or the next never used one, in O(1)
+ * Returns NULL if the pool is NULL or the parent arena has no room for a new slab
+ */
+void *arena_pool_alloc(ArenaPool *pool) {
+    if (!pool) return NULL;
+
+    ArenaPoolSlab *slab = pool->available;
+    if (!slab) {
+        slab = pool_new_slab(pool);
+        if (!slab) return NULL;
+    }
+    if (slab == pool->spare) pool->spare = NULL;
+
+    void *slot = slab->free_slots;
+    if (slot) {
+        slab->free_slots = *(void **)slot;
+    }
+    else {
+        slot = (void *)slab->cursor;
+        slab->cursor += pool->slot_size;
+    }
+
+    // A slab without free slots leaves the available list until one comes back
+    if (++slab->used == pool->slots_per_slab) {
+        pool_unlink_slab(&pool->available, slab);
+        pool_link_slab(&pool->full, slab);
+    }
+
+    return slot;
+}
+
+/*
+ * Release slot to pool
+ * Puts the slot back on the free list of its slab in O(1). An empty slab goes back to the parent arena,
+ *  except for one spare kept so that a pool alternating between zero and one object does not churn slabs
+ * Slots of other pools are ignored
+ */
+void arena_pool_release(ArenaPool *pool, void *slot) {
+    if (!pool || !slot) return;
+
+    ArenaPoolSlab *slab = (ArenaPoolSlab *)((uintptr_t)slot & ~(uintptr_t)(ARENA_POOL_SLAB_SIZE - 1));
+    if (slab->pool != pool || (uintptr_t)slot < (uintptr_t)slab + pool->slot_offset) return;
+
+    if (slab->used-- == pool->slots_per_slab) {
+        pool_unlink_slab(&pool->full, slab);
+        pool_link_slab(&pool->available, slab);
+    }
+
+    *(void **)slot = slab->free_slots;
+    slab->free_slots = slot;
+
+    if (slab->used == 0) {
+        if (!pool->spare) {
+            pool->spare = slab;
+        }
+        else {
+            pool_unlink_slab(&pool->available, slab);
+            arena_free_block(slab);
+        }
+    }
+}
+
+/*
+ * Reset the pool
+ * Releases every slot at once and gives all slabs back to the parent arena
+ */
+void arena_pool_reset(ArenaPool *pool) {
+    if (!pool) return;
+
+    pool_release_slabs(pool->available);
+    pool_release_slabs(pool->full);
+    pool->available = NULL;
+    pool->full = NULL;
+    pool->spare = NULL;
+}
+
+/*
+ * Free the pool
+ * Gives all slabs and the pool header back to the parent arena
+ */
+void arena_pool_free(ArenaPool *pool) {
+    if (!pool) return;
+
+    arena_pool_reset(pool);
+    arena_free_block(pool);
+}
+
+/*
+ * Get alignment padding of block
+ * Returns the distance between the block data and the pointer handed out for it
+ * Parked blocks and nested arenas have no valid magic, the back link check rejects them
+ */
+static inline size_t block_padding(const Arena *arena, const Block *block) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'block_padding' called on NULL arena");
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'block_padding' called on NULL block");
+
+    uintptr_t start = (uintptr_t)block_data(block);
+    uintptr_t data = get_magic(block) ^ arena_get_key(arena);
+
+    if (data <= start || data >= start + get_size(block) || (data % sizeof(uintptr_t)) != 0) return 0;
+
+    // Padded allocations keep the block pointer XORed with the data right in front of it
+    uintptr_t *spot_before_user_data = (uintptr_t *)(data - sizeof(uintptr_t));
+    if ((*spot_before_user_data ^ data) != (uintptr_t)block) return 0;
+
+    return data - start;
+}
+
+/*
+ * Collect statistics of single arena
+ * Walks the blocks of the arena itself and adds them (and its counters) to 'stats'
+ * In thread-safe mode the caller must hold the arena lock
+ */
+static void collect_arena_stats(Arena *arena, ArenaStats *stats) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'collect_arena_stats' called on NULL arena");
+    ARENA_ASSERT((stats != NULL) && "Internal Error: 'collect_arena_stats' called on NULL stats");
+
+    Block *tail = arena_get_tail(arena);
+
+    stats->capacity += arena_get_capacity(arena);
+    stats->tail_free += free_size_in_tail(arena);
+
+    for (Block *block = arena_get_first_block(arena); block != NULL; block = next_block(arena, block)) {
+        size_t size = get_size(block);
+
+        if (!get_is_free(block)) {
+            stats->bytes_in_use += sizeof(Block) + size;
+            stats->occupied_blocks++;
+            stats->padding_bytes += block_padding(arena, block);
+        }
+        else if (block != tail) {
+            stats->free_bytes += size;
+            stats->free_blocks++;
+            if (size > stats->largest_free_block) stats->largest_free_block = size;
+        }
+    }
+
+    #ifdef ARENA_STATS
+    const ArenaCounters *counters = &arena_get_ext(arena)->counters;
+    stats->peak_in_use += counters->peak_in_use;
+    stats->tail_allocs += counters->tail_allocs;
+    stats->tree_allocs += counters->tree_allocs;
+    stats->tail_frees  += counters->tail_frees;
+    stats->tree_frees  += counters->tree_frees;
+    stats->merges      += counters->merges;
+    #endif
+}
+
+/*
+ * Get statistics of the arena
+ * Fills 'stats' with a snapshot of the memory usage of the arena, of all chunks for growable arenas
+ * Walks every block, so it takes O(number of blocks) under the arena lock
+ * Blocks parked in size class bins or thread caches still count as occupied
+ */
+void arena_get_stats(Arena *arena, ArenaStats *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(ArenaStats));
+    if (!arena) return;
+
+    #ifdef ARENA_THREAD_SAFE
+    ArenaChunk *head_chunk = arena_get_has_chunk(arena) ? arena_get_chunk(arena) : NULL;
+    if (head_chunk) arena_spin_lock(&head_chunk->chain_lock);
+    #endif
+
+    for (Arena *chunk = arena; chunk != NULL; chunk = arena_get_has_chunk(chunk) ? arena_get_chunk(chunk)->next : NULL) {
+        lock_arena(chunk);
+        collect_arena_stats(chunk, stats);
+        unlock_arena(chunk);
+    }
+
+    #ifdef ARENA_THREAD_SAFE
+    if (head_chunk) arena_spin_unlock(&head_chunk->chain_lock);
+    #endif
+}
+
+/*
+ * Coalesce arena
+ * Merges every block parked for quick reuse (ARENA_DEFERRED_COALESCING) or in size class bins (ARENA_SIZE_CLASSES)
+ *  with its free neighbours in one linear pass per arena, and rebuilds the free index from the merged runs
+ * Growable arenas sweep every chunk, thread-safe arenas also take back the blocks cached by the calling thread
+ */
+void arena_coalesce(Arena *arena) {
+    if (!arena) return;
+
+    #ifdef ARENA_THREAD_SAFE
+    flush_thread_cache(arena);
+
+    ArenaChunk *head_chunk = arena_get_has_chunk(arena) ? arena_get_chunk(arena) : NULL;
+    if (head_chunk) arena_spin_lock(&head_chunk->chain_lock);
+    #endif
+
+    for (Arena *chunk = arena; chunk != NULL; chunk = arena_get_has_chunk(chunk) ? arena_get_chunk(chunk)->next : NULL) {
+        lock_arena(chunk);
+        #ifdef ARENA_THREAD_SAFE
+        drain_remote_frees(chunk);
+        #endif
+        coalesce_arena(chunk);
+        unlock_arena(chunk);
+    }
+
+    #ifdef ARENA_THREAD_SAFE
+    if (head_chunk) arena_spin_unlock(&head_chunk->chain_lock);
+    #endif
+}
+
+#ifdef ARENA_PURGE
+/*
+ * Purge the arena
+ * Gives the whole pages inside the tail and inside every free block of at least 'min_bytes' bytes back to the OS,
+ *  with MADV_DONTNEED, or MADV_FREE for mapped arenas created with ARENA_MMAP_LAZY_RELEASE. Block headers stay
+ *  resident, the purged pages fault back in as zero (or with their old contents, if the OS did not take them yet)
+ * Blocks parked in size class bins, deferred lists or thread caches are not free yet, 'arena_coalesce' releases them
+ * Growable arenas purge every chunk. Returns the number of bytes given back
+ */
+size_t arena_purge(Arena *arena, size_t min_bytes) {
+    if (!arena) return 0;
+
+    #ifdef ARENA_THREAD_SAFE
+    ArenaChunk *head_chunk = arena_get_has_chunk(arena) ? arena_get_chunk(arena) : NULL;
+    if (head_chunk) arena_spin_lock(&head_chunk->chain_lock);
+    #endif
+
+    size_t purged = 0;
+    for (Arena *chunk = arena; chunk != NULL; chunk = arena_get_has_chunk(chunk) ? arena_get_chunk(chunk)->next : NULL) {
+        lock_arena(chunk);
+        #ifdef ARENA_THREAD_SAFE
+        drain_remote_frees(chunk);
+        #endif
+        purged += purge_arena(chunk, min_bytes);
+        unlock_arena(chunk);
+    }
+
+    #ifdef ARENA_THREAD_SAFE
+    if (head_chunk) arena_spin_unlock(&head_chunk->chain_lock);
+    #endif
+
+    return purged;
 }
 
 /*
- * Create a static arena
- * Initializes an arena using preallocated memory and sets up the first block
- * Returns NULL if the provided size is too small, memory is NULL or size is negative
+ * Purge the arena if decayed
+ * Purges the chunks whose freed memory stayed resident for their decay time, for a timer or a background thread
+ *  to call when the arena sees too few frees to purge itself. Returns the number of bytes given back
  */
-Arena *arena_new_static_custom(void *memory, size_t size, size_t alignment) {
-    if (!memory || size < ARENA_MIN_SIZE || size > SIZE_MASK) return NULL;
-    if ((alignment & (alignment - 1)) != 0) return NULL;
-    if (alignment < MIN_ALIGNMENT|| alignment > MAX_ALIGNMENT) return NULL;
+size_t arena_purge_decayed(Arena *arena) {
+    if (!arena) return 0;
 
-    uintptr_t raw_addr = (uintptr_t)memory;
-    uintptr_t aligned_addr = align_up(raw_addr, MIN_ALIGNMENT);
-    size_t arena_padding = aligned_addr - raw_addr; 
+    #ifdef ARENA_THREAD_SAFE
+    ArenaChunk *head_chunk = arena_get_has_chunk(arena) ? arena_get_chunk(arena) : NULL;
+    if (head_chunk) arena_spin_lock(&head_chunk->chain_lock);
+    #endif
 
-    if (size < arena_padding + sizeof(Arena) + BLOCK_MIN_SIZE) return NULL;
-    
-    Arena *arena = (Arena *)aligned_addr;
+    uint64_t now = purge_clock_ms();
+    size_t purged = 0;
+    for (Arena *chunk = arena; chunk != NULL; chunk = arena_get_has_chunk(chunk) ? arena_get_chunk(chunk)->next : NULL) {
+        lock_arena(chunk);
+        purged += purge_if_decayed(chunk, now);
+        unlock_arena(chunk);
+    }
 
-    /*
-     * Magic LSB Padding Detector
-     *
-     *What is this for?
-     * One of the core goals of Arena_c is Zero-Cost Parent Tracking. We need to find 
-     * the 'Arena' header starting from a 'Block' pointer (especially the first block) 
-     * without storing an explicit 8-byte 'parent' pointer in every single block.
-     *
-     * In a nested or static arena, there is often a gap (padding) between the 
-     * end of the 'Arena' struct and the start of the first 'Block' due to 
-     * alignment requirements. Instead of wasting this space, we use it to store 
-     * a "back-link" offset to the Arena header.
-     *
-     * Why/How are we sure there is enough space?
-     * 1. Structural Invariants: Both 'Arena' and 'Block' structures are designed 
-     *    to be multiples of the machine word (sizeof(uintptr_t)).
-     * 2. Alignment Logic: Since 'alignment' is a power of two and is at least 
-     *    sizeof(uintptr_t), any gap created by 'align_up' will also be 
-     *    a multiple of the machine word.
-     * 3. The Condition: If 'aligned_block_start' is greater than the end of the 
-     *    Arena structure, the difference is guaranteed to be at least 4 bytes 
-     *    (on 32-bit) or 8 bytes (on 64-bit). This is exactly the space needed 
-     *    to store our tagged uintptr_t offset.
-     *
-     * The Detection Trick
-     * We store the offset shifted left by 1, with the Least Significant Bit (LSB) 
-     * set to 1 (e.g., (offset << 1) | 1). 
-     * Why? Because the last field of an 'Arena' struct is 'free_blocks' (a pointer). 
-     * Valid pointers are always word-aligned (even numbers). By checking the LSB, 
-     * we can instantly distinguish between:
-     *   - 0: We are looking at the 'free_blocks' pointer (Arena is immediately adjacent).
-     *   - 1: We are looking at our custom padding offset (Arena is 'offset' bytes away).
-    */
+    #ifdef ARENA_THREAD_SAFE
+    if (head_chunk) arena_spin_unlock(&head_chunk->chain_lock);
+    #endif
 
-    uintptr_t aligned_block_start = align_up(aligned_addr + sizeof(Block) + sizeof(Arena), alignment) - sizeof(Block);
-    Block *block = create_block((void *)(aligned_block_start));
+    return purged;
+}
 
-    if (aligned_block_start > (aligned_addr + sizeof(Arena))) {
-        uintptr_t offset = aligned_block_start - (uintptr_t)arena;
-        uintptr_t *detector_spot = (uintptr_t *)(aligned_block_start - sizeof(uintptr_t));
-        *detector_spot = (offset << 1) | 1;
-    }
+/*
+ * Set purge decay of the arena
+ * Sets the milliseconds freed memory may stay resident before frees purge it, 0 switches automatic purging off
+ * Applies to every chunk of a growable arena, chunks added later inherit it
+ */
+void arena_set_purge_decay(Arena *arena, size_t decay_ms) {
+    if (!arena) return;
 
-    arena_set_alignment(arena, alignment);
-    arena_set_capacity(arena, size - arena_padding);
-    arena_set_free_blocks(arena, NULL);
-    arena_set_tail(arena, block);
-    arena_set_is_dynamic(arena, false);
+    #ifdef ARENA_THREAD_SAFE
+    ArenaChunk *head_chunk = arena_get_has_chunk(arena) ? arena_get_chunk(arena) : NULL;
+    if (head_chunk) arena_spin_lock(&head_chunk->chain_lock);
+    #endif
 
-    return arena;
+    for (Arena *chunk = arena; chunk != NULL; chunk = arena_get_has_chunk(chunk) ? arena_get_chunk(chunk)->next : NULL) {
+        lock_arena(chunk);
+        arena_get_ext(chunk)->decay_ms = decay_ms;
+        arena_get_ext(chunk)->dirty_since = 0;
+        arena_get_ext(chunk)->purge_ticks = 0;
+        unlock_arena(chunk);
+    }
+
+    #ifdef ARENA_THREAD_SAFE
+    if (head_chunk) arena_spin_unlock(&head_chunk->chain_lock);
+    #endif
 }
+#endif // ARENA_PURGE
 
+#ifdef ARENA_PROFILING
 /*
- * Create a static arena with default alignment
- * Initializes an arena using preallocated memory with default alignment
- * Returns NULL if the provided size is too small, memory is NULL or size is negative
+ * Set profile rate
+ * Sets the average number of bytes allocated between two samples, 0 switches the profiler off
  */
-Arena *arena_new_static(void *memory, size_t size) {
-    return arena_new_static_custom(memory, size, ARENA_DEFAULT_ALIGNMENT);
+void arena_profile_set_rate(size_t rate) {
+    ARENA_STORE_TAGGED(arena_profile_rate, rate);
 }
 
-#ifndef ARENA_NO_MALLOC
 /*
- * Create a dynamic arena
- * Allocates memory for the arena and initializes it with the specified size and alignment
- * Returns NULL if the provided size is too small, memory allocation fails or size is negative
+ * Set profile tag
+ * Attaches a tag to the samples of the calling thread until another one is set, NULL for none
+ * The string is stored, not copied, so it must outlive the profile (string literals do)
  */
-Arena *arena_new_dynamic_custom(size_t size, size_t alignment) {
-    if (size < BLOCK_MIN_SIZE || size > SIZE_MASK) return NULL;
-    if ((alignment & (alignment - 1)) != 0) return NULL;
-    if (alignment < MIN_ALIGNMENT|| alignment > MAX_ALIGNMENT) return NULL;
+void arena_profile_set_tag(const char *tag) {
+    arena_profile_tag = tag;
+}
 
-    void *data = malloc(size + sizeof(Arena) + alignment);
-    if (!data) return NULL;
-    
-    Arena *arena = arena_new_static_custom(data, size + sizeof(Arena), alignment);
+/*
+ * Get profiled sites
+ * Copies up to 'max_sites' sites of the profile table to 'sites'
+ * Returns the number of sites recorded so far, which may exceed 'max_sites'
+ */
+size_t arena_profile_get_sites(ArenaProfileSite *sites, size_t max_sites) {
+    #ifdef ARENA_THREAD_SAFE
+    arena_spin_lock(&arena_profile_lock);
+    #endif
 
-    if (!arena) {
-        // LCOV_EXCL_START
-        free(data);
-        return NULL;
-        // LCOV_EXCL_STOP
+    size_t copied = 0;
+    for (size_t i = 0; i < ARENA_PROFILE_SITES && sites && copied < max_sites; i++) {
+        if (arena_profile_table[i].samples != 0) sites[copied++] = arena_profile_table[i];
     }
+    size_t count = arena_profile_site_count;
 
-    arena_set_is_dynamic(arena, true);
+    #ifdef ARENA_THREAD_SAFE
+    arena_spin_unlock(&arena_profile_lock);
+    #endif
 
-    return arena;
+    return count;
 }
 
 /*
- * Create a dynamic arena with default alignment
- * Allocates memory for the arena and initializes it with the specified size and default alignment
- * Returns NULL if the provided size is too small, memory allocation fails or size is negative
+ * Reset profile
+ * Drops every recorded sample, the sampling rate stays as it is
  */
-Arena *arena_new_dynamic(size_t size) {
-    return arena_new_dynamic_custom(size, ARENA_DEFAULT_ALIGNMENT);
+void arena_profile_reset(void) {
+    #ifdef ARENA_THREAD_SAFE
+    arena_spin_lock(&arena_profile_lock);
+    #endif
+
+    memset(arena_profile_table, 0, sizeof(arena_profile_table));
+    arena_profile_site_count = 0;
+    arena_profile_dropped = 0;
+
+    #ifdef ARENA_THREAD_SAFE
+    arena_spin_unlock(&arena_profile_lock);
+    #endif
 }
-#endif // ARENA_NO_MALLOC
+
+#define ARENA_SNAPSHOT_BUCKETS (sizeof(size_t) * 8)
 
 /*
- * Free arena
- * Deallocates the memory used by the arena if it was dynamically allocated
- * Can be safely called with static arenas (no operation in that case)
+ * Snapshot histogram
+ * Occupied and free blocks of one arena by power of two of their size
  */
-void arena_free(Arena *arena) {
-    if (!arena) return;
-
-    if (arena_get_is_nested(arena)) {
-        Arena *parent = get_parent_arena((Block *)arena);
-        arena_free_block_full(parent, (Block *)arena); 
-        return;
-    }
+typedef struct SnapshotHistogram {
+    size_t occupied[ARENA_SNAPSHOT_BUCKETS];
+    size_t occupied_bytes[ARENA_SNAPSHOT_BUCKETS];
+    size_t free[ARENA_SNAPSHOT_BUCKETS];
+    size_t free_bytes[ARENA_SNAPSHOT_BUCKETS];
+} SnapshotHistogram;
 
-    #ifndef ARENA_NO_MALLOC
-    if (arena_get_is_dynamic(arena)) {
-        free(arena);
-    }
-    #endif // ARENA_NO_MALLOC
+/*
+ * Get snapshot bucket
+ * Returns the floor of the binary logarithm of the size, 0 for sizes below two
+ */
+static inline size_t snapshot_bucket(size_t size) {
+    size_t bucket = 0;
+    while (size >>= 1) bucket++;
+    return bucket;
 }
 
 /*
- * Reset the arena
- * Clears the arena's blocks and resets it to the initial state without freeing memory
+ * Get nested arena of block
+ * Returns the nested arena an occupied block of 'arena' holds, or NULL if it holds user data
+ * The header of a nested arena overlays the block, its parent link points back to the arena
+ * Extra chunks of nested growable arenas are skipped, they are listed by nothing but their head
  */
-void arena_reset(Arena *arena) {
-    if (!arena) return;
+static inline Arena *snapshot_nested(Arena *arena, Block *block) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'snapshot_nested' called on NULL arena");
+    ARENA_ASSERT((block != NULL) && "Internal Error: 'snapshot_nested' called on NULL block");
 
-    Block *first_block = arena_get_first_block(arena);
+    /*
+     * Why is the is_nested flag a safe marker?
+     * The header word it is kept in holds the owner pointer of any other occupied block,
+     *  and arena pointers are word aligned, so the flag bit is never set for user data.
+     * The other flags share the word with the magic, which is odd for user blocks,
+     *  so 'has_chunk' may only be read once the block is known to be an arena.
+    */
 
-    // Reset first block
-    set_size(first_block, 0);
-    set_prev(first_block, NULL);
-    set_is_free(first_block, true);
-    set_color(first_block, RED);
-    set_left_tree(first_block, NULL);
-    set_right_tree(first_block, NULL);
+    Arena *nested = (Arena *)(void *)block;
+    if (get_is_free(block) || !arena_get_is_nested(nested)) return NULL;
+    if (*arena_get_parent_link(nested) != arena) return NULL;
 
-    // Reset arena metadata
-    arena_set_free_blocks(arena, NULL);
-    arena_set_tail(arena, first_block);
+    // Only the head of a chain has a growth policy, and growth factors are never zero
+    if (arena_get_has_chunk(nested) && arena_get_chunk(nested)->policy.growth_factor == 0) return NULL;
+
+    return nested;
 }
 
 /*
- * Reset the arena and set its tail to zero
- * clears the arens`s blocks and reserts it ti the initial state with zeroing all the memory
+ * Write JSON string
+ * Writes a quoted string with the characters JSON needs escaped, or null
  */
-void arena_reset_zero(Arena *arena) {
-    if (!arena) return;
-    arena_reset(arena); // Reset arena
-    memset(block_data(arena_get_tail(arena)), 0, free_size_in_tail(arena)); // Set tail to zero
+static void snapshot_string(FILE *out, const char *text) {
+    if (!text) {
+        fputs("null", out);
+        return;
+    }
+
+    fputc('"', out);
+    for (const unsigned char *c = (const unsigned char *)text; *c; c++) {
+        if (*c == '"' || *c == '\\') fprintf(out, "\\%c", *c);
+        else if (*c < 0x20) fprintf(out, "\\u%04x", *c);
+        else fputc(*c, out);
+    }
+    fputc('"', out);
 }
 
 /*
- * Create a nested arena with custom alignment
- * Allocates memory for a nested arena from a parent arena and initializes it
- * Returns NULL if the parent arena is NULL, requested size is too small, or allocation fails
+ * Write arena snapshot
+ * Writes one arena as a JSON object: its totals, a size histogram and the nested arenas it holds
+ * In thread-safe mode the caller must hold the arena lock
  */
-Arena *arena_new_nested_custom(Arena *parent_arena, size_t size, size_t alignment) {
-    if (!parent_arena || size < BLOCK_MIN_SIZE || size > SIZE_MASK) return NULL;
-    if ((alignment & (alignment - 1)) != 0) return NULL;
-    if (alignment < MIN_ALIGNMENT|| alignment > MAX_ALIGNMENT) return NULL;
-    
-    void *data = arena_alloc(parent_arena, size);  // Allocate memory from the parent arena
-    if (!data) return NULL;
+static void snapshot_arena(Arena *arena, FILE *out) {
+    ARENA_ASSERT((arena != NULL) && "Internal Error: 'snapshot_arena' called on NULL arena");
 
-    Block *block = NULL;
+    ArenaStats stats;
+    memset(&stats, 0, sizeof(stats));
+    collect_arena_stats(arena, &stats);
 
-    uintptr_t *spot_before_user_data = (uintptr_t *)((char *)data - sizeof(uintptr_t));
-    uintptr_t check = *spot_before_user_data ^ (uintptr_t)data;
-    if (check == (uintptr_t)0xDEADBEEF) {
-        block = (Block *)(void *)((char *)data - sizeof(Block));
-    }
-    // LCOV_EXCL_START
-    else {
-        block = (Block *)check;
+    SnapshotHistogram histogram;
+    memset(&histogram, 0, sizeof(histogram));
+    Block *tail = arena_get_tail(arena);
+    for (Block *block = arena_get_first_block(arena); block != NULL; block = next_block(arena, block)) {
+        size_t size = get_size(block);
+        size_t bucket = snapshot_bucket(size);
+        if (!get_is_free(block)) {
+            histogram.occupied[bucket]++;
+            histogram.occupied_bytes[bucket] += size;
+        }
+        else if (block != tail) {
+            histogram.free[bucket]++;
+            histogram.free_bytes[bucket] += size;
+        }
     }
-    // LCOV_EXCL_STOP
 
-    Arena *arena = arena_new_static_custom((void *)block, size, alignment);
-    arena_set_is_nested(arena, true); // Mark the arena as nested
+    // Share of the free memory a single request of the largest free size could not use
+    size_t free_total = stats.free_bytes + stats.tail_free;
+    size_t largest = stats.largest_free_block > stats.tail_free ? stats.largest_free_block : stats.tail_free;
+    double fragmentation = free_total ? 1.0 - (double)largest / (double)free_total : 0.0;
+
+    fprintf(out, "{\"address\":\"%p\",\"capacity\":%zu,\"alignment\":%zu,", (void *)arena, stats.capacity, arena_get_alignment(arena));
+    fprintf(out, "\"bytes_in_use\":%zu,\"occupied_blocks\":%zu,\"free_bytes\":%zu,\"free_blocks\":%zu,",
+            stats.bytes_in_use, stats.occupied_blocks, stats.free_bytes, stats.free_blocks);
+    fprintf(out, "\"largest_free_block\":%zu,\"tail_free\":%zu,\"padding_bytes\":%zu,\"fragmentation\":%.4f,",
+            stats.largest_free_block, stats.tail_free, stats.padding_bytes, fragmentation);
+
+    fputs("\"histogram\":[", out);
+    bool first = true;
+    for (size_t bucket = 0; bucket < ARENA_SNAPSHOT_BUCKETS; bucket++) {
+        if (!histogram.occupied[bucket] && !histogram.free[bucket]) continue;
+        fprintf(out, "%s{\"min_size\":%zu,\"occupied\":%zu,\"occupied_bytes\":%zu,\"free\":%zu,\"free_bytes\":%zu}",
+                first ? "" : ",", (size_t)1 << bucket, histogram.occupied[bucket], histogram.occupied_bytes[bucket],
+                histogram.free[bucket], histogram.free_bytes[bucket]);
+        first = false;
+    }
 
-    return arena;
+    fputs("],\"nested\":[", out);
+    first = true;
+    for (Block *block = arena_get_first_block(arena); block != NULL; block = next_block(arena, block)) {
+        Arena *nested = snapshot_nested(arena, block);
+        if (!nested) continue;
+
+        if (!first) fputc(',', out);
+        lock_arena(nested);
+        snapshot_arena(nested, out);
+        unlock_arena(nested);
+        first = false;
+    }
+    fputs("]}", out);
 }
 
 /*
- * Create a nested arena with alignment of parent arena
- * Allocates memory for a nested arena from a parent arena and initializes it
- * Returns NULL if the parent arena is NULL, requested size is too small, or allocation fails
+ * Dump heap snapshot
+ * Writes the arena as JSON: totals, fragmentation and a size histogram of every chunk and nested arena,
+ *  followed by the allocation sites the profiler sampled in the whole process
+ * Walks every block, so it takes O(number of blocks) under the arena locks
  */
-Arena *arena_new_nested(Arena *parent_arena, size_t size) {
-    if (!parent_arena || size < BLOCK_MIN_SIZE || size > SIZE_MASK) return NULL;
+void arena_dump_snapshot(Arena *arena, FILE *out) {
+    if (!arena || !out) return;
 
-    return arena_new_nested_custom(parent_arena, size, arena_get_alignment(parent_arena));
+    #ifdef ARENA_THREAD_SAFE
+    ArenaChunk *head_chunk = arena_get_has_chunk(arena) ? arena_get_chunk(arena) : NULL;
+    if (head_chunk) arena_spin_lock(&head_chunk->chain_lock);
+    #endif
+
+    fputs("{\"chunks\":[", out);
+    for (Arena *chunk = arena; chunk != NULL; chunk = arena_get_has_chunk(chunk) ? arena_get_chunk(chunk)->next : NULL) {
+        if (chunk != arena) fputc(',', out);
+        lock_arena(chunk);
+        snapshot_arena(chunk, out);
+        unlock_arena(chunk);
+    }
+
+    #ifdef ARENA_THREAD_SAFE
+    if (head_chunk) arena_spin_unlock(&head_chunk->chain_lock);
+    arena_spin_lock(&arena_profile_lock);
+    #endif
+
+    fprintf(out, "],\"profile\":{\"rate\":%zu,\"dropped\":%zu,\"sites\":[", ARENA_LOAD_TAGGED(arena_profile_rate), arena_profile_dropped);
+    bool first = true;
+    for (size_t i = 0; i < ARENA_PROFILE_SITES; i++) {
+        const ArenaProfileSite *site = &arena_profile_table[i];
+        if (site->samples == 0) continue;
+
+        fputs(first ? "{\"tag\":" : ",{\"tag\":", out);
+        snapshot_string(out, site->tag);
+        fprintf(out, ",\"samples\":%zu,\"sampled_bytes\":%zu,\"estimated_bytes\":%zu,\"frames\":[",
+                site->samples, site->sampled_bytes, site->estimated_bytes);
+        for (size_t f = 0; f < site->depth; f++) fprintf(out, "%s\"%p\"", f ? "," : "", site->frames[f]);
+        fputs("]}", out);
+        first = false;
+    }
+
+    #ifdef ARENA_THREAD_SAFE
+    arena_spin_unlock(&arena_profile_lock);
+    #endif
+
+    fputs("]}}\n", out);
 }
+#endif // ARENA_PROFILING
 
 
 #ifdef DEBUG
@@ -1959,12 +7805,11 @@ void print_fancy(Arena *arena, size_t bar_size) {
         }
         
         // Check each block
-        size_t current_pos = 0;
-        Block *current = (Block *)((char *)arena + sizeof(Arena));
+        Block *current = arena_get_first_block(arena);
         
         while (current) {
             // Position of block metadata
-            size_t block_meta_start = current_pos;
+            size_t block_meta_start = (uintptr_t)current - (uintptr_t)arena;
             size_t block_meta_end = block_meta_start + sizeof(Block);
             
             // Check intersection with block metadata
@@ -2002,7 +7847,6 @@ void print_fancy(Arena *arena, size_t bar_size) {
                 }
             }
             
-            current_pos = block_data_end;
             current = next_block(arena, current);
         }
 
@@ -2041,12 +7885,231 @@ void print_fancy(Arena *arena, size_t bar_size) {
     PRINTF(T("\033[42m   \033[0m - Free blocks, "));
     PRINTF(T("\033[40m   \033[0m - Empty space\n\n"));
 }
+
+// The printing helpers must not leak into code after the header, 'T' is a common template parameter name
+#undef PRINTF
+#undef T
 #endif // DEBUG
 
 #endif // ARENA_IMPLEMENTATION
 
 #ifdef __cplusplus
 } // extern "C"
+
+#include <new>
+#include <utility>
+#include <cstddef>
+
+/*
+ * Typed allocation
+ * Constructs a T in the arena through the unchecked fast path, the alignment is checked at compile time
+ * Returns nullptr if there is not enough space, the arena must not be NULL
+ */
+template <typename T, typename... Args>
+inline T *arena_new(Arena *arena, Args &&...args) {
+    static_assert(alignof(T) <= MAX_ALIGNMENT, "arena_new: type alignment exceeds the maximum arena alignment");
+    void *memory = arena_alloc_fast(arena, sizeof(T), alignof(T) > MIN_ALIGNMENT ? alignof(T) : MIN_ALIGNMENT);
+    return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+}
+
+#if defined(__has_include)
+#   if __has_include(<memory_resource>) && (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#       include <memory_resource>
+#       define ARENA_HAS_PMR
+#   endif
+#endif
+
+/*
+ * Report allocation failure
+ * Standard allocators and memory resources throw on failure, builds without exceptions abort instead
+ */
+[[noreturn]] inline void arena_throw_bad_alloc() {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+    throw std::bad_alloc();
+#else
+    abort();
+#endif
+}
+
+/*
+ * Allocate for the standard library
+ * Raises the alignment to what arena blocks need and throws instead of returning NULL
+ */
+inline void *arena_cxx_allocate(Arena *arena, std::size_t size, std::size_t alignment) {
+    if (alignment < MIN_ALIGNMENT) alignment = MIN_ALIGNMENT;
+    void *ptr = arena_alloc_custom(arena, size != 0 ? size : 1, alignment);
+    if (!ptr) arena_throw_bad_alloc();
+    return ptr;
+}
+
+/*
+ * Standard allocator
+ * Allocator for standard containers backed by an arena, freed blocks go back to the arena
+ * Copies and rebinds share the arena, allocators of the same arena compare equal
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(Arena *arena) noexcept : arena_(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena_(other.arena()) {}
+
+    T *allocate(std::size_t count) {
+        if (count > SIZE_MAX / sizeof(T)) arena_throw_bad_alloc();
+        return static_cast<T *>(arena_cxx_allocate(arena_, count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *ptr, std::size_t) noexcept { arena_free_block(ptr); }
+
+    Arena *arena() const noexcept { return arena_; }
+
+private:
+    Arena *arena_;
+};
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) noexcept { return a.arena() == b.arena(); }
+
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) noexcept { return a.arena() != b.arena(); }
+
+#ifdef ARENA_HAS_PMR
+/*
+ * Polymorphic memory resource
+ * 'std::pmr::memory_resource' backed by an arena, deallocation frees the block
+ */
+class ArenaMemoryResource : public std::pmr::memory_resource {
+public:
+    explicit ArenaMemoryResource(Arena *arena) noexcept : arena_(arena) {}
+
+    Arena *arena() const noexcept { return arena_; }
+
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return arena_cxx_allocate(arena_, bytes, alignment);
+    }
+
+    void do_deallocate(void *ptr, std::size_t, std::size_t) override { arena_free_block(ptr); }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        const ArenaMemoryResource *resource = dynamic_cast<const ArenaMemoryResource *>(&other);
+        return resource != nullptr && resource->arena_ == arena_;
+    }
+
+    Arena *arena_;
+};
+
+/*
+ * Monotonic memory resource
+ * Serves allocations from bump regions carved from an arena, deallocation does nothing
+ * A full region is followed by one twice its size, 'release' and the destructor give all regions back
+ * Every region starts with a link to itself and the previous link, so the resource needs no bookkeeping of its own
+ */
+class ArenaMonotonicResource : public std::pmr::memory_resource {
+public:
+    explicit ArenaMonotonicResource(Arena *parent, std::size_t region_size = 4096) noexcept
+        : parent_(parent), regions_(nullptr), next_size_(region_size != 0 ? region_size : 4096) {}
+    ~ArenaMonotonicResource() override { release(); }
+
+    ArenaMonotonicResource(const ArenaMonotonicResource &) = delete;
+    ArenaMonotonicResource &operator=(const ArenaMonotonicResource &) = delete;
+
+    void release() noexcept {
+        while (regions_) {
+            RegionLink *previous = regions_->previous; // The link lives in the region, read it before freeing
+            arena_bump_free(regions_->region);
+            regions_ = previous;
+        }
+    }
+
+private:
+    struct RegionLink {
+        ArenaBump *region;      // Region holding this link
+        RegionLink *previous;   // Link of the region before it
+    };
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (bytes == 0) bytes = 1;
+        void *ptr = regions_ ? arena_bump_alloc_custom(regions_->region, bytes, alignment) : nullptr;
+        if (ptr) return ptr;
+
+        if (alignment > MAX_ALIGNMENT || bytes > SIZE_MAX / 2 - alignment - sizeof(RegionLink)) arena_throw_bad_alloc();
+        std::size_t size = next_size_;
+        while (size < bytes + alignment + sizeof(RegionLink)) size *= 2;
+
+        ArenaBump *region = arena_bump_new_custom(parent_, size, alignof(RegionLink));
+        if (!region) arena_throw_bad_alloc();
+        RegionLink *link = static_cast<RegionLink *>(arena_bump_alloc_custom(region, sizeof(RegionLink), alignof(RegionLink)));
+        if (!link) {
+            // LCOV_EXCL_START
+            arena_bump_free(region);
+            arena_throw_bad_alloc();
+            // LCOV_EXCL_STOP
+        }
+        link->region = region;
+        link->previous = regions_;
+        regions_ = link;
+        next_size_ = size * 2;
+
+        return arena_bump_alloc_custom(region, bytes, alignment);
+    }
+
+    void do_deallocate(void *, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    Arena *parent_;
+    RegionLink *regions_;   // Link of the newest region, allocations are served from it
+    std::size_t next_size_; // Size of the next region
+};
+#endif // ARENA_HAS_PMR
+
+/*
+ * Typed object pool
+ * C++ wrapper of 'ArenaPool' that constructs objects of type T in its slots and destroys them on release
+ * The pool owns its slabs: destroying the wrapper gives them back to the parent arena without running destructors
+ */
+template <typename T>
+class ArenaObjectPool {
+public:
+    explicit ArenaObjectPool(Arena *parent) : pool_(arena_pool_new_custom(parent, sizeof(T), alignof(T))) {}
+    ~ArenaObjectPool() { arena_pool_free(pool_); }
+
+    ArenaObjectPool(const ArenaObjectPool &) = delete;
+    ArenaObjectPool &operator=(const ArenaObjectPool &) = delete;
+    ArenaObjectPool(ArenaObjectPool &&other) noexcept : pool_(other.pool_) { other.pool_ = nullptr; }
+    ArenaObjectPool &operator=(ArenaObjectPool &&other) noexcept {
+        if (this != &other) {
+            arena_pool_free(pool_);
+            pool_ = other.pool_;
+            other.pool_ = nullptr;
+        }
+        return *this;
+    }
+
+    // Returns nullptr if the pool could not be created or the parent is out of memory
+    template <typename... Args>
+    T *create(Args &&...args) {
+        void *slot = arena_pool_alloc(pool_);
+        if (!slot) return nullptr;
+        return new (slot) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T *object) {
+        if (!object) return;
+        object->~T();
+        arena_pool_release(pool_, object);
+    }
+
+    void reset() { arena_pool_reset(pool_); }
+    bool valid() const { return pool_ != nullptr; }
+    ArenaPool *get() const { return pool_; }
+
+private:
+    ArenaPool *pool_;
+};
 #endif
 
 #endif // ARENA_ALLOCATOR_H
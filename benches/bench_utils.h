@@ -0,0 +1,227 @@
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#   define _POSIX_C_SOURCE 200112L // clock_gettime and posix_memalign under strict -std=c99
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#   include <windows.h>
+#   include <malloc.h>
+#else
+#   include <time.h>
+#   include <sys/resource.h>
+#endif
+
+#ifndef BENCH_MALLOC_NAME
+    // Name reported for the system allocator; set to "jemalloc" when linked against it.
+#   define BENCH_MALLOC_NAME "malloc"
+#endif
+
+#ifndef BENCH_ARENA_NAME
+    // Name reported for the arena; set per free index backend when built with ARENA_FREE_INDEX_BITMAP.
+#   define BENCH_ARENA_NAME "arena"
+#endif
+
+#ifndef BENCH_REPETITIONS
+#   define BENCH_REPETITIONS 5 // Measured runs of each benchmark, the fastest one is reported
+#endif
+
+/*
+ * Benchmark result
+ * One measured workload for one allocator, serialized as a JSON object
+ */
+typedef struct BenchResult {
+    const char *name;       // Workload name
+    const char *allocator;  // Allocator name
+    size_t iterations;      // Operations per run
+    double ns_per_op;       // Fastest run, nanoseconds per operation
+    double mean_ns_per_op;  // Mean over all runs, nanoseconds per operation
+    double bytes_per_op;    // Average payload of one operation, 0 if not applicable
+    double fragmentation;   // Share of the used address range left in holes after the last run, negative if not measured
+} BenchResult;
+
+/*
+ * Allocator interface
+ * Lets every workload run unchanged on top of the arena and the system allocator
+ */
+typedef struct BenchAllocator {
+    const char *name;
+    void *ctx;
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*alloc_aligned)(void *ctx, size_t size, size_t alignment);
+    void (*free)(void *ctx, void *ptr);
+    void (*free_aligned)(void *ctx, void *ptr);
+    void (*release_all)(void *ctx, void **ptrs, size_t count); // Frees everything at once (reset for arenas)
+} BenchAllocator;
+
+/*
+ * Workload function
+ * Performs 'iterations' operations and returns the elapsed time in nanoseconds
+ */
+typedef uint64_t (*BenchWorkload)(const BenchAllocator *allocator, size_t iterations);
+
+/*
+ * Sink for results the optimizer must not drop
+ */
+static volatile uintptr_t bench_sink = 0;
+
+/*
+ * Fragmentation seen by the last run, set by workloads that measure it
+ */
+static double bench_fragmentation = -1.0;
+
+/*
+ * Monotonic clock in nanoseconds
+ */
+static inline uint64_t bench_now_ns(void) {
+    #if defined(_WIN32)
+    static LARGE_INTEGER frequency = {0};
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+    #else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    #endif
+}
+
+/*
+ * Restart the peak resident set size measurement
+ * Linux resets the high water mark through /proc, elsewhere the peak of the whole process is kept
+ */
+static inline void bench_reset_peak_rss(void) {
+    #if defined(__linux__)
+    FILE *clear_refs = fopen("/proc/self/clear_refs", "w");
+    if (!clear_refs) return;
+    fputs("5", clear_refs);
+    fclose(clear_refs);
+    #endif
+}
+
+/*
+ * Peak resident set size in bytes since the last reset, 0 if it cannot be measured
+ */
+static inline size_t bench_peak_rss_bytes(void) {
+    #if defined(_WIN32)
+    return 0;
+    #else
+    #if defined(__linux__)
+    FILE *status = fopen("/proc/self/status", "r");
+    if (status) {
+        char line[256];
+        unsigned long kb = 0;
+        while (fgets(line, sizeof(line), status)) {
+            if (sscanf(line, "VmHWM: %lu kB", &kb) == 1) break;
+        }
+        fclose(status);
+        if (kb > 0) return (size_t)kb * 1024;
+    }
+    #endif
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    #if defined(__APPLE__)
+    return (size_t)usage.ru_maxrss; // Bytes on macOS
+    #else
+    return (size_t)usage.ru_maxrss * 1024;
+    #endif
+    #endif
+}
+
+/*
+ * Deterministic xorshift random generator, so every run sees the same sequence
+ */
+static inline uint32_t bench_rand(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/*
+ * Shuffle an array of pointers in place
+ */
+static inline void bench_shuffle(void **ptrs, size_t count, uint32_t seed) {
+    uint32_t state = seed ? seed : 1;
+    for (size_t i = count; i > 1; i--) {
+        size_t j = bench_rand(&state) % i;
+        void *tmp = ptrs[i - 1];
+        ptrs[i - 1] = ptrs[j];
+        ptrs[j] = tmp;
+    }
+}
+
+/*
+ * Run a workload
+ * Warms up once, then keeps the fastest and the mean of BENCH_REPETITIONS runs
+ */
+static inline BenchResult bench_run(const char *name, const BenchAllocator *allocator, BenchWorkload workload, size_t iterations, double bytes_per_op) {
+    BenchResult result;
+    result.name = name;
+    result.allocator = allocator->name;
+    result.iterations = iterations;
+    result.bytes_per_op = bytes_per_op;
+
+    bench_fragmentation = -1.0;
+    workload(allocator, iterations);
+
+    uint64_t best = UINT64_MAX;
+    uint64_t total = 0;
+    for (int i = 0; i < BENCH_REPETITIONS; i++) {
+        uint64_t elapsed = workload(allocator, iterations);
+        if (elapsed < best) best = elapsed;
+        total += elapsed;
+    }
+
+    result.ns_per_op = (double)best / (double)iterations;
+    result.mean_ns_per_op = (double)total / BENCH_REPETITIONS / (double)iterations;
+    result.fragmentation = bench_fragmentation;
+    return result;
+}
+
+/*
+ * JSON output
+ * Mirrors the layout of Google Benchmark reports: a context object and a list of benchmarks
+ */
+static inline void bench_json_begin(FILE *out, const char *suite) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"context\": {\n");
+    fprintf(out, "    \"suite\": \"%s\",\n", suite);
+    fprintf(out, "    \"system_allocator\": \"%s\",\n", BENCH_MALLOC_NAME);
+    fprintf(out, "    \"repetitions\": %d,\n", BENCH_REPETITIONS);
+    fprintf(out, "    \"pointer_size\": %u\n", (unsigned)sizeof(void *));
+    fprintf(out, "  },\n");
+    fprintf(out, "  \"benchmarks\": [");
+}
+
+static inline void bench_json_result(FILE *out, const BenchResult *result, bool first) {
+    double ops_per_second = result->ns_per_op > 0.0 ? 1e9 / result->ns_per_op : 0.0;
+
+    fprintf(out, "%s\n    {", first ? "" : ",");
+    fprintf(out, "\"name\": \"%s/%s\", ", result->name, result->allocator);
+    fprintf(out, "\"workload\": \"%s\", ", result->name);
+    fprintf(out, "\"allocator\": \"%s\", ", result->allocator);
+    fprintf(out, "\"iterations\": %lu, ", (unsigned long)result->iterations);
+    fprintf(out, "\"real_time\": %.3f, ", result->ns_per_op);
+    fprintf(out, "\"mean_time\": %.3f, ", result->mean_ns_per_op);
+    fprintf(out, "\"time_unit\": \"ns\", ");
+    fprintf(out, "\"items_per_second\": %.1f, ", ops_per_second);
+    if (result->fragmentation >= 0.0) fprintf(out, "\"fragmentation\": %.4f, ", result->fragmentation);
+    fprintf(out, "\"bytes_per_second\": %.1f}", ops_per_second * result->bytes_per_op);
+}
+
+static inline void bench_json_end(FILE *out) {
+    fprintf(out, "\n  ]\n}\n");
+}
+
+#endif // BENCH_UTILS_H
@@ -0,0 +1,471 @@
+#include "bench_utils.h" // First, so its feature test macros apply to every system header
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+
+#define ARENA_BENCH_SIZE (96u * 1024u * 1024u)
+#define BUMP_COUNT (100000)
+#define BUMP_SIZE (64)
+#define CHURN_COUNT (1000000)
+#define CHURN_LIVE (16)
+#define RANDOM_COUNT (50000)
+#define RANDOM_MIN_SIZE (16)
+#define RANDOM_MAX_SIZE (512)
+#define ALIGNED_COUNT (10000)
+#define ALIGNED_SIZE (128)
+#define ALIGNED_ALIGNMENT (4096)
+#define NESTED_COUNT (100000)
+#define NESTED_SIZE (4096)
+#define RESET_COUNT (1000)
+#define RESET_ARENA_SIZE (1024u * 1024u)
+#define RESET_BLOCKS (64)
+#define RESET_BLOCK_SIZE (256)
+#define FRAG_LIVE (20000)
+#define FRAG_COUNT (200000)
+#define FIT_ARENA_SIZE (16u * 1024u * 1024u)
+
+enum { ORDER_LIFO, ORDER_FIFO, ORDER_RANDOM };
+
+static void *ptrs[BUMP_COUNT];
+static size_t random_sizes[RANDOM_COUNT];
+static void *frag_live[FRAG_LIVE];
+
+/*
+ * Arena backend
+ */
+static void *arena_backend_alloc(void *ctx, size_t size) {
+    return arena_alloc((Arena *)ctx, size);
+}
+
+static void *arena_backend_alloc_aligned(void *ctx, size_t size, size_t alignment) {
+    return arena_alloc_custom((Arena *)ctx, size, alignment);
+}
+
+static void arena_backend_free(void *ctx, void *ptr) {
+    (void)ctx;
+    arena_free_block(ptr);
+}
+
+static void arena_backend_release_all(void *ctx, void **blocks, size_t count) {
+    (void)blocks;
+    (void)count;
+    arena_reset((Arena *)ctx);
+}
+
+/*
+ * System allocator backend (malloc, or jemalloc when linked against it)
+ */
+static void *malloc_backend_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void *malloc_backend_alloc_aligned(void *ctx, size_t size, size_t alignment) {
+    (void)ctx;
+    #if defined(_WIN32)
+    return _aligned_malloc(size, alignment);
+    #else
+    void *ptr = NULL;
+    return posix_memalign(&ptr, alignment, size) == 0 ? ptr : NULL;
+    #endif
+}
+
+static void malloc_backend_free(void *ctx, void *ptr) {
+    (void)ctx;
+    free(ptr);
+}
+
+static void malloc_backend_free_aligned(void *ctx, void *ptr) {
+    (void)ctx;
+    #if defined(_WIN32)
+    _aligned_free(ptr);
+    #else
+    free(ptr);
+    #endif
+}
+
+static void malloc_backend_release_all(void *ctx, void **blocks, size_t count) {
+    (void)ctx;
+    for (size_t i = 0; i < count; i++) free(blocks[i]);
+}
+
+/*
+ * Tail-only bump allocation
+ * Only allocations are timed, the memory is released afterwards in one step
+ */
+static uint64_t bench_tail_bump(const BenchAllocator *allocator, size_t iterations) {
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        ptrs[i] = allocator->alloc(allocator->ctx, BUMP_SIZE);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    bench_sink ^= (uintptr_t)ptrs[iterations - 1];
+    allocator->release_all(allocator->ctx, ptrs, iterations);
+    return elapsed;
+}
+
+/*
+ * Tail-only bump allocation without parameter checks
+ * Same allocations as the tail bump through 'arena_alloc_fast', which carves from the tail of a bare arena right away
+ */
+static uint64_t bench_tail_bump_fast(const BenchAllocator *allocator, size_t iterations) {
+    Arena *arena = (Arena *)allocator->ctx;
+    size_t alignment = arena_get_alignment(arena);
+
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        ptrs[i] = arena_alloc_fast(arena, BUMP_SIZE, alignment);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    bench_sink ^= (uintptr_t)ptrs[iterations - 1];
+    allocator->release_all(allocator->ctx, ptrs, iterations);
+    return elapsed;
+}
+
+/*
+ * Batch allocation and free
+ * Same allocations as the tail bump, carved by one batch call and released by one batch free
+ */
+static uint64_t bench_batch(const BenchAllocator *allocator, size_t iterations) {
+    Arena *arena = (Arena *)allocator->ctx;
+
+    uint64_t start = bench_now_ns();
+    size_t allocated = arena_alloc_batch(arena, BUMP_SIZE, iterations, ptrs);
+    arena_free_batch(ptrs, allocated);
+    uint64_t elapsed = bench_now_ns() - start;
+
+    bench_sink ^= (uintptr_t)allocated;
+    allocator->release_all(allocator->ctx, ptrs, 0);
+    return elapsed;
+}
+
+/*
+ * Bump region allocation
+ * Same allocations as the tail bump, served by a header-free region carved from the arena
+ */
+static uint64_t bench_bump_region(const BenchAllocator *allocator, size_t iterations) {
+    ArenaBump *bump = arena_bump_new((Arena *)allocator->ctx, iterations * BUMP_SIZE);
+
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        ptrs[i] = arena_bump_alloc(bump, BUMP_SIZE);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    bench_sink ^= (uintptr_t)ptrs[iterations - 1];
+    arena_bump_free(bump);
+    return elapsed;
+}
+
+/*
+ * Same size churn
+ * Keeps a small live set and replaces one of its blocks on every operation
+ */
+static uint64_t bench_same_size_churn(const BenchAllocator *allocator, size_t iterations) {
+    void *live[CHURN_LIVE];
+    for (size_t i = 0; i < CHURN_LIVE; i++) live[i] = allocator->alloc(allocator->ctx, BUMP_SIZE);
+
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        size_t slot = i % CHURN_LIVE;
+        allocator->free(allocator->ctx, live[slot]);
+        live[slot] = allocator->alloc(allocator->ctx, BUMP_SIZE);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    for (size_t i = 0; i < CHURN_LIVE; i++) {
+        bench_sink ^= (uintptr_t)live[i];
+        allocator->free(allocator->ctx, live[i]);
+    }
+    allocator->release_all(allocator->ctx, ptrs, 0);
+    return elapsed;
+}
+
+/*
+ * Random sizes freed in LIFO, FIFO or random order
+ * One operation is an allocation together with its free
+ */
+static uint64_t bench_random_order(const BenchAllocator *allocator, size_t iterations, int order) {
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        ptrs[i] = allocator->alloc(allocator->ctx, random_sizes[i]);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    // Shuffling is not part of the measurement
+    if (order == ORDER_RANDOM) bench_shuffle(ptrs, iterations, 0x9E3779B9u);
+
+    start = bench_now_ns();
+    if (order == ORDER_LIFO) {
+        for (size_t i = iterations; i > 0; i--) allocator->free(allocator->ctx, ptrs[i - 1]);
+    } else {
+        for (size_t i = 0; i < iterations; i++) allocator->free(allocator->ctx, ptrs[i]);
+    }
+    elapsed += bench_now_ns() - start;
+
+    allocator->release_all(allocator->ctx, ptrs, 0);
+    return elapsed;
+}
+
+static uint64_t bench_random_lifo(const BenchAllocator *allocator, size_t iterations) {
+    return bench_random_order(allocator, iterations, ORDER_LIFO);
+}
+
+static uint64_t bench_random_fifo(const BenchAllocator *allocator, size_t iterations) {
+    return bench_random_order(allocator, iterations, ORDER_FIFO);
+}
+
+static uint64_t bench_random_shuffled(const BenchAllocator *allocator, size_t iterations) {
+    return bench_random_order(allocator, iterations, ORDER_RANDOM);
+}
+
+/*
+ * Fragmented reuse
+ * Follows the patterns of the stress test: mixed sizes are allocated, every other block is freed,
+ *  and the holes are then refilled with the sizes of 'Allocation in fragmented arena' while blocks keep being freed.
+ * Every allocation searches a free index holding thousands of blocks of different sizes
+ */
+static uint64_t bench_fragmented_reuse(const BenchAllocator *allocator, size_t iterations) {
+    static const size_t refill_sizes[] = { 20, 60, 120, 30, 90 };
+
+    for (size_t i = 0; i < FRAG_LIVE; i++) frag_live[i] = allocator->alloc(allocator->ctx, 20 + (i * 7) % 180);
+    for (size_t i = 0; i < FRAG_LIVE; i += 2) {
+        allocator->free(allocator->ctx, frag_live[i]);
+        frag_live[i] = NULL;
+    }
+
+    uint32_t state = 0xC0FFEEu;
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        size_t slot = bench_rand(&state) % FRAG_LIVE;
+        if (frag_live[slot]) allocator->free(allocator->ctx, frag_live[slot]);
+        frag_live[slot] = allocator->alloc(allocator->ctx, refill_sizes[i % 5]);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    for (size_t i = 0; i < FRAG_LIVE; i++) {
+        if (!frag_live[i]) continue;
+        bench_sink ^= (uintptr_t)frag_live[i];
+        allocator->free(allocator->ctx, frag_live[i]);
+        frag_live[i] = NULL;
+    }
+    allocator->release_all(allocator->ctx, ptrs, 0);
+    return elapsed;
+}
+
+#ifdef ARENA_FIT_POLICIES
+/*
+ * Fragmented reuse per fit policy
+ * Runs the fragmented reuse pattern on an arena of its own with the given policy, with a few bigger refills that
+ *  need merged holes. Only the churn is timed, the holes left behind are reported as the fragmentation
+ */
+static uint64_t bench_fit_common(ArenaFitPolicy policy, size_t iterations) {
+    static const size_t refill_sizes[] = { 20, 60, 120, 30, 90, 20, 60, 400 };
+
+    ArenaOptions options = {0};
+    options.fit_policy = policy;
+    Arena *arena = arena_new_dynamic_ex(FIT_ARENA_SIZE, &options);
+
+    for (size_t i = 0; i < FRAG_LIVE; i++) frag_live[i] = arena_alloc(arena, 20 + (i * 7) % 180);
+    for (size_t i = 0; i < FRAG_LIVE; i += 2) {
+        arena_free_block(frag_live[i]);
+        frag_live[i] = NULL;
+    }
+
+    uint32_t state = 0xC0FFEEu;
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        size_t slot = bench_rand(&state) % FRAG_LIVE;
+        if (frag_live[slot]) arena_free_block(frag_live[slot]);
+        frag_live[slot] = arena_alloc(arena, refill_sizes[i % 8]);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    ArenaStats stats;
+    arena_get_stats(arena, &stats);
+    size_t span = stats.bytes_in_use + stats.free_bytes;
+    bench_fragmentation = span ? (double)stats.free_bytes / (double)span : 0.0;
+
+    for (size_t i = 0; i < FRAG_LIVE; i++) frag_live[i] = NULL;
+    arena_free(arena);
+    return elapsed;
+}
+
+static uint64_t bench_fit_best(const BenchAllocator *allocator, size_t iterations) {
+    (void)allocator;
+    return bench_fit_common(ARENA_FIT_BEST, iterations);
+}
+
+static uint64_t bench_fit_first(const BenchAllocator *allocator, size_t iterations) {
+    (void)allocator;
+    return bench_fit_common(ARENA_FIT_FIRST, iterations);
+}
+
+static uint64_t bench_fit_address(const BenchAllocator *allocator, size_t iterations) {
+    (void)allocator;
+    return bench_fit_common(ARENA_FIT_ADDRESS, iterations);
+}
+
+static uint64_t bench_fit_tail(const BenchAllocator *allocator, size_t iterations) {
+    (void)allocator;
+    return bench_fit_common(ARENA_FIT_TAIL, iterations);
+}
+#endif // ARENA_FIT_POLICIES
+
+/*
+ * High alignment allocations
+ * Goes through arena_alloc_custom and posix_memalign respectively
+ */
+static uint64_t bench_high_alignment(const BenchAllocator *allocator, size_t iterations) {
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        ptrs[i] = allocator->alloc_aligned(allocator->ctx, ALIGNED_SIZE, ALIGNED_ALIGNMENT);
+    }
+    for (size_t i = 0; i < iterations; i++) {
+        bench_sink ^= (uintptr_t)ptrs[i];
+        allocator->free_aligned(allocator->ctx, ptrs[i]);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    allocator->release_all(allocator->ctx, ptrs, 0);
+    return elapsed;
+}
+
+/*
+ * Nested arena create/free
+ * The system allocator counterpart is a malloc/free of a region of the same size
+ */
+static uint64_t bench_nested(const BenchAllocator *allocator, size_t iterations) {
+    bool is_arena = allocator->alloc == arena_backend_alloc;
+
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        if (is_arena) {
+            Arena *nested = arena_new_nested((Arena *)allocator->ctx, NESTED_SIZE);
+            bench_sink ^= (uintptr_t)arena_alloc(nested, BUMP_SIZE);
+            arena_free(nested);
+        } else {
+            void *region = malloc(NESTED_SIZE);
+            bench_sink ^= (uintptr_t)region;
+            free(region);
+        }
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    allocator->release_all(allocator->ctx, ptrs, 0);
+    return elapsed;
+}
+
+/*
+ * Reset vs reset zero
+ * Uses its own smaller arena, since reset zero clears the whole capacity.
+ * Only the reset itself is timed, after filling the arena with a few blocks
+ */
+static uint64_t bench_reset_common(const BenchAllocator *allocator, size_t iterations, bool zero) {
+    (void)allocator;
+    Arena *arena = arena_new_dynamic(RESET_ARENA_SIZE);
+    uint64_t elapsed = 0;
+
+    for (size_t i = 0; i < iterations; i++) {
+        for (size_t j = 0; j < RESET_BLOCKS; j++) {
+            bench_sink ^= (uintptr_t)arena_alloc(arena, RESET_BLOCK_SIZE);
+        }
+        uint64_t start = bench_now_ns();
+        if (zero) arena_reset_zero(arena);
+        else arena_reset(arena);
+        elapsed += bench_now_ns() - start;
+    }
+
+    arena_free(arena);
+    return elapsed;
+}
+
+static uint64_t bench_reset(const BenchAllocator *allocator, size_t iterations) {
+    return bench_reset_common(allocator, iterations, false);
+}
+
+static uint64_t bench_reset_zero(const BenchAllocator *allocator, size_t iterations) {
+    return bench_reset_common(allocator, iterations, true);
+}
+
+/*
+ * Benchmark table
+ */
+typedef struct BenchCase {
+    const char *name;
+    BenchWorkload workload;
+    size_t iterations;
+    double bytes_per_op;
+    bool arena_only;
+} BenchCase;
+
+static const BenchCase bench_cases[] = {
+    { "tail_bump",        bench_tail_bump,       BUMP_COUNT,   BUMP_SIZE,    false },
+    { "tail_bump_fast",   bench_tail_bump_fast,  BUMP_COUNT,   BUMP_SIZE,    true },
+    { "batch_alloc_free", bench_batch,           BUMP_COUNT,   BUMP_SIZE,    true },
+    { "bump_region",      bench_bump_region,     BUMP_COUNT,   BUMP_SIZE,    true },
+    { "same_size_churn",  bench_same_size_churn, CHURN_COUNT,  BUMP_SIZE,    false },
+    { "random_lifo",      bench_random_lifo,     RANDOM_COUNT, (RANDOM_MIN_SIZE + RANDOM_MAX_SIZE) / 2.0, false },
+    { "random_fifo",      bench_random_fifo,     RANDOM_COUNT, (RANDOM_MIN_SIZE + RANDOM_MAX_SIZE) / 2.0, false },
+    { "random_shuffled",  bench_random_shuffled, RANDOM_COUNT, (RANDOM_MIN_SIZE + RANDOM_MAX_SIZE) / 2.0, false },
+    { "fragmented_reuse", bench_fragmented_reuse, FRAG_COUNT, 64,         false },
+    { "high_alignment",   bench_high_alignment,  ALIGNED_COUNT, ALIGNED_SIZE, false },
+    { "nested_create_free", bench_nested,        NESTED_COUNT, NESTED_SIZE,  false },
+    { "reset",            bench_reset,           RESET_COUNT,  RESET_BLOCKS * RESET_BLOCK_SIZE, true },
+    { "reset_zero",       bench_reset_zero,      RESET_COUNT,  RESET_BLOCKS * RESET_BLOCK_SIZE, true },
+    #ifdef ARENA_FIT_POLICIES
+    { "fit_best",         bench_fit_best,        FRAG_COUNT,   64,           true },
+    { "fit_first",        bench_fit_first,       FRAG_COUNT,   64,           true },
+    { "fit_address",      bench_fit_address,     FRAG_COUNT,   64,           true },
+    { "fit_tail",         bench_fit_tail,        FRAG_COUNT,   64,           true },
+    #endif
+};
+
+int main(int argc, char **argv) {
+    FILE *out = stdout;
+    if (argc > 1) {
+        out = fopen(argv[1], "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open %s for writing\n", argv[1]);
+            return 1;
+        }
+    }
+
+    uint32_t state = 12345;
+    for (size_t i = 0; i < RANDOM_COUNT; i++) {
+        random_sizes[i] = RANDOM_MIN_SIZE + bench_rand(&state) % (RANDOM_MAX_SIZE - RANDOM_MIN_SIZE + 1);
+    }
+
+    Arena *arena = arena_new_dynamic(ARENA_BENCH_SIZE);
+    if (!arena) {
+        fprintf(stderr, "Cannot create a %u byte arena\n", ARENA_BENCH_SIZE);
+        return 1;
+    }
+
+    const BenchAllocator allocators[] = {
+        { BENCH_ARENA_NAME, arena, arena_backend_alloc, arena_backend_alloc_aligned, arena_backend_free, arena_backend_free, arena_backend_release_all },
+        { BENCH_MALLOC_NAME, NULL, malloc_backend_alloc, malloc_backend_alloc_aligned, malloc_backend_free, malloc_backend_free_aligned, malloc_backend_release_all },
+    };
+
+    bench_json_begin(out, "micro_bench");
+    bool first = true;
+    for (size_t i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++) {
+        const BenchCase *bench = &bench_cases[i];
+        for (size_t j = 0; j < sizeof(allocators) / sizeof(allocators[0]); j++) {
+            if (bench->arena_only && j > 0) continue;
+
+            BenchResult result = bench_run(bench->name, &allocators[j], bench->workload, bench->iterations, bench->bytes_per_op);
+            bench_json_result(out, &result, first);
+            first = false;
+            fprintf(stderr, "%-20s %-10s %10.2f ns/op", result.name, result.allocator, result.ns_per_op);
+            if (result.fragmentation >= 0.0) fprintf(stderr, " %8.1f%% in holes", result.fragmentation * 100.0);
+            fprintf(stderr, "\n");
+        }
+    }
+    bench_json_end(out);
+
+    arena_free(arena);
+    if (out != stdout) fclose(out);
+    return 0;
+}
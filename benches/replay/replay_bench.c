@@ -0,0 +1,876 @@
+#include "../bench_utils.h" // First, so its feature test macros apply to every system header
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+
+#if defined(_WIN32)
+typedef HANDLE replay_thread;
+#define THREAD_FUNC(name) DWORD WINAPI name(LPVOID arg)
+#define THREAD_RETURN return 0
+static bool thread_start(replay_thread *thread, LPTHREAD_START_ROUTINE func, void *arg) {
+    *thread = CreateThread(NULL, 0, func, arg, 0, NULL);
+    return *thread != NULL;
+}
+static void thread_join(replay_thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#else
+#include <pthread.h>
+typedef pthread_t replay_thread;
+#define THREAD_FUNC(name) void *name(void *arg)
+#define THREAD_RETURN return NULL
+static bool thread_start(replay_thread *thread, void *(*func)(void *), void *arg) {
+    return pthread_create(thread, NULL, func, arg) == 0;
+}
+static void thread_join(replay_thread thread) {
+    pthread_join(thread, NULL);
+}
+#endif
+
+#define REPLAY_MAX_ID (1u << 20)    // Highest slot or arena id a trace may use
+#define REPLAY_MAX_THREADS (64)
+#define REPLAY_ITERATIONS (20)      // Default number of times every thread replays the trace
+#define REPLAY_SAMPLES (64)         // Fragmentation samples taken over one replay of the trace
+#define REPLAY_LINE_SIZE (256)
+
+/*
+ * Trace format
+ * One operation per line, '#' starts a comment. Slots name live allocations and arenas name the root (0)
+ *  and nested arenas; both are small integers reused once their previous owner is gone
+ *
+ *   arena <size>                         Capacity of the root arena of every thread, before any operation
+ *   a <slot> <size> [alignment] [arena]  arena_alloc_custom (arena_alloc for alignment 0) into the slot
+ *   f <slot>                             arena_free_block of the slot
+ *   r [arena]                            arena_reset, drops the slots and nested arenas inside the arena
+ *   n <arena> <size> [parent]            arena_new_nested of the given parent
+ *   x <arena>                            arena_free of a nested arena, drops what was inside it
+ */
+typedef enum ReplayKind {
+    OP_ALLOC,
+    OP_FREE,
+    OP_RESET,
+    OP_NEW_NESTED,
+    OP_FREE_NESTED,
+    OP_KIND_COUNT
+} ReplayKind;
+
+static const char *const kind_names[OP_KIND_COUNT] = { "alloc", "free", "reset", "nested_new", "nested_free" };
+
+typedef struct ReplayOp {
+    uint32_t kind;      // ReplayKind
+    uint32_t id;        // Slot of allocations and frees, arena of the other operations
+    uint32_t arena;     // Arena of an allocation, parent of a nested arena
+    size_t size;
+    size_t alignment;   // 0 for the default alignment of the arena
+} ReplayOp;
+
+typedef struct ReplayTrace {
+    const char *name;
+    size_t arena_size;
+    ReplayOp *ops;
+    size_t count;
+    size_t capacity;
+    size_t kind_counts[OP_KIND_COUNT];
+    size_t slots;       // Highest slot + 1
+    size_t arenas;      // Highest arena + 1
+} ReplayTrace;
+
+/*
+ * Replay model
+ * Tracks which slots and arenas are alive, so traces that use a freed slot or a dead arena
+ *  are rejected when they are loaded and never reach the allocator
+ */
+typedef struct ReplayModel {
+    uint8_t *slot_live;
+    uint32_t *slot_arena;
+    size_t slot_capacity;
+    uint8_t *arena_live;
+    uint32_t *arena_parent;
+    size_t arena_capacity;
+} ReplayModel;
+
+/*
+ * Fragmentation sample
+ * Free tree of the root arena of the first thread after 'op' operations
+ */
+typedef struct ReplaySample {
+    size_t op;
+    size_t bytes_in_use;
+    size_t free_bytes;
+    size_t free_blocks;
+    size_t largest_free_block;
+    size_t tail_free;
+} ReplaySample;
+
+typedef struct ReplayWorker {
+    const ReplayTrace *trace;
+    size_t iterations;
+    uint64_t timer_overhead;
+    bool sample;                            // Records the fragmentation series, set for the first thread
+    Arena **arenas;
+    void **slots;
+    uint32_t *latencies[OP_KIND_COUNT];     // Nanoseconds of every timed operation, by kind
+    size_t latency_counts[OP_KIND_COUNT];
+    uint64_t begin;                         // Clock at the start and the end of the untimed replays
+    uint64_t end;
+    size_t failed;                          // Allocations and nested arenas the arena could not serve
+    ReplaySample samples[REPLAY_SAMPLES + 2];
+    size_t sample_count;
+    bool ok;
+} ReplayWorker;
+
+typedef struct ReplayLatency {
+    size_t count;
+    uint32_t p50;
+    uint32_t p99;
+    uint32_t p999;
+    uint32_t max;
+} ReplayLatency;
+
+static bool grow_array(void **array, size_t *capacity, size_t needed, size_t element_size) {
+    if (needed <= *capacity) return true;
+    size_t new_capacity = *capacity ? *capacity : 64;
+    while (new_capacity < needed) new_capacity *= 2;
+    void *grown = realloc(*array, new_capacity * element_size);
+    if (!grown) return false;
+    memset((char *)grown + *capacity * element_size, 0, (new_capacity - *capacity) * element_size);
+    *array = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+static bool grow_pair(void **first, void **second, size_t *capacity, size_t needed, size_t first_size, size_t second_size) {
+    size_t first_capacity = *capacity;
+    size_t second_capacity = *capacity;
+    if (!grow_array(first, &first_capacity, needed, first_size)) return false;
+    if (!grow_array(second, &second_capacity, needed, second_size)) return false;
+    *capacity = first_capacity;
+    return true;
+}
+
+static bool model_reserve(ReplayModel *model, uint32_t slot, uint32_t arena) {
+    return grow_pair((void **)&model->slot_live, (void **)&model->slot_arena, &model->slot_capacity, (size_t)slot + 1, sizeof(uint8_t), sizeof(uint32_t))
+        && grow_pair((void **)&model->arena_live, (void **)&model->arena_parent, &model->arena_capacity, (size_t)arena + 1, sizeof(uint8_t), sizeof(uint32_t));
+}
+
+static bool model_init(ReplayModel *model) {
+    memset(model, 0, sizeof(ReplayModel));
+    if (!model_reserve(model, 0, 0)) return false;
+    model->arena_live[0] = 1; // The root is always alive
+    return true;
+}
+
+static void model_free(ReplayModel *model) {
+    free(model->slot_live);
+    free(model->slot_arena);
+    free(model->arena_live);
+    free(model->arena_parent);
+}
+
+static bool model_is_inside(const ReplayModel *model, uint32_t arena, uint32_t ancestor) {
+    while (arena != ancestor) {
+        if (arena == 0) return false;
+        arena = model->arena_parent[arena];
+    }
+    return true;
+}
+
+/*
+ * Drops the slots and nested arenas inside the arena, and the arena itself if 'self' is set
+ */
+static void model_drop(ReplayModel *model, uint32_t arena, bool self) {
+    for (size_t slot = 0; slot < model->slot_capacity; slot++) {
+        if (model->slot_live[slot] && model_is_inside(model, model->slot_arena[slot], arena)) model->slot_live[slot] = 0;
+    }
+    for (uint32_t nested = 1; nested < model->arena_capacity; nested++) {
+        if (nested != arena && model->arena_live[nested] && model_is_inside(model, nested, arena)) model->arena_live[nested] = 0;
+    }
+    if (self) model->arena_live[arena] = 0;
+}
+
+/*
+ * Applies the operation to the model, returns false if the trace may not perform it
+ */
+static bool model_apply(ReplayModel *model, const ReplayOp *op) {
+    if (op->id >= REPLAY_MAX_ID || op->arena >= REPLAY_MAX_ID) return false;
+    bool is_slot = op->kind == OP_ALLOC || op->kind == OP_FREE;
+    if (!model_reserve(model, is_slot ? op->id : 0, is_slot ? op->arena : (op->id > op->arena ? op->id : op->arena))) return false;
+
+    switch (op->kind) {
+        case OP_ALLOC:
+            if (model->slot_live[op->id] || !model->arena_live[op->arena] || op->size == 0) return false;
+            if ((op->alignment & (op->alignment - 1)) != 0) return false;
+            model->slot_live[op->id] = 1;
+            model->slot_arena[op->id] = op->arena;
+            return true;
+        case OP_FREE:
+            if (!model->slot_live[op->id]) return false;
+            model->slot_live[op->id] = 0;
+            return true;
+        case OP_RESET:
+            if (!model->arena_live[op->id]) return false;
+            model_drop(model, op->id, false);
+            return true;
+        case OP_NEW_NESTED:
+            if (op->id == 0 || model->arena_live[op->id] || !model->arena_live[op->arena] || op->size == 0) return false;
+            model->arena_live[op->id] = 1;
+            model->arena_parent[op->id] = op->arena;
+            return true;
+        case OP_FREE_NESTED:
+            if (op->id == 0 || !model->arena_live[op->id]) return false;
+            model_drop(model, op->id, true);
+            return true;
+        default:
+            return false; // LCOV_EXCL_LINE
+    }
+}
+
+static bool parse_op(const char *line, ReplayOp *op) {
+    unsigned id = 0;
+    unsigned arena = 0;
+    size_t size = 0;
+    size_t alignment = 0;
+    int fields = 0;
+
+    memset(op, 0, sizeof(ReplayOp));
+    switch (line[0]) {
+        case 'a':
+            fields = sscanf(line + 1, "%u %zu %zu %u", &id, &size, &alignment, &arena);
+            if (fields < 2) return false;
+            op->kind = OP_ALLOC;
+            break;
+        case 'f':
+            if (sscanf(line + 1, "%u", &id) != 1) return false;
+            op->kind = OP_FREE;
+            break;
+        case 'r':
+            sscanf(line + 1, "%u", &id);
+            op->kind = OP_RESET;
+            break;
+        case 'n':
+            fields = sscanf(line + 1, "%u %zu %u", &id, &size, &arena);
+            if (fields < 2) return false;
+            op->kind = OP_NEW_NESTED;
+            break;
+        case 'x':
+            if (sscanf(line + 1, "%u", &id) != 1) return false;
+            op->kind = OP_FREE_NESTED;
+            break;
+        default:
+            return false;
+    }
+
+    op->id = (uint32_t)id;
+    op->arena = (uint32_t)arena;
+    op->size = size;
+    op->alignment = alignment;
+    return true;
+}
+
+static void write_op(FILE *out, const ReplayOp *op) {
+    switch (op->kind) {
+        case OP_ALLOC:
+            if (op->arena) fprintf(out, "a %u %zu %zu %u\n", (unsigned)op->id, op->size, op->alignment, (unsigned)op->arena);
+            else if (op->alignment) fprintf(out, "a %u %zu %zu\n", (unsigned)op->id, op->size, op->alignment);
+            else fprintf(out, "a %u %zu\n", (unsigned)op->id, op->size);
+            break;
+        case OP_FREE:
+            fprintf(out, "f %u\n", (unsigned)op->id);
+            break;
+        case OP_RESET:
+            if (op->id) fprintf(out, "r %u\n", (unsigned)op->id);
+            else fprintf(out, "r\n");
+            break;
+        case OP_NEW_NESTED:
+            fprintf(out, "n %u %zu %u\n", (unsigned)op->id, op->size, (unsigned)op->arena);
+            break;
+        case OP_FREE_NESTED:
+            fprintf(out, "x %u\n", (unsigned)op->id);
+            break;
+        default:
+            break; // LCOV_EXCL_LINE
+    }
+}
+
+static void trace_free(ReplayTrace *trace) {
+    free(trace->ops);
+    memset(trace, 0, sizeof(ReplayTrace));
+}
+
+/*
+ * Load a trace file
+ * Parses and validates every operation up front, so the replay itself only calls the allocator
+ */
+static bool trace_load(const char *path, ReplayTrace *trace) {
+    memset(trace, 0, sizeof(ReplayTrace));
+    trace->name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        fprintf(stderr, "Cannot open trace %s\n", path);
+        return false;
+    }
+
+    ReplayModel model;
+    bool ok = model_init(&model);
+    char line[REPLAY_LINE_SIZE];
+    size_t line_number = 0;
+
+    while (ok && fgets(line, sizeof(line), in)) {
+        line_number++;
+        const char *text = line;
+        while (*text == ' ' || *text == '\t') text++;
+        if (*text == '#' || *text == '\n' || *text == '\r' || *text == '\0') continue;
+
+        if (strncmp(text, "arena", 5) == 0) {
+            if (trace->count > 0 || sscanf(text + 5, "%zu", &trace->arena_size) != 1) ok = false;
+        }
+        else {
+            ReplayOp op;
+            ok = trace->arena_size > 0 && parse_op(text, &op) && model_apply(&model, &op)
+                && grow_array((void **)&trace->ops, &trace->capacity, trace->count + 1, sizeof(ReplayOp));
+            if (ok) {
+                trace->ops[trace->count++] = op;
+                trace->kind_counts[op.kind]++;
+                if (op.kind == OP_ALLOC || op.kind == OP_FREE) {
+                    if (op.id >= trace->slots) trace->slots = (size_t)op.id + 1;
+                }
+                else if (op.id >= trace->arenas) trace->arenas = (size_t)op.id + 1;
+            }
+        }
+        if (!ok) fprintf(stderr, "%s:%lu: invalid operation: %s", path, (unsigned long)line_number, line);
+    }
+    fclose(in);
+    model_free(&model);
+
+    if (ok && trace->count == 0) {
+        fprintf(stderr, "%s: no operations\n", path);
+        ok = false;
+    }
+    if (!ok) trace_free(trace);
+    if (trace->arenas == 0) trace->arenas = 1;
+    return ok;
+}
+
+static inline void replay_op(ReplayWorker *worker, const ReplayOp *op) {
+    switch (op->kind) {
+        case OP_ALLOC: {
+            Arena *arena = worker->arenas[op->arena];
+            void *ptr = op->alignment ? arena_alloc_custom(arena, op->size, op->alignment) : arena_alloc(arena, op->size);
+            if (!ptr) worker->failed++;
+            worker->slots[op->id] = ptr;
+            break;
+        }
+        case OP_FREE:
+            arena_free_block(worker->slots[op->id]);
+            break;
+        case OP_RESET:
+            arena_reset(worker->arenas[op->id]);
+            break;
+        case OP_NEW_NESTED:
+            worker->arenas[op->id] = arena_new_nested(worker->arenas[op->arena], op->size);
+            if (!worker->arenas[op->id]) worker->failed++;
+            break;
+        case OP_FREE_NESTED:
+            arena_free(worker->arenas[op->id]);
+            worker->arenas[op->id] = NULL;
+            break;
+        default:
+            break; // LCOV_EXCL_LINE
+    }
+}
+
+/*
+ * Start the next replay from an empty root arena, nested arenas and slots die with its reset
+ */
+static void replay_restart(ReplayWorker *worker) {
+    arena_reset(worker->arenas[0]);
+    memset(worker->arenas + 1, 0, (worker->trace->arenas - 1) * sizeof(Arena *));
+}
+
+static void replay_sample(ReplayWorker *worker, size_t op) {
+    ArenaStats stats;
+    arena_get_stats(worker->arenas[0], &stats);
+
+    ReplaySample *sample = &worker->samples[worker->sample_count++];
+    sample->op = op;
+    sample->bytes_in_use = stats.bytes_in_use;
+    sample->free_bytes = stats.free_bytes;
+    sample->free_blocks = stats.free_blocks;
+    sample->largest_free_block = stats.largest_free_block;
+    sample->tail_free = stats.tail_free;
+}
+
+/*
+ * Throughput worker
+ * Creates the arena of the worker and replays the trace without timing single operations
+ */
+static THREAD_FUNC(throughput_worker) {
+    ReplayWorker *worker = (ReplayWorker *)arg;
+    const ReplayTrace *trace = worker->trace;
+
+    worker->arenas[0] = arena_new_dynamic(trace->arena_size);
+    if (!worker->arenas[0]) THREAD_RETURN;
+
+    worker->begin = bench_now_ns();
+    for (size_t iteration = 0; iteration < worker->iterations; iteration++) {
+        for (size_t i = 0; i < trace->count; i++) replay_op(worker, &trace->ops[i]);
+        replay_restart(worker);
+    }
+    worker->end = bench_now_ns();
+    worker->ok = true;
+    THREAD_RETURN;
+}
+
+/*
+ * Latency worker
+ * Replays the trace again timing every operation, the first worker samples the free tree during its first replay
+ */
+static THREAD_FUNC(latency_worker) {
+    ReplayWorker *worker = (ReplayWorker *)arg;
+    const ReplayTrace *trace = worker->trace;
+    size_t failed = worker->failed; // Failures of the timed replays repeat the same ones
+
+    size_t interval = trace->count / REPLAY_SAMPLES ? trace->count / REPLAY_SAMPLES : 1;
+    for (size_t iteration = 0; iteration < worker->iterations; iteration++) {
+        bool sample = worker->sample && iteration == 0;
+        if (sample) replay_sample(worker, 0);
+
+        for (size_t i = 0; i < trace->count; i++) {
+            const ReplayOp *op = &trace->ops[i];
+            uint64_t start = bench_now_ns();
+            replay_op(worker, op);
+            uint64_t elapsed = bench_now_ns() - start;
+
+            elapsed = elapsed > worker->timer_overhead ? elapsed - worker->timer_overhead : 0;
+            worker->latencies[op->kind][worker->latency_counts[op->kind]++] = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+            if (sample && (i + 1) % interval == 0 && worker->sample_count < REPLAY_SAMPLES + 1) replay_sample(worker, i + 1);
+        }
+        if (sample && worker->samples[worker->sample_count - 1].op != trace->count) replay_sample(worker, trace->count);
+        replay_restart(worker);
+    }
+
+    worker->failed = failed;
+    THREAD_RETURN;
+}
+
+/*
+ * Run the phase on one thread per worker and wait for all of them
+ * Phases run one after the other, so timed replays never overlap with the throughput measurement
+ */
+static bool run_phase(ReplayWorker *workers, size_t threads, bool latency) {
+    replay_thread handles[REPLAY_MAX_THREADS];
+    size_t started = 0;
+    while (started < threads && thread_start(&handles[started], latency ? latency_worker : throughput_worker, &workers[started])) started++;
+    for (size_t t = 0; t < started; t++) thread_join(handles[t]);
+    return started == threads;
+}
+
+/*
+ * Cost of reading the clock, taken off every timed operation
+ */
+static uint64_t measure_timer_overhead(void) {
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 1000; i++) {
+        uint64_t start = bench_now_ns();
+        uint64_t elapsed = bench_now_ns() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+static int compare_latency(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t *sorted, size_t count, double quantile) {
+    return sorted[(size_t)(quantile * (double)(count - 1))];
+}
+
+/*
+ * Latency distribution of one kind (or every kind for OP_KIND_COUNT) over all workers
+ */
+static ReplayLatency collect_latency(const ReplayWorker *workers, size_t threads, size_t kind) {
+    ReplayLatency latency;
+    memset(&latency, 0, sizeof(ReplayLatency));
+
+    size_t first = kind == OP_KIND_COUNT ? 0 : kind;
+    size_t last = kind == OP_KIND_COUNT ? OP_KIND_COUNT : kind + 1;
+    for (size_t t = 0; t < threads; t++) {
+        for (size_t k = first; k < last; k++) latency.count += workers[t].latency_counts[k];
+    }
+    if (latency.count == 0) return latency;
+
+    uint32_t *merged = (uint32_t *)malloc(latency.count * sizeof(uint32_t));
+    if (!merged) {
+        latency.count = 0;
+        return latency;
+    }
+    size_t filled = 0;
+    for (size_t t = 0; t < threads; t++) {
+        for (size_t k = first; k < last; k++) {
+            memcpy(merged + filled, workers[t].latencies[k], workers[t].latency_counts[k] * sizeof(uint32_t));
+            filled += workers[t].latency_counts[k];
+        }
+    }
+
+    qsort(merged, latency.count, sizeof(uint32_t), compare_latency);
+    latency.p50 = percentile(merged, latency.count, 0.50);
+    latency.p99 = percentile(merged, latency.count, 0.99);
+    latency.p999 = percentile(merged, latency.count, 0.999);
+    latency.max = merged[latency.count - 1];
+    free(merged);
+    return latency;
+}
+
+static void json_latency(FILE *out, const char *name, const ReplayLatency *latency, bool first) {
+    fprintf(out, "%s\n        \"%s\": {\"count\": %lu, \"p50\": %u, \"p99\": %u, \"p999\": %u, \"max\": %u}", first ? "" : ",",
+            name, (unsigned long)latency->count, latency->p50, latency->p99, latency->p999, latency->max);
+}
+
+static void json_sample(FILE *out, const ReplaySample *sample, bool first) {
+    double fragmentation = sample->free_bytes ? 1.0 - (double)sample->largest_free_block / (double)sample->free_bytes : 0.0;
+    fprintf(out, "%s\n        {\"op\": %lu, \"bytes_in_use\": %lu, \"free_bytes\": %lu, \"free_blocks\": %lu, "
+            "\"largest_free_block\": %lu, \"tail_free\": %lu, \"fragmentation\": %.4f}", first ? "" : ",",
+            (unsigned long)sample->op, (unsigned long)sample->bytes_in_use, (unsigned long)sample->free_bytes,
+            (unsigned long)sample->free_blocks, (unsigned long)sample->largest_free_block, (unsigned long)sample->tail_free, fragmentation);
+}
+
+static void free_workers(ReplayWorker *workers, size_t threads) {
+    for (size_t t = 0; t < threads; t++) {
+        free(workers[t].arenas);
+        free(workers[t].slots);
+        for (size_t k = 0; k < OP_KIND_COUNT; k++) free(workers[t].latencies[k]);
+    }
+    free(workers);
+}
+
+/*
+ * Replay the trace on 'threads' threads and append its report to the JSON output
+ */
+static bool replay_trace(FILE *out, const ReplayTrace *trace, size_t threads, size_t iterations, uint64_t timer_overhead, bool first) {
+    ReplayWorker *workers = (ReplayWorker *)calloc(threads, sizeof(ReplayWorker));
+    if (!workers) return false;
+
+    bool ok = true;
+    for (size_t t = 0; t < threads && ok; t++) {
+        ReplayWorker *worker = &workers[t];
+        worker->trace = trace;
+        worker->iterations = iterations;
+        worker->timer_overhead = timer_overhead;
+        worker->sample = t == 0;
+        worker->arenas = (Arena **)calloc(trace->arenas, sizeof(Arena *));
+        worker->slots = (void **)calloc(trace->slots ? trace->slots : 1, sizeof(void *));
+        ok = worker->arenas && worker->slots;
+        for (size_t k = 0; k < OP_KIND_COUNT && ok; k++) {
+            worker->latencies[k] = (uint32_t *)malloc((trace->kind_counts[k] * iterations + 1) * sizeof(uint32_t));
+            ok = worker->latencies[k] != NULL;
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "%s: out of memory for %lu threads\n", trace->name, (unsigned long)threads);
+        free_workers(workers, threads);
+        return false;
+    }
+
+    bench_reset_peak_rss();
+    ok = run_phase(workers, threads, false);
+    size_t peak_rss = bench_peak_rss_bytes(); // Before the latency buffers are written
+    for (size_t t = 0; t < threads; t++) {
+        if (!workers[t].ok) ok = false;
+    }
+    if (ok) ok = run_phase(workers, threads, true);
+
+    uint64_t begin = UINT64_MAX;
+    uint64_t end = 0;
+    size_t failed = 0;
+    for (size_t t = 0; t < threads; t++) {
+        arena_free(workers[t].arenas[0]);
+        if (workers[t].begin < begin) begin = workers[t].begin;
+        if (workers[t].end > end) end = workers[t].end;
+        failed += workers[t].failed;
+    }
+    if (!ok) {
+        fprintf(stderr, "%s: cannot replay on %lu threads with %lu byte arenas\n", trace->name, (unsigned long)threads, (unsigned long)trace->arena_size);
+        free_workers(workers, threads);
+        return false;
+    }
+
+    // Every worker replays the whole trace, the throughput covers the span from the first start to the last end
+    double total_ops = (double)trace->count * (double)iterations * (double)threads;
+    double ops_per_second = end > begin ? total_ops * 1e9 / (double)(end - begin) : 0.0;
+    ReplayLatency all = collect_latency(workers, threads, OP_KIND_COUNT);
+
+    fprintf(out, "%s\n    {\n", first ? "" : ",");
+    fprintf(out, "      \"name\": \"%s\",\n", trace->name);
+    fprintf(out, "      \"operations\": %lu,\n", (unsigned long)trace->count);
+    fprintf(out, "      \"arena_size\": %lu,\n", (unsigned long)trace->arena_size);
+    fprintf(out, "      \"threads\": %lu,\n", (unsigned long)threads);
+    fprintf(out, "      \"iterations\": %lu,\n", (unsigned long)iterations);
+    fprintf(out, "      \"items_per_second\": %.1f,\n", ops_per_second);
+    fprintf(out, "      \"failed_operations\": %lu,\n", (unsigned long)failed);
+    if (peak_rss) fprintf(out, "      \"peak_rss_bytes\": %lu,\n", (unsigned long)peak_rss);
+    else fprintf(out, "      \"peak_rss_bytes\": null,\n");
+    fprintf(out, "      \"latency_ns\": {");
+    json_latency(out, "all", &all, true);
+    for (size_t k = 0; k < OP_KIND_COUNT; k++) {
+        ReplayLatency latency = collect_latency(workers, threads, k);
+        if (latency.count) json_latency(out, kind_names[k], &latency, false);
+    }
+    fprintf(out, "\n      },\n");
+    fprintf(out, "      \"fragmentation\": [");
+    for (size_t i = 0; i < workers[0].sample_count; i++) json_sample(out, &workers[0].samples[i], i == 0);
+    fprintf(out, "\n      ]\n    }");
+
+    const ReplaySample *last = &workers[0].samples[workers[0].sample_count - 1];
+    fprintf(stderr, "%-24s %2lu threads %12.0f ops/s  p50 %5u ns  p99 %6u ns  p999 %7u ns  peak RSS %7.1f MiB  %lu holes at the end\n",
+            trace->name, (unsigned long)threads, ops_per_second, all.p50, all.p99, all.p999,
+            (double)peak_rss / (1024.0 * 1024.0), (unsigned long)last->free_blocks);
+
+    free_workers(workers, threads);
+    return true;
+}
+
+/*
+ * Synthetic traces
+ * Emit the operation after checking it against the model, so generated traces always load
+ */
+typedef struct TraceGenerator {
+    FILE *out;
+    ReplayModel model;
+    uint32_t state;
+} TraceGenerator;
+
+static void emit(TraceGenerator *gen, uint32_t kind, uint32_t id, size_t size, size_t alignment, uint32_t arena) {
+    ReplayOp op;
+    op.kind = kind;
+    op.id = id;
+    op.arena = arena;
+    op.size = size;
+    op.alignment = alignment;
+    if (!model_apply(&gen->model, &op)) {
+        fprintf(stderr, "Generator emitted an invalid operation\n"); // LCOV_EXCL_LINE
+        exit(1);                                                      // LCOV_EXCL_LINE
+    }
+    write_op(gen->out, &op);
+}
+
+static bool is_live(const TraceGenerator *gen, uint32_t slot) {
+    return slot < gen->model.slot_capacity && gen->model.slot_live[slot];
+}
+
+static bool is_alive(const TraceGenerator *gen, uint32_t arena) {
+    return arena < gen->model.arena_capacity && gen->model.arena_live[arena];
+}
+
+/*
+ * Rounds of the complex allocation pattern of the stress test: mixed sizes, frees of every third,
+ *  half at random and every even object, allocations into the holes and a reset
+ */
+#define STRESS_OBJECTS (300)
+#define STRESS_ROUNDS (100)
+static void generate_stress_pattern(TraceGenerator *gen) {
+    static const size_t hole_sizes[5] = { 20, 60, 120, 30, 90 };
+
+    fprintf(gen->out, "# Complex allocation pattern of tests/stress_test.c, %d rounds with varying sizes\n", STRESS_ROUNDS);
+    fprintf(gen->out, "arena %u\n", 64u * 1024u);
+
+    for (uint32_t round = 0; round < STRESS_ROUNDS; round++) {
+        uint32_t allocated = 0;
+        size_t large_alignment = round % 4 == 0 ? 64 : 0;
+
+        for (uint32_t i = 0; i < 50; i++) emit(gen, OP_ALLOC, allocated++, 20 + (i * 7 + round) % 180, 0, 0);
+        for (uint32_t i = 0; i < allocated; i += 3) emit(gen, OP_FREE, i, 0, 0, 0);
+        for (uint32_t i = 0; i < 20; i++) emit(gen, OP_ALLOC, allocated++, 25 + (i * 3 + round) % 15, 0, 0);
+        for (uint32_t i = 0; i < 10; i++) emit(gen, OP_ALLOC, allocated++, 150 + (i * 17 + round) % 100, large_alignment, 0);
+
+        for (uint32_t i = 0; i < allocated / 2; i++) {
+            uint32_t index = (i * 17 + 11) % allocated;
+            if (is_live(gen, index)) emit(gen, OP_FREE, index, 0, 0, 0);
+        }
+        for (uint32_t i = 0; i < allocated; i += 2) {
+            if (is_live(gen, i)) emit(gen, OP_FREE, i, 0, 0, 0);
+        }
+
+        for (uint32_t i = 0; i < 30; i++) {
+            uint32_t slot = 0;
+            while (is_live(gen, slot)) slot++;
+            emit(gen, OP_ALLOC, slot, hole_sizes[i % 5], 0, 0);
+        }
+        emit(gen, OP_RESET, 0, 0, 0, 0);
+    }
+}
+
+/*
+ * Long running churn of a large live set with random sizes and occasional alignments, never reset.
+ *  Every few thousand steps the even slots are freed together and refilled bigger, which needs merged holes
+ */
+#define FRAG_LIVE (1500)
+#define FRAG_STEPS (7000)
+#define FRAG_PHASE (2500)
+static size_t random_size(TraceGenerator *gen) {
+    uint32_t r = bench_rand(&gen->state);
+    return 16 + bench_rand(&gen->state) % ((r % 8 == 0) ? 2048 : 192);
+}
+
+static void generate_fragmentation(TraceGenerator *gen) {
+    fprintf(gen->out, "# Fragmentation stress of tests/stress_test.c: random churn of %d live blocks, no reset\n", FRAG_LIVE);
+    fprintf(gen->out, "arena %u\n", 4u * 1024u * 1024u);
+
+    for (uint32_t slot = 0; slot < FRAG_LIVE; slot++) emit(gen, OP_ALLOC, slot, random_size(gen), 0, 0);
+
+    for (uint32_t step = 1; step <= FRAG_STEPS; step++) {
+        uint32_t slot = bench_rand(&gen->state) % FRAG_LIVE;
+        size_t alignment = bench_rand(&gen->state) % 16 == 0 ? 64 : 0;
+        emit(gen, OP_FREE, slot, 0, 0, 0);
+        emit(gen, OP_ALLOC, slot, random_size(gen), alignment, 0);
+
+        if (step % FRAG_PHASE == 0) {
+            for (uint32_t even = 0; even < FRAG_LIVE; even += 2) emit(gen, OP_FREE, even, 0, 0, 0);
+            for (uint32_t even = 0; even < FRAG_LIVE; even += 2) emit(gen, OP_ALLOC, even, random_size(gen) * 2, 0, 0);
+        }
+    }
+}
+
+/*
+ * Requests served by short lived nested session arenas next to long lived root blocks.
+ *  Some sessions open a child arena, sessions close in random order and the root is reset periodically
+ */
+#define SESSION_COUNT (8)
+#define SESSION_SLOTS (48)
+#define SESSION_REQUESTS (300)
+#define SESSION_RESET (60)
+#define ROOT_SLOTS (64)
+static void generate_nested_sessions(TraceGenerator *gen) {
+    fprintf(gen->out, "# Nested session arenas of tests/arena_nested_test.c with the churn of tests/stress_test.c\n");
+    fprintf(gen->out, "arena %u\n", 1024u * 1024u);
+
+    uint32_t root_base = (SESSION_COUNT * 2 + 1) * SESSION_SLOTS;
+    for (uint32_t request = 1; request <= SESSION_REQUESTS; request++) {
+        uint32_t session = 1 + bench_rand(&gen->state) % SESSION_COUNT;
+        uint32_t child = session + SESSION_COUNT;
+        if (!is_alive(gen, session)) emit(gen, OP_NEW_NESTED, session, 24 * 1024 + (bench_rand(&gen->state) % 4) * 8 * 1024, 0, 0);
+
+        // The request allocates in its session and frees part of it again
+        uint32_t blocks = 8 + bench_rand(&gen->state) % 24;
+        for (uint32_t i = 0; i < blocks; i++) {
+            uint32_t slot = session * SESSION_SLOTS + bench_rand(&gen->state) % SESSION_SLOTS;
+            if (is_live(gen, slot)) emit(gen, OP_FREE, slot, 0, 0, 0);
+            else emit(gen, OP_ALLOC, slot, 16 + bench_rand(&gen->state) % 240, 0, session);
+        }
+
+        if (request % 4 == 0 && !is_alive(gen, child)) emit(gen, OP_NEW_NESTED, child, 4096, 0, session);
+        if (is_alive(gen, child)) {
+            for (uint32_t i = 0; i < 4; i++) {
+                uint32_t slot = child * SESSION_SLOTS + i;
+                if (!is_live(gen, slot)) emit(gen, OP_ALLOC, slot, 32 + bench_rand(&gen->state) % 96, 16, child);
+            }
+            if (bench_rand(&gen->state) % 3 == 0) emit(gen, OP_FREE_NESTED, child, 0, 0, 0);
+        }
+
+        // Long lived state of the root
+        uint32_t root_slot = root_base + bench_rand(&gen->state) % ROOT_SLOTS;
+        if (is_live(gen, root_slot)) emit(gen, OP_FREE, root_slot, 0, 0, 0);
+        emit(gen, OP_ALLOC, root_slot, 64 + bench_rand(&gen->state) % 1024, 0, 0);
+
+        if (bench_rand(&gen->state) % 3 == 0) emit(gen, OP_FREE_NESTED, session, 0, 0, 0); // Also drops its child
+        if (request % SESSION_RESET == 0) emit(gen, OP_RESET, 0, 0, 0, 0);
+    }
+}
+
+typedef struct TraceRecipe {
+    const char *name;
+    void (*generate)(TraceGenerator *gen);
+} TraceRecipe;
+
+static const TraceRecipe recipes[] = {
+    { "stress_pattern", generate_stress_pattern },
+    { "fragmentation", generate_fragmentation },
+    { "nested_sessions", generate_nested_sessions },
+};
+
+static int generate(const char *name) {
+    for (size_t i = 0; i < sizeof(recipes) / sizeof(recipes[0]); i++) {
+        if (strcmp(recipes[i].name, name) != 0) continue;
+
+        TraceGenerator gen;
+        gen.out = stdout;
+        gen.state = 0x2545F491u;
+        if (!model_init(&gen.model)) return 1;
+        recipes[i].generate(&gen);
+        model_free(&gen.model);
+        return 0;
+    }
+    fprintf(stderr, "Unknown synthetic trace %s\n", name);
+    return 1;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-t threads] [-i iterations] [-o report.json] trace...\n", program);
+    fprintf(stderr, "       %s -g name > trace, writes a synthetic trace:", program);
+    for (size_t i = 0; i < sizeof(recipes) / sizeof(recipes[0]); i++) fprintf(stderr, " %s", recipes[i].name);
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv) {
+    size_t threads = 1;
+    size_t iterations = REPLAY_ITERATIONS;
+    const char *out_path = NULL;
+    int first_trace = argc;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) return generate(argv[i + 1]);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) threads = (size_t)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) iterations = (size_t)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) out_path = argv[++i];
+        else if (argv[i][0] == '-') break;
+        else {
+            first_trace = i;
+            break;
+        }
+    }
+    if (first_trace >= argc || threads == 0 || threads > REPLAY_MAX_THREADS || iterations == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *out = stdout;
+    if (out_path) {
+        out = fopen(out_path, "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open %s for writing\n", out_path);
+            return 1;
+        }
+    }
+
+    uint64_t timer_overhead = measure_timer_overhead();
+    fprintf(out, "{\n");
+    fprintf(out, "  \"context\": {\n");
+    fprintf(out, "    \"suite\": \"replay_bench\",\n");
+    fprintf(out, "    \"allocator\": \"%s\",\n", BENCH_ARENA_NAME);
+    fprintf(out, "    \"threads\": %lu,\n", (unsigned long)threads);
+    fprintf(out, "    \"iterations\": %lu,\n", (unsigned long)iterations);
+    fprintf(out, "    \"timer_overhead_ns\": %lu,\n", (unsigned long)timer_overhead);
+    fprintf(out, "    \"pointer_size\": %u\n", (unsigned)sizeof(void *));
+    fprintf(out, "  },\n");
+    fprintf(out, "  \"traces\": [");
+
+    int status = 0;
+    bool first = true;
+    for (int i = first_trace; i < argc; i++) {
+        ReplayTrace trace;
+        if (!trace_load(argv[i], &trace)) {
+            status = 1;
+            continue;
+        }
+        if (replay_trace(out, &trace, threads, iterations, timer_overhead, first)) first = false;
+        else status = 1;
+        trace_free(&trace);
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout) fclose(out);
+    return status;
+}
@@ -0,0 +1,142 @@
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (1024 * 1024)
+#define PAGE (4096)
+#define BIG_ALIGNMENT (64 * 1024)
+#define BUFFER_SIZE (1024)
+#define CHURN_SLOTS (32)
+#define CHURN_CYCLES (5000)
+
+static bool is_aligned(const void *ptr, size_t alignment) {
+    return ((uintptr_t)ptr & (alignment - 1)) == 0;
+}
+
+void test_aligned_limits(void) {
+    TEST_PHASE("Allocation Alignment Limits");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Alignments above the arena maximum");
+    void *page = arena_alloc_custom(arena, BUFFER_SIZE, PAGE);
+    ASSERT(page != NULL && is_aligned(page, PAGE), "Page aligned buffer should be served");
+    void *big = arena_alloc_custom(arena, BUFFER_SIZE, BIG_ALIGNMENT);
+    ASSERT(big != NULL && is_aligned(big, BIG_ALIGNMENT), "64KB aligned buffer should be served");
+    ASSERT(arena_try_resize(big, BUFFER_SIZE * 2), "Aligned block should be a regular occupied block");
+
+    TEST_CASE("Invalid alignments");
+    ASSERT(arena_alloc_custom(arena, BUFFER_SIZE, MAX_ALLOC_ALIGNMENT * 2) == NULL, "Alignment above the limit should fail");
+    ASSERT(arena_alloc_custom(arena, BUFFER_SIZE, PAGE + 8) == NULL, "Alignment must be a power of two");
+    ASSERT(arena_new_dynamic_custom(ARENA_SIZE, PAGE) == NULL, "Arena alignment is still limited to MAX_ALIGNMENT");
+
+    TEST_CASE("Freeing aligned blocks restores the arena");
+    arena_reset(arena);
+    size_t initial_tail = free_size_in_tail(arena);
+    void *blocks[8];
+    for (int i = 0; i < 8; i++) blocks[i] = arena_alloc_custom(arena, BUFFER_SIZE, PAGE << (i % 3));
+    for (int i = 0; i < 8; i++) arena_free_block(blocks[i]);
+    ASSERT(free_size_in_tail(arena) == initial_tail && arena_get_free_blocks(arena) == NULL, "Arena should be one tail again");
+
+    arena_free(arena);
+}
+
+void test_aligned_reuse(void) {
+    TEST_PHASE("Aligned Allocation From Free Blocks");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Hole big enough for the worst case is used");
+    char *hole = (char *)arena_alloc(arena, PAGE * 3);
+    void *guard = arena_alloc(arena, 64);
+    arena_free_block(hole);
+    char *aligned = (char *)arena_alloc_custom(arena, BUFFER_SIZE, PAGE);
+    ASSERT(aligned >= hole && aligned + BUFFER_SIZE <= hole + PAGE * 3, "Buffer should come from the hole, not the tail");
+    ASSERT(is_aligned(aligned, PAGE), "Buffer should be page aligned");
+
+    TEST_CASE("Padding in front of the buffer stays usable");
+    size_t front_room = (size_t)(aligned - hole);
+    char *front = (char *)arena_alloc(arena, 64);
+    ASSERT(front_room < sizeof(Block) + 64 || (front >= hole && front < aligned), "Front padding should serve small requests");
+
+    TEST_CASE("Freed buffer merges with its neighbours");
+    arena_reset(arena);
+    size_t initial_tail = free_size_in_tail(arena);
+    hole = (char *)arena_alloc(arena, PAGE * 3);
+    guard = arena_alloc(arena, 64);
+    arena_free_block(hole);
+    aligned = (char *)arena_alloc_custom(arena, BUFFER_SIZE, PAGE);
+    arena_free_block(aligned);
+    arena_free_block(guard);
+    ASSERT(free_size_in_tail(arena) == initial_tail && arena_get_free_blocks(arena) == NULL, "Arena should be one tail again");
+
+    arena_free(arena);
+}
+
+void test_aligned_churn(void) {
+    TEST_PHASE("Aligned Buffer Churn");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE * 4);
+    size_t initial_tail = free_size_in_tail(arena);
+    void *slots[CHURN_SLOTS] = {0};
+    size_t sizes[CHURN_SLOTS] = {0};
+    bool intact = true;
+    bool aligned = true;
+    srand(23);
+
+    TEST_CASE("Mixed aligned and plain blocks keep their data");
+    for (int i = 0; i < CHURN_CYCLES; i++) {
+        int slot = rand() % CHURN_SLOTS;
+        if (slots[slot]) {
+            if (!verify_memory_pattern(slots[slot], sizes[slot], slot)) intact = false;
+            arena_free_block(slots[slot]);
+            slots[slot] = NULL;
+            continue;
+        }
+
+        sizes[slot] = (size_t)(rand() % 16 + 1) * 256;
+        if (slot % 2 == 0) {
+            size_t alignment = (size_t)PAGE << (rand() % 5);
+            slots[slot] = arena_alloc_custom(arena, sizes[slot], alignment);
+            if (slots[slot] && !is_aligned(slots[slot], alignment)) aligned = false;
+        }
+        else {
+            slots[slot] = arena_alloc(arena, sizes[slot]);
+        }
+        if (slots[slot]) fill_memory_pattern(slots[slot], sizes[slot], slot);
+    }
+    ASSERT(intact, "Live blocks should keep their patterns");
+    ASSERT(aligned, "Every aligned block should honor its alignment");
+
+    TEST_CASE("Freeing everything restores the tail");
+    for (int i = 0; i < CHURN_SLOTS; i++) {
+        if (slots[i]) arena_free_block(slots[i]);
+    }
+    ASSERT(free_size_in_tail(arena) == initial_tail && arena_get_free_blocks(arena) == NULL, "Arena should be empty again");
+
+    arena_free(arena);
+}
+
+void test_aligned_growable(void) {
+    TEST_PHASE("Aligned Allocation in Growable Arenas");
+
+    Arena *arena = arena_new_dynamic_growable(PAGE);
+
+    TEST_CASE("New chunk is big enough for the padding");
+    void *big = arena_alloc_custom(arena, BUFFER_SIZE, BIG_ALIGNMENT);
+    ASSERT(big != NULL && is_aligned(big, BIG_ALIGNMENT), "Growable arena should grow for an aligned request");
+
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_aligned_limits();
+    test_aligned_reuse();
+    test_aligned_churn();
+    test_aligned_growable();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -136,11 +136,69 @@ void test_nested_freeing(void) {
     ASSERT(true, "Parent arena should be freed successfully");
 }
 
+void test_nested_owner_lookup(void) {
+    TEST_PHASE("Nested Arena Owner Lookup");
+
+    #define NESTED_COUNT 256
+    size_t nested_size = 256;
+    Arena *parent_arena = arena_new_dynamic(NESTED_COUNT * (nested_size + sizeof(Block)) + 4096);
+    ASSERT(parent_arena != NULL, "Parent arena should be created successfully");
+    size_t parent_free_before = free_size_in_tail(parent_arena);
+
+    TEST_CASE("Nested arena remembers its parent");
+    Arena *nested[NESTED_COUNT] = {0};
+    bool all_created = true;
+    for (int i = 0; i < NESTED_COUNT; i++) {
+        nested[i] = arena_new_nested(parent_arena, nested_size);
+        if (!nested[i] || get_parent_arena(nested[i]) != parent_arena) all_created = false;
+    }
+    ASSERT(all_created, "Every nested arena should link back to its parent");
+
+    TEST_CASE("Freeing behind free neighbours and nested arenas");
+    // Free every other arena first, so the rest sit behind free blocks and nested arenas
+    for (int i = 0; i < NESTED_COUNT; i += 2) arena_free(nested[i]);
+    for (int i = NESTED_COUNT - 1; i > 0; i -= 2) arena_free(nested[i]);
+    ASSERT(free_size_in_tail(parent_arena) == parent_free_before, "Parent arena should be fully restored");
+
+    TEST_CASE("Nested arena inside nested arena");
+    Arena *outer = arena_new_nested(parent_arena, 2048);
+    Arena *inner = arena_new_nested(outer, 512);
+    ASSERT(inner != NULL && get_parent_arena(inner) == outer, "Inner arena should link to the outer one");
+    ASSERT(get_parent_arena(outer) == parent_arena, "Outer arena should link to the parent");
+    size_t outer_tail = free_size_in_tail(outer);
+    arena_free(inner);
+    ASSERT(free_size_in_tail(outer) > outer_tail, "Inner arena should be returned to the outer one");
+    arena_free(outer);
+    ASSERT(free_size_in_tail(parent_arena) == parent_free_before, "Outer arena should be returned to the parent");
+
+    TEST_CASE("Nested arena in a slightly bigger free block");
+    void *hole = arena_alloc(parent_arena, 1024 + 16); // Too little over the request to be split off
+    void *guard = arena_alloc(parent_arena, 1024);
+    arena_free_block(hole);
+    Arena *snug = arena_new_nested(parent_arena, 1024);
+    ASSERT((char *)snug == (char *)hole - sizeof(Block), "Nested arena should take the free block");
+    ArenaStats stats;
+    arena_get_stats(parent_arena, &stats);
+    ASSERT(stats.occupied_blocks == 2 && stats.free_blocks == 0, "Parent should still walk its blocks");
+    arena_free(snug);
+    arena_free_block(guard);
+    ASSERT(free_size_in_tail(parent_arena) == parent_free_before, "Whole block should be returned to the parent");
+
+    TEST_CASE("Too small nested arena is rejected without leaking");
+    Arena *tiny = arena_new_nested(parent_arena, BLOCK_MIN_SIZE);
+    ASSERT(tiny == NULL, "Nested arena without room for its header should fail");
+    ASSERT(free_size_in_tail(parent_arena) == parent_free_before, "Failed creation should give the block back");
+
+    arena_free(parent_arena);
+    #undef NESTED_COUNT
+}
+
 int main(void) {
     setvbuf(stdout, NULL, _IONBF, 0); 
 
     test_nested_creation();
     test_nested_freeing();
+    test_nested_owner_lookup();
 
     // Print test summary
     print_test_summary();
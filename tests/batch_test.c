@@ -0,0 +1,193 @@
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (16384)
+#define NODE_SIZE (40)
+#define NODE_COUNT (64)
+
+static size_t count_free_blocks(Block *node) {
+    if (!node) return 0;
+    return 1 + count_free_blocks(get_left_tree(node)) + count_free_blocks(get_right_tree(node));
+}
+
+void test_alloc_batch(void) {
+    TEST_PHASE("Batch Allocation");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    Arena *reference = arena_new_dynamic(ARENA_SIZE);
+    void *nodes[NODE_COUNT] = {0};
+
+    TEST_CASE("Invalid parameters");
+    ASSERT(arena_alloc_batch(NULL, NODE_SIZE, NODE_COUNT, nodes) == 0, "NULL arena should allocate nothing");
+    ASSERT(arena_alloc_batch(arena, 0, NODE_COUNT, nodes) == 0, "Zero size should allocate nothing");
+    ASSERT(arena_alloc_batch(arena, NODE_SIZE, NODE_COUNT, NULL) == 0, "NULL output should allocate nothing");
+    ASSERT(arena_alloc_batch(arena, NODE_SIZE, 0, nodes) == 0, "Zero count should allocate nothing");
+
+    TEST_CASE("Batch is carved from the tail");
+    size_t allocated = arena_alloc_batch(arena, NODE_SIZE, NODE_COUNT, nodes);
+    ASSERT(allocated == NODE_COUNT, "Whole batch should be allocated");
+    for (int i = 0; i < NODE_COUNT; i++) arena_alloc(reference, NODE_SIZE);
+    ASSERT(free_size_in_tail(arena) == free_size_in_tail(reference), "Batch should use exactly as much memory as single allocations");
+
+    bool aligned = true;
+    bool increasing = true;
+    for (int i = 0; i < NODE_COUNT; i++) {
+        if (((uintptr_t)nodes[i] % ARENA_DEFAULT_ALIGNMENT) != 0) aligned = false;
+        if (i > 0 && nodes[i] <= nodes[i - 1]) increasing = false;
+        fill_memory_pattern(nodes[i], NODE_SIZE, i);
+    }
+    ASSERT(aligned, "Every node should have the arena alignment");
+    ASSERT(increasing, "Nodes should follow each other in memory");
+
+    bool intact = true;
+    for (int i = 0; i < NODE_COUNT; i++) {
+        if (!verify_memory_pattern(nodes[i], NODE_SIZE, i)) intact = false;
+    }
+    ASSERT(intact, "Nodes should not overlap");
+
+    TEST_CASE("Batch nodes are regular blocks");
+    arena_free_block(nodes[NODE_COUNT - 1]);
+    ASSERT(arena_alloc(arena, NODE_SIZE) == nodes[NODE_COUNT - 1], "Freed node should be reused");
+
+    TEST_CASE("Batch is carved from one free block");
+    void *big = arena_alloc(arena, NODE_COUNT * 64);
+    void *guard = arena_alloc(arena, NODE_SIZE);
+    arena_free_block(big);
+    size_t tail_before = free_size_in_tail(arena);
+    allocated = arena_alloc_batch(arena, NODE_SIZE, NODE_COUNT / 2, nodes);
+    ASSERT(allocated == NODE_COUNT / 2, "Batch should fit in the free block");
+    ASSERT(nodes[0] == big, "Batch should start at the free block");
+    ASSERT(free_size_in_tail(arena) == tail_before, "Tail should stay untouched");
+    ASSERT(arena_get_free_blocks(arena) != NULL && count_free_blocks(arena_get_free_blocks(arena)) == 1, "Rest of the free block should go back to the tree");
+
+    TEST_CASE("Batch bigger than the arena is partial");
+    arena_reset(arena);
+    static void *many[ARENA_SIZE / 32];
+    allocated = arena_alloc_batch(arena, NODE_SIZE, ARENA_SIZE / 32, many);
+    ASSERT(allocated > 0 && allocated < ARENA_SIZE / 32, "Only the nodes that fit should be allocated");
+    ASSERT(arena_alloc(arena, NODE_SIZE) == NULL, "Arena should be exhausted");
+    for (size_t i = 0; i < allocated; i++) fill_memory_pattern(many[i], NODE_SIZE, (int)i);
+    intact = true;
+    for (size_t i = 0; i < allocated; i++) {
+        if (!verify_memory_pattern(many[i], NODE_SIZE, (int)i)) intact = false;
+    }
+    ASSERT(intact, "Partial batch should be usable up to the last node");
+
+    TEST_CASE("Batch honors custom arena alignment");
+    Arena *aligned_arena = arena_new_dynamic_custom(ARENA_SIZE, 64);
+    allocated = arena_alloc_batch(aligned_arena, NODE_SIZE, NODE_COUNT, nodes);
+    aligned = allocated == NODE_COUNT;
+    for (size_t i = 0; i < allocated; i++) {
+        if (((uintptr_t)nodes[i] % 64) != 0) aligned = false;
+    }
+    ASSERT(aligned, "Every node should have the custom alignment");
+    arena_free(aligned_arena);
+
+    TEST_CASE("Growable arena spreads the batch over chunks");
+    Arena *growable = arena_new_dynamic_growable(1024);
+    allocated = arena_alloc_batch(growable, NODE_SIZE, NODE_COUNT, nodes);
+    ASSERT(allocated == NODE_COUNT, "Growable arena should grow to fit the batch");
+    ASSERT(arena_get_chunk(growable)->next != NULL, "Batch should have chained a new chunk");
+    arena_free(growable);
+
+    (void)guard;
+    arena_free(reference);
+    arena_free(arena);
+}
+
+void test_free_batch(void) {
+    TEST_PHASE("Batch Free");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    size_t initial_tail = free_size_in_tail(arena);
+    void *nodes[NODE_COUNT] = {0};
+
+    TEST_CASE("Invalid parameters");
+    arena_free_batch(NULL, NODE_COUNT);
+    arena_free_batch(nodes, 0);
+    ASSERT(true, "NULL batch and zero count should be ignored");
+
+    TEST_CASE("Adjacent nodes coalesce into one free block");
+    arena_alloc_batch(arena, NODE_SIZE, NODE_COUNT, nodes);
+    void *guard = arena_alloc(arena, NODE_SIZE);
+    void *first = nodes[0];
+    // Reverse half of the nodes, the batch sorts them anyway
+    for (int i = 0; i < NODE_COUNT / 4; i++) {
+        void *tmp = nodes[i];
+        nodes[i] = nodes[NODE_COUNT / 2 - 1 - i];
+        nodes[NODE_COUNT / 2 - 1 - i] = tmp;
+    }
+    arena_free_batch(nodes, NODE_COUNT / 2);
+    ASSERT(count_free_blocks(arena_get_free_blocks(arena)) == 1, "Freed run should become a single free block");
+    void *reused = arena_alloc(arena, (char *)nodes[NODE_COUNT / 2] - (char *)first - sizeof(Block));
+    ASSERT(reused == first, "Coalesced block should serve a request spanning the whole run");
+    arena_free_block(reused);
+
+    TEST_CASE("Runs separated by live blocks stay separate");
+    arena_free_block(guard);
+    arena_reset(arena);
+    arena_alloc_batch(arena, NODE_SIZE, NODE_COUNT, nodes);
+    guard = arena_alloc(arena, NODE_SIZE);
+    void *odd[NODE_COUNT / 2] = {0};
+    void *even[NODE_COUNT / 2] = {0};
+    for (int i = 0; i < NODE_COUNT / 2; i++) {
+        even[i] = nodes[2 * i];
+        odd[i] = nodes[2 * i + 1];
+    }
+    arena_free_batch(even, NODE_COUNT / 2);
+    ASSERT(count_free_blocks(arena_get_free_blocks(arena)) == NODE_COUNT / 2, "Every second node should be its own free block");
+
+    TEST_CASE("Freeing the rest merges everything back");
+    arena_free_batch(odd, NODE_COUNT / 2);
+    ASSERT(count_free_blocks(arena_get_free_blocks(arena)) == 1, "Whole batch should coalesce into one free block");
+    arena_free_block(guard);
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Everything should merge into the tail");
+    ASSERT(free_size_in_tail(arena) == initial_tail, "Arena should be fully restored");
+
+    TEST_CASE("NULL, foreign and duplicate pointers are skipped");
+    arena_alloc_batch(arena, NODE_SIZE, 8, nodes);
+    guard = arena_alloc(arena, NODE_SIZE);
+    char foreign[64] = {0};
+    void *mixed[12] = { nodes[3], NULL, nodes[0], foreign + 16, nodes[3], nodes[1], nodes[2], nodes[0], nodes[4], nodes[5], nodes[6], nodes[7] };
+    arena_free_batch(mixed, 12);
+    ASSERT(count_free_blocks(arena_get_free_blocks(arena)) == 1, "Duplicates should not corrupt the free block");
+    arena_free_batch(mixed, 12);
+    ASSERT(count_free_blocks(arena_get_free_blocks(arena)) == 1, "Freeing the batch again should be rejected");
+    arena_free_block(guard);
+    ASSERT(free_size_in_tail(arena) == initial_tail, "Arena should be fully restored");
+
+    TEST_CASE("Batch filling the whole arena");
+    Arena *small = arena_new_dynamic(1024);
+    size_t small_tail = free_size_in_tail(small);
+    static void *all[1024 / 32];
+    size_t allocated = arena_alloc_batch(small, NODE_SIZE, 1024 / 32, all);
+    ASSERT(allocated > 0 && arena_alloc(small, NODE_SIZE) == NULL, "Batch should use the whole arena");
+    arena_free_batch(all, allocated);
+    ASSERT(free_size_in_tail(small) == small_tail && arena_get_free_blocks(small) == NULL, "Everything should return to the tail");
+    arena_free(small);
+
+    TEST_CASE("Blocks of several arenas in one batch");
+    Arena *other = arena_new_dynamic(ARENA_SIZE);
+    size_t other_tail = free_size_in_tail(other);
+    void *mine[4], *theirs[4];
+    arena_alloc_batch(arena, NODE_SIZE, 4, mine);
+    arena_alloc_batch(other, NODE_SIZE, 4, theirs);
+    void *both[8] = { mine[0], theirs[0], mine[1], theirs[1], mine[2], theirs[2], mine[3], theirs[3] };
+    arena_free_batch(both, 8);
+    ASSERT(free_size_in_tail(arena) == initial_tail, "First arena should be fully restored");
+    ASSERT(free_size_in_tail(other) == other_tail, "Second arena should be fully restored");
+    arena_free(other);
+
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_alloc_batch();
+    test_free_batch();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
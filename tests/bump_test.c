@@ -0,0 +1,117 @@
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (16384)
+#define REGION_SIZE (4096)
+#define OBJECT_SIZE (24)
+#define OBJECT_COUNT (100)
+
+void test_bump_creation(void) {
+    TEST_PHASE("Bump Region Creation");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    size_t parent_tail = free_size_in_tail(arena);
+
+    TEST_CASE("Invalid parameters");
+    ASSERT(arena_bump_new(NULL, REGION_SIZE) == NULL, "NULL parent should fail");
+    ASSERT(arena_bump_new(arena, 0) == NULL, "Zero size should fail");
+    ASSERT(arena_bump_new_custom(arena, REGION_SIZE, 24) == NULL, "Non power of two alignment should fail");
+    ASSERT(arena_bump_new_custom(arena, REGION_SIZE, MAX_ALIGNMENT * 2) == NULL, "Too big alignment should fail");
+    ASSERT(arena_bump_new(arena, ARENA_SIZE * 2) == NULL, "Region bigger than the parent should fail");
+    ASSERT(free_size_in_tail(arena) == parent_tail, "Failed creations should not touch the parent");
+
+    TEST_CASE("Region is carved from the parent");
+    ArenaBump *bump = arena_bump_new(arena, REGION_SIZE);
+    ASSERT(bump != NULL, "Region creation should succeed");
+    ASSERT(bump->parent == arena, "Region should remember its parent");
+    ASSERT(bump->end - bump->cursor >= REGION_SIZE, "Region should provide the requested capacity");
+    ASSERT(free_size_in_tail(arena) < parent_tail - REGION_SIZE, "Region should occupy parent memory");
+
+    TEST_CASE("Freeing the region returns it to the parent");
+    arena_bump_free(bump);
+    ASSERT(free_size_in_tail(arena) == parent_tail, "Parent should be fully restored");
+
+    TEST_CASE("Static region");
+    char buffer[512];
+    ASSERT(arena_bump_new_static(NULL, sizeof(buffer)) == NULL, "NULL memory should fail");
+    ASSERT(arena_bump_new_static(buffer, sizeof(ArenaBump) - 1) == NULL, "Memory smaller than the header should fail");
+    ArenaBump *static_bump = arena_bump_new_static(buffer + 1, sizeof(buffer) - 1);
+    ASSERT(static_bump != NULL && ((uintptr_t)static_bump % MIN_ALIGNMENT) == 0, "Unaligned memory should be aligned for the header");
+    ASSERT(static_bump->end == (uintptr_t)buffer + sizeof(buffer), "Static region should end with the buffer");
+    void *p = arena_bump_alloc(static_bump, 64);
+    ASSERT(p != NULL && ((uintptr_t)p % ARENA_DEFAULT_ALIGNMENT) == 0, "Static region should serve aligned allocations");
+    arena_bump_free(static_bump);
+    ASSERT(true, "Freeing a static region should be a no-op");
+
+    arena_free(arena);
+}
+
+void test_bump_allocation(void) {
+    TEST_PHASE("Bump Region Allocation");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Word aligned region packs objects without headers");
+    ArenaBump *bump = arena_bump_new_custom(arena, REGION_SIZE, sizeof(uintptr_t));
+    uintptr_t start = bump->cursor;
+    void *objects[OBJECT_COUNT] = {0};
+    for (int i = 0; i < OBJECT_COUNT; i++) {
+        objects[i] = arena_bump_alloc(bump, OBJECT_SIZE);
+        ASSERT_QUIET(objects[i] != NULL, "Allocation should succeed");
+        fill_memory_pattern(objects[i], OBJECT_SIZE, i);
+    }
+    ASSERT(bump->cursor - start == OBJECT_COUNT * OBJECT_SIZE, "Objects should take exactly their own size");
+    ASSERT((char *)objects[1] - (char *)objects[0] == OBJECT_SIZE, "Objects should be adjacent");
+    bool intact = true;
+    for (int i = 0; i < OBJECT_COUNT; i++) {
+        if (!verify_memory_pattern(objects[i], OBJECT_SIZE, i)) intact = false;
+    }
+    ASSERT(intact, "Objects should not overlap");
+
+    TEST_CASE("Custom alignment per allocation");
+    void *byte = arena_bump_alloc_custom(bump, 1, 1);
+    void *wide = arena_bump_alloc_custom(bump, 32, 256);
+    ASSERT(byte != NULL && (uintptr_t)byte == start + OBJECT_COUNT * OBJECT_SIZE, "Byte alignment should not pad");
+    ASSERT(wide != NULL && ((uintptr_t)wide % 256) == 0, "Over-aligned allocation should be aligned");
+    ASSERT(arena_bump_alloc_custom(bump, 32, 3) == NULL, "Invalid alignment should fail");
+    ASSERT(arena_bump_alloc(bump, 0) == NULL, "Zero size should fail");
+    ASSERT(arena_bump_alloc(NULL, 8) == NULL, "NULL region should fail");
+
+    TEST_CASE("Exhausted region fails without touching the parent");
+    size_t parent_tail = free_size_in_tail(arena);
+    ASSERT(arena_bump_alloc(bump, REGION_SIZE) == NULL, "Allocation bigger than the rest should fail");
+    size_t rest = bump->end - bump->cursor;
+    ASSERT(arena_bump_alloc_custom(bump, rest, 1) != NULL, "Rest of the region should be usable");
+    ASSERT(bump->cursor == bump->end, "Region should be full");
+    ASSERT(arena_bump_alloc_custom(bump, 1, 1) == NULL, "Full region should fail");
+    ASSERT(free_size_in_tail(arena) == parent_tail, "Parent should never be touched by region allocations");
+
+    TEST_CASE("Reset releases everything at once");
+    arena_bump_reset(bump);
+    ASSERT(bump->cursor == start, "Cursor should go back to the start");
+    ASSERT(arena_bump_alloc(bump, OBJECT_SIZE) == objects[0], "First allocation after reset should reuse the start");
+
+    TEST_CASE("Region inside a nested arena");
+    Arena *nested = arena_new_nested(arena, 2048);
+    size_t nested_tail = free_size_in_tail(nested);
+    ArenaBump *inner = arena_bump_new(nested, 512);
+    ASSERT(inner != NULL && inner->parent == nested, "Region should be carved from the nested arena");
+    ASSERT(arena_bump_alloc(inner, 128) != NULL, "Region in nested arena should serve allocations");
+    arena_bump_free(inner);
+    ASSERT(free_size_in_tail(nested) == nested_tail, "Nested arena should be fully restored");
+    arena_free(nested);
+
+    arena_bump_free(bump);
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_bump_creation();
+    test_bump_allocation();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
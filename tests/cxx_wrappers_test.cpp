@@ -0,0 +1,265 @@
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#define ARENA_SIZE (4 * 1024 * 1024)
+#define CHURN_KEYS (2000)
+#define CHURN_ROUNDS (20)
+
+static size_t occupied_blocks(Arena *arena) {
+    ArenaStats stats;
+    arena_get_stats(arena, &stats);
+    return stats.occupied_blocks;
+}
+
+static bool is_inside(Arena *arena, const void *ptr) {
+    return (const char *)ptr > (const char *)arena && (const char *)ptr < (const char *)arena + arena_get_capacity(arena);
+}
+
+struct Tracked {
+    static int alive;
+    int value;
+    explicit Tracked(int v) : value(v) { alive++; }
+    ~Tracked() { alive--; }
+};
+int Tracked::alive = 0;
+
+struct alignas(64) Wide {
+    char bytes[64];
+};
+
+void test_allocator(void) {
+    TEST_PHASE("Standard Allocator");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    size_t baseline = occupied_blocks(arena);
+
+    TEST_CASE("Vector grows inside the arena");
+    {
+        std::vector<int, ArenaAllocator<int>> values{ArenaAllocator<int>(arena)};
+        for (int i = 0; i < 10000; i++) values.push_back(i * 3);
+        bool intact = true;
+        for (int i = 0; i < 10000; i++) intact &= values[(size_t)i] == i * 3;
+        ASSERT(intact, "Vector should keep every element across reallocations");
+        ASSERT(is_inside(arena, values.data()), "Vector storage should come from the arena");
+    }
+    ASSERT(occupied_blocks(arena) == baseline, "Destroyed vector should give its blocks back");
+
+    TEST_CASE("Unordered map churn");
+    {
+        typedef std::pair<const int, int> Entry;
+        std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, ArenaAllocator<Entry>> map(
+            16, std::hash<int>(), std::equal_to<int>(), ArenaAllocator<Entry>(arena));
+        std::map<int, int> expected;
+        unsigned seed = 17;
+        for (int round = 0; round < CHURN_ROUNDS; round++) {
+            for (int i = 0; i < CHURN_KEYS; i++) {
+                seed = seed * 1103515245u + 12345u;
+                int key = (int)((seed >> 16) % (CHURN_KEYS * 2));
+                if (seed & 0x100) {
+                    map[key] = round;
+                    expected[key] = round;
+                }
+                else {
+                    map.erase(key);
+                    expected.erase(key);
+                }
+            }
+        }
+        bool same = map.size() == expected.size();
+        for (std::map<int, int>::const_iterator it = expected.begin(); same && it != expected.end(); ++it) {
+            std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, ArenaAllocator<Entry>>::const_iterator found = map.find(it->first);
+            same = found != map.end() && found->second == it->second;
+        }
+        ASSERT(same, "Map should match the reference after inserts and erases");
+    }
+    ASSERT(occupied_blocks(arena) == baseline, "Destroyed map should give its nodes back");
+
+    TEST_CASE("Rebound copies share the arena");
+    Arena *other = arena_new_dynamic(ARENA_SIZE);
+    ArenaAllocator<int> ints(arena);
+    ArenaAllocator<double> doubles(ints);
+    ASSERT(doubles.arena() == arena && doubles == ints, "Rebound allocator should compare equal");
+    ASSERT(ArenaAllocator<int>(other) != ints, "Allocators of different arenas should differ");
+
+    TEST_CASE("Over-aligned elements");
+    {
+        std::vector<Wide, ArenaAllocator<Wide>> wide{ArenaAllocator<Wide>(arena)};
+        wide.resize(9);
+        ASSERT(((uintptr_t)wide.data() % alignof(Wide)) == 0, "Storage should satisfy the element alignment");
+    }
+
+    #if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+    TEST_CASE("Exhausted arena throws");
+    bool thrown = false;
+    try {
+        std::vector<char, ArenaAllocator<char>> huge{ArenaAllocator<char>(arena)};
+        huge.resize(ARENA_SIZE * 2);
+    }
+    catch (const std::bad_alloc &) {
+        thrown = true;
+    }
+    ASSERT(thrown, "Allocation failure should throw bad_alloc");
+    #endif
+
+    TEST_CASE("Typed allocation");
+    Tracked *tracked = arena_new<Tracked>(arena, 42);
+    ASSERT(tracked != NULL && tracked->value == 42 && Tracked::alive == 1, "Object should be constructed in the arena");
+    tracked->~Tracked();
+    arena_free_block(tracked);
+
+    arena_free(other);
+    arena_free(arena);
+}
+
+#ifdef ARENA_HAS_PMR
+void test_memory_resource(void) {
+    TEST_PHASE("Polymorphic Memory Resource");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    size_t baseline = occupied_blocks(arena);
+    ArenaMemoryResource resource(arena);
+
+    TEST_CASE("Containers allocate from the arena");
+    {
+        std::pmr::vector<std::pmr::string> words(&resource);
+        for (int i = 0; i < 500; i++) words.emplace_back(std::string(40, (char)('a' + i % 26)));
+        bool intact = true;
+        for (int i = 0; i < 500; i++) intact &= words[(size_t)i].size() == 40 && words[(size_t)i][0] == (char)('a' + i % 26);
+        ASSERT(intact, "Strings should keep their contents");
+        ASSERT(is_inside(arena, words.data()) && is_inside(arena, words[0].data()), "Vector and strings should live in the arena");
+    }
+    ASSERT(occupied_blocks(arena) == baseline, "Destroyed containers should give their blocks back");
+
+    TEST_CASE("Resources compare by arena");
+    ArenaMemoryResource same(arena);
+    ASSERT(resource.is_equal(same) && !resource.is_equal(*std::pmr::new_delete_resource()), "Resources of one arena should be equal");
+
+    arena_free(arena);
+}
+
+void test_monotonic_resource(void) {
+    TEST_PHASE("Monotonic Memory Resource");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    size_t baseline = occupied_blocks(arena);
+
+    {
+        TEST_CASE("Allocations span several regions");
+        ArenaMonotonicResource resource(arena, 1024);
+        std::vector<char *> blocks;
+        for (int i = 0; i < 300; i++) {
+            char *block = static_cast<char *>(resource.allocate(48, 16));
+            memset(block, i & 0xFF, 48);
+            blocks.push_back(block);
+        }
+        bool intact = true;
+        for (int i = 0; i < 300; i++) intact &= verify_memory_pattern(blocks[(size_t)i], 48, i);
+        ASSERT(intact, "Blocks of every region should keep their contents");
+        ASSERT(occupied_blocks(arena) > baseline + 2, "Regions should be carved from the parent");
+
+        TEST_CASE("Big and aligned requests");
+        void *big = resource.allocate(64 * 1024, 8);
+        void *aligned = resource.allocate(24, 256);
+        ASSERT(big != NULL && aligned != NULL && ((uintptr_t)aligned % 256) == 0, "Requests beyond the region size should get a region of their own");
+        resource.deallocate(big, 64 * 1024, 8);
+        ASSERT(true, "Deallocation should do nothing");
+
+        TEST_CASE("Release gives every region back");
+        resource.release();
+        ASSERT(occupied_blocks(arena) == baseline, "Parent should hold no region after release");
+
+        TEST_CASE("Resource is reusable after release");
+        {
+            std::pmr::vector<int> values(&resource);
+            for (int i = 0; i < 5000; i++) values.push_back(i);
+            ASSERT(values.back() == 4999 && is_inside(arena, values.data()), "Released resource should serve containers again");
+        }
+        resource.release();
+        resource.release();
+        ASSERT(occupied_blocks(arena) == baseline, "Repeated release should be harmless");
+    }
+
+    TEST_CASE("Destructor releases the regions");
+    {
+        ArenaMonotonicResource scoped(arena);
+        void *held = scoped.allocate(100, 8);
+        ASSERT(held != NULL && occupied_blocks(arena) > baseline, "Scoped resource should hold a region");
+    }
+    ASSERT(occupied_blocks(arena) == baseline, "Destroyed resource should give its regions back");
+
+    arena_free(arena);
+}
+#endif // ARENA_HAS_PMR
+
+void test_object_pool(void) {
+    TEST_PHASE("Typed Object Pool");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    // The pools hold slabs of the arena, so they go away before it
+    {
+        TEST_CASE("Invalid parent");
+        ArenaObjectPool<Tracked> none(NULL);
+        ASSERT(!none.valid() && none.create(1) == NULL, "Pool without a parent should create nothing");
+
+        TEST_CASE("Objects are constructed and destroyed");
+        ArenaObjectPool<Tracked> pool(arena);
+        Tracked::alive = 0;
+        Tracked *objects[100];
+        for (int i = 0; i < 100; i++) objects[i] = pool.create(i);
+        bool built = Tracked::alive == 100;
+        for (int i = 0; i < 100; i++) built &= objects[i] != NULL && objects[i]->value == i;
+        ASSERT(built, "Every object should be constructed with its arguments");
+        pool.destroy(objects[10]);
+        pool.destroy(NULL);
+        ASSERT(Tracked::alive == 99, "Destroy should run the destructor");
+
+        TEST_CASE("Released slot is reused");
+        Tracked *again = pool.create(7);
+        ASSERT(again == objects[10] && again->value == 7, "New object should take the released slot");
+
+        TEST_CASE("Move transfers the slabs");
+        ArenaObjectPool<Tracked> moved(std::move(pool));
+        ASSERT(!pool.valid() && moved.valid(), "Moved-from pool should be empty");
+        ArenaObjectPool<Tracked> assigned(arena);
+        assigned = std::move(moved);
+        ASSERT(assigned.valid() && !moved.valid(), "Move assignment should transfer the slabs");
+        Tracked *last = assigned.create(5);
+        ASSERT(last != NULL && last->value == 5, "Moved pool should keep working");
+
+        TEST_CASE("Over-aligned objects");
+        ArenaObjectPool<Wide> wide(arena);
+        Wide *first = wide.create();
+        Wide *second = wide.create();
+        ASSERT(first && second && ((uintptr_t)first % alignof(Wide)) == 0 && ((uintptr_t)second % alignof(Wide)) == 0, "Slots should satisfy the type alignment");
+
+        TEST_CASE("Reset empties the pool");
+        assigned.reset();
+        Tracked::alive = 0;
+        Tracked *fresh = assigned.create(3);
+        ASSERT(fresh != NULL && fresh->value == 3, "Pool should hand out slots again after a reset");
+        assigned.destroy(fresh);
+    }
+
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_allocator();
+    #ifdef ARENA_HAS_PMR
+    test_memory_resource();
+    test_monotonic_resource();
+    #endif
+    test_object_pool();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
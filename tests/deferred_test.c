@@ -0,0 +1,220 @@
+#define ARENA_DEFERRED_COALESCING
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (64 * 1024)
+#define BLOCK_SIZE (64)
+#define STRESS_SLOTS (128)
+#define STRESS_CYCLES (20000)
+
+static size_t count_deferred_blocks(Arena *arena) {
+    size_t count = 0;
+    for (Block *block = arena_get_ext(arena)->deferred; block != NULL; block = get_parked_next(block)) {
+        count++;
+    }
+    return count;
+}
+
+void test_deferred_reuse(void) {
+    TEST_PHASE("Quick Reuse Without Coalescing");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    void *a = arena_alloc(arena, BLOCK_SIZE);
+    void *b = arena_alloc(arena, BLOCK_SIZE);
+    void *c = arena_alloc(arena, BLOCK_SIZE);
+    void *guard = arena_alloc(arena, BLOCK_SIZE);
+    size_t tail_before = free_size_in_tail(arena);
+
+    TEST_CASE("Freed block is parked, not merged");
+    arena_free_block(b);
+    ASSERT(count_deferred_blocks(arena) == 1, "Freed block should be parked");
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Free index should stay empty");
+
+    TEST_CASE("Same size allocation takes the parked block back");
+    void *reused = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(reused == b && count_deferred_blocks(arena) == 0, "Parked block should be reused");
+    ASSERT(arena_try_resize(reused, BLOCK_SIZE), "Reused block should be a valid occupied block");
+
+    TEST_CASE("Parked block cannot be freed twice");
+    arena_free_block(reused);
+    arena_free_block(reused);
+    ASSERT(count_deferred_blocks(arena) == 1, "Double free should be ignored");
+
+    TEST_CASE("Different size skips the parked block");
+    void *bigger = arena_alloc(arena, BLOCK_SIZE * 4);
+    ASSERT(bigger != b && free_size_in_tail(arena) < tail_before, "Bigger request should come from the tail");
+    arena_free_block(bigger);
+    ASSERT(count_deferred_blocks(arena) == 1, "Block touching the tail should not be parked");
+
+    TEST_CASE("Over-aligned request skips the list");
+    void *aligned = arena_alloc_custom(arena, BLOCK_SIZE, 256);
+    ASSERT(aligned != NULL && ((uintptr_t)aligned % 256) == 0 && aligned != b, "Over-aligned block should come from elsewhere");
+
+    (void)a; (void)c; (void)guard;
+    arena_free(arena);
+}
+
+void test_deferred_coalesce(void) {
+    TEST_PHASE("Explicit Coalescing");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    size_t initial_tail = free_size_in_tail(arena);
+    void *a = arena_alloc(arena, BLOCK_SIZE);
+    void *b = arena_alloc(arena, BLOCK_SIZE);
+    void *c = arena_alloc(arena, BLOCK_SIZE);
+    void *guard = arena_alloc(arena, BLOCK_SIZE);
+    void *last = arena_alloc(arena, BLOCK_SIZE);
+
+    TEST_CASE("Invalid parameters");
+    arena_coalesce(NULL);
+    arena_coalesce(arena);
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Coalescing without parked blocks should change nothing");
+
+    TEST_CASE("Adjacent parked blocks merge into one free block");
+    arena_free_block(c);
+    arena_free_block(a);
+    arena_free_block(b);
+    ASSERT(count_deferred_blocks(arena) == 3, "Blocks should be parked");
+    arena_coalesce(arena);
+    Block *merged = arena_get_free_blocks(arena);
+    ASSERT(count_deferred_blocks(arena) == 0, "List should be empty");
+    ASSERT(merged != NULL && get_size(merged) == BLOCK_SIZE * 3 + sizeof(Block) * 2, "Run should become one free block");
+    ASSERT(merged != NULL && get_left_tree(merged) == NULL && get_right_tree(merged) == NULL, "Only the run should be indexed");
+    void *joined = arena_alloc(arena, BLOCK_SIZE * 3 + sizeof(Block) * 2);
+    ASSERT(joined == a, "Merged run should serve a request of its whole size");
+    arena_free_block(joined);
+
+    TEST_CASE("Run in front of a free tail joins the tail");
+    arena_free_block(guard);
+    arena_free_block(last);
+    arena_coalesce(arena);
+    ASSERT(free_size_in_tail(arena) == initial_tail, "Arena should be one tail again");
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Free index should be empty");
+
+    arena_free(arena);
+}
+
+void test_deferred_limits(void) {
+    TEST_PHASE("Deferred List Limits");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    static void *blocks[(ARENA_DEFERRED_LIMIT + 1) * 2];
+
+    TEST_CASE("Full list is coalesced in one pass");
+    for (int i = 0; i < (ARENA_DEFERRED_LIMIT + 1) * 2; i++) {
+        blocks[i] = arena_alloc(arena, BLOCK_SIZE);
+    }
+    arena_alloc(arena, BLOCK_SIZE);
+    for (int i = 0; i < ARENA_DEFERRED_LIMIT * 2; i += 2) {
+        arena_free_block(blocks[i]);
+    }
+    ASSERT(count_deferred_blocks(arena) == ARENA_DEFERRED_LIMIT && arena_get_free_blocks(arena) == NULL, "List should fill up to its limit");
+    arena_free_block(blocks[ARENA_DEFERRED_LIMIT * 2]);
+    ASSERT(count_deferred_blocks(arena) == 1, "Only the newest block should stay parked");
+    ASSERT(arena_get_free_blocks(arena) != NULL, "Flushed blocks should be in the free index");
+
+    TEST_CASE("Adjacent flushed blocks become one free block");
+    arena_reset(arena);
+    for (int i = 0; i <= ARENA_DEFERRED_LIMIT + 1; i++) {
+        blocks[i] = arena_alloc(arena, BLOCK_SIZE);
+    }
+    arena_alloc(arena, BLOCK_SIZE);
+    for (int i = 0; i <= ARENA_DEFERRED_LIMIT; i++) {
+        arena_free_block(blocks[i]);
+    }
+    Block *run = arena_get_free_blocks(arena);
+    ASSERT(count_deferred_blocks(arena) == 1 && (void *)run == (char *)blocks[0] - sizeof(Block), "Flushed blocks should form one run");
+    ASSERT(get_left_tree(run) == NULL && get_right_tree(run) == NULL, "Only the merged run should be indexed");
+    ASSERT(get_size(run) == ARENA_DEFERRED_LIMIT * (BLOCK_SIZE + sizeof(Block)) - sizeof(Block), "Run should cover every flushed block");
+
+    TEST_CASE("Failed allocation coalesces before giving up");
+    Arena *fixed = arena_new_dynamic(4096);
+    void *parts[4];
+    for (int i = 0; i < 4; i++) parts[i] = arena_alloc(fixed, 512);
+    arena_alloc(fixed, free_size_in_tail(fixed));
+    for (int i = 0; i < 4; i++) arena_free_block(parts[i]);
+    ASSERT(count_deferred_blocks(fixed) == 4, "Blocks should be parked");
+    void *whole = arena_alloc(fixed, 512 * 4 + sizeof(Block) * 3);
+    ASSERT(whole == parts[0] && count_deferred_blocks(fixed) == 0, "Request should be served by the merged blocks");
+    arena_free(fixed);
+
+    TEST_CASE("Reset drops the parked blocks");
+    arena_reset(arena);
+    ASSERT(count_deferred_blocks(arena) == 0 && arena_get_free_blocks(arena) == NULL, "Reset should clear the list");
+    void *fresh = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(fresh == block_data(arena_get_first_block(arena)), "Reset arena should allocate from its start");
+
+    arena_free(arena);
+}
+
+void test_deferred_growable(void) {
+    TEST_PHASE("Coalescing Growable Arenas");
+
+    Arena *arena = arena_new_dynamic_growable(1024);
+    void *blocks[48];
+    for (int i = 0; i < 48; i++) blocks[i] = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(arena_get_chunk(arena)->next != NULL, "Arena should have grown");
+
+    TEST_CASE("Every chunk is swept");
+    for (int i = 0; i < 47; i++) arena_free_block(blocks[i]);
+    arena_coalesce(arena);
+    bool empty = true;
+    for (Arena *chunk = arena; chunk != NULL; chunk = arena_get_chunk(chunk)->next) {
+        if (count_deferred_blocks(chunk) != 0) empty = false;
+    }
+    ASSERT(empty, "No chunk should keep deferred blocks");
+    ASSERT(arena_alloc(arena, BLOCK_SIZE * 8) != NULL, "Merged memory should serve bigger requests");
+
+    arena_free(arena);
+}
+
+void test_deferred_stress(void) {
+    TEST_PHASE("Deferred Coalescing Stress");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    size_t initial_tail = free_size_in_tail(arena);
+    void *slots[STRESS_SLOTS] = {0};
+    size_t sizes[STRESS_SLOTS] = {0};
+    bool intact = true;
+    srand(14);
+
+    TEST_CASE("Random churn keeps data intact");
+    for (int i = 0; i < STRESS_CYCLES; i++) {
+        int slot = rand() % STRESS_SLOTS;
+        if (slots[slot]) {
+            if (!verify_memory_pattern(slots[slot], sizes[slot], slot)) intact = false;
+            arena_free_block(slots[slot]);
+            slots[slot] = NULL;
+        }
+        else {
+            sizes[slot] = (size_t)(rand() % 8 + 1) * 16;
+            slots[slot] = arena_alloc(arena, sizes[slot]);
+            if (slots[slot]) fill_memory_pattern(slots[slot], sizes[slot], slot);
+        }
+        if (i % 997 == 0) arena_coalesce(arena);
+    }
+    ASSERT(intact, "Live blocks should keep their patterns");
+
+    TEST_CASE("Freeing everything restores the tail");
+    for (int i = 0; i < STRESS_SLOTS; i++) {
+        if (slots[i]) arena_free_block(slots[i]);
+    }
+    arena_coalesce(arena);
+    ASSERT(free_size_in_tail(arena) == initial_tail && arena_get_free_blocks(arena) == NULL, "Arena should be empty");
+
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_deferred_reuse();
+    test_deferred_coalesce();
+    test_deferred_limits();
+    test_deferred_growable();
+    test_deferred_stress();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,120 @@
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (64 * 1024)
+#define BLOCK_SIZE (64)
+
+typedef struct {
+    int id;
+    double weight;
+    char name[20];
+} Node;
+
+typedef struct {
+    char tag;
+    long double value;
+} Wide;
+
+void test_fast_path_sequence(void) {
+    TEST_PHASE("Fast Path Matches the Checked Path");
+
+    Arena *checked = arena_new_dynamic(ARENA_SIZE);
+    Arena *fast = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Same offsets for the same requests");
+    bool same = true;
+    for (int i = 0; i < 200; i++) {
+        size_t size = (size_t)(i % 13 + 1) * 8;
+        char *a = (char *)arena_alloc(checked, size);
+        char *b = (char *)arena_alloc_fast(fast, size, arena_get_alignment(fast));
+        if (a == NULL || b == NULL || a - (char *)checked != b - (char *)fast) same = false;
+    }
+    ASSERT(same, "Fast path should carve the same blocks as arena_alloc");
+    ASSERT(free_size_in_tail(checked) == free_size_in_tail(fast), "Both tails should be the same size");
+
+    TEST_CASE("Blocks from the fast path are regular blocks");
+    void *p = arena_alloc_fast(fast, BLOCK_SIZE, MIN_ALIGNMENT);
+    ASSERT(arena_try_resize(p, BLOCK_SIZE), "Block should be recognized as occupied");
+    size_t tail = free_size_in_tail(fast);
+    arena_free_block(p);
+    ASSERT(free_size_in_tail(fast) == tail + BLOCK_SIZE + sizeof(Block), "Freed block should return to the tail");
+
+    arena_free(checked);
+    arena_free(fast);
+}
+
+void test_fast_path_fallbacks(void) {
+    TEST_PHASE("Fast Path Fallbacks");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Free blocks are still reused before the tail");
+    void *hole = arena_alloc(arena, BLOCK_SIZE);
+    arena_alloc(arena, BLOCK_SIZE);
+    arena_free_block(hole);
+    ASSERT(arena_alloc_fast(arena, BLOCK_SIZE, MIN_ALIGNMENT) == hole, "Hole should be served first");
+
+    TEST_CASE("Over-aligned requests take the full path");
+    void *aligned = arena_alloc_fast(arena, BLOCK_SIZE, 256);
+    ASSERT(aligned != NULL && ((uintptr_t)aligned % 256) == 0, "Block should honor the requested alignment");
+
+    TEST_CASE("Tail too small for a split is taken whole");
+    arena_reset(arena);
+    size_t size = free_size_in_tail(arena);
+    void *whole = arena_alloc_fast(arena, size - sizeof(Block) / 2, MIN_ALIGNMENT);
+    ASSERT(whole != NULL && free_size_in_tail(arena) == 0, "Block should absorb the tail");
+    ASSERT(arena_alloc_fast(arena, BLOCK_SIZE, MIN_ALIGNMENT) == NULL, "Full arena should fail");
+
+    TEST_CASE("Growable arenas chain chunks");
+    Arena *growable = arena_new_dynamic_growable(4096);
+    bool served = true;
+    for (int i = 0; i < 200; i++) served &= arena_alloc_fast(growable, BLOCK_SIZE, MIN_ALIGNMENT) != NULL;
+    ASSERT(served && arena_get_chunk(growable)->next != NULL, "Requests beyond the first chunk should grow the arena");
+    arena_free(growable);
+
+    arena_reset(arena);
+    TEST_CASE("Checked entry points keep validating");
+    ASSERT(arena_alloc(NULL, BLOCK_SIZE) == NULL && arena_alloc(arena, 0) == NULL, "arena_alloc should still reject bad parameters");
+    ASSERT(arena_alloc_custom(arena, BLOCK_SIZE, 3) == NULL, "arena_alloc_custom should still reject bad alignments");
+
+    arena_free(arena);
+}
+
+void test_fast_path_typed(void) {
+    TEST_PHASE("Typed Allocation");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("ARENA_NEW returns aligned objects");
+    Node *node = ARENA_NEW(arena, Node);
+    ASSERT(node != NULL && ((uintptr_t)node % ARENA_ALIGNOF(Node)) == 0, "Node should be aligned for its type");
+    node->id = 7;
+    node->weight = 1.5;
+    Wide *wide = ARENA_NEW(arena, Wide);
+    ASSERT(wide != NULL && ((uintptr_t)wide % ARENA_ALIGNOF(Wide)) == 0, "Wide should be aligned for its type");
+    char *byte = ARENA_NEW(arena, char);
+    ASSERT(byte != NULL && ((uintptr_t)byte % MIN_ALIGNMENT) == 0, "Small types should get the minimum alignment");
+    ASSERT(node->id == 7 && node->weight == 1.5, "Objects should not overlap");
+
+    TEST_CASE("Type alignment is a compile-time constant");
+    ASSERT(ARENA_TYPE_ALIGNMENT(char) == MIN_ALIGNMENT, "Small types should be raised to the minimum alignment");
+    ASSERT(ARENA_TYPE_ALIGNMENT(Wide) >= ARENA_ALIGNOF(long double), "Alignment should follow the widest member");
+
+    TEST_CASE("Full arena returns NULL");
+    arena_alloc(arena, free_size_in_tail(arena));
+    ASSERT(ARENA_NEW(arena, Node) == NULL, "Allocation from a full arena should fail");
+
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_fast_path_sequence();
+    test_fast_path_fallbacks();
+    test_fast_path_typed();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
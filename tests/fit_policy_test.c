@@ -0,0 +1,177 @@
+#define ARENA_FIT_POLICIES
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (64 * 1024)
+#define REQUEST_SIZE (80)
+#define STRESS_SLOTS (256)
+#define STRESS_CYCLES (20000)
+
+typedef struct {
+    void *high;     // Hole that fits the request best
+    void *middle;   // Hole of medium size
+    void *low;      // Biggest hole, at the lowest address
+} Holes;
+
+/*
+ * Leaves three holes of different sizes, separated by guard blocks, in front of the tail
+ */
+static Holes make_holes(Arena *arena) {
+    Holes holes;
+    holes.low = arena_alloc(arena, 256);
+    arena_alloc(arena, 32);
+    holes.middle = arena_alloc(arena, 128);
+    arena_alloc(arena, 32);
+    holes.high = arena_alloc(arena, 96);
+    arena_alloc(arena, 32);
+
+    arena_free_block(holes.low);
+    arena_free_block(holes.middle);
+    arena_free_block(holes.high);
+    return holes;
+}
+
+static Arena *new_arena(ArenaFitPolicy policy) {
+    ArenaOptions options = {0};
+    options.fit_policy = policy;
+    return arena_new_dynamic_ex(ARENA_SIZE, &options);
+}
+
+void test_fit_options(void) {
+    TEST_PHASE("Arena Options");
+
+    TEST_CASE("Invalid options");
+    ArenaOptions options = {0};
+    options.fit_policy = (ArenaFitPolicy)42;
+    ASSERT(arena_new_dynamic_ex(ARENA_SIZE, &options) == NULL, "Unknown policy should be rejected");
+    options.fit_policy = ARENA_FIT_FIRST;
+    options.alignment = 24;
+    ASSERT(arena_new_dynamic_ex(ARENA_SIZE, &options) == NULL, "Invalid alignment should be rejected");
+    static char memory[ARENA_SIZE];
+    options.alignment = 0;
+    options.growable = true;
+    ASSERT(arena_new_static_ex(memory, ARENA_SIZE, &options) == NULL, "Static arenas cannot grow");
+    ASSERT(arena_get_fit_policy(NULL) == ARENA_FIT_BEST, "NULL arena should report the default policy");
+
+    TEST_CASE("Defaults");
+    Arena *arena = arena_new_dynamic_ex(ARENA_SIZE, NULL);
+    ASSERT(arena != NULL && arena_get_fit_policy(arena) == ARENA_FIT_BEST, "NULL options should give a best fit arena");
+    ASSERT(arena_get_alignment(arena) == ARENA_DEFAULT_ALIGNMENT, "NULL options should give the default alignment");
+    arena_free(arena);
+    Arena *plain = arena_new_dynamic(ARENA_SIZE);
+    ASSERT(arena_get_fit_policy(plain) == ARENA_FIT_BEST, "Arenas of the other constructors should use best fit");
+    arena_free(plain);
+
+    TEST_CASE("Options are applied");
+    options.growable = false;
+    options.alignment = 64;
+    options.fit_policy = ARENA_FIT_ADDRESS;
+    Arena *fixed = arena_new_static_ex(memory, ARENA_SIZE, &options);
+    ASSERT(fixed != NULL && arena_get_fit_policy(fixed) == ARENA_FIT_ADDRESS, "Static arena should keep its policy");
+    ASSERT(arena_get_alignment(fixed) == 64, "Static arena should keep its alignment");
+    arena_reset(fixed);
+    ASSERT(arena_get_fit_policy(fixed) == ARENA_FIT_ADDRESS, "Policy should survive a reset");
+}
+
+void test_fit_placement(void) {
+    TEST_PHASE("Placement by Policy");
+
+    TEST_CASE("Best fit takes the smallest hole");
+    Arena *best = new_arena(ARENA_FIT_BEST);
+    Holes holes = make_holes(best);
+    ASSERT(arena_alloc(best, REQUEST_SIZE) == holes.high, "Smallest fitting hole should be used");
+    arena_free(best);
+
+    TEST_CASE("First fit takes some hole that fits");
+    Arena *first = new_arena(ARENA_FIT_FIRST);
+    holes = make_holes(first);
+    void *p = arena_alloc(first, REQUEST_SIZE);
+    ASSERT(p == holes.high || p == holes.middle || p == holes.low, "A hole should be used before the tail");
+    ASSERT(arena_alloc(first, 200) == holes.low, "Only the big hole fits a big request");
+    arena_free(first);
+
+    TEST_CASE("Address-ordered fit takes the lowest hole");
+    Arena *address = new_arena(ARENA_FIT_ADDRESS);
+    holes = make_holes(address);
+    ASSERT(arena_alloc(address, REQUEST_SIZE) == holes.low, "Lowest fitting hole should be used");
+    void *next = arena_alloc(address, REQUEST_SIZE);
+    ASSERT((char *)next > (char *)holes.low && (char *)next < (char *)holes.middle, "Remainder of the low hole should be used next");
+    ASSERT(arena_alloc(address, 300) != NULL, "Requests no hole fits should come from the tail");
+    ASSERT(arena_alloc_custom(address, 64, 256) != NULL, "Aligned requests should be placed as well");
+    arena_free(address);
+
+    TEST_CASE("Tail-first keeps the holes while the tail lasts");
+    Arena *tail = new_arena(ARENA_FIT_TAIL);
+    holes = make_holes(tail);
+    void *q = arena_alloc(tail, REQUEST_SIZE);
+    ASSERT((char *)q > (char *)holes.high, "Tail should serve while it has room");
+    arena_alloc(tail, free_size_in_tail(tail));
+    void *r = arena_alloc(tail, REQUEST_SIZE);
+    ASSERT(r == holes.high, "Holes should serve once the tail is used up");
+    arena_free(tail);
+}
+
+void test_fit_growable(void) {
+    TEST_PHASE("Policies of Growable Arenas");
+
+    ArenaOptions options = {0};
+    options.fit_policy = ARENA_FIT_TAIL;
+    options.growable = true;
+    Arena *arena = arena_new_dynamic_ex(1024, &options);
+    ASSERT(arena != NULL && arena_get_chunk(arena) != NULL, "Growable arena should be created");
+
+    TEST_CASE("New chunks inherit the policy");
+    for (int i = 0; i < 64; i++) arena_alloc(arena, 64);
+    Arena *second = arena_get_chunk(arena)->next;
+    ASSERT(second != NULL && arena_get_fit_policy(second) == ARENA_FIT_TAIL, "Chunk should use the policy of the head");
+
+    arena_free(arena);
+}
+
+void test_fit_stress(void) {
+    TEST_PHASE("Fit Policy Stress");
+
+    for (int policy = ARENA_FIT_BEST; policy <= ARENA_FIT_TAIL; policy++) {
+        TEST_CASE("Random churn keeps data intact");
+        Arena *arena = new_arena((ArenaFitPolicy)policy);
+        size_t initial_tail = free_size_in_tail(arena);
+        void *slots[STRESS_SLOTS] = {0};
+        size_t sizes[STRESS_SLOTS] = {0};
+        bool intact = true;
+        srand(22 + policy);
+
+        for (int i = 0; i < STRESS_CYCLES; i++) {
+            int slot = rand() % STRESS_SLOTS;
+            if (slots[slot]) {
+                if (!verify_memory_pattern(slots[slot], sizes[slot], slot)) intact = false;
+                arena_free_block(slots[slot]);
+                slots[slot] = NULL;
+            }
+            else {
+                sizes[slot] = (size_t)(rand() % 12 + 1) * 16;
+                slots[slot] = arena_alloc(arena, sizes[slot]);
+                if (slots[slot]) fill_memory_pattern(slots[slot], sizes[slot], slot);
+            }
+        }
+        ASSERT(intact, "Live blocks should keep their patterns");
+
+        for (int i = 0; i < STRESS_SLOTS; i++) {
+            if (slots[i]) arena_free_block(slots[i]);
+        }
+        ASSERT(free_size_in_tail(arena) == initial_tail && arena_get_free_blocks(arena) == NULL, "Arena should be empty again");
+        arena_free(arena);
+    }
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_fit_options();
+    test_fit_placement();
+    test_fit_growable();
+    test_fit_stress();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,181 @@
+#define ARENA_FREE_INDEX_BITMAP
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (64 * 1024)
+#define BLOCK_SIZE (64)
+#define STRESS_COUNT (400)
+#define STRESS_ROUNDS (4000)
+
+/*
+ * Helper: Count blocks held by the free lists
+ */
+static size_t count_indexed_blocks(Arena *arena) {
+    ArenaFreeIndex *index = &arena_get_ext(arena)->free_index;
+    size_t count = 0;
+    for (size_t fl = 0; fl < FREE_INDEX_FL_COUNT; fl++) {
+        for (size_t sl = 0; sl < FREE_INDEX_SL_COUNT; sl++) {
+            // Heads of lists the bitmaps mark as empty are stale and never read
+            if (!((index->sl_bitmap[fl] >> sl) & 1)) continue;
+            if (index->heads[fl][sl] == NULL) return SIZE_MAX;
+            for (Block *block = index->heads[fl][sl]; block; block = get_right_tree(block)) count++;
+        }
+        if (((index->fl_bitmap >> fl) & 1) != (index->sl_bitmap[fl] != 0)) return SIZE_MAX;
+    }
+    return count;
+}
+
+/*
+ * Helper: Count free blocks in front of the tail by walking the arena
+ */
+static size_t count_physical_free_blocks(Arena *arena) {
+    size_t count = 0;
+    Block *tail = arena_get_tail(arena);
+    for (Block *block = arena_get_first_block(arena); block && block != tail; block = next_block(arena, block)) {
+        if (get_is_free(block)) count++;
+    }
+    return count;
+}
+
+void test_free_index_mapping(void) {
+    TEST_PHASE("Free Index Mapping");
+
+    size_t fl, sl, next_fl, next_sl;
+
+    TEST_CASE("Small sizes map linearly");
+    free_index_mapping(8, &fl, &sl);
+    free_index_mapping(16, &next_fl, &next_sl);
+    ASSERT(fl == 0 && next_fl == 0 && next_sl == sl + 1, "Small sizes should get a list per 8 bytes");
+
+    TEST_CASE("Bigger sizes split every power of two");
+    free_index_mapping(1024, &fl, &sl);
+    free_index_mapping(1024 + 1024 / FREE_INDEX_SL_COUNT, &next_fl, &next_sl);
+    ASSERT(next_fl == fl && next_sl == sl + 1, "Every power of two should have several lists");
+    free_index_mapping(2048, &next_fl, &next_sl);
+    ASSERT(next_fl == fl + 1 && next_sl == 0, "Next power of two should start a new class");
+
+    TEST_CASE("Huge sizes share the last list");
+    free_index_mapping(SIZE_MASK, &fl, &sl);
+    ASSERT(fl == FREE_INDEX_FL_COUNT - 1 && sl == FREE_INDEX_SL_COUNT - 1, "Sizes past the last class should clamp");
+}
+
+void test_free_index_reuse(void) {
+    TEST_PHASE("Free Index Reuse");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    void *small = arena_alloc(arena, BLOCK_SIZE);
+    arena_alloc(arena, BLOCK_SIZE);
+    void *medium = arena_alloc(arena, BLOCK_SIZE * 8);
+    arena_alloc(arena, BLOCK_SIZE);
+    void *large = arena_alloc(arena, BLOCK_SIZE * 32);
+    arena_alloc(arena, BLOCK_SIZE);
+
+    TEST_CASE("Freed blocks land in the lists");
+    arena_free_block(small);
+    arena_free_block(medium);
+    arena_free_block(large);
+    ASSERT(count_indexed_blocks(arena) == 3, "Three blocks should be listed");
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Free tree should stay unused");
+
+    TEST_CASE("Allocations take the closest fitting block");
+    ASSERT(arena_alloc(arena, BLOCK_SIZE * 6) == medium, "Medium request should reuse the medium block");
+    ASSERT(arena_alloc(arena, BLOCK_SIZE) == small, "Small request should reuse the small block");
+    ASSERT(arena_alloc(arena, BLOCK_SIZE * 20) == large, "Large request should reuse the large block");
+    ASSERT(count_indexed_blocks(arena) == 2, "Remainders of the split blocks should be listed");
+
+    TEST_CASE("Over-aligned requests skip blocks without room for the padding");
+    arena_reset(arena);
+    void *hole = arena_alloc(arena, BLOCK_SIZE * 16);
+    void *guard = arena_alloc(arena, BLOCK_SIZE);
+    arena_free_block(hole);
+    void *aligned = arena_alloc_custom(arena, BLOCK_SIZE, 512);
+    ASSERT(aligned != NULL && ((uintptr_t)aligned % 512) == 0, "Alignment should be honoured");
+    ASSERT((char *)aligned < (char *)guard, "Free block should serve the over-aligned request");
+
+    TEST_CASE("Reset empties the index");
+    arena_reset(arena);
+    ASSERT(count_indexed_blocks(arena) == 0 && arena_get_ext(arena)->free_index.fl_bitmap == 0, "Index should be empty after reset");
+
+    arena_free(arena);
+}
+
+void test_free_index_coalescing(void) {
+    TEST_PHASE("Free Index Coalescing");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    void *blocks[6];
+    for (int i = 0; i < 6; i++) blocks[i] = arena_alloc(arena, BLOCK_SIZE);
+
+    TEST_CASE("Neighbours merge out of their lists");
+    arena_free_block(blocks[1]);
+    arena_free_block(blocks[3]);
+    ASSERT(count_indexed_blocks(arena) == 2, "Two separate blocks should be listed");
+    arena_free_block(blocks[2]);
+    ASSERT(count_indexed_blocks(arena) == 1, "Merged block should replace its parts");
+    ASSERT(arena_alloc(arena, BLOCK_SIZE * 3) == blocks[1], "Merged block should serve a bigger request");
+
+    TEST_CASE("Resize consumes a listed successor");
+    arena_reset(arena);
+    void *first = arena_alloc(arena, BLOCK_SIZE);
+    void *second = arena_alloc(arena, BLOCK_SIZE);
+    arena_alloc(arena, BLOCK_SIZE);
+    arena_free_block(second);
+    ASSERT(arena_try_resize(first, BLOCK_SIZE + sizeof(Block) + BLOCK_SIZE), "Resize should take the free successor");
+    ASSERT(count_indexed_blocks(arena) == 0, "Successor should leave the lists");
+
+    arena_free(arena);
+}
+
+void test_free_index_stress(void) {
+    TEST_PHASE("Free Index Stress");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE * 8);
+    void *objects[STRESS_COUNT] = {0};
+    size_t sizes[STRESS_COUNT] = {0};
+    uint32_t state = 7;
+    int pattern_errors = 0;
+    int consistency_errors = 0;
+
+    TEST_CASE("Random allocations and frees keep the index exact");
+    for (int round = 0; round < STRESS_ROUNDS; round++) {
+        state = state * 1103515245u + 12345u;
+        size_t slot = (state >> 8) % STRESS_COUNT;
+
+        if (objects[slot]) {
+            if (!verify_memory_pattern(objects[slot], sizes[slot], (int)slot)) pattern_errors++;
+            arena_free_block(objects[slot]);
+            objects[slot] = NULL;
+        }
+        else {
+            sizes[slot] = 16 + (state >> 16) % 600;
+            objects[slot] = (state & 1) ? arena_alloc(arena, sizes[slot]) : arena_alloc_custom(arena, sizes[slot], 64);
+            if (objects[slot]) fill_memory_pattern(objects[slot], sizes[slot], (int)slot);
+        }
+
+        if (round % 97 == 0 && count_indexed_blocks(arena) != count_physical_free_blocks(arena)) consistency_errors++;
+    }
+    ASSERT(pattern_errors == 0, "Live blocks should keep their contents");
+    ASSERT(consistency_errors == 0, "Lists should hold exactly the free blocks of the arena");
+
+    TEST_CASE("Freeing everything coalesces into the tail");
+    for (int i = 0; i < STRESS_COUNT; i++) {
+        if (objects[i]) arena_free_block(objects[i]);
+    }
+    ASSERT(count_indexed_blocks(arena) == 0, "Lists should be empty");
+    ASSERT(arena_get_tail(arena) == arena_get_first_block(arena), "Whole arena should be one free tail");
+
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_free_index_mapping();
+    test_free_index_reuse();
+    test_free_index_coalescing();
+    test_free_index_stress();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
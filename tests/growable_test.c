@@ -0,0 +1,174 @@
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define CHUNK_SIZE (1024)
+#define BLOCK_SIZE (64)
+#define BLOCK_COUNT (200)
+
+static size_t count_chunks(Arena *arena) {
+    size_t count = 0;
+    for (Arena *chunk = arena; chunk != NULL; chunk = arena_get_chunk(chunk)->next) {
+        count++;
+    }
+    return count;
+}
+
+void test_growable_creation(void) {
+    TEST_PHASE("Growable Arena Creation");
+
+    TEST_CASE("Invalid parameters");
+    ASSERT(arena_new_dynamic_growable(0) == NULL, "Zero size should fail");
+    ASSERT(arena_new_dynamic_growable_custom(CHUNK_SIZE, 24, NULL) == NULL, "Non power of two alignment should fail");
+    ArenaGrowthPolicy zero_factor = { 0, 0, ARENA_RETAIN_ALL };
+    ASSERT(arena_new_dynamic_growable_custom(CHUNK_SIZE, 16, &zero_factor) == NULL, "Zero growth factor should fail");
+
+    TEST_CASE("Single chunk behaves like a dynamic arena");
+    Arena *arena = arena_new_dynamic_growable(CHUNK_SIZE);
+    ASSERT(arena != NULL, "Growable arena creation should succeed");
+    ASSERT(arena_get_has_chunk(arena), "Growable arena should carry a chunk descriptor");
+    ASSERT(count_chunks(arena) == 1, "Fresh arena should have a single chunk");
+    ASSERT(free_size_in_tail(arena) > CHUNK_SIZE - sizeof(Block) - ARENA_DEFAULT_ALIGNMENT, "Chunk descriptor should not eat the requested capacity");
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Free tree should be empty despite the tagged pointer");
+
+    void *p = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(p != NULL && ((uintptr_t)p % ARENA_DEFAULT_ALIGNMENT) == 0, "Allocation should be aligned");
+    arena_free_block(p);
+    ASSERT(count_chunks(arena) == 1, "Small allocations should not grow the arena");
+
+    arena_free(arena);
+}
+
+void test_growable_growth(void) {
+    TEST_PHASE("Growable Arena Growth");
+
+    Arena *arena = arena_new_dynamic_growable(CHUNK_SIZE);
+    void *blocks[BLOCK_COUNT] = {0};
+
+    TEST_CASE("Exhausting the first chunk chains new ones");
+    bool all_allocated = true;
+    for (int i = 0; i < BLOCK_COUNT; i++) {
+        blocks[i] = arena_alloc(arena, BLOCK_SIZE);
+        if (!blocks[i]) { all_allocated = false; break; }
+        fill_memory_pattern(blocks[i], BLOCK_SIZE, i);
+    }
+    ASSERT(all_allocated, "Arena should keep growing instead of failing");
+    size_t chunks = count_chunks(arena);
+    ASSERT(chunks > 1, "Arena should consist of several chunks");
+    ASSERT(chunks < 8, "Geometric growth should keep the chain short");
+
+    TEST_CASE("Chunks grow geometrically");
+    Arena *second = arena_get_chunk(arena)->next;
+    Arena *third = arena_get_chunk(second)->next;
+    ASSERT(third != NULL, "Third chunk should exist");
+    ASSERT(arena_get_capacity(third) > arena_get_capacity(second), "Each chunk should be bigger than the previous one");
+
+    TEST_CASE("Pointers stay stable and memory intact");
+    bool intact = true;
+    for (int i = 0; i < BLOCK_COUNT; i++) {
+        if (!verify_memory_pattern(blocks[i], BLOCK_SIZE, i)) intact = false;
+    }
+    ASSERT(intact, "Memory of all chunks should hold its pattern");
+
+    TEST_CASE("Blocks are freed into their own chunk");
+    arena_free_block(blocks[BLOCK_COUNT - 2]);
+    void *reused = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(reused == blocks[BLOCK_COUNT - 2], "Freed block of a later chunk should be reused");
+    blocks[BLOCK_COUNT - 2] = reused;
+
+    arena_free_block(blocks[0]);
+    ASSERT(arena_get_free_blocks(arena) != NULL, "Block of the head should go to the head free tree");
+    ASSERT(arena_get_free_blocks(second) == NULL, "Other chunks should not see the freed block");
+
+    TEST_CASE("Request bigger than any chunk gets its own chunk");
+    size_t big_size = CHUNK_SIZE * 64;
+    void *big = arena_alloc_custom(arena, big_size, 256);
+    ASSERT(big != NULL && ((uintptr_t)big % 256) == 0, "Oversized aligned request should succeed");
+    fill_memory_pattern(big, big_size, 0x3C);
+    ASSERT(verify_memory_pattern(big, big_size, 0x3C), "Oversized block should be writable");
+    ASSERT(count_chunks(arena) == chunks + 1, "Oversized request should add exactly one chunk");
+
+    TEST_CASE("Nested arena inside a later chunk");
+    Arena *nested = arena_new_nested(arena, CHUNK_SIZE * 8);
+    ASSERT(nested != NULL, "Nested arena should be carved from the chain");
+    ASSERT(arena_alloc(nested, BLOCK_SIZE) != NULL, "Nested arena should serve allocations");
+    arena_free(nested);
+
+    arena_free(arena);
+}
+
+void test_growable_max_chunk(void) {
+    TEST_PHASE("Growable Arena Max Chunk Size");
+
+    ArenaGrowthPolicy policy = { 4, CHUNK_SIZE * 2, ARENA_RETAIN_ALL };
+    Arena *arena = arena_new_dynamic_growable_custom(CHUNK_SIZE, 32, &policy);
+    ASSERT(arena != NULL, "Arena creation with custom policy should succeed");
+
+    for (int i = 0; i < BLOCK_COUNT; i++) {
+        void *p = arena_alloc(arena, BLOCK_SIZE);
+        ASSERT_QUIET(p != NULL && ((uintptr_t)p % 32) == 0, "Allocation should succeed with arena alignment");
+    }
+
+    TEST_CASE("Chunk sizes are clamped by the policy");
+    bool clamped = true;
+    for (Arena *chunk = arena_get_chunk(arena)->next; chunk != NULL; chunk = arena_get_chunk(chunk)->next) {
+        if (arena_get_capacity(chunk) > CHUNK_SIZE * 2 + sizeof(Arena) + ARENA_CHUNK_RESERVE + 32) clamped = false;
+        if (arena_get_alignment(chunk) != 32) clamped = false;
+    }
+    ASSERT(clamped, "Extra chunks should respect max chunk size and arena alignment");
+
+    arena_free(arena);
+}
+
+void test_growable_reset(void) {
+    TEST_PHASE("Growable Arena Reset");
+
+    TEST_CASE("Default policy retains every reached chunk");
+    Arena *arena = arena_new_dynamic_growable(CHUNK_SIZE);
+    for (int i = 0; i < BLOCK_COUNT; i++) arena_alloc(arena, BLOCK_SIZE);
+    size_t chunks = count_chunks(arena);
+    size_t head_tail = 0;
+
+    arena_reset(arena);
+    ASSERT(count_chunks(arena) == chunks, "All chunks should survive the reset");
+    head_tail = free_size_in_tail(arena);
+    ASSERT(arena_get_tail(arena) == arena_get_first_block(arena), "Head should be empty after reset");
+
+    for (int i = 0; i < BLOCK_COUNT; i++) arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(count_chunks(arena) == chunks, "Same workload should reuse retained chunks");
+
+    TEST_CASE("Chunks above the high-water mark are released");
+    arena_reset(arena);
+    for (int i = 0; i < 4; i++) arena_alloc(arena, BLOCK_SIZE);
+    arena_reset(arena);
+    ASSERT(count_chunks(arena) == 1, "Chunks untouched in the last cycle should be released");
+    ASSERT(free_size_in_tail(arena) == head_tail, "Head should be fully restored");
+    arena_free(arena);
+
+    TEST_CASE("Retain limit bounds kept memory");
+    ArenaGrowthPolicy policy = { 2, 0, 0 };
+    arena = arena_new_dynamic_growable_custom(CHUNK_SIZE, 16, &policy);
+    for (int i = 0; i < BLOCK_COUNT; i++) arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(count_chunks(arena) > 1, "Arena should grow");
+    arena_reset_zero(arena);
+    ASSERT(count_chunks(arena) == 1, "Zero retain limit should release every extra chunk");
+    void *p = arena_alloc(arena, BLOCK_SIZE);
+    bool zeroed = true;
+    for (size_t i = 0; i < BLOCK_SIZE; i++) if (((unsigned char *)p)[i] != 0) zeroed = false;
+    ASSERT(zeroed, "Reset zero should clear the head");
+    for (int i = 0; i < BLOCK_COUNT; i++) arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(count_chunks(arena) > 1, "Arena should grow again after releasing chunks");
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_growable_creation();
+    test_growable_growth();
+    test_growable_max_chunk();
+    test_growable_reset();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
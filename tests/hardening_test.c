@@ -0,0 +1,177 @@
+#define ARENA_HARDENING
+#define ARENA_MMAP
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (64 * 1024)
+#define BLOCK_SIZE (64)
+
+/*
+ * Checks whether the byte can be read, write() reports EFAULT for inaccessible memory instead of faulting
+ */
+static bool is_accessible(const void *ptr) {
+    int fds[2];
+    if (pipe(fds) != 0) return true;
+    bool readable = write(fds[1], ptr, 1) == 1;
+    close(fds[0]);
+    close(fds[1]);
+    return readable;
+}
+
+static bool is_occupied(void *data) {
+    return arena_try_resize(data, BLOCK_SIZE);
+}
+
+void test_validation_levels(void) {
+    TEST_PHASE("Validation Levels");
+
+    TEST_CASE("Level selection");
+    ASSERT(arena_get_validation() == ARENA_VALIDATE_CHECKED, "Checked should be the default level");
+    arena_set_validation(ARENA_VALIDATE_HARDENED);
+    ASSERT(arena_get_validation() == ARENA_VALIDATE_HARDENED, "Level should be changed");
+    arena_set_validation((ArenaValidation)7);
+    ASSERT(arena_get_validation() == ARENA_VALIDATE_HARDENED, "Unknown level should be ignored");
+    arena_set_validation(ARENA_VALIDATE_CHECKED);
+
+    TEST_CASE("Trusted level frees without checks");
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    size_t initial_tail = free_size_in_tail(arena);
+    arena_set_validation(ARENA_VALIDATE_TRUSTED);
+    void *blocks[16];
+    for (int i = 0; i < 16; i++) blocks[i] = arena_alloc_custom(arena, BLOCK_SIZE, (size_t)16 << (i % 4));
+    for (int i = 0; i < 16; i++) arena_free_block(blocks[i]);
+    arena_set_validation(ARENA_VALIDATE_CHECKED);
+    ASSERT(free_size_in_tail(arena) == initial_tail && arena_get_free_blocks(arena) == NULL, "Padded and plain blocks should be decoded");
+
+    arena_free(arena);
+}
+
+void test_arena_keys(void) {
+    TEST_PHASE("Per-Arena Keys");
+
+    Arena *first = arena_new_dynamic(ARENA_SIZE);
+    Arena *second = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Every arena has its own odd key");
+    uintptr_t key = arena_get_key(first);
+    ASSERT((key & 1) && (arena_get_key(second) & 1), "Keys should be odd");
+    ASSERT(key != arena_get_key(second), "Keys should differ between arenas");
+    ASSERT(key != ARENA_MAGIC, "Key should not be the fixed constant");
+    arena_reset(first);
+    ASSERT(arena_get_key(first) == key, "Key should survive a reset");
+
+    TEST_CASE("Header forged with the fixed constant is rejected");
+    void *data = arena_alloc(first, BLOCK_SIZE);
+    Block *block = (Block *)(void *)((char *)data - sizeof(Block));
+    uintptr_t magic = block->as.occupied.magic;
+    block->as.occupied.magic = ARENA_MAGIC ^ (uintptr_t)data;
+    arena_free_block(data);
+    block->as.occupied.magic = magic;
+    ASSERT(is_occupied(data), "Forged block should not be freed");
+
+    TEST_CASE("Header moved to another arena is rejected");
+    void *other = arena_alloc(second, BLOCK_SIZE);
+    Block *other_block = (Block *)(void *)((char *)other - sizeof(Block));
+    Arena *owner = other_block->as.occupied.arena;
+    other_block->as.occupied.arena = first;
+    arena_free_block(other);
+    other_block->as.occupied.arena = owner;
+    ASSERT(is_occupied(other), "Block keyed for another arena should not be freed");
+
+    TEST_CASE("Foreign pointers are ignored before their arena is read");
+    uintptr_t foreign[6] = { 64, 0, 0x1000, 0x12345, 0, 0 }; // Arena field points to unmapped memory
+    arena_free_block(&foreign[4]);
+    ASSERT(!arena_try_resize(&foreign[4], BLOCK_SIZE), "Foreign header should be rejected without a crash");
+    ASSERT((key & ARENA_KEY_TAG_MASK) == (ARENA_MAGIC & ARENA_KEY_TAG_MASK), "Keys should carry the tag bits");
+
+    TEST_CASE("Nested arenas and their blocks use their own key");
+    Arena *nested = arena_new_nested(first, ARENA_SIZE / 4);
+    ASSERT(nested != NULL && arena_get_key(nested) != key, "Nested arena should get a key of its own");
+    void *inner = arena_alloc(nested, BLOCK_SIZE);
+    size_t tail = free_size_in_tail(nested);
+    arena_free_block(inner);
+    ASSERT(free_size_in_tail(nested) > tail, "Blocks of the nested arena should be freed");
+    arena_free(nested);
+
+    arena_free(first);
+    arena_free(second);
+}
+
+void test_hardened_links(void) {
+    TEST_PHASE("Hardened Neighbour Checks");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    arena_set_validation(ARENA_VALIDATE_HARDENED);
+
+    TEST_CASE("Overrun into the next header is detected");
+    void *a = arena_alloc(arena, BLOCK_SIZE);
+    void *b = arena_alloc(arena, BLOCK_SIZE);
+    arena_alloc(arena, BLOCK_SIZE);
+    Block *header = (Block *)(void *)((char *)b - sizeof(Block));
+    Block saved = *header;
+    memset(header, 0x41, offsetof(Block, as)); // Overwrites size and back link, magic and arena stay intact
+    arena_free_block(b);
+    size_t tail = free_size_in_tail(arena);
+    *header = saved;
+    ASSERT(is_occupied(b), "Block with a corrupted header should not be freed");
+
+    TEST_CASE("Grown size is detected");
+    Block *first = (Block *)(void *)((char *)a - sizeof(Block));
+    size_t size_and_alignment = first->size_and_alignment;
+    first->size_and_alignment += 64;
+    arena_free_block(a);
+    first->size_and_alignment = size_and_alignment;
+    ASSERT(is_occupied(a), "Block with a wrong size should not be freed");
+
+    TEST_CASE("Intact blocks are freed");
+    arena_free_block(b);
+    arena_free_block(a);
+    ASSERT(!is_occupied(a) && !is_occupied(b) && free_size_in_tail(arena) == tail, "Blocks should be freed");
+    void *aligned = arena_alloc_custom(arena, BLOCK_SIZE, 4096);
+    arena_free_block(aligned);
+    ASSERT(!is_occupied(aligned), "Padded blocks should be freed");
+
+    arena_set_validation(ARENA_VALIDATE_CHECKED);
+    arena_free(arena);
+}
+
+void test_guard_pages(void) {
+    TEST_PHASE("Guard Pages");
+
+    TEST_CASE("Guards surround the reserved range");
+    Arena *arena = arena_new_mapped_growable(ARENA_SIZE, ARENA_SIZE * 4, ARENA_MMAP_GUARD);
+    ASSERT(arena != NULL, "Guarded arena should be created");
+    ArenaMapping *mapping = arena_get_mapping(arena);
+    ASSERT(mapping->guard > 0, "Guard length should be recorded");
+    ASSERT(!is_accessible((char *)arena - 1), "Byte before the arena should fault");
+    ASSERT(!is_accessible((char *)arena + mapping->reserved), "Byte after the reservation should fault");
+    ASSERT(is_accessible(arena), "Arena itself should be accessible");
+
+    TEST_CASE("Guarded arena grows up to the guard");
+    bool grew = true;
+    for (int i = 0; i < 3; i++) {
+        if (!arena_alloc(arena, ARENA_SIZE)) grew = false;
+    }
+    ASSERT(grew, "Arena should commit its whole reservation");
+    ASSERT(!is_accessible((char *)arena + mapping->reserved), "Guard should stay inaccessible");
+    arena_free(arena);
+
+    TEST_CASE("Fully committed arena is guarded as well");
+    Arena *fixed = arena_new_mapped(ARENA_SIZE, ARENA_MMAP_GUARD);
+    ASSERT(fixed != NULL && !is_accessible((char *)fixed - 1), "Fixed size arena should be guarded");
+    ASSERT(arena_alloc(fixed, BLOCK_SIZE) != NULL, "Fixed size arena should serve");
+    arena_free(fixed);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_validation_levels();
+    test_arena_keys();
+    test_hardened_links();
+    test_guard_pages();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
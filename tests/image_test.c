@@ -0,0 +1,145 @@
+#define ARENA_MMAP
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (256 * 1024)
+#define MAX_SIZE (4 * 1024 * 1024)
+#define NODE_COUNT (1000)
+
+typedef struct Node {
+    struct Node *next;
+    int value;
+    char label[20];
+} Node;
+
+static char image_path[64];
+
+static Node *build_list(Arena *arena, int count) {
+    Node *head = NULL;
+    for (int i = 0; i < count; i++) {
+        Node *node = (Node *)arena_alloc(arena, sizeof(Node));
+        node->next = head;
+        node->value = i;
+        memset(node->label, 'a' + i % 26, sizeof(node->label));
+        head = node;
+    }
+    return head;
+}
+
+static bool check_list(const Node *head, int count) {
+    for (int i = count - 1; i >= 0; i--, head = head->next) {
+        if (!head || head->value != i || head->label[0] != 'a' + i % 26) return false;
+    }
+    return head == NULL;
+}
+
+static void patch_file(size_t offset, char value) {
+    int fd = open(image_path, O_WRONLY);
+    if (pwrite(fd, &value, 1, (off_t)offset) != 1) printf("patch failed\n");
+    close(fd);
+}
+
+void test_image_round_trip(void) {
+    TEST_PHASE("Saving and Mapping Images");
+
+    TEST_CASE("Invalid parameters");
+    Arena *dynamic = arena_new_dynamic(ARENA_SIZE);
+    ASSERT(!arena_save(NULL, image_path), "NULL arena should fail");
+    ASSERT(!arena_save(dynamic, image_path), "Only mapped arenas can be saved");
+    ASSERT(arena_map_file(NULL, 0) == NULL, "NULL path should fail");
+    ASSERT(arena_map_file("/nonexistent/arena.img", 0) == NULL, "Missing file should fail");
+    arena_free(dynamic);
+
+    TEST_CASE("Pointers stay valid after a round trip");
+    Arena *arena = arena_new_mapped_growable(ARENA_SIZE, MAX_SIZE, 0);
+    Node *head = build_list(arena, NODE_COUNT);
+    ASSERT(arena_save(arena, image_path), "Mapped arena should be saved");
+    void *address = arena;
+    size_t capacity = arena_get_capacity(arena);
+    size_t tail = free_size_in_tail(arena);
+
+    TEST_CASE("Image cannot be mapped while its range is in use");
+    ASSERT(arena_map_file(image_path, 0) == NULL, "Occupied range should fail");
+    arena_free(arena);
+
+    Arena *loaded = arena_map_file(image_path, 0);
+    ASSERT(loaded == address && arena_get_capacity(loaded) == capacity, "Image should be mapped at its address");
+    ASSERT(loaded != NULL && check_list(head, NODE_COUNT), "Stored pointers should be valid without fixup");
+
+    TEST_CASE("Loaded arena keeps working");
+    arena_free_block(head);
+    ASSERT(arena_alloc(loaded, sizeof(Node)) == head, "Freed block should be reused");
+    void *big = arena_alloc(loaded, ARENA_SIZE * 2);
+    ASSERT(big != NULL && arena_get_capacity(loaded) > capacity, "Arena should grow past the image");
+    memset(big, 0x6B, ARENA_SIZE * 2);
+    head->value = -1;
+
+    TEST_CASE("Changes stay private to the process");
+    arena_free(loaded);
+    loaded = arena_map_file(image_path, ARENA_MMAP_POPULATE);
+    ASSERT(loaded != NULL && head->value == NODE_COUNT - 1, "File should keep the saved contents");
+    ASSERT(free_size_in_tail(loaded) == tail, "Saved tail should be free");
+    arena_reset_zero(loaded);
+    char *cleared = (char *)arena_alloc(loaded, 1024);
+    bool zero = true;
+    for (int i = 0; i < 1024; i++) if (cleared[i] != 0) zero = false;
+    ASSERT(zero, "Reset zero should clear image pages without dropping them");
+    arena_free(loaded);
+}
+
+void test_image_validation(void) {
+    TEST_PHASE("Image Validation");
+
+    Arena *arena = arena_new_mapped(ARENA_SIZE, 0);
+    build_list(arena, 16);
+    arena_save(arena, image_path);
+    arena_free(arena);
+
+    TEST_CASE("Corrupt header is rejected");
+    patch_file(0, 'X');
+    ASSERT(arena_map_file(image_path, 0) == NULL, "Bad magic should fail");
+    patch_file(0, 'A');
+    Arena *restored = arena_map_file(image_path, 0);
+    ASSERT(restored != NULL, "Restored magic should map again");
+    arena_free(restored);
+
+    TEST_CASE("Image of another build is rejected");
+    patch_file(offsetof(ArenaImageHeader, features) + 1, 0x7F);
+    ASSERT(arena_map_file(image_path, 0) == NULL, "Different features should fail");
+    arena = arena_new_mapped(ARENA_SIZE, 0);
+    arena_save(arena, image_path);
+    arena_free(arena);
+    patch_file(offsetof(ArenaImageHeader, ext_size), 0x7F);
+    ASSERT(arena_map_file(image_path, 0) == NULL, "Different extension size should fail");
+    arena = arena_new_mapped(ARENA_SIZE, 0);
+    arena_save(arena, image_path);
+    arena_free(arena);
+    patch_file(offsetof(ArenaImageHeader, block_size), 0x7F);
+    ASSERT(arena_map_file(image_path, 0) == NULL, "Different block size should fail");
+
+    TEST_CASE("Truncated image is rejected");
+    ASSERT(truncate(image_path, ARENA_SIZE / 2) == 0, "File should be truncated");
+    ASSERT(arena_map_file(image_path, 0) == NULL, "Short file should fail");
+
+    TEST_CASE("Saving replaces the file");
+    arena = arena_new_mapped(ARENA_SIZE, 0);
+    build_list(arena, 8);
+    ASSERT(arena_save(arena, image_path), "Save should replace the broken file");
+    arena_free(arena);
+    Arena *loaded = arena_map_file(image_path, 0);
+    ASSERT(loaded != NULL, "Replaced file should map");
+    arena_free(loaded);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+    snprintf(image_path, sizeof(image_path), "/tmp/arena_image_test_%ld.img", (long)getpid());
+
+    test_image_round_trip();
+    test_image_validation();
+
+    unlink(image_path);
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (64 * 1024)
+#define BLOCK_SIZE (64)
+#define ATTEMPTS (1000)
+
+void test_mark_rewind(void) {
+    TEST_PHASE("Mark and Rewind");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Invalid parameters");
+    ArenaMark invalid = arena_mark(NULL);
+    ASSERT(invalid.chunk == NULL, "NULL arena should give an invalid mark");
+    arena_rewind(NULL, invalid);
+    arena_rewind(arena, invalid);
+    Arena *other = arena_new_dynamic(ARENA_SIZE);
+    arena_alloc(arena, BLOCK_SIZE);
+    size_t tail_before = free_size_in_tail(arena);
+    arena_rewind(arena, arena_mark(other));
+    ASSERT(free_size_in_tail(arena) == tail_before, "Mark of another arena should be ignored");
+    arena_free(other);
+    arena_reset(arena);
+
+    TEST_CASE("Rewind to an empty arena");
+    size_t initial_tail = free_size_in_tail(arena);
+    ArenaMark empty = arena_mark(arena);
+    for (int i = 0; i < 10; i++) arena_alloc(arena, BLOCK_SIZE * (i + 1));
+    arena_rewind(arena, empty);
+    ASSERT(free_size_in_tail(arena) == initial_tail, "Whole arena should be free again");
+
+    TEST_CASE("Blocks before the mark survive");
+    void *keep = arena_alloc(arena, BLOCK_SIZE);
+    fill_memory_pattern(keep, BLOCK_SIZE, 0x11);
+    tail_before = free_size_in_tail(arena);
+    ArenaMark mark = arena_mark(arena);
+    void *first = arena_alloc(arena, BLOCK_SIZE * 2);
+    void *hole = arena_alloc(arena, BLOCK_SIZE * 3);
+    arena_alloc(arena, BLOCK_SIZE);
+    arena_free_block(hole); // Free blocks behind the mark must leave the free tree
+    ASSERT(arena_get_free_blocks(arena) != NULL, "Freed block should be in the tree");
+    arena_rewind(arena, mark);
+    ASSERT(free_size_in_tail(arena) == tail_before, "Tail should be back where it was");
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Free tree should not keep released blocks");
+    ASSERT(verify_memory_pattern(keep, BLOCK_SIZE, 0x11), "Block before the mark should keep its data");
+    ASSERT(arena_alloc(arena, BLOCK_SIZE * 2) == first, "Next allocation should reuse the released memory");
+    arena_rewind(arena, mark);
+
+    TEST_CASE("Rewinding twice and nested marks");
+    ArenaMark outer = arena_mark(arena);
+    arena_alloc(arena, BLOCK_SIZE);
+    ArenaMark inner = arena_mark(arena);
+    arena_alloc(arena, BLOCK_SIZE);
+    arena_rewind(arena, inner);
+    arena_rewind(arena, inner);
+    ASSERT(free_size_in_tail(arena) == tail_before - sizeof(Block) - BLOCK_SIZE, "Inner rewind should keep the outer block");
+    arena_rewind(arena, outer);
+    ASSERT(free_size_in_tail(arena) == tail_before, "Outer rewind should release both");
+
+    arena_free(arena);
+}
+
+void test_mark_edge_cases(void) {
+    TEST_PHASE("Rewind Edge Cases");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    void *before = arena_alloc(arena, BLOCK_SIZE);
+    size_t tail_before = free_size_in_tail(arena);
+    ArenaMark mark = arena_mark(arena);
+
+    TEST_CASE("Free block merged over the mark");
+    void *after = arena_alloc(arena, BLOCK_SIZE);
+    arena_alloc(arena, BLOCK_SIZE);
+    arena_free_block(before);
+    arena_free_block(after);
+    arena_rewind(arena, mark);
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Merged block should not stay in the tree");
+    ASSERT(free_size_in_tail(arena) == tail_before + sizeof(Block) + BLOCK_SIZE, "Merged block should join the tail");
+
+    TEST_CASE("Tail given back before the rewind");
+    arena_reset(arena);
+    before = arena_alloc(arena, BLOCK_SIZE);
+    mark = arena_mark(arena);
+    after = arena_alloc(arena, BLOCK_SIZE);
+    arena_free_block(after);
+    arena_free_block(before);
+    size_t tail = free_size_in_tail(arena);
+    arena_rewind(arena, mark);
+    ASSERT(free_size_in_tail(arena) == tail, "Rewind should leave an earlier tail alone");
+
+    TEST_CASE("Block before the mark grown over it");
+    arena_reset(arena);
+    before = arena_alloc(arena, BLOCK_SIZE);
+    mark = arena_mark(arena);
+    ASSERT(arena_try_resize(before, BLOCK_SIZE * 4), "Last block should grow into the tail");
+    arena_alloc(arena, BLOCK_SIZE);
+    arena_rewind(arena, mark);
+    fill_memory_pattern(before, BLOCK_SIZE * 4, 0x22);
+    void *next = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT((char *)next >= (char *)before + BLOCK_SIZE * 4, "New tail should start after the grown block");
+    ASSERT(verify_memory_pattern(before, BLOCK_SIZE * 4, 0x22), "Grown block should stay intact");
+
+    TEST_CASE("Mark of an absorbed tail");
+    arena_reset(arena);
+    void *whole = arena_alloc(arena, free_size_in_tail(arena));
+    mark = arena_mark(arena);
+    arena_rewind(arena, mark);
+    ASSERT(free_size_in_tail(arena) == 0 && arena_try_resize(whole, BLOCK_SIZE), "Block owning the tail should survive");
+
+    arena_free(arena);
+}
+
+void test_mark_scope(void) {
+    TEST_PHASE("Scoped Marks");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Scope rewinds at its end");
+    size_t tail_before = free_size_in_tail(arena);
+    int runs = 0;
+    ARENA_SCOPE(arena) {
+        runs++;
+        for (int i = 0; i < 32; i++) arena_alloc(arena, BLOCK_SIZE);
+        ASSERT(free_size_in_tail(arena) < tail_before, "Scope should allocate");
+    }
+    ASSERT(runs == 1 && free_size_in_tail(arena) == tail_before, "Scope should run once and rewind");
+
+    TEST_CASE("Speculative attempts do not accumulate");
+    bool stable = true;
+    for (int attempt = 0; attempt < ATTEMPTS; attempt++) {
+        ArenaMark mark = arena_mark(arena);
+        for (int i = 0; i < 16; i++) {
+            void *p = arena_alloc(arena, (size_t)(attempt % 7 + 1) * 16);
+            if (i % 3 == 0) arena_free_block(p);
+        }
+        arena_rewind(arena, mark);
+        if (free_size_in_tail(arena) != tail_before || arena_get_free_blocks(arena) != NULL) stable = false;
+    }
+    ASSERT(stable, "Every attempt should leave the arena as it found it");
+
+    arena_free(arena);
+}
+
+void test_mark_growable(void) {
+    TEST_PHASE("Marks in Growable Arenas");
+
+    Arena *arena = arena_new_dynamic_growable(1024);
+    void *before = arena_alloc(arena, BLOCK_SIZE);
+    ArenaMark mark = arena_mark(arena);
+
+    TEST_CASE("Chunks added after the mark are emptied");
+    for (int i = 0; i < 64; i++) arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(arena_get_chunk(arena)->next != NULL, "Arena should have grown");
+    arena_rewind(arena, mark);
+    bool empty = true;
+    for (Arena *chunk = arena_get_chunk(arena)->next; chunk != NULL; chunk = arena_get_chunk(chunk)->next) {
+        if (arena_get_tail(chunk) != arena_get_first_block(chunk)) empty = false;
+    }
+    ASSERT(empty, "Chunks after the mark should be empty");
+    void *again = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT((char *)again > (char *)before && (char *)again < (char *)arena + arena_get_capacity(arena), "Head chunk should serve again");
+
+    TEST_CASE("Stale mark after a reset is ignored");
+    ArenaMark late = arena_mark(arena);
+    arena_reset(arena);
+    arena_alloc(arena, BLOCK_SIZE);
+    arena_rewind(arena, late);
+    ASSERT(arena_get_tail(arena) != arena_get_first_block(arena), "Rewind past the reset should not release newer blocks");
+
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_mark_rewind();
+    test_mark_edge_cases();
+    test_mark_scope();
+    test_mark_growable();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (8 * 1024 * 1024)
+#define BIG_SIZE (ARENA_STREAM_COPY_MIN + 77) // Streamed, with a rest after the last full line
+#define FRAGMENT_COUNT (5)
+
+static void fill_pattern(unsigned char *buffer, size_t size, unsigned seed) {
+    for (size_t i = 0; i < size; i++) buffer[i] = (unsigned char)(i * 31 + seed);
+}
+
+static bool is_aligned(const void *ptr) {
+    return ((uintptr_t)ptr % ARENA_DEFAULT_ALIGNMENT) == 0;
+}
+
+void test_memdup(void) {
+    TEST_PHASE("Memory Duplication");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Invalid parameters");
+    char source[] = "payload";
+    ASSERT(arena_memdup(NULL, source, sizeof(source)) == NULL, "NULL arena should fail");
+    ASSERT(arena_memdup(arena, NULL, sizeof(source)) == NULL, "NULL source should fail");
+    ASSERT(arena_memdup(arena, source, 0) == NULL, "Empty buffer should fail");
+
+    TEST_CASE("Small buffer");
+    char *copy = (char *)arena_memdup(arena, source, sizeof(source));
+    ASSERT(copy != NULL && copy != source && memcmp(copy, source, sizeof(source)) == 0, "Copy should hold the buffer");
+    ASSERT(is_aligned(copy), "Copy should have the default alignment");
+    arena_free_block(copy);
+
+    TEST_CASE("Big buffer is streamed");
+    unsigned char *big = (unsigned char *)malloc(BIG_SIZE);
+    fill_pattern(big, BIG_SIZE, 7);
+    unsigned char *big_copy = (unsigned char *)arena_memdup(arena, big, BIG_SIZE);
+    ASSERT(big_copy != NULL && memcmp(big_copy, big, BIG_SIZE) == 0, "Big copy should hold the buffer");
+    arena_free_block(big_copy);
+
+    TEST_CASE("Unaligned source");
+    big_copy = (unsigned char *)arena_memdup(arena, big + 3, BIG_SIZE - 3);
+    ASSERT(big_copy != NULL && memcmp(big_copy, big + 3, BIG_SIZE - 3) == 0, "Copy of an unaligned source should match");
+    arena_free_block(big_copy);
+
+    TEST_CASE("Too big buffer");
+    ASSERT(arena_memdup(arena, big, ARENA_SIZE * 2) == NULL, "Buffer bigger than the arena should fail");
+
+    free(big);
+    arena_free(arena);
+}
+
+void test_strdup(void) {
+    TEST_PHASE("String Duplication");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Invalid parameters");
+    ASSERT(arena_strdup(NULL, "text") == NULL && arena_strdup(arena, NULL) == NULL, "Invalid strdup should fail");
+    ASSERT(arena_strndup(NULL, "text", 4) == NULL && arena_strndup(arena, NULL, 4) == NULL, "Invalid strndup should fail");
+
+    TEST_CASE("Whole string");
+    const char *text = "scattered packet";
+    char *copy = arena_strdup(arena, text);
+    ASSERT(copy != NULL && copy != text && strcmp(copy, text) == 0, "Copy should hold the string");
+    char *empty = arena_strdup(arena, "");
+    ASSERT(empty != NULL && empty[0] == '\0', "Empty string should be copied");
+
+    TEST_CASE("Bounded copies");
+    char *prefix = arena_strndup(arena, text, 9);
+    ASSERT(prefix != NULL && strcmp(prefix, "scattered") == 0, "Prefix should be terminated");
+    char *whole = arena_strndup(arena, text, 1000);
+    ASSERT(whole != NULL && strcmp(whole, text) == 0, "Bound past the end should copy the whole string");
+    char unterminated[4] = { 'a', 'b', 'c', 'd' };
+    char *bounded = arena_strndup(arena, unterminated, sizeof(unterminated));
+    ASSERT(bounded != NULL && strcmp(bounded, "abcd") == 0, "Unterminated buffer should be read up to the bound");
+    char *none = arena_strndup(arena, text, 0);
+    ASSERT(none != NULL && none[0] == '\0', "Zero bound should give an empty string");
+
+    arena_free(arena);
+}
+
+void test_copy_iov(void) {
+    TEST_PHASE("Scatter-Gather Copies");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Invalid parameters");
+    char header[] = "HDR:";
+    ArenaIoVec single = { header, 4 };
+    ASSERT(arena_copy_iov(NULL, &single, 1) == NULL, "NULL arena should fail");
+    ASSERT(arena_copy_iov(arena, NULL, 1) == NULL && arena_copy_iov(arena, &single, 0) == NULL, "No buffers should fail");
+    ArenaIoVec empty[2] = { { header, 0 }, { NULL, 0 } };
+    ASSERT(arena_copy_iov(arena, empty, 2) == NULL, "Only empty buffers should fail");
+    ArenaIoVec missing = { NULL, 8 };
+    ASSERT(arena_copy_iov(arena, &missing, 1) == NULL, "NULL buffer with a length should fail");
+    ArenaIoVec overflow[2] = { { header, SIZE_MAX - 2 }, { header, 4 } };
+    ASSERT(arena_copy_iov(arena, overflow, 2) == NULL, "Overflowing lengths should fail");
+
+    TEST_CASE("Fragments are gathered in order");
+    char body[] = "payload";
+    char trailer[] = ";END";
+    ArenaIoVec fragments[4] = { { header, 4 }, { body, 7 }, { NULL, 0 }, { trailer, 4 } };
+    char *packet = (char *)arena_copy_iov(arena, fragments, 4);
+    ASSERT(packet != NULL && memcmp(packet, "HDR:payload;END", 15) == 0, "Fragments should follow each other");
+    ASSERT(is_aligned(packet), "Gathered block should have the default alignment");
+
+    TEST_CASE("Big and small fragments are gathered in one block");
+    size_t sizes[FRAGMENT_COUNT] = { 13, BIG_SIZE, 1, 4096 + 5, BIG_SIZE / 2 };
+    ArenaIoVec big[FRAGMENT_COUNT];
+    size_t total = 0;
+    for (int i = 0; i < FRAGMENT_COUNT; i++) {
+        big[i].iov_base = malloc(sizes[i]);
+        big[i].iov_len = sizes[i];
+        fill_pattern((unsigned char *)big[i].iov_base, sizes[i], (unsigned)i);
+        total += sizes[i];
+    }
+    unsigned char *gathered = (unsigned char *)arena_copy_iov(arena, big, FRAGMENT_COUNT);
+    bool intact = gathered != NULL;
+    size_t offset = 0;
+    for (int i = 0; i < FRAGMENT_COUNT && intact; i++) {
+        intact = memcmp(gathered + offset, big[i].iov_base, sizes[i]) == 0;
+        offset += sizes[i];
+    }
+    ASSERT(intact && offset == total, "Every fragment should be copied behind the previous one");
+    for (int i = 0; i < FRAGMENT_COUNT; i++) free(big[i].iov_base);
+
+    TEST_CASE("Gather that does not fit");
+    ArenaIoVec huge[2] = { { header, ARENA_SIZE }, { header, ARENA_SIZE } };
+    ASSERT(arena_copy_iov(arena, huge, 2) == NULL, "Gather bigger than the arena should fail");
+
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_memdup();
+    test_strdup();
+    test_copy_iov();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
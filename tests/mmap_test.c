@@ -0,0 +1,151 @@
+#define ARENA_MMAP
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (64 * 1024)
+#define MAX_SIZE (16 * 1024 * 1024)
+#define BLOCK_SIZE (1024)
+
+void test_mapped_creation(void) {
+    TEST_PHASE("Mapped Arena Creation");
+
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    TEST_CASE("Invalid parameters");
+    ASSERT(arena_new_mapped(0, 0) == NULL, "Zero size should fail");
+    ASSERT(arena_new_mapped(SIZE_MAX, 0) == NULL, "Huge size should fail");
+    ASSERT(arena_new_mapped_custom(ARENA_SIZE, 24, 0) == NULL, "Non power of two alignment should fail");
+    ASSERT(arena_new_mapped_custom(ARENA_SIZE, MAX_ALIGNMENT * 2, 0) == NULL, "Too big alignment should fail");
+    ASSERT(arena_new_mapped_growable(ARENA_SIZE, ARENA_SIZE - 1, 0) == NULL, "Reservation smaller than the commit should fail");
+
+    TEST_CASE("Arena lives at the start of its mapping");
+    Arena *arena = arena_new_mapped(ARENA_SIZE, 0);
+    ASSERT(arena != NULL, "Mapped arena should be created");
+    ASSERT(((uintptr_t)arena % page_size) == 0, "Arena should be page aligned");
+    ASSERT(arena_get_capacity(arena) >= ARENA_SIZE && (arena_get_capacity(arena) % page_size) == 0, "Capacity should cover whole pages");
+    ASSERT(!arena_get_is_dynamic(arena) && arena_get_is_mapped(arena), "Arena should be flagged as mapped");
+
+    TEST_CASE("Mapped arena behaves like any other arena");
+    void *blocks[8];
+    for (int i = 0; i < 8; i++) {
+        blocks[i] = arena_alloc(arena, BLOCK_SIZE);
+        fill_memory_pattern(blocks[i], BLOCK_SIZE, i);
+    }
+    arena_free_block(blocks[3]);
+    ASSERT(arena_alloc(arena, BLOCK_SIZE) == blocks[3], "Freed block should be reused");
+    ASSERT(arena_alloc(arena, ARENA_SIZE) == NULL, "Fixed mapped arena should not grow");
+    void *aligned = arena_alloc_custom(arena, 64, 1024);
+    ASSERT(aligned != NULL && ((uintptr_t)aligned % 1024) == 0, "Custom alignment should work");
+    Arena *nested = arena_new_nested(arena, 4096);
+    ASSERT(nested != NULL && !arena_get_is_mapped(nested), "Nested arena should not inherit the mapping");
+    arena_free(nested);
+    arena_free(arena);
+
+    TEST_CASE("Huge pages and prefaulting");
+    Arena *huge = arena_new_mapped(ARENA_SIZE, ARENA_MMAP_HUGEPAGES | ARENA_MMAP_POPULATE);
+    ASSERT(huge != NULL, "Huge page request should fall back to regular pages if needed");
+    ASSERT(arena_get_mapping(huge)->granule == ARENA_HUGE_PAGE_SIZE, "Huge page mapping should be rounded to huge pages");
+    void *p = arena_alloc(huge, BLOCK_SIZE);
+    fill_memory_pattern(p, BLOCK_SIZE, 0x42);
+    ASSERT(verify_memory_pattern(p, BLOCK_SIZE, 0x42), "Huge page memory should be usable");
+    arena_free(huge);
+
+    Arena *populated = arena_new_mapped(ARENA_SIZE, ARENA_MMAP_POPULATE);
+    ASSERT(populated != NULL && arena_alloc(populated, BLOCK_SIZE) != NULL, "Prefaulted arena should be usable");
+    arena_free(populated);
+}
+
+void test_mapped_growth(void) {
+    TEST_PHASE("Mapped Arena Growth");
+
+    TEST_CASE("Arena grows in place");
+    Arena *arena = arena_new_mapped_growable(ARENA_SIZE, MAX_SIZE, 0);
+    ASSERT(arena != NULL, "Growable mapped arena should be created");
+    size_t initial = arena_get_capacity(arena);
+    ASSERT(initial < MAX_SIZE, "Only the first part should be committed");
+
+    void *first = arena_alloc(arena, BLOCK_SIZE);
+    fill_memory_pattern(first, BLOCK_SIZE, 0x11);
+    void *big = arena_alloc(arena, ARENA_SIZE * 4);
+    ASSERT(big != NULL, "Allocation beyond the commit should succeed");
+    ASSERT(arena_get_capacity(arena) > initial, "Capacity should grow");
+    ASSERT((char *)big > (char *)first && (char *)big < (char *)arena + arena_get_capacity(arena), "Arena should grow contiguously");
+    fill_memory_pattern(big, ARENA_SIZE * 4, 0x22);
+    ASSERT(verify_memory_pattern(first, BLOCK_SIZE, 0x11), "Earlier blocks should stay in place");
+
+    TEST_CASE("Growth after the tail was absorbed");
+    size_t rest = free_size_in_tail(arena);
+    void *last = arena_alloc(arena, rest);
+    ASSERT(last != NULL && free_size_in_tail(arena) == 0, "Last allocation should absorb the tail");
+    void *after = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(after != NULL && (char *)after > (char *)last, "Arena should grow behind an occupied tail");
+    arena_free_block(last);
+    arena_free_block(after);
+
+    TEST_CASE("Reservation limits the growth");
+    ASSERT(arena_alloc(arena, MAX_SIZE) == NULL, "Request beyond the reservation should fail");
+    size_t count = 0;
+    while (arena_alloc(arena, ARENA_SIZE) != NULL) count++;
+    ASSERT(count > 0 && arena_get_capacity(arena) == arena_get_mapping(arena)->reserved, "Arena should commit the whole reservation");
+    ASSERT(arena_get_capacity(arena) >= MAX_SIZE, "Reservation should hold the requested maximum");
+
+    arena_reset(arena);
+    ASSERT(free_size_in_tail(arena) > MAX_SIZE - ARENA_SIZE, "Reset should keep the committed memory");
+    arena_free(arena);
+
+    TEST_CASE("Batch allocations grow the arena");
+    Arena *batched = arena_new_mapped_growable(ARENA_SIZE, MAX_SIZE, ARENA_MMAP_POPULATE);
+    static void *nodes[256];
+    ASSERT(arena_alloc_batch(batched, BLOCK_SIZE, 256, nodes) == 256, "Batch should commit the memory it needs");
+    arena_free(batched);
+}
+
+void test_mapped_release(void) {
+    TEST_PHASE("Mapped Arena Release On Reset");
+
+    TEST_CASE("Released pages read as zero");
+    Arena *arena = arena_new_mapped(ARENA_SIZE * 4, ARENA_MMAP_RELEASE);
+    void *p = arena_alloc(arena, ARENA_SIZE * 2);
+    memset(p, 0xAB, ARENA_SIZE * 2);
+    arena_reset(arena);
+    void *q = arena_alloc(arena, ARENA_SIZE * 2);
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    char *page = (char *)align_up((uintptr_t)q, page_size);
+    bool zero = true;
+    for (size_t i = 0; i < ARENA_SIZE; i++) {
+        if (page[i] != 0) zero = false;
+    }
+    ASSERT(q == p && zero, "Pages given back to the OS should come back zeroed");
+
+    TEST_CASE("Reset zero skips released pages");
+    memset(q, 0xCD, ARENA_SIZE * 2);
+    arena_reset_zero(arena);
+    char *r = (char *)arena_alloc(arena, ARENA_SIZE * 2);
+    zero = true;
+    for (size_t i = 0; i < ARENA_SIZE * 2; i++) {
+        if (r[i] != 0) zero = false;
+    }
+    ASSERT(zero, "Whole tail should read as zero");
+    arena_free(arena);
+
+    TEST_CASE("Lazy release keeps the arena usable");
+    Arena *lazy = arena_new_mapped(ARENA_SIZE, ARENA_MMAP_LAZY_RELEASE);
+    void *l = arena_alloc(lazy, BLOCK_SIZE);
+    memset(l, 0xEF, BLOCK_SIZE);
+    arena_reset_zero(lazy);
+    l = arena_alloc(lazy, BLOCK_SIZE);
+    ASSERT(((char *)l)[BLOCK_SIZE - 1] == 0, "Reset zero should clear memory that may not be released yet");
+    arena_free(lazy);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_mapped_creation();
+    test_mapped_growth();
+    test_mapped_release();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,167 @@
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define PARENT_SIZE (1024 * 1024)
+#define CHUNK_SIZE (ARENA_MIN_SIZE + 1024)
+#define CONNECTION_SIZE (ARENA_MIN_SIZE + 256)
+#define BLOCK_SIZE (128)
+#define CONNECTIONS (2000)
+
+static bool is_inside(const void *ptr, const Arena *arena) {
+    return (const char *)ptr >= (const char *)arena && (const char *)ptr < (const char *)arena + arena_get_capacity(arena);
+}
+
+static size_t count_chunks(Arena *arena) {
+    size_t count = 0;
+    for (Arena *chunk = arena; chunk != NULL; chunk = arena_get_chunk(chunk)->next) count++;
+    return count;
+}
+
+void test_nested_growable_creation(void) {
+    TEST_PHASE("Nested Growable Creation");
+
+    Arena *parent = arena_new_dynamic(PARENT_SIZE);
+
+    TEST_CASE("Invalid parameters");
+    ArenaGrowthPolicy bad = { 0, 0, 0 };
+    ASSERT(arena_new_nested_growable(NULL, CHUNK_SIZE) == NULL, "NULL parent should fail");
+    ASSERT(arena_new_nested_growable(parent, 0) == NULL, "Zero size should fail");
+    ASSERT(arena_new_nested_growable_custom(parent, CHUNK_SIZE, 24, NULL) == NULL, "Invalid alignment should fail");
+    ASSERT(arena_new_nested_growable_custom(parent, CHUNK_SIZE, 16, &bad) == NULL, "Zero growth factor should fail");
+    ASSERT(arena_new_nested_growable(parent, PARENT_SIZE * 2) == NULL, "Arena bigger than the parent should fail");
+
+    TEST_CASE("First chunk is carved from the parent");
+    Arena *arena = arena_new_nested_growable(parent, CHUNK_SIZE);
+    ASSERT(arena != NULL && is_inside(arena, parent), "Arena should live inside the parent");
+    ASSERT(arena_get_is_nested(arena) && arena_get_has_chunk(arena), "Arena should be nested and chained");
+    ASSERT(arena_get_alignment(arena) == arena_get_alignment(parent), "Arena should take the alignment of the parent");
+
+    arena_free(arena);
+    arena_free(parent);
+}
+
+void test_nested_growable_growth(void) {
+    TEST_PHASE("Growing From the Parent");
+
+    Arena *parent = arena_new_dynamic(PARENT_SIZE);
+    size_t initial_tail = free_size_in_tail(parent);
+    Arena *arena = arena_new_nested_growable(parent, CHUNK_SIZE);
+
+    TEST_CASE("New chunks are borrowed from the parent");
+    void *blocks[64];
+    bool inside = true;
+    for (int i = 0; i < 64; i++) {
+        blocks[i] = arena_alloc(arena, BLOCK_SIZE);
+        if (!blocks[i] || !is_inside(blocks[i], parent)) inside = false;
+        else fill_memory_pattern(blocks[i], BLOCK_SIZE, i);
+    }
+    ASSERT(inside, "Every block should come from the parent memory");
+    ASSERT(count_chunks(arena) > 1, "Arena should have grown");
+
+    TEST_CASE("Blocks keep their data across chunks");
+    bool intact = true;
+    for (int i = 0; i < 64; i++) {
+        if (!verify_memory_pattern(blocks[i], BLOCK_SIZE, i)) intact = false;
+    }
+    ASSERT(intact, "Blocks should not overlap");
+
+    TEST_CASE("Request bigger than a chunk gets its own chunk");
+    void *big = arena_alloc(arena, CHUNK_SIZE * 8);
+    ASSERT(big != NULL && is_inside(big, parent), "Big block should be served from the parent");
+
+    TEST_CASE("Reset gives the extra chunks back");
+    arena_reset(arena);
+    ASSERT(count_chunks(arena) == 1, "Only the first chunk should be left");
+    ASSERT(arena_alloc(arena, BLOCK_SIZE) != NULL, "Arena should still serve after a reset");
+
+    TEST_CASE("Free gives everything back");
+    arena_free(arena);
+    ASSERT(free_size_in_tail(parent) == initial_tail && arena_get_free_blocks(parent) == NULL, "Parent should be one tail again");
+
+    arena_free(parent);
+}
+
+void test_nested_growable_policy(void) {
+    TEST_PHASE("Growth Policy of Nested Arenas");
+
+    Arena *parent = arena_new_dynamic(PARENT_SIZE);
+    ArenaGrowthPolicy policy = { 1, 0, ARENA_RETAIN_ALL };
+    Arena *arena = arena_new_nested_growable_custom(parent, CHUNK_SIZE, 64, &policy);
+
+    TEST_CASE("Retained chunks survive a reset");
+    for (int i = 0; i < 32; i++) arena_alloc(arena, BLOCK_SIZE);
+    size_t chunks = count_chunks(arena);
+    arena_reset(arena);
+    ASSERT(chunks > 1 && count_chunks(arena) == chunks, "Chunks should be kept for the next cycle");
+    void *p = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(p != NULL && ((uintptr_t)p % 64) == 0, "Blocks should honor the arena alignment");
+
+    arena_free(arena);
+    arena_free(parent);
+}
+
+void test_nested_growable_subtree(void) {
+    TEST_PHASE("Per-Connection Scoping");
+
+    Arena *parent = arena_new_dynamic(PARENT_SIZE * 16);
+    size_t initial_tail = free_size_in_tail(parent);
+    Arena *group = arena_new_nested_growable(parent, CHUNK_SIZE * 16);
+
+    TEST_CASE("Many small connections share one group");
+    static Arena *connections[CONNECTIONS];
+    bool created = true;
+    for (int i = 0; i < CONNECTIONS; i++) {
+        connections[i] = arena_new_nested_growable(group, CONNECTION_SIZE);
+        if (!connections[i] || !arena_alloc(connections[i], 64)) created = false;
+    }
+    ASSERT(created, "Every connection arena should be created");
+
+    TEST_CASE("Busy connection grows on demand");
+    bool grew = true;
+    for (int i = 0; i < 16; i++) {
+        if (!arena_alloc(connections[0], BLOCK_SIZE)) grew = false;
+    }
+    ASSERT(grew && count_chunks(connections[0]) > 1, "Connection should borrow chunks from the group");
+
+    TEST_CASE("Closing one connection");
+    arena_free(connections[1]);
+    ASSERT(arena_alloc(connections[2], 64) != NULL, "Other connections should be unaffected");
+
+    TEST_CASE("Freeing the group releases the whole subtree");
+    arena_free(group);
+    ASSERT(free_size_in_tail(parent) == initial_tail && arena_get_free_blocks(parent) == NULL, "Parent should be one tail again");
+
+    arena_free(parent);
+}
+
+void test_nested_growable_in_growable(void) {
+    TEST_PHASE("Nested Arena in a Growable Parent");
+
+    Arena *parent = arena_new_dynamic_growable(CHUNK_SIZE * 4);
+    Arena *arena = arena_new_nested_growable(parent, CHUNK_SIZE);
+
+    TEST_CASE("Parent grows to serve the nested arena");
+    bool served = true;
+    for (int i = 0; i < 128; i++) {
+        if (!arena_alloc(arena, BLOCK_SIZE)) served = false;
+    }
+    ASSERT(served, "Nested arena should grow together with its parent");
+    ASSERT(count_chunks(parent) > 1, "Parent should have grown");
+
+    arena_free(arena);
+    arena_free(parent);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_nested_growable_creation();
+    test_nested_growable_growth();
+    test_nested_growable_policy();
+    test_nested_growable_subtree();
+    test_nested_growable_in_growable();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,120 @@
+#define ARENA_NUMA
+#define ARENA_THREAD_SAFE
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+#include <pthread.h>
+
+#define ARENA_SIZE (256 * 1024)
+#define NESTED_SIZE (16 * 1024)
+#define BLOCK_SIZE (256)
+#define THREAD_COUNT 4
+
+void test_numa_creation(void) {
+    TEST_PHASE("NUMA Arena Creation");
+
+    TEST_CASE("Invalid parameters");
+    ASSERT(arena_new_dynamic_numa(ARENA_SIZE, -1) == NULL, "Negative node should fail");
+    ASSERT(arena_new_dynamic_numa(ARENA_SIZE, ARENA_NUMA_MAX_NODES) == NULL, "Node past the limit should fail");
+    ASSERT(arena_new_dynamic_numa(0, 0) == NULL, "Zero size should fail");
+    ASSERT(arena_new_dynamic_numa_custom(ARENA_SIZE, 24, 0, 0) == NULL, "Non power of two alignment should fail");
+
+    TEST_CASE("Current node");
+    int node = arena_numa_current_node();
+    ASSERT(node >= 0 && node < ARENA_NUMA_MAX_NODES, "Current node should be in range");
+
+    TEST_CASE("Arena bound to the current node");
+    Arena *arena = arena_new_dynamic_numa(ARENA_SIZE, node);
+    ASSERT(arena != NULL && arena_get_is_mapped(arena), "NUMA arena should be a mapped arena");
+    ASSERT(arena_get_capacity(arena) >= ARENA_SIZE, "Capacity should cover the request");
+    void *p = arena_alloc(arena, BLOCK_SIZE);
+    fill_memory_pattern(p, BLOCK_SIZE, 0x5A);
+    ASSERT(verify_memory_pattern(p, BLOCK_SIZE, 0x5A), "Node local memory should be usable");
+    ASSERT(arena_alloc(arena, ARENA_SIZE * 2) == NULL, "NUMA arena should not grow");
+    arena_free(arena);
+
+    TEST_CASE("Flags of mapped arenas apply");
+    Arena *huge = arena_new_dynamic_numa_custom(ARENA_SIZE, 64, node, ARENA_MMAP_HUGEPAGES | ARENA_MMAP_POPULATE);
+    ASSERT(huge != NULL && arena_get_mapping(huge)->granule == ARENA_HUGE_PAGE_SIZE, "Huge page NUMA arena should be created");
+    void *aligned = arena_alloc_custom(huge, BLOCK_SIZE, 64);
+    ASSERT(aligned != NULL && ((uintptr_t)aligned % 64) == 0, "Custom alignment should work");
+    arena_free(huge);
+}
+
+void test_numa_pool(void) {
+    TEST_PHASE("NUMA Arena Pool");
+
+    ArenaNumaPool pool;
+
+    TEST_CASE("Invalid parameters");
+    ASSERT(!arena_numa_pool_init(NULL, ARENA_SIZE, 0), "NULL pool should fail");
+    ASSERT(!arena_numa_pool_init(&pool, 0, 0), "Zero size should fail");
+    ASSERT(pool.fallback == NULL, "Failed init should leave the pool empty");
+    ASSERT(arena_numa_pool_local(NULL) == NULL && arena_numa_pool_new_nested(&pool, NESTED_SIZE) == NULL, "Empty pool should have no arenas");
+    arena_numa_pool_free(NULL);
+
+    TEST_CASE("Pool holds an arena for the current node");
+    ASSERT(arena_numa_pool_init(&pool, ARENA_SIZE, 0), "Pool should be created");
+    Arena *local = arena_numa_pool_local(&pool);
+    ASSERT(local != NULL && local == pool.nodes[arena_numa_current_node()], "Local arena should belong to the current node");
+    ASSERT(pool.fallback != NULL, "Pool should have a fallback arena");
+
+    TEST_CASE("Nested arenas come from the local arena");
+    Arena *nested = arena_numa_pool_new_nested(&pool, NESTED_SIZE);
+    ASSERT(nested != NULL && get_parent_arena(nested) == local, "Nested arena should be carved from the local arena");
+    ASSERT(arena_alloc(nested, BLOCK_SIZE) != NULL, "Nested arena should be usable");
+    arena_free(nested);
+
+    arena_numa_pool_free(&pool);
+    ASSERT(pool.fallback == NULL && arena_numa_pool_local(&pool) == NULL, "Freed pool should be empty");
+}
+
+static ArenaNumaPool shared_pool;
+
+static void *numa_worker(void *arg) {
+    int id = (int)(intptr_t)arg;
+    Arena *own = arena_numa_pool_new_nested(&shared_pool, NESTED_SIZE);
+    if (!own) return (void *)0;
+
+    bool ok = true;
+    for (int i = 0; i < 32 && ok; i++) {
+        void *p = arena_alloc(own, BLOCK_SIZE);
+        if (!p) { ok = false; break; }
+        fill_memory_pattern(p, BLOCK_SIZE, id + i);
+        ok = verify_memory_pattern(p, BLOCK_SIZE, id + i);
+    }
+    arena_free(own);
+
+    return (void *)(intptr_t)ok;
+}
+
+void test_numa_threads(void) {
+    TEST_PHASE("NUMA Pool Shared By Threads");
+
+    TEST_CASE("Every thread gets a local nested arena");
+    ASSERT(arena_numa_pool_init(&shared_pool, ARENA_SIZE, 0), "Pool should be created");
+    pthread_t threads[THREAD_COUNT];
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        pthread_create(&threads[i], NULL, numa_worker, (void *)(intptr_t)i);
+    }
+    int succeeded = 0;
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        void *result;
+        pthread_join(threads[i], &result);
+        if (result) succeeded++;
+    }
+    ASSERT(succeeded == THREAD_COUNT, "Every worker should allocate from its own arena");
+    ASSERT(arena_get_free_blocks(arena_numa_pool_local(&shared_pool)) == NULL, "Freed nested arenas should go back to the pool arena");
+    arena_numa_pool_free(&shared_pool);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_numa_creation();
+    test_numa_pool();
+    test_numa_threads();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (64 * 1024)
+#define SLOT_SIZE (24)
+#define STRESS_SLOTS (512)
+#define STRESS_CYCLES (20000)
+
+static size_t count_slabs(ArenaPoolSlab *slab) {
+    size_t count = 0;
+    for (; slab != NULL; slab = slab->next) count++;
+    return count;
+}
+
+void test_pool_basic(void) {
+    TEST_PHASE("Object Pool Basics");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Invalid parameters");
+    ASSERT(arena_pool_new(NULL, SLOT_SIZE) == NULL, "NULL parent should fail");
+    ASSERT(arena_pool_new(arena, 0) == NULL, "Zero slot size should fail");
+    ASSERT(arena_pool_new(arena, ARENA_POOL_SLAB_SIZE) == NULL, "Slot bigger than a slab should fail");
+    ASSERT(arena_pool_new_custom(arena, SLOT_SIZE, 3) == NULL, "Non power of two alignment should fail");
+    ASSERT(arena_pool_new_custom(arena, SLOT_SIZE, ARENA_POOL_SLAB_SIZE * 2) == NULL, "Alignment above the slab size should fail");
+    ASSERT(arena_pool_alloc(NULL) == NULL, "NULL pool should not allocate");
+    arena_pool_release(NULL, NULL);
+    arena_pool_reset(NULL);
+    arena_pool_free(NULL);
+
+    TEST_CASE("Slots are packed without headers");
+    ArenaPool *pool = arena_pool_new(arena, SLOT_SIZE);
+    ASSERT(pool != NULL && pool->slot_size == SLOT_SIZE, "Slot size should only be rounded to the pointer size");
+    char *first = (char *)arena_pool_alloc(pool);
+    char *second = (char *)arena_pool_alloc(pool);
+    ASSERT(first != NULL && second == first + SLOT_SIZE, "Consecutive slots should be adjacent");
+    ASSERT(((uintptr_t)first & (ARENA_POOL_SLAB_SIZE - 1)) == pool->slot_offset, "First slot should follow the slab header");
+
+    TEST_CASE("Released slot is reused first");
+    fill_memory_pattern(second, SLOT_SIZE, 0x5A);
+    arena_pool_release(pool, first);
+    ASSERT(arena_pool_alloc(pool) == first, "Last released slot should come back");
+    ASSERT(verify_memory_pattern(second, SLOT_SIZE, 0x5A), "Neighbour slot should keep its data");
+
+    TEST_CASE("Foreign pointers are ignored");
+    ArenaPool *other = arena_pool_new(arena, SLOT_SIZE);
+    void *foreign = arena_pool_alloc(other);
+    arena_pool_release(pool, foreign);
+    ASSERT(arena_pool_alloc(other) != foreign, "Slot of another pool should not be released");
+    arena_pool_free(other);
+
+    TEST_CASE("Custom alignment");
+    ArenaPool *aligned = arena_pool_new_custom(arena, SLOT_SIZE, 64);
+    bool all_aligned = true;
+    for (int i = 0; i < 40; i++) {
+        if (((uintptr_t)arena_pool_alloc(aligned) & 63) != 0) all_aligned = false;
+    }
+    ASSERT(aligned != NULL && aligned->slot_size == 64 && all_aligned, "Slots should honour the alignment");
+    arena_pool_free(aligned);
+
+    arena_pool_free(pool);
+    arena_free(arena);
+}
+
+void test_pool_slabs(void) {
+    TEST_PHASE("Slab Lifecycle");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    size_t initial_tail = free_size_in_tail(arena);
+    ArenaPool *pool = arena_pool_new(arena, SLOT_SIZE);
+    size_t per_slab = pool->slots_per_slab;
+    void **slots = (void **)malloc(sizeof(void *) * per_slab * 3);
+
+    TEST_CASE("Full slabs move off the available list");
+    for (size_t i = 0; i < per_slab * 3; i++) slots[i] = arena_pool_alloc(pool);
+    ASSERT(count_slabs(pool->full) == 3 && pool->available == NULL, "Three full slabs expected");
+
+    TEST_CASE("Slab size follows the configuration");
+    uintptr_t base = (uintptr_t)slots[0] & ~(uintptr_t)(ARENA_POOL_SLAB_SIZE - 1);
+    uintptr_t next = (uintptr_t)slots[per_slab] & ~(uintptr_t)(ARENA_POOL_SLAB_SIZE - 1);
+    ASSERT(next - base == ARENA_POOL_SLAB_SIZE, "Slabs should tile the parent without padding");
+
+    TEST_CASE("Empty slabs go back to the parent");
+    for (size_t i = 0; i < per_slab; i++) arena_pool_release(pool, slots[i]);
+    ASSERT(pool->spare != NULL && count_slabs(pool->available) == 1, "First empty slab should stay as a spare");
+    for (size_t i = per_slab; i < per_slab * 2; i++) arena_pool_release(pool, slots[i]);
+    ASSERT(count_slabs(pool->available) == 1 && count_slabs(pool->full) == 1, "Second empty slab should be released");
+    ASSERT(arena_get_free_blocks(arena) != NULL, "Released slab should be free in the parent");
+
+    TEST_CASE("Spare slab serves the next allocation");
+    void *again = arena_pool_alloc(pool);
+    ASSERT(((uintptr_t)again & ~(uintptr_t)(ARENA_POOL_SLAB_SIZE - 1)) == base && pool->spare == NULL, "Spare should be taken");
+    arena_pool_release(pool, again);
+
+    TEST_CASE("Reset releases every slab");
+    arena_pool_reset(pool);
+    ASSERT(pool->available == NULL && pool->full == NULL && pool->spare == NULL, "Pool should be empty");
+    ASSERT(arena_pool_alloc(pool) != NULL, "Reset pool should allocate again");
+
+    TEST_CASE("Free returns everything to the parent");
+    arena_pool_free(pool);
+    ASSERT(free_size_in_tail(arena) == initial_tail, "Parent should be empty again");
+
+    TEST_CASE("Exhausted parent fails cleanly");
+    Arena *small = arena_new_dynamic(ARENA_POOL_SLAB_SIZE * 2);
+    ArenaPool *bounded = arena_pool_new(small, SLOT_SIZE);
+    void *last = NULL;
+    size_t count = 0;
+    while ((last = arena_pool_alloc(bounded)) != NULL) count++;
+    ASSERT(count > 0 && count <= bounded->slots_per_slab * 2, "Pool should stop at the parent capacity");
+    arena_pool_free(bounded);
+    arena_free(small);
+
+    free(slots);
+    arena_free(arena);
+}
+
+void test_pool_stress(void) {
+    TEST_PHASE("Object Pool Stress");
+
+    Arena *arena = arena_new_dynamic_growable(ARENA_SIZE);
+    ArenaPool *pool = arena_pool_new(arena, SLOT_SIZE);
+    void *slots[STRESS_SLOTS] = {0};
+    bool intact = true;
+    srand(17);
+
+    TEST_CASE("Random churn keeps data intact");
+    for (int i = 0; i < STRESS_CYCLES; i++) {
+        int slot = rand() % STRESS_SLOTS;
+        if (slots[slot]) {
+            if (!verify_memory_pattern(slots[slot], SLOT_SIZE, slot)) intact = false;
+            arena_pool_release(pool, slots[slot]);
+            slots[slot] = NULL;
+        }
+        else {
+            slots[slot] = arena_pool_alloc(pool);
+            if (slots[slot]) fill_memory_pattern(slots[slot], SLOT_SIZE, slot);
+            else intact = false;
+        }
+    }
+    ASSERT(intact, "Live slots should keep their patterns");
+
+    TEST_CASE("Releasing everything leaves only the spare");
+    for (int i = 0; i < STRESS_SLOTS; i++) {
+        if (slots[i]) arena_pool_release(pool, slots[i]);
+    }
+    ASSERT(pool->full == NULL && count_slabs(pool->available) == 1 && pool->spare == pool->available, "Only the spare slab should remain");
+
+    arena_pool_free(pool);
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_pool_basic();
+    test_pool_slabs();
+    test_pool_stress();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,189 @@
+#define ARENA_PROFILING
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (1024 * 1024)
+#define BLOCK_SIZE (64)
+#define RATE (4096)
+#define ALLOCATIONS (2000)
+
+static size_t total_samples(void) {
+    ArenaProfileSite sites[ARENA_PROFILE_SITES];
+    size_t count = arena_profile_get_sites(sites, ARENA_PROFILE_SITES);
+    size_t samples = 0;
+    for (size_t i = 0; i < count; i++) samples += sites[i].samples;
+    return samples;
+}
+
+static bool has_tag(const char *tag) {
+    ArenaProfileSite sites[ARENA_PROFILE_SITES];
+    size_t count = arena_profile_get_sites(sites, ARENA_PROFILE_SITES);
+    for (size_t i = 0; i < count; i++) {
+        if (sites[i].tag && strcmp(sites[i].tag, tag) == 0) return true;
+    }
+    return false;
+}
+
+static char *dump_to_string(Arena *arena) {
+    FILE *file = tmpfile();
+    arena_dump_snapshot(arena, file);
+    long length = ftell(file);
+    char *text = (char *)calloc((size_t)length + 1, 1);
+    rewind(file);
+    if (fread(text, 1, (size_t)length, file) != (size_t)length) text[0] = '\0';
+    fclose(file);
+    return text;
+}
+
+static size_t count_occurrences(const char *text, const char *needle) {
+    size_t count = 0;
+    for (const char *at = strstr(text, needle); at != NULL; at = strstr(at + 1, needle)) count++;
+    return count;
+}
+
+static bool is_balanced(const char *text) {
+    int depth = 0;
+    bool in_string = false;
+    for (const char *c = text; *c; c++) {
+        if (in_string) {
+            if (*c == '\\') c++;
+            else if (*c == '"') in_string = false;
+        }
+        else if (*c == '"') in_string = true;
+        else if (*c == '{' || *c == '[') depth++;
+        else if (*c == '}' || *c == ']') depth--;
+        if (depth < 0) return false;
+    }
+    return depth == 0 && !in_string;
+}
+
+void test_profile_sampling(void) {
+    TEST_PHASE("Allocation Sampling");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Switched off profiler records nothing");
+    arena_profile_set_rate(0);
+    for (int i = 0; i < ALLOCATIONS; i++) arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(arena_profile_get_sites(NULL, 0) == 0, "No site should be recorded");
+    arena_reset(arena);
+
+    TEST_CASE("Samples follow the allocated bytes");
+    arena_profile_set_rate(RATE);
+    for (int i = 0; i < ALLOCATIONS; i++) arena_alloc(arena, BLOCK_SIZE);
+    size_t expected = (size_t)ALLOCATIONS * BLOCK_SIZE / RATE;
+    size_t samples = total_samples();
+    ASSERT(samples >= expected / 2 && samples <= expected * 2, "Sample count should match the rate");
+    ArenaProfileSite site;
+    ASSERT(arena_profile_get_sites(&site, 1) >= 1 && site.sampled_bytes == site.samples * BLOCK_SIZE, "Sampled sizes should be kept");
+    ASSERT(site.estimated_bytes == site.samples * RATE, "Each small sample should stand for the rate");
+    #ifdef ARENA_HAS_BACKTRACE
+    ASSERT(site.depth > 0, "Samples should carry a backtrace");
+    #endif
+    arena_reset(arena);
+
+    TEST_CASE("Big allocations are always sampled");
+    arena_profile_reset();
+    arena_alloc(arena, RATE * 2);
+    ArenaProfileSite big[2];
+    size_t big_sites = arena_profile_get_sites(big, 2);
+    bool counted = false;
+    for (size_t i = 0; i < big_sites && i < 2; i++) {
+        if (big[i].sampled_bytes == RATE * 2 && big[i].estimated_bytes == RATE * 2) counted = true;
+    }
+    ASSERT(counted, "Big allocation should be counted at its size");
+    arena_reset(arena);
+
+    TEST_CASE("Tags separate the sites");
+    arena_profile_reset();
+    arena_profile_set_tag("parser");
+    for (int i = 0; i < ALLOCATIONS; i++) arena_alloc(arena, BLOCK_SIZE);
+    arena_profile_set_tag("render");
+    for (int i = 0; i < ALLOCATIONS; i++) arena_alloc(arena, BLOCK_SIZE);
+    arena_profile_set_tag(NULL);
+    ASSERT(has_tag("parser") && has_tag("render"), "Both tags should have sites");
+
+    TEST_CASE("Reset drops the samples");
+    arena_profile_reset();
+    ASSERT(arena_profile_get_sites(NULL, 0) == 0, "Profile should be empty");
+
+    arena_free(arena);
+}
+
+void test_profile_snapshot(void) {
+    TEST_PHASE("Heap Snapshot");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Invalid parameters");
+    arena_dump_snapshot(NULL, stdout);
+    arena_dump_snapshot(arena, NULL);
+
+    TEST_CASE("Snapshot lists nested arenas and free blocks");
+    arena_profile_set_rate(RATE);
+    arena_profile_set_tag("say \"hi\"");
+    void *blocks[32];
+    for (int i = 0; i < 32; i++) blocks[i] = arena_alloc(arena, BLOCK_SIZE * (i + 1));
+    for (int i = 0; i < 32; i += 2) arena_free_block(blocks[i]);
+    Arena *nested = arena_new_nested(arena, 64 * 1024);
+    Arena *inner = arena_new_nested(nested, 8 * 1024);
+    arena_alloc(inner, BLOCK_SIZE);
+    for (int i = 0; i < 200; i++) arena_alloc(nested, BLOCK_SIZE);
+    arena_profile_set_tag(NULL);
+
+    char *text = dump_to_string(arena);
+    ASSERT(is_balanced(text), "Snapshot should be well formed");
+    ASSERT(count_occurrences(text, "\"address\"") == 3, "Arena, nested and inner arena should be listed");
+    ASSERT(strstr(text, "\"nested\":[{") != NULL, "Nested arena should be in the parent");
+    ASSERT(strstr(text, "\"free_blocks\":16") != NULL, "Freed blocks should be counted");
+    ASSERT(strstr(text, "\"min_size\":") != NULL, "Histogram should have buckets");
+    ASSERT(strstr(text, "say \\\"hi\\\"") != NULL, "Tags should be escaped");
+    const char *fragmentation = strstr(text, "\"fragmentation\":");
+    ASSERT(fragmentation && atof(fragmentation + strlen("\"fragmentation\":")) > 0.0, "Holes should show as fragmentation");
+    free(text);
+
+    TEST_CASE("Snapshot lists nested growable arenas");
+    Arena *parent = arena_new_dynamic(ARENA_SIZE);
+    Arena *fixed = arena_new_nested(parent, 16 * 1024);
+    Arena *growing = arena_new_nested_growable(parent, 16 * 1024);
+    arena_alloc(fixed, BLOCK_SIZE);
+    arena_alloc(growing, BLOCK_SIZE);
+    arena_alloc(parent, BLOCK_SIZE);
+    text = dump_to_string(parent);
+    char address[32];
+    snprintf(address, sizeof(address), "\"address\":\"%p\"", (void *)growing);
+    ASSERT(is_balanced(text) && count_occurrences(text, "\"address\"") == 3, "Both nested arenas should be listed");
+    ASSERT(strstr(text, address) != NULL, "Nested growable arena should be in the parent");
+    free(text);
+
+    TEST_CASE("Extra chunks of nested growable arenas are not listed as arenas");
+    for (int i = 0; i < 1000; i++) arena_alloc(growing, BLOCK_SIZE);
+    ASSERT(arena_get_chunk(growing)->next != NULL, "Nested growable arena should have grown");
+    text = dump_to_string(parent);
+    ASSERT(is_balanced(text) && count_occurrences(text, "\"address\"") == 3, "Only the head of the chain should be listed");
+    free(text);
+    arena_free(growing);
+    arena_free(parent);
+
+    TEST_CASE("Growable arenas list every chunk");
+    Arena *growable = arena_new_dynamic_growable(4096);
+    for (int i = 0; i < 200; i++) arena_alloc(growable, BLOCK_SIZE);
+    text = dump_to_string(growable);
+    ASSERT(is_balanced(text) && count_occurrences(text, "\"address\"") > 1, "Every chunk should be listed");
+    free(text);
+
+    arena_profile_reset();
+    arena_free(growable);
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_profile_sampling();
+    test_profile_snapshot();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
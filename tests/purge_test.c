@@ -0,0 +1,209 @@
+#define ARENA_PURGE
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (4 * 1024 * 1024)
+#define BIG_SIZE (512 * 1024)
+#define SMALL_SIZE (64)
+#define TICK_SIZE (1024) // Above the thread cache and size class limits, so every free reaches the arena
+
+static size_t page_size(void) {
+    return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+/*
+ * Counts the resident pages of the whole pages inside the range
+ */
+static size_t resident_pages(const void *ptr, size_t size) {
+    uintptr_t start = ((uintptr_t)ptr + page_size() - 1) & ~(uintptr_t)(page_size() - 1);
+    uintptr_t end = ((uintptr_t)ptr + size) & ~(uintptr_t)(page_size() - 1);
+    if (start >= end) return 0;
+
+    size_t pages = (end - start) / page_size();
+    unsigned char *vec = (unsigned char *)malloc(pages);
+    if (!vec || mincore((void *)start, end - start, vec) != 0) {
+        free(vec);
+        return 0;
+    }
+
+    size_t resident = 0;
+    for (size_t i = 0; i < pages; i++) resident += vec[i] & 1;
+    free(vec);
+    return resident;
+}
+
+static void touch(void *ptr, size_t size, int value) {
+    memset(ptr, value, size);
+}
+
+static bool holds(const void *ptr, size_t size, int value) {
+    const unsigned char *bytes = (const unsigned char *)ptr;
+    for (size_t i = 0; i < size; i++) {
+        if (bytes[i] != (unsigned char)value) return false;
+    }
+    return true;
+}
+
+static void sleep_ms(long ms) {
+    struct timespec delay = { ms / 1000, (ms % 1000) * 1000000 };
+    nanosleep(&delay, NULL);
+}
+
+void test_purge(void) {
+    TEST_PHASE("Purging Free Memory");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Invalid parameters");
+    ASSERT(arena_purge(NULL, 0) == 0 && arena_purge_decayed(NULL) == 0, "NULL arena should purge nothing");
+    arena_set_purge_decay(NULL, 10);
+    ASSERT(true, "Setting the decay of a NULL arena should not crash");
+
+    TEST_CASE("Free block is given back");
+    char *big = (char *)arena_alloc(arena, BIG_SIZE);
+    char *neighbour = (char *)arena_alloc(arena, BIG_SIZE);
+    char *guard = (char *)arena_alloc(arena, SMALL_SIZE);
+    touch(big, BIG_SIZE, 0x11);
+    touch(neighbour, BIG_SIZE, 0x22);
+    touch(guard, SMALL_SIZE, 0x33);
+    arena_free_block(big);
+    ASSERT(resident_pages(big, BIG_SIZE) > 0, "Freed block should still be resident");
+    ASSERT(arena_purge(arena, ARENA_SIZE) == 0, "Blocks below the threshold should be kept");
+    size_t purged = arena_purge(arena, BIG_SIZE / 2);
+    ASSERT(purged >= BIG_SIZE - 2 * page_size() && purged % page_size() == 0, "Whole pages inside the free block should be purged");
+    ASSERT(resident_pages(big, BIG_SIZE) == 0, "Purged pages should not be resident");
+    ASSERT(holds(neighbour, BIG_SIZE, 0x22) && holds(guard, SMALL_SIZE, 0x33), "Occupied blocks should be intact");
+
+    TEST_CASE("Headers survive the purge");
+    ArenaStats stats;
+    arena_get_stats(arena, &stats);
+    ASSERT(stats.free_blocks == 1 && stats.free_bytes >= BIG_SIZE && stats.occupied_blocks == 2, "Arena should still walk its blocks");
+    char *again = (char *)arena_alloc(arena, BIG_SIZE);
+    ASSERT(again == big, "Purged block should be reused");
+    touch(again, BIG_SIZE, 0x44);
+    ASSERT(holds(again, BIG_SIZE, 0x44), "Reused block should be writable");
+
+    TEST_CASE("Tail is given back");
+    char *scratch = (char *)arena_alloc(arena, BIG_SIZE * 2);
+    touch(scratch, BIG_SIZE * 2, 0x55);
+    arena_free_block(scratch);
+    ASSERT(resident_pages(scratch, BIG_SIZE * 2) > 0, "Memory returned to the tail should still be resident");
+    arena_purge(arena, 0);
+    ASSERT(resident_pages(scratch, BIG_SIZE * 2) == 0, "Purged tail should not be resident");
+    ASSERT(holds(again, BIG_SIZE, 0x44) && holds(neighbour, BIG_SIZE, 0x22), "Occupied blocks should be intact");
+
+    TEST_CASE("Purged memory is handed out again");
+    char *fresh = (char *)arena_calloc(arena, 1, BIG_SIZE);
+    ASSERT(fresh != NULL && holds(fresh, BIG_SIZE, 0), "Calloc should return zeroed memory from the purged tail");
+
+    arena_free(arena);
+}
+
+void test_purge_chunks(void) {
+    TEST_PHASE("Purging Growable Arenas");
+
+    Arena *arena = arena_new_dynamic_growable(ARENA_SIZE / 4);
+
+    TEST_CASE("Every chunk is purged");
+    char *blocks[6];
+    for (int i = 0; i < 6; i++) {
+        blocks[i] = (char *)arena_alloc(arena, BIG_SIZE);
+        touch(blocks[i], BIG_SIZE, i);
+    }
+    size_t resident = 0;
+    for (int i = 0; i < 6; i += 2) {
+        arena_free_block(blocks[i]);
+        resident += resident_pages(blocks[i], BIG_SIZE);
+    }
+    arena_purge(arena, BIG_SIZE);
+    size_t left = 0;
+    for (int i = 0; i < 6; i += 2) left += resident_pages(blocks[i], BIG_SIZE);
+    ASSERT(resident > 0 && left == 0, "Free blocks of all chunks should be purged");
+    ASSERT(holds(blocks[1], BIG_SIZE, 1) && holds(blocks[5], BIG_SIZE, 5), "Occupied blocks should be intact");
+
+    arena_free(arena);
+}
+
+void test_purge_decay(void) {
+    TEST_PHASE("Decayed Purging");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    char *big = (char *)arena_alloc(arena, BIG_SIZE);
+    arena_alloc(arena, SMALL_SIZE);
+    touch(big, BIG_SIZE, 0x66);
+
+    TEST_CASE("Automatic purging is off by default");
+    arena_free_block(big);
+    for (int i = 0; i < ARENA_PURGE_TICKS * 2; i++) arena_free_block(arena_alloc(arena, TICK_SIZE));
+    ASSERT(arena_purge_decayed(arena) == 0, "Arena without a decay time should not purge");
+    ASSERT(resident_pages(big + BIG_SIZE / 2, BIG_SIZE / 4) > 0, "Freed memory should stay resident");
+
+    TEST_CASE("Frees purge once the memory decayed");
+    arena_set_purge_decay(arena, 1);
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < ARENA_PURGE_TICKS; i++) arena_free_block(arena_alloc(arena, TICK_SIZE));
+        sleep_ms(5);
+    }
+    ASSERT(resident_pages(big + BIG_SIZE / 2, BIG_SIZE / 4) == 0, "Decayed memory should be purged by frees");
+
+    TEST_CASE("Timer driven purging");
+    arena_purge(arena, 0); // Also drops the decay the ticking frees started
+    big = (char *)arena_alloc(arena, BIG_SIZE);
+    touch(big, BIG_SIZE, 0x77);
+    arena_free_block(big);
+    ASSERT(arena_purge_decayed(arena) == 0, "First check should only start the decay");
+    sleep_ms(5);
+    ASSERT(arena_purge_decayed(arena) > 0, "Decayed memory should be purged");
+    ASSERT(resident_pages(big + BIG_SIZE / 2, BIG_SIZE / 4) == 0, "Purged pages should not be resident");
+    ASSERT(arena_purge_decayed(arena) == 0, "Nothing should be left to purge");
+
+    TEST_CASE("Small frees do not start the decay");
+    void *small = arena_alloc(arena, SMALL_SIZE);
+    arena_free_block(small);
+    arena_purge_decayed(arena);
+    sleep_ms(5);
+    ASSERT(arena_purge_decayed(arena) == 0, "Less than the minimum purge size should be kept");
+
+    arena_free(arena);
+}
+
+void test_purge_mapped(void) {
+    TEST_PHASE("Purging Mapped Arenas");
+
+    TEST_CASE("Mapped arena purges whole pages");
+    Arena *arena = arena_new_mapped(ARENA_SIZE, 0);
+    char *big = (char *)arena_alloc(arena, BIG_SIZE);
+    char *kept = (char *)arena_alloc(arena, SMALL_SIZE);
+    touch(big, BIG_SIZE, 0x12);
+    touch(kept, SMALL_SIZE, 0x34);
+    arena_free_block(big);
+    size_t purged = arena_purge(arena, 0);
+    ASSERT(purged > 0 && purged % arena_get_mapping(arena)->granule == 0, "Purged bytes should be whole pages");
+    ASSERT(resident_pages(big, BIG_SIZE) == 0 && holds(kept, SMALL_SIZE, 0x34), "Only free memory should be dropped");
+    arena_free(arena);
+
+    TEST_CASE("Lazily released arena purges as well");
+    Arena *lazy = arena_new_mapped(ARENA_SIZE, ARENA_MMAP_LAZY_RELEASE);
+    big = (char *)arena_alloc(lazy, BIG_SIZE);
+    arena_alloc(lazy, SMALL_SIZE);
+    touch(big, BIG_SIZE, 0x56);
+    arena_free_block(big);
+    ASSERT(arena_purge(lazy, 0) > 0, "Free memory should be given back lazily");
+    big = (char *)arena_alloc(lazy, BIG_SIZE);
+    touch(big, BIG_SIZE, 0x78);
+    ASSERT(holds(big, BIG_SIZE, 0x78), "Lazily purged memory should be writable");
+    arena_free(lazy);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_purge();
+    test_purge_chunks();
+    test_purge_decay();
+    test_purge_mapped();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
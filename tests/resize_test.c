@@ -0,0 +1,129 @@
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (8192)
+#define BLOCK_SIZE (64)
+
+void test_resize_invalid(void) {
+    TEST_PHASE("Resize Invalid Input");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    void *p = arena_alloc(arena, BLOCK_SIZE);
+
+    TEST_CASE("Invalid pointers and sizes");
+    ASSERT(!arena_try_resize(NULL, BLOCK_SIZE), "NULL pointer should fail");
+    ASSERT(!arena_try_resize(p, 0), "Zero size should fail");
+    ASSERT(!arena_try_resize(p, SIZE_MAX), "Huge size should fail");
+
+    char foreign[64] = {0};
+    ASSERT(!arena_try_resize(foreign + 16, BLOCK_SIZE), "Foreign pointer should fail");
+
+    arena_free_block(p);
+    ASSERT(!arena_try_resize(p, BLOCK_SIZE * 2), "Freed pointer should fail");
+
+    arena_free(arena);
+}
+
+void test_resize_tail(void) {
+    TEST_PHASE("Resize Into Tail");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    size_t initial_tail = free_size_in_tail(arena);
+
+    TEST_CASE("Last block grows into the tail");
+    void *p = arena_alloc(arena, BLOCK_SIZE);
+    fill_memory_pattern(p, BLOCK_SIZE, 0x11);
+    ASSERT(arena_try_resize(p, BLOCK_SIZE * 10), "Growing into the tail should succeed");
+    ASSERT(verify_memory_pattern(p, BLOCK_SIZE, 0x11), "Data should be preserved");
+    fill_memory_pattern(p, BLOCK_SIZE * 10, 0x22);
+    void *next = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT((char *)next >= (char *)p + BLOCK_SIZE * 10, "Next allocation should start after the grown block");
+    ASSERT(verify_memory_pattern(p, BLOCK_SIZE * 10, 0x22), "Grown block should be fully usable");
+
+    TEST_CASE("Block that is not last cannot grow into live memory");
+    fill_memory_pattern(next, BLOCK_SIZE, 0x66);
+    ASSERT(!arena_try_resize(p, BLOCK_SIZE * 20), "Growing over a live block should fail");
+    ASSERT(verify_memory_pattern(next, BLOCK_SIZE, 0x66), "Failed resize should leave the neighbour alone");
+
+    TEST_CASE("Last block shrinks and gives memory back to the tail");
+    size_t tail_before = free_size_in_tail(arena);
+    ASSERT(arena_try_resize(next, BLOCK_SIZE * 30), "Growing the last block should succeed");
+    ASSERT(free_size_in_tail(arena) < tail_before, "Tail should shrink");
+    ASSERT(arena_try_resize(next, BLOCK_SIZE), "Shrinking should succeed");
+    ASSERT(free_size_in_tail(arena) == tail_before, "Tail should be restored");
+
+    TEST_CASE("Growing up to the end of the arena");
+    ASSERT(!arena_try_resize(next, ARENA_SIZE), "Growing past the arena should fail");
+    size_t whole = (char *)arena + arena_get_capacity(arena) - (char *)next;
+    ASSERT(arena_try_resize(next, whole), "Growing to the last byte should succeed");
+    ASSERT(free_size_in_tail(arena) == 0, "Block should absorb the tail");
+    fill_memory_pattern(next, whole, 0x33);
+    ASSERT(verify_memory_pattern(next, whole, 0x33), "Absorbed tail should be usable");
+
+    TEST_CASE("Occupied tail shrinks into a new tail");
+    ASSERT(arena_try_resize(next, BLOCK_SIZE), "Shrinking the occupied tail should succeed");
+    ASSERT(free_size_in_tail(arena) == tail_before, "New tail should hold the released memory");
+    ASSERT(arena_alloc(arena, BLOCK_SIZE) != NULL, "Tail should serve allocations again");
+
+    arena_reset(arena);
+    ASSERT(free_size_in_tail(arena) == initial_tail, "Reset should restore the arena");
+    arena_free(arena);
+}
+
+void test_resize_free_neighbour(void) {
+    TEST_PHASE("Resize Into Free Neighbour");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    void *a = arena_alloc(arena, BLOCK_SIZE);
+    void *b = arena_alloc(arena, BLOCK_SIZE * 8);
+    void *guard = arena_alloc(arena, BLOCK_SIZE);
+    size_t tail_before = free_size_in_tail(arena);
+
+    TEST_CASE("Block grows into its free successor");
+    arena_free_block(b);
+    fill_memory_pattern(a, BLOCK_SIZE, 0x44);
+    ASSERT(arena_try_resize(a, BLOCK_SIZE * 4), "Growing into the free successor should succeed");
+    ASSERT(verify_memory_pattern(a, BLOCK_SIZE, 0x44), "Data should be preserved");
+    ASSERT(arena_get_free_blocks(arena) != NULL, "Rest of the successor should stay free");
+    void *rest = arena_alloc(arena, BLOCK_SIZE * 2);
+    ASSERT((char *)rest >= (char *)a + BLOCK_SIZE * 4 && (char *)rest < (char *)guard, "Rest should be reused after the grown block");
+    arena_free_block(rest);
+    ASSERT(free_size_in_tail(arena) == tail_before, "Tail should stay untouched");
+
+    TEST_CASE("Block takes the whole free successor");
+    size_t span = (char *)guard - (char *)a - sizeof(Block);
+    ASSERT(arena_try_resize(a, span), "Growing over the whole successor should succeed");
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Successor should be consumed");
+    ASSERT(!arena_try_resize(a, span + 1), "Growing into the live guard should fail");
+
+    TEST_CASE("Shrinking gives a free block back");
+    ASSERT(arena_try_resize(a, BLOCK_SIZE), "Shrinking should succeed");
+    ASSERT(arena_get_free_blocks(arena) != NULL, "Released memory should become a free block");
+    ASSERT(arena_try_resize(a, BLOCK_SIZE / 2 + 1), "Shrinking by less than a block should still succeed");
+
+    TEST_CASE("Freeing a resized block coalesces everything");
+    arena_free_block(a);
+    arena_free_block(guard);
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Everything should merge into the tail");
+
+    TEST_CASE("Over-aligned block keeps its padding");
+    void *aligned = arena_alloc_custom(arena, BLOCK_SIZE, 256);
+    fill_memory_pattern(aligned, BLOCK_SIZE, 0x55);
+    ASSERT(arena_try_resize(aligned, BLOCK_SIZE * 16), "Over-aligned block should grow");
+    ASSERT(((uintptr_t)aligned % 256) == 0 && verify_memory_pattern(aligned, BLOCK_SIZE, 0x55), "Pointer and data should stay");
+    arena_free_block(aligned);
+
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_resize_invalid();
+    test_resize_tail();
+    test_resize_free_neighbour();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define ARENA_SIZE (64 * 1024)
+#define BLOCK_SIZE (128)
+
+static bool is_poisoned(const void *ptr) {
+    return is_memory_poisoned(ptr, 1);
+}
+
+/*
+ * Runs the probe in a child process, which a sanitizer report terminates
+ * Returns true if the child did not exit normally
+ */
+static bool is_reported(void (*probe)(void)) {
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        if (null >= 0) dup2(null, STDERR_FILENO); // Keep the report out of the test output
+        probe();
+        _exit(0);
+    }
+
+    int status = 0;
+    if (waitpid(pid, &status, 0) != pid) return false;
+    return !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+}
+
+static void read_after_free(void) {
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    volatile char *p = (volatile char *)arena_alloc(arena, BLOCK_SIZE);
+    arena_alloc(arena, BLOCK_SIZE);
+    arena_free_block((void *)p);
+    (void)p[0];
+}
+
+static void read_after_reset(void) {
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    volatile char *p = (volatile char *)arena_alloc(arena, BLOCK_SIZE);
+    arena_reset(arena);
+    (void)p[BLOCK_SIZE / 2];
+}
+
+#ifdef ARENA_HAS_SANITIZER_HOOKS
+void test_poisoning(void) {
+    TEST_PHASE("Poisoning Free Memory");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Tail starts poisoned");
+    Block *tail = arena_get_tail(arena);
+    ASSERT(is_poisoned(block_data(tail)), "Tail memory should be poisoned");
+    ASSERT(!is_memory_poisoned(tail, sizeof(Block)), "Tail header should stay accessible");
+
+    TEST_CASE("Allocations are accessible");
+    char *a = (char *)arena_alloc(arena, BLOCK_SIZE);
+    char *b = (char *)arena_alloc(arena, BLOCK_SIZE);
+    char *c = (char *)arena_alloc_custom(arena, BLOCK_SIZE, 256);
+    ASSERT(!is_memory_poisoned(a, BLOCK_SIZE) && !is_memory_poisoned(c, BLOCK_SIZE), "Allocated data should not be poisoned");
+    ASSERT(is_poisoned(block_data(arena_get_tail(arena))), "Rest of the tail should stay poisoned");
+
+    TEST_CASE("Freed blocks are poisoned");
+    arena_free_block(a);
+    ASSERT(is_poisoned(a) && is_poisoned(a + BLOCK_SIZE - 1), "Freed data should be poisoned");
+    ASSERT(!is_memory_poisoned(b, BLOCK_SIZE), "Neighbour should stay accessible");
+    arena_free_block(b);
+    #if !defined(ARENA_SIZE_CLASSES) && !defined(ARENA_DEFERRED_COALESCING) && !defined(ARENA_THREAD_SAFE)
+    ASSERT(is_poisoned(b - sizeof(uintptr_t)), "Header merged into the free block should be poisoned"); // Parked blocks keep their header
+    #endif
+
+    TEST_CASE("Double frees are still rejected");
+    arena_free_block(c);
+    size_t tail_size = free_size_in_tail(arena);
+    arena_free_block(c);
+    arena_free_block(b);
+    arena_free_block(a);
+    ASSERT(free_size_in_tail(arena) == tail_size, "Freed blocks should be ignored");
+
+    TEST_CASE("Reused memory is accessible again");
+    char *again = (char *)arena_calloc(arena, 1, BLOCK_SIZE);
+    ASSERT(again != NULL && !is_memory_poisoned(again, BLOCK_SIZE) && again[0] == 0, "Reused block should be accessible");
+
+    arena_free(arena);
+}
+
+void test_poisoning_resize_and_reset(void) {
+    TEST_PHASE("Poisoning on Resize, Rewind and Reset");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Resize follows the block");
+    char *p = (char *)arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(arena_try_resize(p, BLOCK_SIZE * 8), "Block should grow into the tail");
+    ASSERT(!is_memory_poisoned(p, BLOCK_SIZE * 8), "Grown data should be accessible");
+    ASSERT(arena_try_resize(p, BLOCK_SIZE), "Block should shrink");
+    ASSERT(is_poisoned(p + BLOCK_SIZE * 4), "Released rest should be poisoned");
+
+    TEST_CASE("Rewind poisons what it releases");
+    ArenaMark mark = arena_mark(arena);
+    char *scratch = (char *)arena_alloc(arena, BLOCK_SIZE);
+    arena_rewind(arena, mark);
+    ASSERT(is_poisoned(scratch), "Rewound block should be poisoned");
+    ASSERT(!is_memory_poisoned(p, BLOCK_SIZE), "Block in front of the mark should stay accessible");
+
+    TEST_CASE("Reset poisons everything");
+    arena_reset(arena);
+    ASSERT(is_poisoned(p), "Memory should be poisoned after a reset");
+    arena_reset_zero(arena);
+    ASSERT(is_poisoned(p), "Memory should be poisoned after a zeroing reset");
+
+    arena_free(arena);
+
+    TEST_CASE("Static memory is given back accessible");
+    static char memory[ARENA_SIZE];
+    Arena *fixed = arena_new_static(memory, sizeof(memory));
+    arena_alloc(fixed, BLOCK_SIZE);
+    ASSERT(is_poisoned(memory + sizeof(memory) - 1), "Static arena should poison its tail");
+    arena_free(fixed);
+    ASSERT(!is_memory_poisoned(memory, sizeof(memory)), "Freed static arena should leave its memory accessible");
+}
+
+void test_reports(void) {
+    TEST_PHASE("Sanitizer Reports");
+
+    #ifdef ARENA_HAS_ASAN
+    TEST_CASE("Use after free is reported");
+    ASSERT(is_reported(read_after_free), "Reading a freed block should be reported");
+
+    TEST_CASE("Use after reset is reported");
+    ASSERT(is_reported(read_after_reset), "Reading a block released by a reset should be reported");
+    #endif
+}
+#else
+void test_no_hooks(void) {
+    TEST_PHASE("Without Sanitizer Hooks");
+
+    TEST_CASE("Free memory stays plain memory");
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    char *p = (char *)arena_alloc(arena, BLOCK_SIZE);
+    arena_alloc(arena, BLOCK_SIZE);
+    arena_free_block(p);
+    ASSERT(!is_poisoned(p) && !is_poisoned(block_data(arena_get_tail(arena))), "Nothing should be poisoned");
+    arena_free(arena);
+
+    TEST_CASE("Uses after free are not reported");
+    ASSERT(!is_reported(read_after_free) && !is_reported(read_after_reset), "Hooks should compile to nothing");
+}
+#endif
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    #ifdef ARENA_HAS_SANITIZER_HOOKS
+    test_poisoning();
+    test_poisoning_resize_and_reset();
+    test_reports();
+    #else
+    test_no_hooks();
+    #endif
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,216 @@
+#define ARENA_IMPLEMENTATION
+#define ARENA_THREAD_SAFE
+#include "arena.h"
+#include "test_utils.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+typedef HANDLE test_thread;
+#define THREAD_FUNC(name) DWORD WINAPI name(LPVOID arg)
+#define THREAD_RETURN return 0
+static void thread_start(test_thread *thread, LPTHREAD_START_ROUTINE func, void *arg) {
+    *thread = CreateThread(NULL, 0, func, arg, 0, NULL);
+}
+static void thread_join(test_thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#else
+#include <pthread.h>
+typedef pthread_t test_thread;
+#define THREAD_FUNC(name) void *name(void *arg)
+#define THREAD_RETURN return NULL
+static void thread_start(test_thread *thread, void *(*func)(void *), void *arg) {
+    pthread_create(thread, NULL, func, arg);
+}
+static void thread_join(test_thread thread) {
+    pthread_join(thread, NULL);
+}
+#endif
+
+#define ARENA_SIZE (8 * 1024 * 1024)
+#define REGION_SIZE (1024 * 1024)
+#define THREAD_COUNT (4)
+#define RECORDS_PER_THREAD (2000)
+#define RECORD_SIZE (40)
+#define BIG_RECORD_SIZE (ARENA_SHARED_BUMP_RESERVE / 2 + 8)
+#define BATCHES (5)
+
+typedef struct IngestContext {
+    ArenaSharedBump *bump;
+    unsigned char *records[RECORDS_PER_THREAD];
+    size_t count;
+    int id;
+} IngestContext;
+
+static bool is_inside(const ArenaSharedBump *bump, const void *ptr, size_t size) {
+    return (uintptr_t)ptr >= bump->start && (uintptr_t)ptr <= bump->end && bump->end - (uintptr_t)ptr >= size;
+}
+
+static THREAD_FUNC(ingest_worker) {
+    IngestContext *ctx = (IngestContext *)arg;
+    ctx->count = 0;
+
+    for (int i = 0; i < RECORDS_PER_THREAD; i++) {
+        // Every tenth record is big enough to take a range of its own
+        size_t size = (i % 10 == 9) ? BIG_RECORD_SIZE : RECORD_SIZE;
+        unsigned char *record = (unsigned char *)arena_shared_bump_alloc(ctx->bump, size);
+        if (!record) break;
+
+        memset(record, ctx->id + 1, size);
+        ctx->records[ctx->count++] = record;
+    }
+    THREAD_RETURN;
+}
+
+static bool verify_records(const IngestContext *contexts) {
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        for (size_t i = 0; i < contexts[t].count; i++) {
+            size_t size = (i % 10 == 9) ? BIG_RECORD_SIZE : RECORD_SIZE;
+            const unsigned char *record = contexts[t].records[i];
+            if (!is_inside(contexts[t].bump, record, size)) return false;
+            if ((uintptr_t)record % contexts[t].bump->alignment != 0) return false;
+            for (size_t j = 0; j < size; j++) {
+                if (record[j] != (unsigned char)(t + 1)) return false; // Overlapping records overwrote each other
+            }
+        }
+    }
+    return true;
+}
+
+void test_shared_bump_creation(void) {
+    TEST_PHASE("Shared Bump Region Creation");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    size_t parent_tail = free_size_in_tail(arena);
+
+    TEST_CASE("Invalid parameters");
+    ASSERT(arena_shared_bump_new(NULL, REGION_SIZE) == NULL, "NULL parent should fail");
+    ASSERT(arena_shared_bump_new(arena, 0) == NULL, "Zero size should fail");
+    ASSERT(arena_shared_bump_new_custom(arena, REGION_SIZE, 24, 0) == NULL, "Non power of two alignment should fail");
+    ASSERT(arena_shared_bump_new(arena, ARENA_SIZE * 2) == NULL, "Region bigger than the parent should fail");
+    ASSERT(arena_shared_bump_new_static(NULL, REGION_SIZE) == NULL, "NULL memory should fail");
+    ASSERT(free_size_in_tail(arena) == parent_tail, "Failed creations should not touch the parent");
+
+    TEST_CASE("Region is nested in the parent");
+    ArenaSharedBump *bump = arena_shared_bump_new(arena, REGION_SIZE);
+    ASSERT(bump != NULL && bump->parent == arena, "Region should remember its parent");
+    ASSERT(bump->end - bump->start >= REGION_SIZE, "Region should provide the requested capacity");
+    ASSERT(bump->reserve == ARENA_SHARED_BUMP_RESERVE, "Default reservation size should be used");
+    ASSERT((uintptr_t)&bump->cursor - (uintptr_t)&bump->parent >= 64, "Cursor should be on a cache line of its own");
+    void *regular = arena_alloc(arena, ARENA_THREAD_CACHE_MAX_SIZE * 2);
+    ASSERT(regular != NULL, "Parent should keep serving regular allocations");
+
+    TEST_CASE("Freeing the region returns it to the parent");
+    arena_free_block(regular);
+    arena_shared_bump_free(bump);
+    ASSERT(free_size_in_tail(arena) == parent_tail, "Parent should be fully restored");
+
+    TEST_CASE("Static region");
+    static char memory[64 * 1024];
+    ArenaSharedBump *fixed = arena_shared_bump_new_static_custom(memory + 1, sizeof(memory) - 1, 64, 1000);
+    ASSERT(fixed != NULL && ((uintptr_t)fixed % MIN_ALIGNMENT) == 0, "Unaligned memory should be aligned for the header");
+    ASSERT(fixed->reserve % MIN_ALIGNMENT == 0 && fixed->reserve >= 1000, "Reservation size should be word aligned");
+    void *p = arena_shared_bump_alloc(fixed, 100);
+    ASSERT(p != NULL && ((uintptr_t)p % 64) == 0, "Static region should serve aligned allocations");
+    arena_shared_bump_free(fixed);
+    ASSERT(true, "Freeing a static region should be a no-op");
+
+    arena_free(arena);
+}
+
+void test_shared_bump_single_thread(void) {
+    TEST_PHASE("Shared Bump Region Allocation");
+
+    static char memory[64 * 1024];
+    ArenaSharedBump *bump = arena_shared_bump_new_static_custom(memory, sizeof(memory), sizeof(uintptr_t), 1024);
+
+    TEST_CASE("Small allocations are packed in the range of the thread");
+    uintptr_t cursor = bump->cursor;
+    char *a = (char *)arena_shared_bump_alloc(bump, 24);
+    char *b = (char *)arena_shared_bump_alloc(bump, 24);
+    ASSERT(a != NULL && b == a + 24, "Allocations should follow each other without headers");
+    ASSERT(bump->cursor == cursor + 1024, "Only one range should be reserved");
+
+    TEST_CASE("Custom alignment");
+    void *aligned = arena_shared_bump_alloc_custom(bump, 16, 256);
+    ASSERT(aligned != NULL && ((uintptr_t)aligned % 256) == 0, "Allocation should honor the alignment");
+    ASSERT(arena_shared_bump_alloc_custom(bump, 16, 3) == NULL, "Invalid alignment should fail");
+    ASSERT(arena_shared_bump_alloc(bump, 0) == NULL && arena_shared_bump_alloc(NULL, 16) == NULL, "Invalid requests should fail");
+
+    TEST_CASE("Big allocations take a range of their own");
+    cursor = bump->cursor;
+    char *big = (char *)arena_shared_bump_alloc(bump, 4096);
+    char *c = (char *)arena_shared_bump_alloc(bump, 24);
+    ASSERT(big != NULL && (uintptr_t)big == cursor, "Big allocation should be reserved directly");
+    ASSERT(c > b && c < b + 1024, "Range of the thread should stay in use");
+
+    TEST_CASE("Exhausted region");
+    size_t served = 0;
+    while (arena_shared_bump_alloc(bump, 200)) served++;
+    ASSERT(served > 0 && bump->cursor >= bump->end, "Region should run out");
+    ASSERT(arena_shared_bump_alloc(bump, 4096) == NULL, "No range should be reserved past the end");
+
+    TEST_CASE("Reset starts over");
+    arena_shared_bump_reset(bump);
+    void *first = arena_shared_bump_alloc(bump, 24);
+    ASSERT(first == (void *)bump->start, "Reset should drop the old range of the thread");
+}
+
+void test_shared_bump_parallel(void) {
+    TEST_PHASE("Parallel Ingest");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    ArenaSharedBump *bump = arena_shared_bump_new(arena, REGION_SIZE * 4);
+    static IngestContext contexts[THREAD_COUNT];
+    test_thread threads[THREAD_COUNT];
+
+    TEST_CASE("Threads append records at once");
+    bool intact = true;
+    bool complete = true;
+    for (int batch = 0; batch < BATCHES; batch++) {
+        for (int t = 0; t < THREAD_COUNT; t++) {
+            contexts[t].bump = bump;
+            contexts[t].id = t;
+            thread_start(&threads[t], ingest_worker, &contexts[t]);
+        }
+        for (int t = 0; t < THREAD_COUNT; t++) thread_join(threads[t]);
+
+        for (int t = 0; t < THREAD_COUNT; t++) {
+            if (contexts[t].count != RECORDS_PER_THREAD) complete = false;
+        }
+        if (!verify_records(contexts)) intact = false;
+
+        arena_shared_bump_reset(bump); // Batch boundary
+    }
+    ASSERT(complete, "Every record of every batch should fit");
+    ASSERT(intact, "Records should lie inside the region and never overlap");
+
+    TEST_CASE("Contended region runs out cleanly");
+    ArenaSharedBump *small = arena_shared_bump_new(arena, REGION_SIZE / 8);
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        contexts[t].bump = small;
+        contexts[t].id = t;
+        thread_start(&threads[t], ingest_worker, &contexts[t]);
+    }
+    for (int t = 0; t < THREAD_COUNT; t++) thread_join(threads[t]);
+    size_t total = 0;
+    for (int t = 0; t < THREAD_COUNT; t++) total += contexts[t].count;
+    ASSERT(total > 0 && total < THREAD_COUNT * RECORDS_PER_THREAD, "Only part of the records should fit");
+    ASSERT(verify_records(contexts), "Records served before the end should be intact");
+
+    arena_shared_bump_free(small);
+    arena_shared_bump_free(bump);
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_shared_bump_creation();
+    test_shared_bump_single_thread();
+    test_shared_bump_parallel();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
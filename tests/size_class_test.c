@@ -0,0 +1,170 @@
+#define ARENA_IMPLEMENTATION
+#define ARENA_SIZE_CLASSES
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (4096)
+#define BLOCK_SIZE (32)
+#define BLOCK_COUNT (10)
+#define CHURN_CYCLES (10000)
+
+static size_t count_binned_blocks(Arena *arena) {
+    size_t count = 0;
+    for (size_t i = 0; i < ARENA_SIZE_CLASS_COUNT; i++) {
+        for (Block *block = arena_get_ext(arena)->bins[i]; block != NULL; block = get_parked_next(block)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void test_same_size_churn(void) {
+    TEST_PHASE("Same Size Churn Through Bins");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    ASSERT(arena != NULL, "Arena creation should succeed");
+
+    void *blocks[BLOCK_COUNT] = {0};
+    for (int i = 0; i < BLOCK_COUNT; i++) {
+        blocks[i] = arena_alloc(arena, BLOCK_SIZE);
+        ASSERT_QUIET(blocks[i] != NULL, "Block allocation should succeed");
+    }
+    size_t tail_after_initial = free_size_in_tail(arena);
+
+    TEST_CASE("Freed small blocks go to bins, not to the tree");
+    for (int i = 0; i < BLOCK_COUNT - 1; i += 2) {
+        arena_free_block(blocks[i]);
+    }
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Free tree should stay empty");
+    ASSERT(count_binned_blocks(arena) == BLOCK_COUNT / 2, "Every freed block should be binned");
+
+    TEST_CASE("Same size allocations reuse binned blocks in LIFO order");
+    void *reused = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(reused == blocks[BLOCK_COUNT - 2], "Last freed block should be reused first");
+    ASSERT(free_size_in_tail(arena) == tail_after_initial, "Tail should not be touched by binned allocations");
+
+    TEST_CASE("Thousands of alloc/free cycles stay in the bin");
+    bool stable = true;
+    for (int i = 0; i < CHURN_CYCLES; i++) {
+        void *p = arena_alloc(arena, BLOCK_SIZE);
+        fill_memory_pattern(p, BLOCK_SIZE, i);
+        if (p != reused && !verify_memory_pattern(p, BLOCK_SIZE, i)) stable = false;
+        arena_free_block(p);
+    }
+    ASSERT(stable, "Churned memory should hold its pattern");
+    ASSERT(free_size_in_tail(arena) == tail_after_initial, "Churn should not grow the arena");
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Churn should never touch the free tree");
+
+    TEST_CASE("Smaller request is served by a bin of its own class only");
+    void *tiny = arena_alloc(arena, 8);
+    ASSERT(tiny != NULL, "Tiny allocation should succeed");
+    ASSERT(count_binned_blocks(arena) == BLOCK_COUNT / 2 - 1, "Tiny allocation should not steal a 32-byte block");
+
+    arena_free(arena);
+}
+
+void test_bin_safety(void) {
+    TEST_PHASE("Bin Safety");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    void *a = arena_alloc(arena, BLOCK_SIZE);
+    void *b = arena_alloc(arena, BLOCK_SIZE);
+    void *c = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(a && b && c, "Initial allocations should succeed");
+
+    TEST_CASE("Double free of a binned block is rejected");
+    arena_free_block(a);
+    arena_free_block(a);
+    ASSERT(count_binned_blocks(arena) == 1, "Block should be binned only once");
+
+    TEST_CASE("Block before the tail is returned to the tail");
+    size_t tail_before = free_size_in_tail(arena);
+    arena_free_block(c);
+    ASSERT(count_binned_blocks(arena) == 1, "Block next to tail should not be binned");
+    ASSERT(free_size_in_tail(arena) > tail_before, "Tail should grow back");
+
+    TEST_CASE("Over-aligned requests bypass bins");
+    void *aligned = arena_alloc_custom(arena, BLOCK_SIZE, 128);
+    ASSERT(aligned != NULL && ((uintptr_t)aligned % 128) == 0, "Over-aligned allocation should succeed");
+    ASSERT(count_binned_blocks(arena) == 1, "Over-aligned allocation should not pop from bins");
+
+    TEST_CASE("Reset empties the bins");
+    arena_reset(arena);
+    ASSERT(count_binned_blocks(arena) == 0, "Bins should be empty after reset");
+    void *after_reset = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(after_reset == a, "First allocation after reset should start at the first block");
+
+    (void)b;
+    arena_free(arena);
+}
+
+void test_bin_flush_on_exhaustion(void) {
+    TEST_PHASE("Bin Flush On Exhaustion");
+
+    Arena *arena = arena_new_dynamic(1024);
+    ASSERT(arena != NULL, "Arena creation should succeed");
+
+    void *blocks[64] = {0};
+    int count = 0;
+    while (count < 64 && (blocks[count] = arena_alloc(arena, BLOCK_SIZE)) != NULL) count++;
+    ASSERT(count > 4, "Arena should be filled with small blocks");
+
+    // Free everything except the last block, so nothing can return to the tail
+    for (int i = 0; i < count - 1; i++) {
+        arena_free_block(blocks[i]);
+    }
+    ASSERT(count_binned_blocks(arena) == (size_t)(count - 1), "All freed blocks should be binned");
+
+    TEST_CASE("Large allocation coalesces binned blocks");
+    size_t large_size = (size_t)(count - 1) * BLOCK_SIZE;
+    void *large = arena_alloc(arena, large_size);
+    ASSERT(large != NULL, "Large allocation should succeed after flushing bins");
+    ASSERT(large == blocks[0], "Coalesced block should start at the first freed block");
+    ASSERT(count_binned_blocks(arena) == 0, "Bins should be empty after flush");
+    fill_memory_pattern(large, large_size, 0x5A);
+    ASSERT(verify_memory_pattern(large, large_size, 0x5A), "Coalesced memory should be writable");
+
+    arena_free(arena);
+}
+
+void test_nested_with_bins(void) {
+    TEST_PHASE("Nested Arena With Bins");
+
+    Arena *parent = arena_new_dynamic(8192);
+    size_t parent_tail = free_size_in_tail(parent);
+
+    void *small = arena_alloc(parent, BLOCK_SIZE);
+    Arena *nested = arena_new_nested(parent, 2048);
+    ASSERT(nested != NULL, "Nested arena creation should succeed");
+
+    void *inner = arena_alloc(nested, BLOCK_SIZE);
+    void *inner_guard = arena_alloc(nested, BLOCK_SIZE);
+    arena_free_block(inner);
+    ASSERT(count_binned_blocks(nested) == 1, "Nested arena should use its own bins");
+    ASSERT(count_binned_blocks(parent) == 0, "Parent bins should be untouched");
+
+    arena_free_block(small);
+    ASSERT(count_binned_blocks(parent) == 1, "Parent small block should be binned");
+
+    arena_free(nested);
+    void *again = arena_alloc(parent, BLOCK_SIZE);
+    ASSERT(again == small, "Parent should reuse its binned block");
+    arena_free_block(again);
+    arena_reset(parent);
+    ASSERT(free_size_in_tail(parent) == parent_tail, "Parent should be fully restored after reset");
+
+    (void)inner_guard;
+    arena_free(parent);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_same_size_churn();
+    test_bin_safety();
+    test_bin_flush_on_exhaustion();
+    test_nested_with_bins();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
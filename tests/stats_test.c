@@ -0,0 +1,161 @@
+#define ARENA_STATS
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (8192)
+#define BLOCK_SIZE (64)
+
+void test_stats_snapshot(void) {
+    TEST_PHASE("Statistics Snapshot");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    ArenaStats stats;
+
+    TEST_CASE("Invalid parameters");
+    arena_get_stats(arena, NULL);
+    arena_get_stats(NULL, &stats);
+    ASSERT(stats.capacity == 0 && stats.bytes_in_use == 0, "NULL arena should report empty stats");
+
+    TEST_CASE("Empty arena");
+    arena_get_stats(arena, &stats);
+    ASSERT(stats.capacity == arena_get_capacity(arena), "Capacity should match the arena");
+    ASSERT(stats.bytes_in_use == 0 && stats.occupied_blocks == 0, "Nothing should be in use");
+    ASSERT(stats.free_blocks == 0 && stats.free_bytes == 0, "Free tree should be empty");
+    ASSERT(stats.tail_free == free_size_in_tail(arena), "Tail should hold all the memory");
+
+    TEST_CASE("Occupied and free blocks");
+    void *a = arena_alloc(arena, BLOCK_SIZE);
+    void *b = arena_alloc(arena, BLOCK_SIZE * 4);
+    void *c = arena_alloc(arena, BLOCK_SIZE);
+    void *d = arena_alloc(arena, BLOCK_SIZE * 2);
+    void *e = arena_alloc(arena, BLOCK_SIZE);
+    arena_free_block(b);
+    arena_free_block(d);
+    arena_get_stats(arena, &stats);
+    ASSERT(stats.occupied_blocks == 3, "Three blocks should be occupied");
+    ASSERT(stats.bytes_in_use == 3 * (sizeof(Block) + BLOCK_SIZE), "Bytes in use should include the headers");
+    ASSERT(stats.free_blocks == 2, "Two blocks should be in the free tree");
+    ASSERT(stats.free_bytes == BLOCK_SIZE * 6, "Free bytes should add up the free blocks");
+    ASSERT(stats.largest_free_block == BLOCK_SIZE * 4, "Largest free block should be found");
+    ASSERT(stats.bytes_in_use + stats.free_bytes + 2 * sizeof(Block) + stats.tail_free + sizeof(Block) + arena_get_reserve(arena) + sizeof(Arena) == stats.capacity,
+           "Every byte of the arena should be accounted for");
+
+    TEST_CASE("Alignment padding");
+    ASSERT(stats.padding_bytes == 0, "Default aligned blocks should have no padding");
+    // Padding big enough for a block is split off as a free block, smaller padding stays in front of the data
+    Arena *padded = arena_new_dynamic(ARENA_SIZE);
+    void *hole = arena_alloc(padded, BLOCK_SIZE * 16);
+    void *guard = arena_alloc(padded, BLOCK_SIZE);
+    arena_free_block(hole);
+    void *aligned = arena_alloc_custom(padded, BLOCK_SIZE, 256);
+    size_t expected = (uintptr_t)aligned - (uintptr_t)hole;
+    if (expected >= BLOCK_MIN_SIZE) expected = 0;
+    arena_get_stats(padded, &stats);
+    ASSERT(aligned != NULL && (char *)aligned < (char *)guard, "Over-aligned block should reuse the free block");
+    ASSERT(stats.padding_bytes == expected, "Padding of the over-aligned block should be reported");
+    arena_free(padded);
+
+    (void)a; (void)c; (void)e;
+    arena_free(arena);
+}
+
+void test_stats_counters(void) {
+    TEST_PHASE("Statistics Counters");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    ArenaStats stats;
+
+    TEST_CASE("Tail and tree paths");
+    void *a = arena_alloc(arena, BLOCK_SIZE);
+    void *b = arena_alloc(arena, BLOCK_SIZE);
+    void *c = arena_alloc(arena, BLOCK_SIZE);
+    arena_free_block(a);
+    void *reused = arena_alloc(arena, BLOCK_SIZE);
+    arena_get_stats(arena, &stats);
+    ASSERT(stats.tail_allocs == 3, "Three allocations should come from the tail");
+    ASSERT(stats.tree_allocs == 1 && reused == a, "Reuse should come from the free tree");
+    ASSERT(stats.tree_frees == 1 && stats.tail_frees == 0, "Freed block should go to the tree");
+    ASSERT(stats.merges == 0, "Nothing should merge yet");
+
+    TEST_CASE("Merges and frees to the tail");
+    arena_free_block(b);
+    arena_free_block(reused);
+    arena_free_block(c);
+    arena_get_stats(arena, &stats);
+    ASSERT(stats.tree_frees == 3, "Blocks behind a live block should go to the tree");
+    ASSERT(stats.tail_frees == 1, "Last block should go back to the tail");
+    ASSERT(stats.merges == 3, "Every free after the first should merge");
+    ASSERT(stats.bytes_in_use == 0 && stats.free_blocks == 0, "Arena should be empty");
+
+    TEST_CASE("Peak usage");
+    ASSERT(stats.peak_in_use == 3 * (sizeof(Block) + BLOCK_SIZE), "Peak should remember the three live blocks");
+    void *big = arena_alloc(arena, BLOCK_SIZE * 20);
+    arena_free_block(big);
+    arena_get_stats(arena, &stats);
+    ASSERT(stats.peak_in_use == sizeof(Block) + BLOCK_SIZE * 20, "Peak should follow the biggest usage");
+
+    TEST_CASE("Resize and batches keep the usage exact");
+    void *nodes[16];
+    arena_alloc_batch(arena, BLOCK_SIZE, 16, nodes);
+    void *guard = arena_alloc(arena, BLOCK_SIZE);
+    arena_try_resize(nodes[15], BLOCK_SIZE / 2);
+    arena_get_stats(arena, &stats);
+    ArenaStats before = stats;
+    arena_free_batch(nodes, 16);
+    arena_free_block(guard);
+    arena_get_stats(arena, &stats);
+    ASSERT(before.tail_allocs == 3 + 1 + 16 + 1, "Batch should count every block");
+    ASSERT(stats.merges - before.merges >= 15, "Joined blocks of the batch should count as merges");
+    ASSERT(stats.bytes_in_use == 0 && stats.tail_free == free_size_in_tail(arena), "Arena should be empty again");
+
+    TEST_CASE("Reset keeps cumulative counters");
+    arena_alloc(arena, BLOCK_SIZE);
+    arena_reset(arena);
+    arena_get_stats(arena, &stats);
+    ASSERT(stats.bytes_in_use == 0 && stats.tail_allocs > 0, "Counters should survive the reset");
+    arena_alloc(arena, BLOCK_SIZE);
+    arena_get_stats(arena, &stats);
+    ASSERT(stats.bytes_in_use == sizeof(Block) + BLOCK_SIZE, "Usage should restart after the reset");
+
+    arena_free(arena);
+}
+
+void test_stats_chunks(void) {
+    TEST_PHASE("Statistics of Growable and Nested Arenas");
+
+    TEST_CASE("Growable arena sums its chunks");
+    Arena *growable = arena_new_dynamic_growable(1024);
+    for (int i = 0; i < 40; i++) arena_alloc(growable, BLOCK_SIZE);
+    ArenaStats stats;
+    arena_get_stats(growable, &stats);
+    ASSERT(arena_get_chunk(growable)->next != NULL, "Arena should have grown");
+    ASSERT(stats.capacity > arena_get_capacity(growable), "Capacity should include every chunk");
+    ASSERT(stats.occupied_blocks == 40 && stats.tail_allocs == 40, "Blocks of every chunk should be counted");
+    arena_free(growable);
+
+    TEST_CASE("Nested arena is one block of its parent");
+    Arena *parent = arena_new_dynamic(ARENA_SIZE);
+    Arena *nested = arena_new_nested(parent, 2048);
+    arena_alloc(nested, BLOCK_SIZE);
+    ArenaStats parent_stats, nested_stats;
+    arena_get_stats(parent, &parent_stats);
+    arena_get_stats(nested, &nested_stats);
+    ASSERT(parent_stats.occupied_blocks == 1 && parent_stats.padding_bytes == 0, "Parent should see one occupied block");
+    ASSERT(nested_stats.occupied_blocks == 1 && nested_stats.tail_allocs == 1, "Nested arena should have its own stats");
+    arena_free(nested);
+    arena_get_stats(parent, &parent_stats);
+    ASSERT(parent_stats.bytes_in_use == 0 && parent_stats.tail_frees == 1, "Freeing the nested arena should empty the parent");
+    arena_free(parent);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_stats_snapshot();
+    test_stats_counters();
+    test_stats_chunks();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,417 @@
+#define ARENA_IMPLEMENTATION
+#define ARENA_THREAD_SAFE
+#include "arena.h"
+#include "test_utils.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+typedef HANDLE test_thread;
+#define THREAD_FUNC(name) DWORD WINAPI name(LPVOID arg)
+#define THREAD_RETURN return 0
+static void thread_start(test_thread *thread, LPTHREAD_START_ROUTINE func, void *arg) {
+    *thread = CreateThread(NULL, 0, func, arg, 0, NULL);
+}
+static void thread_join(test_thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#else
+#include <pthread.h>
+typedef pthread_t test_thread;
+#define THREAD_FUNC(name) void *name(void *arg)
+#define THREAD_RETURN return NULL
+static void thread_start(test_thread *thread, void *(*func)(void *), void *arg) {
+    pthread_create(thread, NULL, func, arg);
+}
+static void thread_join(test_thread thread) {
+    pthread_join(thread, NULL);
+}
+#endif
+
+#define ARENA_SIZE (1024 * 1024)
+#define THREAD_COUNT (4)
+#define BLOCKS_PER_THREAD (512)
+#define ROUNDS (20)
+#define SMALL_SIZE (48)
+#define LARGE_SIZE (ARENA_THREAD_CACHE_MAX_SIZE + 64)
+#define CHURN_ARENAS (ARENA_THREAD_CACHE_SIZE) // Fills the cache of this thread in every round
+#define CHURN_ROUNDS (ARENA_THREAD_CACHE_ARENAS / CHURN_ARENAS + 2) // Enough arenas to go through every liveness cell
+#define CHURN_ARENA_SIZE (4096)
+
+typedef struct WorkerContext {
+    Arena *arena;
+    void **blocks;
+    size_t *sizes;
+    int id;
+    bool failed;
+} WorkerContext;
+
+static THREAD_FUNC(free_blocks_worker) {
+    WorkerContext *ctx = (WorkerContext *)arg;
+    for (int i = 0; i < BLOCKS_PER_THREAD; i++) {
+        arena_free_block(ctx->blocks[i]);
+    }
+    THREAD_RETURN;
+}
+
+static THREAD_FUNC(free_arenas_worker) {
+    Arena **arenas = (Arena **)arg;
+    for (int i = 0; i < CHURN_ARENAS; i++) {
+        arena_free(arenas[i]);
+    }
+    THREAD_RETURN;
+}
+
+typedef struct MarkContext {
+    Arena *arena;
+    ArenaMark mark;
+    void *block;
+} MarkContext;
+
+static THREAD_FUNC(mark_worker) {
+    MarkContext *ctx = (MarkContext *)arg;
+    ctx->mark = arena_mark(ctx->arena);
+    ctx->block = arena_alloc(ctx->arena, SMALL_SIZE);
+    THREAD_RETURN;
+}
+
+static THREAD_FUNC(rewind_worker) {
+    MarkContext *ctx = (MarkContext *)arg;
+    arena_rewind(ctx->arena, ctx->mark);
+    THREAD_RETURN;
+}
+
+static THREAD_FUNC(exit_worker) {
+    MarkContext *ctx = (MarkContext *)arg;
+    ctx->block = arena_alloc(ctx->arena, SMALL_SIZE);
+    arena_alloc(ctx->arena, SMALL_SIZE);
+    arena_free_block(ctx->block); // Parked in the cache of this thread, which exits without a flush
+    THREAD_RETURN;
+}
+
+static THREAD_FUNC(churn_worker) {
+    WorkerContext *ctx = (WorkerContext *)arg;
+    unsigned int seed = (unsigned int)ctx->id * 7919u + 1u;
+
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < BLOCKS_PER_THREAD; i++) {
+            seed = seed * 1103515245u + 12345u;
+            size_t size = 8 + (seed >> 16) % 400;
+            ctx->blocks[i] = arena_alloc(ctx->arena, size);
+            ctx->sizes[i] = size;
+            if (!ctx->blocks[i]) { ctx->failed = true; THREAD_RETURN; }
+            fill_memory_pattern(ctx->blocks[i], size, ctx->id * 31 + i);
+        }
+        for (int i = 0; i < BLOCKS_PER_THREAD; i++) {
+            if (!verify_memory_pattern(ctx->blocks[i], ctx->sizes[i], ctx->id * 31 + i)) ctx->failed = true;
+        }
+        for (int i = 0; i < BLOCKS_PER_THREAD; i++) {
+            arena_free_block(ctx->blocks[i]);
+        }
+    }
+
+    arena_thread_cache_flush(ctx->arena);
+    THREAD_RETURN;
+}
+
+static THREAD_FUNC(alloc_worker) {
+    WorkerContext *ctx = (WorkerContext *)arg;
+    for (int i = 0; i < BLOCKS_PER_THREAD; i++) {
+        ctx->sizes[i] = 16 + (size_t)((i * 37 + ctx->id * 11) % 300);
+        ctx->blocks[i] = arena_alloc(ctx->arena, ctx->sizes[i]);
+        if (!ctx->blocks[i]) { ctx->failed = true; THREAD_RETURN; }
+        fill_memory_pattern(ctx->blocks[i], ctx->sizes[i], ctx->id + i);
+    }
+    THREAD_RETURN;
+}
+
+static THREAD_FUNC(cross_free_worker) {
+    WorkerContext *ctx = (WorkerContext *)arg;
+    for (int i = 0; i < BLOCKS_PER_THREAD; i++) {
+        arena_free_block(ctx->blocks[i]);
+        // Keep allocating meanwhile, so remote frees race with the owner's drains
+        void *p = arena_alloc(ctx->arena, SMALL_SIZE);
+        if (!p) { ctx->failed = true; break; }
+        arena_free_block(p);
+    }
+    arena_thread_cache_flush(ctx->arena);
+    THREAD_RETURN;
+}
+
+void test_thread_cache(void) {
+    TEST_PHASE("Thread Cache");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    ASSERT(arena != NULL, "Arena creation should succeed");
+
+    void *a = arena_alloc(arena, SMALL_SIZE);
+    void *guard = arena_alloc(arena, SMALL_SIZE);
+    size_t tail_before = free_size_in_tail(arena);
+
+    TEST_CASE("Small free is parked in the thread cache");
+    arena_free_block(a);
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Free tree should stay untouched");
+    ASSERT(free_size_in_tail(arena) == tail_before, "Tail should stay untouched");
+
+    TEST_CASE("Same size allocation is served from the cache");
+    void *b = arena_alloc(arena, SMALL_SIZE);
+    ASSERT(b == a, "Cached block should be reused");
+
+    TEST_CASE("Double free of a cached block is rejected");
+    arena_free_block(b);
+    arena_free_block(b);
+    void *c1 = arena_alloc(arena, SMALL_SIZE);
+    void *c2 = arena_alloc(arena, SMALL_SIZE);
+    ASSERT(c1 == a && c2 != a, "Block should be cached only once");
+
+    TEST_CASE("Much smaller request does not take a cached block");
+    void *medium = arena_alloc(arena, 200);
+    void *medium_guard = arena_alloc(arena, SMALL_SIZE);
+    arena_free_block(medium);
+    void *tiny = arena_alloc(arena, 8);
+    ASSERT(tiny != NULL && tiny != medium, "Cache should not waste a bigger block");
+    ASSERT(arena_alloc(arena, 200) == medium, "Cached block should still serve its own size");
+    (void)medium_guard;
+
+    TEST_CASE("Reset invalidates cached blocks");
+    arena_reset(arena);
+    void *first = arena_alloc(arena, SMALL_SIZE);
+    void *second = arena_alloc(arena, SMALL_SIZE);
+    ASSERT(first == a && second != first, "Stale cached block should never be handed out twice");
+
+    TEST_CASE("Flush gives cached blocks back to the arena");
+    arena_free_block(first);
+    arena_thread_cache_flush(arena);
+    ASSERT(arena_get_free_blocks(arena) != NULL, "Flushed block should land in the free tree");
+
+    (void)guard;
+    arena_free(arena);
+}
+
+void test_thread_cache_churn(void) {
+    TEST_PHASE("Thread Cache Churn");
+
+    TEST_CASE("Slots of arenas freed by another thread are reused");
+    bool cached = true;
+    for (int round = 0; round < CHURN_ROUNDS; round++) {
+        Arena *arenas[CHURN_ARENAS];
+        for (int i = 0; i < CHURN_ARENAS; i++) {
+            arenas[i] = arena_new_dynamic(CHURN_ARENA_SIZE);
+            void *block = arena_alloc(arenas[i], SMALL_SIZE);
+            arena_alloc(arenas[i], SMALL_SIZE);
+            arena_free_block(block);
+            if (arena_get_free_blocks(arenas[i]) != NULL) cached = false;
+        }
+
+        // The arenas go away on one worker thread, this thread never learns of it directly
+        test_thread thread;
+        thread_start(&thread, free_arenas_worker, arenas);
+        thread_join(thread);
+    }
+    ASSERT(cached, "Every short-lived arena should have found a free cache slot");
+
+    TEST_CASE("Cache still works for a new arena");
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    void *a = arena_alloc(arena, SMALL_SIZE);
+    void *guard = arena_alloc(arena, SMALL_SIZE);
+    size_t tail_before = free_size_in_tail(arena);
+    arena_free_block(a);
+    ASSERT(arena_get_free_blocks(arena) == NULL && free_size_in_tail(arena) == tail_before, "Block should be parked in the cache");
+    ASSERT(arena_alloc(arena, SMALL_SIZE) == a, "Cached block should be reused");
+
+    TEST_CASE("Static arenas bypass the cache");
+    static char buffer[CHURN_ARENA_SIZE];
+    Arena *fixed = arena_new_static(buffer, sizeof(buffer));
+    void *b = arena_alloc(fixed, SMALL_SIZE);
+    arena_alloc(fixed, SMALL_SIZE);
+    arena_free_block(b);
+    ASSERT(arena_get_free_blocks(fixed) != NULL, "Block of a static arena should go back to the arena");
+
+    (void)guard;
+    arena_free(arena);
+}
+
+void test_rewind_cached_blocks(void) {
+    TEST_PHASE("Rewind With Cached Blocks");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    void *front = arena_alloc(arena, SMALL_SIZE);
+    void *keep = arena_alloc(arena, SMALL_SIZE);
+    arena_free_block(front);
+
+    // Another thread marks and rewinds, while this thread caches a block on both sides of the mark
+    MarkContext ctx = { arena, { NULL, 0, NULL }, NULL };
+    test_thread thread;
+    thread_start(&thread, mark_worker, &ctx);
+    thread_join(thread);
+    arena_free_block(ctx.block);
+    thread_start(&thread, rewind_worker, &ctx);
+    thread_join(thread);
+    size_t rewound_tail = free_size_in_tail(arena);
+
+    TEST_CASE("Cached block in front of the mark survives");
+    void *again = arena_alloc(arena, SMALL_SIZE);
+    ASSERT(again == front, "Block cached in front of the mark should still be handed out");
+
+    TEST_CASE("Cached block behind the mark is dropped");
+    arena_free_block(again);
+    arena_thread_cache_flush(arena);
+    ASSERT(free_size_in_tail(arena) == rewound_tail, "Rewound block should not be released twice");
+    ASSERT(arena_alloc(arena, SMALL_SIZE) == front, "Flushed block in front of the mark should go back to the arena");
+
+    (void)keep;
+    arena_free(arena);
+}
+
+#if !defined(_WIN32)
+void test_thread_exit_flush(void) {
+    TEST_PHASE("Thread Exit Flush");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    MarkContext ctx = { arena, { NULL, 0, NULL }, NULL };
+
+    TEST_CASE("Exiting thread gives its cached blocks back");
+    test_thread thread;
+    thread_start(&thread, exit_worker, &ctx);
+    thread_join(thread);
+    ASSERT(ctx.block != NULL && arena_alloc(arena, SMALL_SIZE) == ctx.block, "Block cached by the exited thread should be reusable");
+
+    arena_free(arena);
+}
+#endif
+
+void test_remote_free(void) {
+    TEST_PHASE("Remote Free");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    void *blocks[BLOCKS_PER_THREAD] = {0};
+    for (int i = 0; i < BLOCKS_PER_THREAD; i++) {
+        blocks[i] = arena_alloc(arena, LARGE_SIZE);
+        ASSERT_QUIET(blocks[i] != NULL, "Allocation should succeed");
+    }
+    void *guard = arena_alloc(arena, LARGE_SIZE);
+    size_t tail_before = free_size_in_tail(arena);
+
+    TEST_CASE("Frees from another thread go to the remote list");
+    WorkerContext ctx = { arena, blocks, NULL, 1, false };
+    test_thread thread;
+    thread_start(&thread, free_blocks_worker, &ctx);
+    thread_join(thread);
+
+    ASSERT(arena_get_ext(arena)->remote_free != NULL, "Remote list should hold the freed blocks");
+    ASSERT(arena_get_free_blocks(arena) == NULL, "Owner tree should not be touched by other threads");
+
+    TEST_CASE("Next allocation merges remote frees");
+    size_t big = (size_t)BLOCKS_PER_THREAD * LARGE_SIZE;
+    void *merged = arena_alloc(arena, big);
+    ASSERT(arena_get_ext(arena)->remote_free == NULL, "Remote list should be drained");
+    ASSERT(merged == blocks[0], "Remotely freed blocks should coalesce into one");
+    ASSERT(free_size_in_tail(arena) == tail_before, "Merged allocation should not touch the tail");
+
+    (void)guard;
+    arena_free(arena);
+}
+
+void test_concurrent_churn(const char *phase) {
+    TEST_PHASE(phase);
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE * 4);
+    size_t initial_tail = free_size_in_tail(arena);
+
+    static void *blocks[THREAD_COUNT][BLOCKS_PER_THREAD];
+    static size_t sizes[THREAD_COUNT][BLOCKS_PER_THREAD];
+    WorkerContext ctx[THREAD_COUNT];
+    test_thread threads[THREAD_COUNT];
+
+    TEST_CASE("Threads allocate and free in a shared arena");
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        ctx[i] = (WorkerContext){ arena, blocks[i], sizes[i], i, false };
+        thread_start(&threads[i], churn_worker, &ctx[i]);
+    }
+    bool failed = false;
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        thread_join(threads[i]);
+        failed |= ctx[i].failed;
+    }
+    ASSERT(!failed, "Every thread should keep its memory intact");
+
+    TEST_CASE("Threads free blocks allocated by other threads");
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        ctx[i] = (WorkerContext){ arena, blocks[i], sizes[i], i, false };
+        thread_start(&threads[i], alloc_worker, &ctx[i]);
+    }
+    for (int i = 0; i < THREAD_COUNT; i++) thread_join(threads[i]);
+
+    bool intact = true;
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        failed |= ctx[t].failed;
+        for (int i = 0; i < BLOCKS_PER_THREAD; i++) {
+            if (!verify_memory_pattern(blocks[t][i], sizes[t][i], t + i)) intact = false;
+        }
+    }
+    ASSERT(!failed && intact, "Concurrent allocations should never overlap");
+
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        ctx[i] = (WorkerContext){ arena, blocks[(i + 1) % THREAD_COUNT], sizes[i], i, false };
+        thread_start(&threads[i], cross_free_worker, &ctx[i]);
+    }
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        thread_join(threads[i]);
+        failed |= ctx[i].failed;
+    }
+    ASSERT(!failed, "Allocations should succeed while other threads free remotely");
+
+    TEST_CASE("Everything coalesces back after all frees");
+    arena_thread_cache_flush(arena);
+    void *whole = arena_alloc(arena, initial_tail - ARENA_DEFAULT_ALIGNMENT);
+    ASSERT(whole != NULL, "Whole arena should be available again");
+
+    arena_free(arena);
+}
+
+void test_nested_thread_safe(void) {
+    TEST_PHASE("Nested Arenas In Threads");
+
+    Arena *parent = arena_new_dynamic(ARENA_SIZE);
+    size_t parent_tail = free_size_in_tail(parent);
+
+    Arena *nested = arena_new_nested(parent, ARENA_SIZE / 4);
+    ASSERT(nested != NULL, "Nested arena creation should succeed");
+
+    void *inner = arena_alloc(nested, LARGE_SIZE);
+    void *blocks[BLOCKS_PER_THREAD] = { inner };
+    for (int i = 1; i < BLOCKS_PER_THREAD; i++) blocks[i] = NULL;
+    WorkerContext ctx = { nested, blocks, NULL, 2, false };
+    test_thread thread;
+    thread_start(&thread, free_blocks_worker, &ctx);
+    thread_join(thread);
+    ASSERT(arena_get_ext(nested)->remote_free != NULL, "Nested arena should receive its own remote frees");
+    ASSERT(arena_get_ext(parent)->remote_free == NULL, "Parent should not see blocks of the nested arena");
+
+    arena_free(nested);
+    ASSERT(free_size_in_tail(parent) == parent_tail, "Nested arena should be returned to the parent");
+
+    arena_free(parent);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_thread_cache();
+    test_thread_cache_churn();
+    test_rewind_cached_blocks();
+    #if !defined(_WIN32)
+    test_thread_exit_flush();
+    #endif
+    test_remote_free();
+    test_concurrent_churn("Concurrent Churn");
+
+    // Neighbour checks race with the splits and merges of other threads unless they run under the arena lock
+    arena_set_validation(ARENA_VALIDATE_HARDENED);
+    test_concurrent_churn("Concurrent Churn (Hardened Validation)");
+    arena_set_validation((ArenaValidation)ARENA_VALIDATION);
+    test_nested_thread_safe();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
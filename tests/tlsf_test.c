@@ -0,0 +1,116 @@
+#define ARENA_TLSF
+#define ARENA_FREE_INDEX_MAX_SHIFT 12
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (256 * 1024)
+#define STRESS_COUNT (300)
+#define STRESS_ROUNDS (5000)
+
+void test_tlsf_good_fit(void) {
+    TEST_PHASE("TLSF Good Fit");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Mode builds on the bitmap free index");
+    ASSERT(good_fit_size(arena, 128, arena_get_alignment(arena)) == 128 + 128 / FREE_INDEX_SL_COUNT - 1, "Request should round up to the next list");
+    ASSERT(good_fit_size(arena, 16, arena_get_alignment(arena)) == 16 + 7, "Small requests should round up to the next 8 bytes");
+    ASSERT(good_fit_size(arena, 128, 256) >= 128 + 256 - arena_get_alignment(arena), "Worst case padding should be added");
+
+    TEST_CASE("Own list is skipped even if a block there would fit");
+    void *close = arena_alloc(arena, 144);
+    arena_alloc(arena, 16);
+    void *big = arena_alloc(arena, 512);
+    arena_alloc(arena, 16);
+    arena_free_block(close);
+    arena_free_block(big);
+    void *p = arena_alloc(arena, 130);
+    ASSERT(p == big, "Request should take the head of the next non-empty list");
+    ASSERT(arena_get_ext(arena)->free_index.fl_bitmap != 0, "Close block and the rest of the big one should stay listed");
+
+    TEST_CASE("Exact list boundary reuses its list");
+    void *q = arena_alloc(arena, 128);
+    ASSERT(q == close, "Request at a list bound should take the head of its own list");
+
+    TEST_CASE("Over-aligned request fits without checking more than one block");
+    arena_reset(arena);
+    void *hole = arena_alloc(arena, 1024);
+    void *guard = arena_alloc(arena, 16);
+    arena_free_block(hole);
+    void *aligned = arena_alloc_custom(arena, 256, 256);
+    ASSERT(aligned != NULL && ((uintptr_t)aligned % 256) == 0, "Alignment should be honoured");
+    ASSERT((char *)aligned < (char *)guard, "Free block should serve the over-aligned request");
+
+    arena_free(arena);
+}
+
+void test_tlsf_shared_list(void) {
+    TEST_PHASE("TLSF Shared Last List");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Blocks past the last class share one list");
+    void *large = arena_alloc(arena, 12000);
+    arena_alloc(arena, 16);
+    void *huge = arena_alloc(arena, 9000);
+    arena_alloc(arena, 16);
+    arena_free_block(large);
+    arena_free_block(huge);
+
+    TEST_CASE("Head that does not fit falls through to the tail");
+    size_t tail_before = free_size_in_tail(arena);
+    void *p = arena_alloc(arena, 10000);
+    ASSERT(p != NULL && free_size_in_tail(arena) < tail_before, "Request should be served by the tail");
+    ASSERT(arena_alloc(arena, 2000) == huge, "Head of the shared list should be taken when it fits");
+
+    arena_free(arena);
+}
+
+void test_tlsf_stress(void) {
+    TEST_PHASE("TLSF Stress");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    void *objects[STRESS_COUNT] = {0};
+    size_t sizes[STRESS_COUNT] = {0};
+    uint32_t state = 11;
+    int pattern_errors = 0;
+
+    TEST_CASE("Random allocations and frees keep every block intact");
+    for (int round = 0; round < STRESS_ROUNDS; round++) {
+        state = state * 1103515245u + 12345u;
+        size_t slot = (state >> 8) % STRESS_COUNT;
+
+        if (objects[slot]) {
+            if (!verify_memory_pattern(objects[slot], sizes[slot], (int)slot)) pattern_errors++;
+            arena_free_block(objects[slot]);
+            objects[slot] = NULL;
+        }
+        else {
+            sizes[slot] = 8 + (state >> 16) % 1500;
+            objects[slot] = (state & 2) ? arena_alloc(arena, sizes[slot]) : arena_alloc_custom(arena, sizes[slot], 128);
+            if (objects[slot]) fill_memory_pattern(objects[slot], sizes[slot], (int)slot);
+        }
+    }
+    ASSERT(pattern_errors == 0, "Live blocks should keep their contents");
+
+    TEST_CASE("Freeing everything coalesces into the tail");
+    for (int i = 0; i < STRESS_COUNT; i++) {
+        if (objects[i]) arena_free_block(objects[i]);
+    }
+    ASSERT(arena_get_ext(arena)->free_index.fl_bitmap == 0, "Free lists should be empty");
+    ASSERT(arena_get_tail(arena) == arena_get_first_block(arena), "Whole arena should be one free tail");
+
+    arena_free(arena);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_tlsf_good_fit();
+    test_tlsf_shared_list();
+    test_tlsf_stress();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -358,6 +358,7 @@ void test_arena_reset_zero(void) {
     ASSERT(free_size_in_tail(arena) == arena_init_free_size, "Arena free size should be reset to initial state");
 
     TEST_CASE("Verify memory zeroing");
+    ARENA_DEFINE_MEMORY(ptr1, arena_get_capacity(arena) - (size_t)(ptr1 - (unsigned char *)arena)); // Peek into the freed memory
 
     int is_zero_1 = 1;
     for (size_t i = 0; i < data_size; i++) {
@@ -614,6 +615,26 @@ void test_tail_alloc_edge_case_deterministic(void) {
     ASSERT(p2 != NULL, "This should trigger the 'final_needed_block_size = free_space' branch");
 }
 
+void test_free_before_occupied_tail(void) {
+    TEST_CASE("Free block before tail that absorbed the remaining space");
+    Arena *arena = arena_new_dynamic(1024);
+
+    void *first = arena_alloc(arena, 64);
+    size_t rest = free_size_in_tail(arena);
+    void *last = arena_alloc(arena, rest);
+    ASSERT(last != NULL, "Allocation absorbing the whole tail should succeed");
+    ASSERT(free_size_in_tail(arena) == 0, "Tail should be fully occupied");
+
+    arena_free_block(first);
+    ASSERT(free_size_in_tail(arena) == 0, "Occupied tail must not be reclaimed by its neighbour");
+
+    void *reused = arena_alloc(arena, 64);
+    ASSERT(reused == first, "Freed block should be reused from the free tree");
+    ASSERT(!pointers_overlap(reused, 64, last, rest), "Reused block must not overlap the live tail allocation");
+
+    arena_free(arena);
+}
+
 
 int main(void) {
     setvbuf(stdout, NULL, _IONBF, 0); 
@@ -629,6 +650,7 @@ int main(void) {
     test_alignment_alloc();
     test_static_arena_detector_coverage();
     test_tail_alloc_edge_case_deterministic();
+    test_free_before_occupied_tail();
     
     print_test_summary();
     return tests_failed > 0 ? 1 : 0;
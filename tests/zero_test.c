@@ -0,0 +1,175 @@
+#define ARENA_ZERO_TRACKING
+#define ARENA_MMAP
+#define ARENA_IMPLEMENTATION
+#include "arena.h"
+#include "test_utils.h"
+
+#define ARENA_SIZE (64 * 1024)
+#define BIG_SIZE (4 * 1024 * 1024)
+#define BLOCK_SIZE (256)
+
+static bool is_zero(const void *ptr, size_t size) {
+    ARENA_DEFINE_MEMORY(ptr, size); // Free memory is checked as well, which sanitizers would report
+    const unsigned char *bytes = (const unsigned char *)ptr;
+    for (size_t i = 0; i < size; i++) {
+        if (bytes[i] != 0) return false;
+    }
+    return true;
+}
+
+static uintptr_t zero_mark(Arena *arena) {
+    return arena_get_ext(arena)->zero_mark;
+}
+
+void test_zero_mark(void) {
+    TEST_PHASE("Known-Zero Mark");
+
+    TEST_CASE("Fresh arenas start known zero");
+    Arena *dynamic = arena_new_dynamic(ARENA_SIZE);
+    ASSERT(zero_mark(dynamic) == (uintptr_t)block_data(arena_get_tail(dynamic)), "Dynamic arena memory should come zeroed");
+    Arena *mapped = arena_new_mapped(ARENA_SIZE, 0);
+    ASSERT(zero_mark(mapped) == (uintptr_t)block_data(arena_get_tail(mapped)), "Mapped arena memory should read as zero");
+    static char memory[ARENA_SIZE];
+    Arena *fixed = arena_new_static(memory, ARENA_SIZE);
+    ASSERT(zero_mark(fixed) == (uintptr_t)fixed + arena_get_capacity(fixed), "Static memory should not be trusted");
+
+    TEST_CASE("Carving from the tail raises the mark");
+    void *p = arena_alloc(dynamic, BLOCK_SIZE);
+    ASSERT(zero_mark(dynamic) == (uintptr_t)block_data(arena_get_tail(dynamic)), "Mark should follow the tail");
+    void *nodes[8];
+    arena_alloc_batch(dynamic, BLOCK_SIZE, 8, nodes);
+    ASSERT(zero_mark(dynamic) == (uintptr_t)block_data(arena_get_tail(dynamic)), "Batches should raise the mark");
+    arena_try_resize(nodes[7], BLOCK_SIZE * 4);
+    ASSERT(zero_mark(dynamic) == (uintptr_t)block_data(arena_get_tail(dynamic)), "Growing into the tail should raise the mark");
+
+    TEST_CASE("Memory given back to the tail stays dirty");
+    uintptr_t mark = zero_mark(dynamic);
+    arena_try_resize(nodes[7], BLOCK_SIZE);
+    arena_free_batch(nodes, 8);
+    ASSERT(zero_mark(dynamic) == mark && (uintptr_t)block_data(arena_get_tail(dynamic)) < mark, "Mark should never move back on free");
+
+    TEST_CASE("Absorbed tail dirties the whole arena");
+    arena_alloc(fixed, free_size_in_tail(fixed));
+    ASSERT(zero_mark(fixed) == (uintptr_t)fixed + arena_get_capacity(fixed), "Mark should reach the end");
+
+    (void)p;
+    arena_free(dynamic);
+    arena_free(mapped);
+}
+
+void test_zero_calloc(void) {
+    TEST_PHASE("Calloc From Known-Zero Memory");
+
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+
+    TEST_CASE("Fresh tail memory is handed out as is");
+    unsigned char *fresh = (unsigned char *)arena_calloc(arena, 4, BLOCK_SIZE);
+    ASSERT(fresh != NULL && is_zero(fresh, 4 * BLOCK_SIZE), "Fresh calloc should read as zero");
+    ASSERT(arena_get_ext(arena)->fresh == NULL, "Fresh allocation should be consumed by calloc");
+
+    TEST_CASE("Reused memory is still cleared");
+    memset(fresh, 0xAB, 4 * BLOCK_SIZE);
+    void *guard = arena_alloc(arena, BLOCK_SIZE);
+    arena_free_block(fresh);
+    unsigned char *reused = (unsigned char *)arena_calloc(arena, 4, BLOCK_SIZE);
+    ASSERT(reused == fresh && is_zero(reused, 4 * BLOCK_SIZE), "Reused block should be zeroed");
+
+    TEST_CASE("Plain allocation does not leave a stale fresh block");
+    void *plain = arena_alloc(arena, BLOCK_SIZE);
+    ASSERT(arena_get_ext(arena)->fresh == plain, "Plain tail allocation should be recorded as fresh");
+    memset(plain, 0xCD, BLOCK_SIZE);
+    arena_free_block(guard);
+    unsigned char *again = (unsigned char *)arena_calloc(arena, 1, BLOCK_SIZE);
+    ASSERT(again == guard && is_zero(again, BLOCK_SIZE), "Calloc from the free tree should clear the block");
+    arena_free_block(plain);
+    unsigned char *last = (unsigned char *)arena_calloc(arena, 1, BLOCK_SIZE);
+    ASSERT(is_zero(last, BLOCK_SIZE), "Calloc after a free to the tail should clear dirty memory");
+
+    TEST_CASE("Calloc after reset");
+    arena_reset(arena);
+    unsigned char *after_reset = (unsigned char *)arena_calloc(arena, 4, BLOCK_SIZE);
+    ASSERT(is_zero(after_reset, 4 * BLOCK_SIZE), "Memory dirtied before the reset should be cleared");
+
+    arena_free(arena);
+}
+
+void test_zero_reset(void) {
+    TEST_PHASE("Reset Zero Clears the Dirty Range Only");
+
+    TEST_CASE("Only written memory is cleared");
+    Arena *arena = arena_new_dynamic(ARENA_SIZE);
+    char *p = (char *)arena_alloc(arena, BLOCK_SIZE * 4);
+    memset(p, 0xEE, BLOCK_SIZE * 4);
+    char *untouched = (char *)arena + arena_get_capacity(arena) - 1;
+    ARENA_DEFINE_MEMORY(untouched, 1);
+    *untouched = 0x11; // Written behind the back of the arena, a full clear would wipe it
+    arena_reset_zero(arena);
+    ARENA_DEFINE_MEMORY(untouched, 1);
+    ASSERT(is_zero(p, BLOCK_SIZE * 4), "Dirty range should be cleared");
+    ASSERT(*untouched == 0x11, "Memory above the mark should not be written");
+    ASSERT(zero_mark(arena) == (uintptr_t)block_data(arena_get_tail(arena)), "Whole tail should be known zero");
+    *untouched = 0;
+    arena_free(arena);
+
+    TEST_CASE("Static arena is cleared once, then tracked");
+    static char memory[ARENA_SIZE];
+    memset(memory, 0x77, sizeof(memory));
+    Arena *fixed = arena_new_static(memory, ARENA_SIZE);
+    arena_reset_zero(fixed);
+    ASSERT(is_zero(block_data(arena_get_tail(fixed)), free_size_in_tail(fixed)), "Untrusted memory should be cleared entirely");
+    void *small = arena_calloc(fixed, 1, BLOCK_SIZE);
+    ASSERT(small != NULL && is_zero(small, BLOCK_SIZE), "Calloc after the clear should be served as is");
+
+    TEST_CASE("Big ranges are streamed");
+    Arena *big = arena_new_dynamic(BIG_SIZE);
+    char *q = (char *)arena_alloc(big, BIG_SIZE / 2 + 3);
+    memset(q, 0x5A, BIG_SIZE / 2 + 3);
+    arena_reset_zero(big);
+    ASSERT(is_zero(q, BIG_SIZE / 2 + 3), "Streamed clear should cover every byte");
+    arena_free(big);
+
+    TEST_CASE("Mapped arenas drop dirty pages");
+    Arena *mapped = arena_new_mapped(BIG_SIZE, 0);
+    char *m = (char *)arena_alloc(mapped, BIG_SIZE / 2);
+    memset(m, 0x3C, BIG_SIZE / 2);
+    arena_reset_zero(mapped);
+    m = (char *)arena_alloc(mapped, BIG_SIZE / 2);
+    ASSERT(is_zero(m, BIG_SIZE / 2), "Dropped pages should read as zero");
+    arena_free(mapped);
+
+    TEST_CASE("Released pages lower the mark");
+    Arena *released = arena_new_mapped(BIG_SIZE, ARENA_MMAP_RELEASE);
+    char *r = (char *)arena_alloc(released, BIG_SIZE / 2);
+    memset(r, 0x42, BIG_SIZE / 2);
+    arena_reset(released);
+    ASSERT(zero_mark(released) < (uintptr_t)r + BIG_SIZE / 2, "Pages given back on reset should be known zero");
+    r = (char *)arena_calloc(released, 1, BIG_SIZE / 2);
+    ASSERT(is_zero(r, BIG_SIZE / 2), "Calloc over released pages should read as zero");
+    arena_free(released);
+
+    TEST_CASE("Growable arenas clear every retained chunk");
+    Arena *growable = arena_new_dynamic_growable(4096);
+    void *blocks[64];
+    for (int i = 0; i < 64; i++) {
+        blocks[i] = arena_alloc(growable, BLOCK_SIZE);
+        memset(blocks[i], 0x99, BLOCK_SIZE);
+    }
+    arena_reset_zero(growable);
+    bool clean = true;
+    for (Arena *chunk = growable; chunk != NULL; chunk = arena_get_chunk(chunk)->next) {
+        if (!is_zero(block_data(arena_get_tail(chunk)), free_size_in_tail(chunk))) clean = false;
+    }
+    ASSERT(clean, "Every chunk tail should read as zero");
+    arena_free(growable);
+}
+
+int main(void) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    test_zero_mark();
+    test_zero_calloc();
+    test_zero_reset();
+
+    print_test_summary();
+    return tests_failed > 0 ? 1 : 0;
+}